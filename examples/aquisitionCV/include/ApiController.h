@@ -2,10 +2,19 @@
 #define AVT_VMBAPI_EXAMPLES_APICONTROLLER
 
 #include <string>
+#include <vector>
+#include <memory>
 
 #include "VimbaCPP/Include/VimbaCPP.h"
 
 #include "FrameObserver.h"
+#include "FrameSource.h"
+#include "FrameSynchronizer.h"
+#include "FrameRecorder.h"
+#include "PreviewDisplay.h"
+#include "BandwidthPlanner.h"
+#include "CameraPreset.h"
+#include "CameraInventory.h"
 
 namespace AVT {
 namespace VmbAPI {
@@ -30,30 +39,149 @@ class ApiController
     void                ShutDown();
     
     //
-    // Opens the given camera
-    // Sets the maximum possible Ethernet packet size
+    // Opens the given cameras, synthetic cameras or recordings if configured, each on a thread of its own
     // Adjusts the image format
-    // Sets up the observer that will be notified on every incoming frame
-    // Calls the API convenience function to start image acquisition
-    // Closes the camera in case of failure
+    // Sets the largest packet size the network carries and splits the bandwidth of every interface among
+    // its cameras if configured
+    // Applies the configured preset
+    // Sets up one observer per camera that will be notified on every incoming frame
+    // Announces the frames and starts image acquisition
+    // Closes a camera in case of failure, the others keep streaming
+    // A camera lost while streaming is reconnected with its configuration and frames
     //
     // Parameters:
-    //  [in]    Config      A configuration struct including the camera ID and other settings
+    //  [in]    Config      A configuration struct including the camera IDs and other settings
     //
     // Returns:
-    //  An API status code
+    //  VmbErrorSuccess if at least one camera streams, else the error of the first camera
     //
     VmbErrorType        StartContinuousImageAcquisition( const ProgramConfig & );    
     
     //
-    // Calls the API convenience function to stop image acquisition
-    // Closes the camera
+    // Stops image acquisition of all cameras
+    // Closes the cameras
     //
     // Returns:
-    //  An API status code
+    //  An API status code, the first error of any camera
     //
     VmbErrorType        StopContinuousImageAcquisition();
 
+    //
+    // Applies a preset of the file given at start to all streaming cameras, each on a thread of its own
+    // The announced buffers fix the image format: a camera is left as it is if the preset changes its
+    // pixel format, binning, decimation or size, its report lists these features
+    //
+    // Parameters:
+    //  [in]    strName     Name of the preset
+    //  [out]   Reports     One per camera of the last start, VmbErrorInvalidCall for cameras not streaming
+    //
+    // Returns:
+    //  VmbErrorNotFound if there is no such preset, else the first error of any camera
+    //
+    VmbErrorType        ApplyPreset( const std::string &strName, std::vector<PresetReport> &Reports );
+
+    //
+    // Gets the number of cameras of the last start, including those that failed
+    //
+    size_t              GetStreamCount() const;
+
+    //
+    // Gets the ID of a camera of the last start
+    //
+    std::string         GetStreamCameraID( size_t nStream ) const;
+
+    //
+    // Gets the result of opening and starting a camera of the last start
+    //
+    VmbErrorType        GetStreamResult( size_t nStream ) const;
+
+    //
+    // Gets the hand-off queue counters of one camera
+    //
+    // Returns:
+    //  Received, processed and overflowed frames plus queue depth
+    //
+    FrameQueueStatistics GetQueueStatistics( size_t nStream ) const;
+
+    //
+    // Gets the hand-off queue counters summed over all cameras
+    //
+    // Returns:
+    //  Received, processed and overflowed frames plus queue depth, the highest depth of any camera
+    //
+    FrameQueueStatistics GetQueueStatistics() const;
+
+    //
+    // Gets the counters of the recording of one camera
+    //
+    // Returns:
+    //  Recorded and dropped frames and bytes written, all 0 without recording
+    //
+    RecordStatistics    GetRecordStatistics( size_t nStream ) const;
+
+    //
+    // Gets the counters of the frame bundling across cameras
+    //
+    // Returns:
+    //  Processed bundles, unmatched, late and dropped frames, all 0 without bundling
+    //
+    BundleStatistics    GetBundleStatistics() const;
+
+    //
+    // Gets the counters of the preview of one camera
+    //
+    // Returns:
+    //  Frames offered to and shown by the preview, all 0 without preview
+    //
+    PreviewStatistics   GetPreviewStatistics( size_t nStream ) const;
+
+    //
+    // Gets the counters of the processing pipeline of one camera
+    //
+    // Returns:
+    //  Frames pushed and completed and the counters of every stage, empty without pipeline
+    //
+    PipelineStatistics  GetPipelineStatistics( size_t nStream ) const;
+
+    //
+    // Gets the outages of one camera
+    //
+    // Returns:
+    //  Losses, reconnects and the time to the first frame after reconnecting, all 0 for a camera never lost
+    //
+    ReconnectStatistics GetReconnectStatistics( size_t nStream ) const;
+
+    //
+    // Gets the frame buffers of one camera
+    //
+    // Returns:
+    //  Frames announced at start and now, the growths and the hold times they were sized for
+    //
+    BufferDepthStatistics GetBufferStatistics( size_t nStream ) const;
+
+    //
+    // Gets the bandwidth planned for one camera
+    //
+    // Returns:
+    //  Cap and planned frame rate, all 0 without planning or for cameras not on a network
+    //
+    BandwidthAllocation GetBandwidthPlan( size_t nStream ) const;
+
+    //
+    // Finds the cameras to open through the camera inventory and its cache, shared with the list cameras example
+    // Without IDs the cameras of the cache are validated concurrently, all cameras are only enumerated
+    // if fewer than needed answer
+    // Given IDs that are serial numbers of cached cameras are replaced by their IDs
+    //
+    // Parameters:
+    //  [in]    nCount      The number of cameras to take if no IDs are given
+    //  [in,out] IDs        The camera IDs or serial numbers given, receives the IDs to open
+    //
+    // Returns:
+    //  VmbErrorNotFound if no camera is found
+    //
+    VmbErrorType        FindCameras( size_t nCount, std::vector<std::string> &IDs );
+
     //
     // Gets all cameras known to Vimba
     //
@@ -82,10 +210,41 @@ class ApiController
     std::string         GetVersion() const;
 
   private:
-    VmbErrorType        PrepareCamera();
+    struct CameraStream
+    {
+        std::string                     CameraID;
+        std::unique_ptr<IFrameSource>   pSource;            // NULL once stopped or failed
+        std::unique_ptr<FrameObserver>  pFrameObserver;     // Every camera has its own frame observer
+        std::unique_ptr<FrameRecorder>  pRecorder;          // Only while recording
+        VmbErrorType                    Result;             // Of opening and starting the camera
+        FrameQueueStatistics            LastStatistics;     // Counters once stopped
+        RecordStatistics                LastRecordStatistics;
+        PipelineStatistics              LastPipelineStatistics;
+        ReconnectStatistics             LastReconnectStatistics;
+        BufferDepthStatistics           LastBufferStatistics;
+        BandwidthDemand                 Demand;             // Read when opening with bandwidth planning
+        bool                            bBandwidthDemand;   // Whether Demand was read, false if not on a network
+        BandwidthAllocation             Bandwidth;          // All 0 if not planned
+
+        CameraStream()
+            : Result( VmbErrorOther )
+            , bBandwidthDemand( false )
+        {}
+    };
+
+    void                OpenStream( CameraStream &, const ProgramConfig &, size_t nStream );
+    void                PlanStreamBandwidth( double dLinkSpeed );
+    void                StartStream( CameraStream &, const ProgramConfig &, size_t nStream );
+    VmbErrorType        StopStream( CameraStream & );
+    void                ReleaseStream( CameraStream & );
+
     VimbaSystem &       m_system;                   // A reference to our Vimba singleton
-    CameraPtr           m_pCamera;                  // The currently streaming camera
-    FrameObserver*      m_pFrameObserver;           // Every camera has its own frame observer
+    std::vector< std::unique_ptr<CameraStream> > m_Streams;    // The cameras of the last start
+    std::unique_ptr<FrameSynchronizer> m_pSynchronizer;        // Only with bundling of several cameras
+    std::unique_ptr<PreviewDisplay> m_pDisplay;                 // Only with preview, kept after stopping for its counters
+    BundleStatistics    m_LastBundleStatistics;     // Counters once stopped
+    std::vector<CameraPreset> m_Presets;            // Of the preset file, kept for switching while streaming
+    const CameraPreset *m_pStartPreset;             // Applied when opening, NULL without presets
 };
 
 }} // namespace AVT::VmbAPI
@@ -0,0 +1,84 @@
+#ifndef AVT_VMBAPI_EXAMPLES_BANDWIDTHPLANNER
+#define AVT_VMBAPI_EXAMPLES_BANDWIDTHPLANNER
+
+#include <string>
+#include <vector>
+
+#include "VimbaCPP/Include/VimbaCPP.h"
+#include "CameraFeatures.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+/**
+ * @brief What one GigE camera needs from the network, read from the camera by ReadBandwidthDemand
+ */
+struct BandwidthDemand
+{
+    std::string     InterfaceID;    // Cameras on the same interface share its bandwidth
+    VmbInt64_t      PayloadSize;    // Bytes per frame
+    VmbInt64_t      PacketSize;     // GVSP packet size in bytes, IP and UDP headers included
+    double          FrameRate;      // Frames per second the camera is set to, 0 if unknown
+
+    BandwidthDemand()
+        : PayloadSize( 0 )
+        , PacketSize( 1500 )
+        , FrameRate( 0.0 )
+    {}
+};
+
+/**
+ * @brief The share of its interface a camera gets
+ */
+struct BandwidthAllocation
+{
+    double          WireBytesPerFrame;      // A frame on the Ethernet, headers and gaps included
+    double          DemandBytesPerSecond;   // At the set frame rate, 0 if the rate is unknown
+    double          CapBytesPerSecond;      // StreamBytesPerSecond of the camera
+    double          PlannedFrameRate;       // The rate fitting into the cap
+
+    BandwidthAllocation()
+        : WireBytesPerFrame( 0.0 )
+        , DemandBytesPerSecond( 0.0 )
+        , CapBytesPerSecond( 0.0 )
+        , PlannedFrameRate( 0.0 )
+    {}
+};
+
+/**
+ * @brief Bytes a frame takes on the Ethernet: the payload cut into packets of PacketSize, each
+ * with its IP, UDP and GVSP headers plus Ethernet framing, preamble and inter-frame gap, and
+ * a leader and a trailer packet
+ */
+double          GetWireBytesPerFrame( VmbInt64_t nPayloadSize, VmbInt64_t nPacketSize );
+
+/**
+ * @brief Splits the bandwidth of every interface among its cameras. A camera asking for less
+ * than an equal share gets its demand plus some headroom for resends, the rest is shared equally
+ * by the others; a camera with unknown frame rate gets an equal share of what is left
+ *
+ * @param Demands One per camera
+ * @param dInterfaceBytesPerSecond What one interface can carry, already reduced by a margin
+ *
+ * @return One allocation per demand, in the same order
+ */
+std::vector<BandwidthAllocation> PlanBandwidth( const std::vector<BandwidthDemand> &Demands, double dInterfaceBytesPerSecond );
+
+/**
+ * @brief Lets the camera find the largest packet size the path to the host carries, then reads
+ * packet size, payload size and frame rate
+ *
+ * @return VmbErrorNotFound if the camera has no GVSP packet size, i.e. is no GigE camera
+ */
+VmbErrorType    ReadBandwidthDemand( ICameraFeatures &Features, BandwidthDemand &Demand );
+
+/**
+ * @brief Sets StreamBytesPerSecond to the cap, fitted to the range of the feature
+ *
+ * @param Allocation Cap and planned frame rate are updated to what the camera accepted
+ */
+VmbErrorType    ApplyBandwidth( ICameraFeatures &Features, BandwidthAllocation &Allocation );
+
+}} // namespace AVT::VmbAPI
+
+#endif
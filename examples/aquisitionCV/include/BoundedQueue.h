@@ -0,0 +1,154 @@
+#ifndef AVT_VMBAPI_EXAMPLES_BOUNDEDQUEUE
+#define AVT_VMBAPI_EXAMPLES_BOUNDEDQUEUE
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace AVT {
+namespace VmbAPI {
+
+/**
+ * @brief Bounded lock-free multi-producer / multi-consumer ring.
+ * Every cell carries a sequence number telling producers and consumers whose turn it is,
+ * so TryPush and TryPop never block, never allocate and only fail when the ring is full / empty.
+ *
+ * @tparam T Element type, must be default constructible and copy assignable
+ */
+template <typename T>
+class BoundedQueue
+{
+    public:
+        /**
+         * @brief Construct a new Bounded Queue object
+         *
+         * @param nCapacity Number of elements, rounded up to the next power of two
+         */
+        explicit BoundedQueue( size_t nCapacity )
+            :   m_nMask( RoundUpPow2( nCapacity ) - 1 )
+            ,   m_pCells( new Cell[ m_nMask + 1 ] )
+            ,   m_EnqueuePos( 0 )
+            ,   m_DequeuePos( 0 )
+        {
+            for( size_t i = 0; i <= m_nMask; ++i )
+            {
+                m_pCells[i].Sequence.store( i, std::memory_order_relaxed );
+            }
+        }
+
+        /**
+         * @brief Append an element
+         *
+         * @return false if the ring is full, the element is not stored then
+         */
+        bool TryPush( const T &value )
+        {
+            size_t nPos = m_EnqueuePos.load( std::memory_order_relaxed );
+            for( ;; )
+            {
+                Cell &cell = m_pCells[ nPos & m_nMask ];
+                const size_t nSeq = cell.Sequence.load( std::memory_order_acquire );
+                const ptrdiff_t nDiff = static_cast<ptrdiff_t>( nSeq ) - static_cast<ptrdiff_t>( nPos );
+                if( 0 == nDiff )
+                {
+                    if( m_EnqueuePos.compare_exchange_weak( nPos, nPos + 1, std::memory_order_relaxed ) )
+                    {
+                        cell.Value = value;
+                        cell.Sequence.store( nPos + 1, std::memory_order_release );
+                        return true;
+                    }
+                }
+                else if( nDiff < 0 )
+                {
+                    return false;
+                }
+                else
+                {
+                    nPos = m_EnqueuePos.load( std::memory_order_relaxed );
+                }
+            }
+        }
+
+        /**
+         * @brief Remove the oldest element
+         *
+         * @return false if the ring is empty
+         */
+        bool TryPop( T &value )
+        {
+            size_t nPos = m_DequeuePos.load( std::memory_order_relaxed );
+            for( ;; )
+            {
+                Cell &cell = m_pCells[ nPos & m_nMask ];
+                const size_t nSeq = cell.Sequence.load( std::memory_order_acquire );
+                const ptrdiff_t nDiff = static_cast<ptrdiff_t>( nSeq ) - static_cast<ptrdiff_t>( nPos + 1 );
+                if( 0 == nDiff )
+                {
+                    if( m_DequeuePos.compare_exchange_weak( nPos, nPos + 1, std::memory_order_relaxed ) )
+                    {
+                        value = cell.Value;
+                        // Do not keep a reference to the element alive inside the ring
+                        cell.Value = T();
+                        cell.Sequence.store( nPos + m_nMask + 1, std::memory_order_release );
+                        return true;
+                    }
+                }
+                else if( nDiff < 0 )
+                {
+                    return false;
+                }
+                else
+                {
+                    nPos = m_DequeuePos.load( std::memory_order_relaxed );
+                }
+            }
+        }
+
+        /**
+         * @brief Approximate number of queued elements, exact only when no push or pop is in flight
+         */
+        size_t Size() const
+        {
+            const size_t nEnqueue = m_EnqueuePos.load( std::memory_order_relaxed );
+            const size_t nDequeue = m_DequeuePos.load( std::memory_order_relaxed );
+            return nEnqueue > nDequeue ? nEnqueue - nDequeue : 0;
+        }
+
+        size_t Capacity() const
+        {
+            return m_nMask + 1;
+        }
+
+    private:
+        BoundedQueue( const BoundedQueue& );
+        BoundedQueue& operator=( const BoundedQueue& );
+
+        static size_t RoundUpPow2( size_t n )
+        {
+            size_t nPow2 = 2;
+            while( nPow2 < n )
+            {
+                nPow2 <<= 1;
+            }
+            return nPow2;
+        }
+
+        struct Cell
+        {
+            std::atomic<size_t> Sequence;
+            T                   Value;
+        };
+
+        // Producer and consumer positions live on separate cache lines
+        const size_t                m_nMask;
+        std::unique_ptr<Cell[]>     m_pCells;
+        char                        m_Pad0[64];
+        std::atomic<size_t>         m_EnqueuePos;
+        char                        m_Pad1[64];
+        std::atomic<size_t>         m_DequeuePos;
+        char                        m_Pad2[64];
+};
+
+}} // namespace AVT::VmbAPI
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef AVT_VMBAPI_EXAMPLES_CVPIXELFORMAT
+#define AVT_VMBAPI_EXAMPLES_CVPIXELFORMAT
+
+#include <opencv2/opencv.hpp>
+
+#include "VimbaCPP/Include/VimbaCPP.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+/**
+ * @brief OpenCV matrix type able to wrap a Vimba buffer of the given format without conversion.
+ * Rows are tightly packed, so the step is always Width times the element size.
+ * Multi-byte formats are little endian like the host, RGB8 keeps its channel order
+ * and Bayer formats are wrapped as raw single channel images
+ *
+ * @param eFormat The Vimba pixel format
+ * @param nType Receives the OpenCV type, e.g. CV_8UC1
+ * @return false if the format is packed or otherwise needs a conversion
+ */
+inline bool PixelFormatToCVType( VmbPixelFormatType eFormat, int &nType )
+{
+    switch( eFormat )
+    {
+    case VmbPixelFormatMono8:
+    case VmbPixelFormatBayerGR8:
+    case VmbPixelFormatBayerRG8:
+    case VmbPixelFormatBayerGB8:
+    case VmbPixelFormatBayerBG8:
+        nType = CV_8UC1;
+        return true;
+    case VmbPixelFormatMono10:
+    case VmbPixelFormatMono12:
+    case VmbPixelFormatMono14:
+    case VmbPixelFormatMono16:
+    case VmbPixelFormatBayerGR10:
+    case VmbPixelFormatBayerRG10:
+    case VmbPixelFormatBayerGB10:
+    case VmbPixelFormatBayerBG10:
+    case VmbPixelFormatBayerGR12:
+    case VmbPixelFormatBayerRG12:
+    case VmbPixelFormatBayerGB12:
+    case VmbPixelFormatBayerBG12:
+    case VmbPixelFormatBayerGR16:
+    case VmbPixelFormatBayerRG16:
+    case VmbPixelFormatBayerGB16:
+    case VmbPixelFormatBayerBG16:
+        nType = CV_16UC1;
+        return true;
+    case VmbPixelFormatRgb8:
+    case VmbPixelFormatBgr8:
+        nType = CV_8UC3;
+        return true;
+    case VmbPixelFormatRgba8:
+    case VmbPixelFormatBgra8:
+        nType = CV_8UC4;
+        return true;
+    default:
+        return false;
+    }
+}
+
+}} // namespace AVT::VmbAPI
+
+#endif
@@ -0,0 +1,114 @@
+#ifndef AVT_VMBAPI_EXAMPLES_CAMERADEVICE
+#define AVT_VMBAPI_EXAMPLES_CAMERADEVICE
+
+#include <string>
+#include <memory>
+
+#include "VimbaCPP/Include/VimbaCPP.h"
+
+#include "FrameSource.h"
+#include "CameraFeatures.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+/**
+ * @brief Gets what the camera of a CameraFrameSource delivers and reports
+ */
+class ICameraDeviceListener
+{
+    public:
+        virtual ~ICameraDeviceListener() {}
+
+        /**
+         * @brief A frame announced with ICameraDevice::AnnounceFrame was filled, with its slot set
+         */
+        virtual void FrameReceived( SourceFrame &Frame ) = 0;
+        /**
+         * @brief The camera left or joined the camera list
+         */
+        virtual void CameraListChanged( UpdateTriggerType eReason ) = 0;
+};
+
+/**
+ * @brief The camera a CameraFrameSource streams from. It is opened again after it was lost and gets
+ * the frames of the source announced each time, so the reconnect logic of the source does not depend on
+ * where the camera comes from: Vimba in the program, a simulated camera in the tests
+ */
+class ICameraDevice
+{
+    public:
+        virtual ~ICameraDevice() {}
+
+        /**
+         * @brief Opens the camera by its ID, again after Close
+         */
+        virtual VmbErrorType        Open() = 0;
+        virtual VmbErrorType        Close() = 0;
+        /**
+         * @brief The features of the open camera, NULL while closed
+         */
+        virtual ICameraFeatures*    GetFeatures() = 0;
+        virtual VmbErrorType        GetPayloadSize( VmbUint32_t &nPayloadSize ) = 0;
+        /**
+         * @brief Announces a frame, once filled it is passed to the listener with nSlot
+         */
+        virtual VmbErrorType        AnnounceFrame( const FramePtr &pFrame, VmbUint32_t nSlot ) = 0;
+        virtual VmbErrorType        StartCapture() = 0;
+        virtual VmbErrorType        QueueFrame( const FramePtr &pFrame ) = 0;
+        /**
+         * @brief Starts image acquisition, after StartCapture and queueing the frames
+         */
+        virtual VmbErrorType        StartAcquisition() = 0;
+        /**
+         * @brief Stops image acquisition and revokes all frames, errors of a camera already gone are ignored
+         */
+        virtual void                EndCapture() = 0;
+        virtual std::string         GetInterfaceID() const = 0;
+        /**
+         * @brief Frames announced from now on and camera list changes go to pListener, NULL stops watching the camera list
+         */
+        virtual void                SetListener( ICameraDeviceListener *pListener ) = 0;
+};
+
+/**
+ * @brief A camera known to Vimba. Every frame gets an observer of its own that knows its slot,
+ * the camera list is watched while there is a listener
+ */
+class VimbaCameraDevice : public ICameraDevice
+{
+    public:
+        /**
+         * @param system The started Vimba singleton
+         * @param strCameraID ID of the camera to open
+         */
+        VimbaCameraDevice( VimbaSystem &system, const std::string &strCameraID );
+        ~VimbaCameraDevice();
+
+        virtual VmbErrorType        Open();
+        virtual VmbErrorType        Close();
+        virtual ICameraFeatures*    GetFeatures();
+        virtual VmbErrorType        GetPayloadSize( VmbUint32_t &nPayloadSize );
+        virtual VmbErrorType        AnnounceFrame( const FramePtr &pFrame, VmbUint32_t nSlot );
+        virtual VmbErrorType        StartCapture();
+        virtual VmbErrorType        QueueFrame( const FramePtr &pFrame );
+        virtual VmbErrorType        StartAcquisition();
+        virtual void                EndCapture();
+        virtual std::string         GetInterfaceID() const;
+        virtual void                SetListener( ICameraDeviceListener *pListener );
+
+    private:
+        // No copy constructor
+        VimbaCameraDevice( const VimbaCameraDevice& );
+
+        VimbaSystem &           m_system;
+        const std::string       m_strCameraID;
+        CameraPtr               m_pCamera;          // Replaced on every Open
+        std::unique_ptr<VimbaCameraFeatures> m_pFeatures;   // While open
+        ICameraDeviceListener * m_pListener;
+        ICameraListObserverPtr  m_pListObserver;    // While there is a listener
+};
+
+}} // namespace AVT::VmbAPI
+
+#endif
@@ -0,0 +1,135 @@
+#ifndef AVT_VMBAPI_EXAMPLES_CAMERAFEATURES
+#define AVT_VMBAPI_EXAMPLES_CAMERAFEATURES
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <unordered_map>
+
+#include "VimbaCPP/Include/VimbaCPP.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+/**
+ * @brief The part of a camera's feature tree the setup code works with: integer, float, boolean,
+ * enumeration and command features by their GenICam name. Implemented on a Vimba camera and on a simulated tree, so the
+ * setup can run against the synthetic camera as well
+ */
+class ICameraFeatures
+{
+    public:
+        virtual ~ICameraFeatures() {}
+
+        virtual VmbErrorType    GetInt( const char *pName, VmbInt64_t &nValue ) = 0;
+
+        /**
+         * @brief Range and increment the feature currently accepts, they change with the features it depends on
+         */
+        virtual VmbErrorType    GetIntRange( const char *pName, VmbInt64_t &nMin, VmbInt64_t &nMax, VmbInt64_t &nIncrement ) = 0;
+
+        virtual VmbErrorType    SetInt( const char *pName, VmbInt64_t nValue ) = 0;
+
+        virtual VmbErrorType    GetEnum( const char *pName, std::string &strValue ) = 0;
+
+        /**
+         * @brief The entries that can be set right now
+         */
+        virtual VmbErrorType    GetEnumEntries( const char *pName, std::vector<std::string> &Entries ) = 0;
+
+        virtual VmbErrorType    SetEnum( const char *pName, const std::string &strValue ) = 0;
+
+        virtual VmbErrorType    GetFloat( const char *pName, double &dValue ) = 0;
+
+        /**
+         * @brief Range and increment the feature currently accepts, an increment of 0 for any value in the range
+         */
+        virtual VmbErrorType    GetFloatRange( const char *pName, double &dMin, double &dMax, double &dIncrement ) = 0;
+
+        virtual VmbErrorType    SetFloat( const char *pName, double dValue ) = 0;
+
+        virtual VmbErrorType    GetBool( const char *pName, bool &bValue ) = 0;
+
+        virtual VmbErrorType    SetBool( const char *pName, bool bValue ) = 0;
+
+        /**
+         * @brief Runs a command feature and waits until the camera reports it done
+         *
+         * @return VmbErrorTimeout if it did not finish within a second
+         */
+        virtual VmbErrorType    RunCommand( const char *pName ) = 0;
+};
+
+/**
+ * @brief The feature tree of an open Vimba camera. Every feature is resolved once when constructed,
+ * with its type; ranges, increments, available enumeration entries and the values of features not
+ * flagged volatile are cached until the camera reports a change of the feature. Repeated access,
+ * e.g. a control loop setting exposure and gain, then costs a hash lookup instead of a name lookup
+ * and a round trip to the camera. Safe to use from several threads
+ */
+class VimbaCameraFeatures : public ICameraFeatures
+{
+    public:
+        /**
+         * @param pCamera Open for as long as the features are used
+         */
+        explicit VimbaCameraFeatures( const CameraPtr &pCamera );
+        ~VimbaCameraFeatures();
+
+        virtual VmbErrorType    GetInt( const char *pName, VmbInt64_t &nValue );
+        virtual VmbErrorType    GetIntRange( const char *pName, VmbInt64_t &nMin, VmbInt64_t &nMax, VmbInt64_t &nIncrement );
+        virtual VmbErrorType    SetInt( const char *pName, VmbInt64_t nValue );
+        virtual VmbErrorType    GetEnum( const char *pName, std::string &strValue );
+        virtual VmbErrorType    GetEnumEntries( const char *pName, std::vector<std::string> &Entries );
+        virtual VmbErrorType    SetEnum( const char *pName, const std::string &strValue );
+        virtual VmbErrorType    GetFloat( const char *pName, double &dValue );
+        virtual VmbErrorType    GetFloatRange( const char *pName, double &dMin, double &dMax, double &dIncrement );
+        virtual VmbErrorType    SetFloat( const char *pName, double dValue );
+        virtual VmbErrorType    GetBool( const char *pName, bool &bValue );
+        virtual VmbErrorType    SetBool( const char *pName, bool bValue );
+        virtual VmbErrorType    RunCommand( const char *pName );
+
+        /**
+         * @brief Drops everything cached, for changes the camera does not report
+         */
+        void                    Invalidate();
+
+    private:
+        struct Entry
+        {
+            FeaturePtr                  pFeature;
+            VmbFeatureDataType          eType;
+            bool                        bVolatile;      // Changes without notice, its value is never cached
+            bool                        bValue;         // Whether the cached value is valid
+            bool                        bRange;         // Whether the cached range or enumeration entries are valid
+            unsigned int                nGeneration;    // Counts the changes, a read racing one is not cached
+            VmbInt64_t                  nValue;
+            VmbInt64_t                  nMin;
+            VmbInt64_t                  nMax;
+            VmbInt64_t                  nIncrement;
+            double                      dValue;
+            double                      dMin;
+            double                      dMax;
+            double                      dIncrement;
+            bool                        bBoolValue;
+            std::string                 strValue;
+            std::vector<std::string>    Entries;
+        };
+        class ChangeObserver;
+
+        VmbErrorType            Find( const char *pName, VmbFeatureDataType eType, Entry *&pEntry );
+        void                    FeatureChanged( const FeaturePtr &pFeature );
+        void                    Invalidate( Entry &entry );
+
+        const CameraPtr         m_pCamera;
+        std::unordered_map<std::string, Entry> m_Entries;  // Fixed after construction, only the cached fields change
+        IFeatureObserverPtr     m_pObserver;
+        std::mutex              m_Mutex;                    // Guards the cached fields, never held while calling the camera
+
+        VimbaCameraFeatures( const VimbaCameraFeatures& );
+        VimbaCameraFeatures& operator=( const VimbaCameraFeatures& );
+};
+
+}} // namespace AVT::VmbAPI
+
+#endif
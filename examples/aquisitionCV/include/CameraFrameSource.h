@@ -0,0 +1,134 @@
+#ifndef AVT_VMBAPI_EXAMPLES_CAMERAFRAMESOURCE
+#define AVT_VMBAPI_EXAMPLES_CAMERAFRAMESOURCE
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+#include "VimbaCPP/Include/VimbaCPP.h"
+
+#include "FrameSource.h"
+#include "ProgramConfig.h"
+#include "CameraFeatures.h"
+#include "CameraDevice.h"
+#include "CameraPreset.h"
+#include "ReconnectMonitor.h"
+#include "FrameBufferPool.h"
+#include "FrameBufferSizer.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+/**
+ * @brief Frame source streaming from a camera known to Vimba.
+ * The frames are allocated once and announced by the source itself, so they survive the camera:
+ * if it disappears while streaming (cable, power, GigE heartbeat) a reconnect thread waits for it
+ * to show up in the camera list again, reopens it, writes every feature value written before and
+ * announces the same frames again. Frames the processing holds during the outage are queued once
+ * it hands them back. The frame buffers are allocated by the API, the transport layer or, if
+ * configured, a FrameBufferPool of the source. Their number is planned by a FrameBufferSizer and
+ * grown by the same thread while streaming when the processing holds the frames too long.
+ * The camera delivers every frame with its slot, so delivering and handing back a frame of a
+ * streaming camera takes neither the mutex nor a search. The camera is a Vimba one unless an
+ * ICameraDevice is given, e.g. to run the reconnect against a simulated camera
+ */
+class CameraFrameSource : public IFrameSource, private ICameraDeviceListener
+{
+    public:
+        /**
+         * @brief Construct a new Camera Frame Source object
+         *
+         * @param system The started Vimba singleton
+         * @param strCameraID ID of the camera to open
+         * @param nBufferCount Number of frames announced to the camera, the least if Buffers is adaptive
+         * @param eAllocation Whether the API or the transport layer allocates the frame buffers
+         * @param Geometry The image the processing needs, the camera is set up to deliver no more
+         * @param bColor Whether the processing demosaics, decides pixel format and binning
+         * @param pPreset Applied after the geometry, replaces the default geometry if there is no request; must outlive the source
+         * @param Buffers Number of the frames, page size, locking and NUMA node of the frame buffers if the source allocates them
+         */
+        CameraFrameSource( VimbaSystem &system, const std::string &strCameraID, VmbUint32_t nBufferCount, FrameAllocationMode eAllocation,
+                           const GeometryRequest &Geometry = GeometryRequest(), bool bColor = false, const CameraPreset *pPreset = NULL,
+                           const FrameBufferConfig &Buffers = FrameBufferConfig() );
+        /**
+         * @brief Construct a new Camera Frame Source object streaming from any camera
+         *
+         * @param pDevice The camera to stream from
+         * @param strCameraID ID of the camera
+         * @param nBufferCount Number of frames announced to the camera, the least if Buffers is adaptive
+         * @param eAllocation Whether the API or the transport layer allocates the frame buffers
+         * @param Geometry The image the processing needs, the camera is set up to deliver no more
+         * @param bColor Whether the processing demosaics, decides pixel format and binning
+         * @param pPreset Applied after the geometry, replaces the default geometry if there is no request; must outlive the source
+         * @param Buffers Number of the frames, page size, locking and NUMA node of the frame buffers if the source allocates them
+         */
+        CameraFrameSource( std::unique_ptr<ICameraDevice> pDevice, const std::string &strCameraID, VmbUint32_t nBufferCount, FrameAllocationMode eAllocation,
+                           const GeometryRequest &Geometry = GeometryRequest(), bool bColor = false, const CameraPreset *pPreset = NULL,
+                           const FrameBufferConfig &Buffers = FrameBufferConfig() );
+
+        virtual VmbErrorType    Open();
+        virtual VmbErrorType    StartAcquisition( FrameObserver *pObserver );
+        virtual VmbErrorType    StopAcquisition();
+        virtual VmbErrorType    Close();
+        virtual VmbErrorType    QueueFrame( const SourceFrame &Frame );
+        virtual std::string     GetID() const;
+        virtual VmbUint64_t     GetTimestampFrequency() const;
+        virtual ICameraFeatures* GetFeatures();
+        virtual std::string     GetInterfaceID() const;
+        virtual ReconnectStatistics GetReconnectStatistics() const;
+        virtual BufferDepthStatistics GetBufferStatistics() const;
+
+    private:
+        struct FrameSlot
+        {
+            FramePtr            pFrame;
+            std::atomic<bool>   bHeld;              // Delivered and not handed back yet
+        };
+
+        VmbErrorType            PrepareCamera();
+        VmbErrorType            AddFrames( VmbUint32_t nCount, VmbUint32_t nPayloadSize );
+        FrameSlot*              FindSlot( const SourceFrame &Frame ) const;
+        VmbErrorType            StartCamera( bool &bReallocated );
+        void                    GrowBuffers();
+        void                    StopCamera();
+        VmbErrorType            Reconnect( bool &bReallocated );
+        void                    ReconnectLoop();
+        virtual void            FrameReceived( SourceFrame &Frame );
+        virtual void            CameraListChanged( UpdateTriggerType eReason );
+
+        const std::unique_ptr<ICameraDevice> m_pDevice;
+        const std::string       m_strCameraID;
+        const FrameAllocationMode m_eAllocation;
+        const GeometryRequest   m_Geometry;
+        const bool              m_bColor;
+        const CameraPreset * const m_pPreset;
+        const FrameBufferConfig m_Buffers;
+        bool                    m_bOpen;
+        FeatureJournal          m_Journal;          // In front of the features of the device, remembers the configuration for reconnecting
+        VmbUint64_t             m_nTimestampFrequency;
+        FrameObserver *         m_pObserver;
+        VmbUint32_t             m_nFrameSize;       // Bytes of every frame buffer
+        std::thread             m_Reconnector;      // Also grows the buffers
+        std::mutex              m_Mutex;            // Protects the connection state and replacing the slots, not handing back while connected
+        std::condition_variable m_Changed;
+        std::unique_ptr<FrameSlot[]> m_pSlots;      // As many as the sizer allows at most, replaced only while not connected
+        std::atomic<VmbUint32_t> m_nSlots;          // Slots with an announced frame, only grown while connected
+        std::atomic<unsigned int> m_nQueueing;      // Frames being handed back without the mutex, StopCamera waits for them
+        std::vector< std::unique_ptr<FrameBufferPool> > m_Pools;           // Memory of the slots if the source allocates it, one per growth
+        std::vector< std::unique_ptr<FrameBufferPool> > m_RetiredPools;    // Replaced on reconnect, frames may still be held
+        FrameBufferSizer        m_Sizer;
+        std::atomic<bool>       m_bConnected;       // Streaming, frames handed back are queued at once
+        bool                    m_bLost;            // The camera disappeared, the reconnect thread takes over
+        bool                    m_bAppeared;        // The camera list reported it again
+        bool                    m_bGrow;            // The sizer asked for more frames
+        bool                    m_bStopping;
+        ReconnectMonitor        m_Reconnects;
+};
+
+}} // namespace AVT::VmbAPI
+
+#endif
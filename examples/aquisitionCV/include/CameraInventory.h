@@ -0,0 +1,148 @@
+#ifndef AVT_VMBAPI_EXAMPLES_CAMERAINVENTORY
+#define AVT_VMBAPI_EXAMPLES_CAMERAINVENTORY
+
+#include <string>
+#include <vector>
+#include <ostream>
+
+#include "VimbaCPP/Include/VimbaCPP.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+/**
+ * @brief Where the details of a camera come from
+ */
+enum CameraRecordSource
+{
+    CameraRecord_Enumerated,    // Found by a full enumeration
+    CameraRecord_Validated,     // Taken from the cache and answering under its ID
+    CameraRecord_Cached,        // Taken from the cache without asking the camera
+};
+
+/**
+ * @brief The static details of one camera
+ */
+struct CameraRecord
+{
+    std::string         ID;
+    std::string         Name;
+    std::string         Model;
+    std::string         SerialNumber;
+    std::string         InterfaceID;
+    CameraRecordSource  Source;
+
+    CameraRecord()
+        : Source( CameraRecord_Enumerated )
+    {}
+};
+
+/**
+ * @brief What building the inventory took
+ */
+struct InventoryStatistics
+{
+    bool    bEnumerated;    // A full enumeration was run
+    size_t  Cached;         // Cameras in the cache file
+    size_t  Validated;      // Cached cameras answering with the serial number and interface of the cache
+    size_t  Changed;        // Cached cameras answering with another serial number or interface
+    size_t  Missing;        // Cached cameras not answering
+    double  Seconds;
+
+    InventoryStatistics()
+        : bEnumerated( false )
+        , Cached( 0 )
+        , Validated( 0 )
+        , Changed( 0 )
+        , Missing( 0 )
+        , Seconds( 0.0 )
+    {}
+};
+
+/**
+ * @brief Output formats of PrintCameraRecords
+ */
+enum InventoryFormat
+{
+    InventoryFormat_Text,       // The human readable listing
+    InventoryFormat_Json,       // One JSON array of objects
+    InventoryFormat_Tsv,        // A header line and one tab separated line per camera
+};
+
+/**
+ * @brief The cameras of the host, queried concurrently and kept in a cache file between runs.
+ * Enumerating the cameras of a host with many GigE cameras takes most of the startup: the discovery
+ * waits for the answers of every interface and the details of the cameras are then read one after
+ * the other. The cache keeps the details keyed by serial number and interface, so a warm start
+ * only asks the cameras of the cache for their details, concurrently and each by its ID, without
+ * a discovery. A full enumeration is only run when the cache is missing, fewer cameras than
+ * needed answer or one answers with another serial number or interface, and it rewrites the cache.
+ */
+class CameraInventory
+{
+    public:
+        /**
+         * @param strCacheFile The cache file, none if empty
+         */
+        CameraInventory( VimbaSystem &system, const std::string &strCacheFile );
+
+        /**
+         * @brief Enumerates all cameras, reads their details concurrently and rewrites the cache
+         */
+        VmbErrorType Enumerate();
+
+        /**
+         * @brief Warm start: asks the cameras of the cache concurrently whether they still answer
+         * under their ID with the same serial number and interface, and keeps those answering.
+         * Falls back to Enumerate if the cache is missing, fewer than nMinimum cameras answer or
+         * a camera has changed
+         *
+         * @param nMinimum Cameras needed, 0 to accept an empty inventory
+         */
+        VmbErrorType Validate( size_t nMinimum );
+
+        /**
+         * @brief Reads the cache without asking any camera, e.g. to translate serial numbers into IDs
+         * for cameras that are opened anyway
+         */
+        VmbErrorType LoadCache();
+
+        /**
+         * @return The camera of that ID or serial number, NULL if the inventory has none
+         */
+        const CameraRecord* Find( const std::string &strIDOrSerial ) const;
+
+        const std::vector<CameraRecord>&    GetCameras() const;
+        const InventoryStatistics&          GetStatistics() const;
+
+        /**
+         * @return vimba-cameras.tsv in $XDG_CACHE_HOME or ~/.cache, empty if neither is set
+         */
+        static std::string                  GetDefaultCacheFile();
+
+    private:
+        bool    ReadCache( std::vector<CameraRecord> &Records ) const;
+        bool    WriteCache() const;
+
+        VimbaSystem &               m_system;
+        const std::string           m_strCacheFile;
+        std::vector<CameraRecord>   m_Cameras;
+        InventoryStatistics         m_Statistics;
+
+        CameraInventory( const CameraInventory& );
+        CameraInventory& operator=( const CameraInventory& );
+};
+
+/**
+ * @brief Reads ID, name, model, serial number and interface of the cameras concurrently, on up to 16 threads
+ *
+ * @param Records Receives the details in the order of the cameras
+ * @return VmbErrorSuccess or the first error of any camera
+ */
+VmbErrorType    QueryCameraRecords( const CameraPtrVector &Cameras, std::vector<CameraRecord> &Records );
+
+void            PrintCameraRecords( std::ostream &s, const std::vector<CameraRecord> &Records, InventoryFormat eFormat );
+
+}} // namespace AVT::VmbAPI
+
+#endif
@@ -0,0 +1,157 @@
+#ifndef AVT_VMBAPI_EXAMPLES_CAMERAPRESET
+#define AVT_VMBAPI_EXAMPLES_CAMERAPRESET
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <mutex>
+
+#include "VimbaCPP/Include/VimbaCPP.h"
+#include "CameraFeatures.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+/**
+ * @brief One feature of a preset with the value it is set to
+ */
+struct PresetSetting
+{
+    std::string     Feature;
+    bool            bText;          // Given as text: an enumeration entry, or true or false
+    std::string     Text;
+    double          Number;
+
+    PresetSetting()
+        : bText( false )
+        , Number( 0.0 )
+    {}
+};
+
+/**
+ * @brief A named set of feature values, e.g. the pixel format, size, exposure and trigger of a scene
+ */
+struct CameraPreset
+{
+    std::string                 Name;
+    std::vector<PresetSetting>  Settings;   // In the order of the file
+};
+
+/**
+ * @brief Outcome of applying a preset to one camera
+ */
+struct PresetReport
+{
+    VmbErrorType    Result;
+    size_t          Written;        // Features set
+    size_t          Unchanged;      // Features already at their value, not written
+    std::string     Feature;        // The feature failing, empty on success
+    std::vector<std::string> Locked;    // Image format features a streaming camera would have to change
+
+    PresetReport()
+        : Result( VmbErrorSuccess )
+        , Written( 0 )
+        , Unchanged( 0 )
+    {}
+};
+
+/**
+ * @brief Reads the presets of a JSON, XML or YAML file, whatever cv::FileStorage reads: a map of
+ * preset names to maps of GenICam feature names to values, e.g.
+ * { "day": { "PixelFormat": "Mono8", "Width": 1280, "ExposureTimeAbs": 2000.0 }, "night": { ... } }
+ *
+ * @param Presets Receives the presets in the order of the file
+ * @param strError Receives what is wrong with the file
+ */
+bool                LoadCameraPresets( const std::string &strFile, std::vector<CameraPreset> &Presets, std::string &strError );
+
+/**
+ * @return NULL if there is no preset of that name
+ */
+const CameraPreset* FindCameraPreset( const std::vector<CameraPreset> &Presets, const std::string &strName );
+
+/**
+ * @brief Sets the features of the preset in one batch. Every feature is checked against the camera
+ * first, so a misspelled name or a value of the wrong type fails before anything is written.
+ * The features are then written in the order they depend on each other: pixel format, binning and
+ * decimation, size, offsets, transport, selectors, modes, the other values and the frame rate last,
+ * as it is limited by exposure and bandwidth. Each value is checked against the range, increment or
+ * available entries the feature has at that point, and skipped if the feature already has it, so
+ * switching between presets only writes what differs.
+ * While the camera streams, its announced buffers fix the payload: a preset changing the pixel format,
+ * binning, decimation or size is rejected before anything is written, with those features listed
+ *
+ * @param bStreaming Whether the camera is acquiring into announced buffers
+ *
+ * @return The error of the first failing feature, which is named in the report; the features
+ * before it stay written. VmbErrorInvalidAccess if the preset needs the camera stopped
+ */
+VmbErrorType        ApplyCameraPreset( ICameraFeatures &Features, const CameraPreset &Preset, PresetReport &Report, bool bStreaming = false );
+
+/**
+ * @brief One line describing the outcome, e.g. "preset day: 3 written, 5 unchanged", "preset day failed at Width after 1 written: ..."
+ * or "preset day needs the camera stopped to change PixelFormat, Width"
+ */
+void                PrintPresetReport( std::ostream &s, const CameraPreset &Preset, const PresetReport &Report );
+
+/**
+ * @brief Passes every call on to the features of the camera and remembers the last value written to each
+ * feature and the commands run, so the configuration can be applied again to a camera that reconnected.
+ * Features behind a selector, e.g. Gain for each GainSelector entry, are remembered once per value of
+ * the selectors written so far, and replayed with those selectors set in front of them.
+ * The features behind it are replaced on reconnect, while there are none every call fails with
+ * VmbErrorDeviceNotOpen. Safe to call from any thread
+ */
+class FeatureJournal : public ICameraFeatures
+{
+    public:
+        FeatureJournal();
+
+        /**
+         * @brief Sets the features calls go to, NULL while the camera is away. Waits for calls in progress
+         */
+        void                    SetTarget( ICameraFeatures *pTarget );
+
+        /**
+         * @brief Runs the journaled commands on the features, then writes the journaled values in
+         * dependency order like ApplyCameraPreset, each after the selector values it was written under,
+         * and skips values already set. The selectors are left at their last values
+         */
+        VmbErrorType            Replay( ICameraFeatures &Features, PresetReport &Report ) const;
+
+        virtual VmbErrorType    GetInt( const char *pName, VmbInt64_t &nValue );
+        virtual VmbErrorType    GetIntRange( const char *pName, VmbInt64_t &nMin, VmbInt64_t &nMax, VmbInt64_t &nIncrement );
+        virtual VmbErrorType    SetInt( const char *pName, VmbInt64_t nValue );
+        virtual VmbErrorType    GetEnum( const char *pName, std::string &strValue );
+        virtual VmbErrorType    GetEnumEntries( const char *pName, std::vector<std::string> &Entries );
+        virtual VmbErrorType    SetEnum( const char *pName, const std::string &strValue );
+        virtual VmbErrorType    GetFloat( const char *pName, double &dValue );
+        virtual VmbErrorType    GetFloatRange( const char *pName, double &dMin, double &dMax, double &dIncrement );
+        virtual VmbErrorType    SetFloat( const char *pName, double dValue );
+        virtual VmbErrorType    GetBool( const char *pName, bool &bValue );
+        virtual VmbErrorType    SetBool( const char *pName, bool bValue );
+        virtual VmbErrorType    RunCommand( const char *pName );
+
+    private:
+        struct Entry
+        {
+            PresetSetting               Setting;
+            std::vector<PresetSetting>  Selectors;  // The values of m_Selectors when written
+        };
+
+        void                    KnowSelector( const char *pName, bool bText );
+        void                    Record( const PresetSetting &Setting );
+
+        mutable std::mutex      m_Mutex;            // Held during calls, so the target is not replaced under one
+        ICameraFeatures *       m_pTarget;
+        std::vector<Entry>      m_Entries;          // One per feature and selector values, in the order of their last write
+        std::vector<PresetSetting> m_Selectors;     // Last written or, before that, read values, in the order first written
+        std::vector<std::string> m_Commands;        // In the order first run
+
+        FeatureJournal( const FeatureJournal& );
+        FeatureJournal& operator=( const FeatureJournal& );
+};
+
+}} // namespace AVT::VmbAPI
+
+#endif
@@ -0,0 +1,166 @@
+#ifndef AVT_VMBAPI_EXAMPLES_CONVERSIONCONTEXT
+#define AVT_VMBAPI_EXAMPLES_CONVERSIONCONTEXT
+
+#include <vector>
+#include <memory>
+
+#include "VimbaCPP/Include/VimbaCPP.h"
+#include "VimbaImageTransform/Include/VmbTransform.h"
+
+#include "BoundedQueue.h"
+#include "ProgramConfig.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+class ImageBufferPool;
+
+/**
+ * @brief A buffer borrowed from an ImageBufferPool, handed back when the lease is released or destroyed
+ */
+class ImageBufferLease
+{
+    public:
+        ImageBufferLease();
+        ImageBufferLease( ImageBufferLease &&other );
+        ImageBufferLease& operator=( ImageBufferLease &&other );
+        ~ImageBufferLease();
+
+        /**
+         * @brief Gives the buffer back to its pool, the lease is empty afterwards
+         */
+        void        Release();
+
+        VmbUchar_t* Data() const
+        {
+            return m_pData;
+        }
+        size_t      Size() const
+        {
+            return m_nSize;
+        }
+        bool        IsValid() const
+        {
+            return NULL != m_pData;
+        }
+
+    private:
+        friend class ImageBufferPool;
+        ImageBufferLease( ImageBufferPool *pPool, VmbUchar_t *pData, size_t nSize );
+        ImageBufferLease( const ImageBufferLease& );
+        ImageBufferLease& operator=( const ImageBufferLease& );
+
+        ImageBufferPool *   m_pPool;
+        VmbUchar_t *        m_pData;
+        size_t              m_nSize;
+};
+
+/**
+ * @brief Fixed set of equally sized, aligned buffers allocated once.
+ * Acquire and release never allocate and may be called from any thread
+ */
+class ImageBufferPool
+{
+    public:
+        ImageBufferPool();
+
+        /**
+         * @brief Allocates the buffers, replacing the previous ones. No lease may be outstanding
+         *
+         * @param nSize Bytes per buffer
+         * @param nCount Number of buffers
+         * @param nAlignment Alignment of every buffer, a power of two
+         */
+        VmbErrorType    Allocate( size_t nSize, size_t nCount, size_t nAlignment = 64 );
+
+        /**
+         * @brief Hands out a free buffer
+         *
+         * @return VmbErrorResources if all buffers are leased
+         */
+        VmbErrorType    Acquire( ImageBufferLease &Lease );
+
+        size_t          BufferSize() const
+        {
+            return m_nBufferSize;
+        }
+        size_t          BufferCount() const
+        {
+            return m_nBufferCount;
+        }
+        size_t          Available() const;
+
+    private:
+        friend class ImageBufferLease;
+        void            Return( VmbUchar_t *pData );
+
+        std::vector<VmbUchar_t>                     m_Storage;
+        std::unique_ptr< BoundedQueue<VmbUchar_t*> > m_pFree;
+        size_t                                      m_nBufferSize;
+        size_t                                      m_nBufferCount;
+};
+
+/**
+ * @brief Everything needed to convert frames of one stream, set up once per format and geometry.
+ * 8 bit Bayer to BGR8 or Mono8 and high bit depth mono to Mono8 or Mono16 use the in-tree kernels,
+ * everything else goes through VmbImageTransform.
+ * Image infos and the colour correction are prepared in Setup, destination buffers come from
+ * an own pool, so Transform neither allocates nor repeats any setup call. Leases may be held
+ * across a new Setup, the pool they came from is kept until they are all back.
+ * A context is meant to be used by one thread at a time and must outlive its leases
+ */
+class ConversionContext
+{
+    public:
+        ConversionContext();
+
+        /**
+         * @brief Prepares the conversion of a stream
+         *
+         * @param eSourceFormat Pixel format of the frames
+         * @param nWidth Frame width
+         * @param nHeight Frame height
+         * @param pDestinationFormat Vimba name of the destination format, e.g. "BGR8"
+         * @param pMatrix 3x3 colour correction matrix, row major, or NULL
+         * @param eDemosaic Who demosaics 8 bit Bayer frames, the in-tree kernels apply the matrix in the same pass
+         * @param nBufferCount Destination buffers that may be leased at the same time
+         */
+        VmbErrorType    Setup( VmbPixelFormatType eSourceFormat, VmbUint32_t nWidth, VmbUint32_t nHeight, const char *pDestinationFormat,
+                               const VmbFloat_t *pMatrix, DemosaicProcessing eDemosaic, size_t nBufferCount = 2 );
+
+        /**
+         * @brief Whether frames of this format and geometry can be converted without a new Setup
+         */
+        bool            Matches( VmbPixelFormatType eSourceFormat, VmbUint32_t nWidth, VmbUint32_t nHeight ) const;
+
+        /**
+         * @brief Converts one image into a buffer of the pool
+         *
+         * @param pSource The image in the format and geometry given to Setup
+         * @param Lease Receives the destination buffer
+         */
+        VmbErrorType    Transform( const VmbUchar_t *pSource, ImageBufferLease &Lease );
+
+    private:
+        ConversionContext( const ConversionContext& );
+        ConversionContext& operator=( const ConversionContext& );
+
+        bool                m_bValid;
+        VmbPixelFormatType  m_eSourceFormat;
+        VmbUint32_t         m_nWidth;
+        VmbUint32_t         m_nHeight;
+        bool                m_bInTreeDemosaic;
+        bool                m_bInTreeUnpack;
+        bool                m_bEdgeAware;
+        bool                m_bMatrix;
+        VmbImage            m_SourceImage;
+        VmbImage            m_DestinationImage;
+        VmbTransformInfo    m_TransformInfo;
+        VmbFloat_t          m_Matrix[9];
+        std::unique_ptr<ImageBufferPool> m_pPool;
+        std::vector< std::unique_ptr<ImageBufferPool> > m_RetiredPools;   // Replaced by Setup while leased
+};
+
+}} // namespace AVT::VmbAPI
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef AVT_VMBAPI_EXAMPLES_DEMOSAIC
+#define AVT_VMBAPI_EXAMPLES_DEMOSAIC
+
+#include "VimbaCPP/Include/VimbaCPP.h"
+#include "SimdLevel.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+enum DemosaicMethod
+{
+    DemosaicMethod_Bilinear,        // Average of the nearest samples of each colour
+    DemosaicMethod_EdgeAware,       // Green interpolated along the direction of the smaller gradient
+};
+
+enum DemosaicOutput
+{
+    DemosaicOutput_BGR8,            // Three bytes per pixel, blue first like OpenCV
+    DemosaicOutput_Mono8,           // Luminance 0.299 R + 0.587 G + 0.114 B
+};
+
+/**
+ * @brief Demosaics an 8 bit Bayer image.
+ * Border pixels mirror their neighbours without repeating the edge, which keeps the colour filter
+ * pattern intact, so every pixel of the output is interpolated the same way.
+ * Rows of source and destination are tightly packed.
+ *
+ * @param pSource       First byte of the Bayer image
+ * @param nWidth        Image width, at least 2
+ * @param nHeight       Image height, at least 2
+ * @param eFormat       One of BayerRG8, BayerGR8, BayerGB8, BayerBG8
+ * @param pDestination  Width x Height x 3 bytes for BGR8, Width x Height bytes for Mono8
+ * @param eOutput       Destination format
+ * @param eMethod       Interpolation method
+ * @param eSimd         Instruction set to use, levels the CPU lacks fall back to the best available one
+ * @param pMatrix       Optional 3x3 colour correction, row major with the red output row first like
+ *                      VmbSetColorCorrectionMatrix3x3. It is applied in the same pass, in fixed point
+ *                      with 12 fractional bits, before the output is formed. Coefficients must lie in [-8, 8)
+ *
+ * @return VmbErrorBadParameter for a bad geometry or matrix, VmbErrorNotSupported for a non Bayer 8 bit format
+ */
+VmbErrorType DemosaicBayer8( const VmbUchar_t *pSource, VmbUint32_t nWidth, VmbUint32_t nHeight, VmbPixelFormatType eFormat,
+                             VmbUchar_t *pDestination, DemosaicOutput eOutput, DemosaicMethod eMethod, SimdLevel eSimd = SimdLevel_Auto,
+                             const VmbFloat_t *pMatrix = NULL );
+
+/**
+ * @brief Demosaics a band of rows of an 8 bit Bayer image, so a frame can be split across threads.
+ * Reads the rows above and below the band, writes only the band
+ *
+ * @param nFirstRow     First row of the band
+ * @param nRowCount     Rows in the band
+ *
+ * @see DemosaicBayer8 for the other parameters
+ */
+VmbErrorType DemosaicBayer8Rows( const VmbUchar_t *pSource, VmbUint32_t nWidth, VmbUint32_t nHeight, VmbPixelFormatType eFormat,
+                                 VmbUchar_t *pDestination, DemosaicOutput eOutput, DemosaicMethod eMethod, SimdLevel eSimd,
+                                 VmbUint32_t nFirstRow, VmbUint32_t nRowCount, const VmbFloat_t *pMatrix = NULL );
+
+}} // namespace AVT::VmbAPI
+
+#endif
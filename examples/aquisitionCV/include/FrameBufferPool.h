@@ -0,0 +1,96 @@
+#ifndef AVT_VMBAPI_EXAMPLES_FRAMEBUFFERPOOL
+#define AVT_VMBAPI_EXAMPLES_FRAMEBUFFERPOOL
+
+#include <string>
+#include <ostream>
+
+#include "VimbaCPP/Include/VimbaCPP.h"
+
+#include "ProgramConfig.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+enum FramePageSize
+{
+    FramePages_Normal,          // 4 KB pages
+    FramePages_Transparent,     // 4 KB pages the kernel may merge into 2 MB pages
+    FramePages_Huge,            // 2 MB pages reserved in the hugetlb pool
+};
+
+/**
+ * @brief How the buffers of a pool ended up, the system may refuse part of the configuration
+ */
+struct FrameBufferInfo
+{
+    VmbUint32_t     Count;
+    VmbUint32_t     BufferSize;     // Bytes requested per buffer
+    size_t          Stride;         // Bytes from one buffer to the next, page aligned
+    size_t          Bytes;          // Bytes mapped for all buffers
+    FramePageSize   PageSize;
+    bool            bLocked;
+    int             NumaNode;       // FrameBufferNode_None if not placed
+
+    FrameBufferInfo()
+        : Count( 0 )
+        , BufferSize( 0 )
+        , Stride( 0 )
+        , Bytes( 0 )
+        , PageSize( FramePages_Normal )
+        , bLocked( false )
+        , NumaNode( FrameBufferNode_None )
+    {}
+};
+
+/**
+ * @brief Frame buffers in one mapping of their own instead of the heap. Every buffer starts on a page,
+ * so it is aligned for any SIMD load, and the mapping can be backed by 2 MB pages, which cover a
+ * 5 MP frame with three TLB entries instead of over a thousand. The pages are placed on a NUMA node,
+ * faulted in and optionally locked before the first frame, so neither the transport layer writing
+ * a frame nor the conversion and recording reading it take page faults or cross the interconnect.
+ * Huge pages fall back to transparent huge pages if the hugetlb pool has too few, and locking is
+ * skipped if RLIMIT_MEMLOCK is too low
+ */
+class FrameBufferPool
+{
+    public:
+        FrameBufferPool();
+        ~FrameBufferPool();
+
+        /**
+         * @brief Maps nCount buffers of nBufferSize bytes, releasing the previous ones
+         *
+         * @param Config Page size, locking and NUMA node
+         * @param strInterfaceID Network interface of the camera, for FrameBufferNode_Auto
+         * @return VmbErrorResources if the memory could not be mapped
+         */
+        VmbErrorType            Allocate( VmbUint32_t nCount, VmbUint32_t nBufferSize, const FrameBufferConfig &Config, const std::string &strInterfaceID = std::string() );
+        void                    Release();
+
+        VmbUchar_t*             GetBuffer( VmbUint32_t nIndex ) const
+        {
+            return static_cast<VmbUchar_t*>( m_pMemory ) + nIndex * m_Info.Stride;
+        }
+        const FrameBufferInfo&  GetInfo() const;
+
+    private:
+        void *                  m_pMemory;
+        FrameBufferInfo         m_Info;
+
+        FrameBufferPool( const FrameBufferPool& );
+        FrameBufferPool& operator=( const FrameBufferPool& );
+};
+
+/**
+ * @brief The NUMA node the buffers of a camera go to
+ *
+ * @return Config.NumaNode, for FrameBufferNode_Auto the node of the network interface, else the node
+ * of the first CPU of Config.Cpus, else FrameBufferNode_None
+ */
+int     ResolveNumaNode( const FrameBufferConfig &Config, const std::string &strInterfaceID );
+
+void    PrintFrameBufferInfo( std::ostream &s, const FrameBufferInfo &Info );
+
+}} // namespace AVT::VmbAPI
+
+#endif
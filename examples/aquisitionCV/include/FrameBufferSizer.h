@@ -0,0 +1,141 @@
+#ifndef AVT_VMBAPI_EXAMPLES_FRAMEBUFFERSIZER
+#define AVT_VMBAPI_EXAMPLES_FRAMEBUFFERSIZER
+
+#include <mutex>
+#include <atomic>
+#include <ostream>
+
+#include "VimbaCPP/Include/VimbaCPP.h"
+
+#include "ProgramConfig.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+struct SourceFrame;
+
+/**
+ * @brief How many frames a source announced and why
+ */
+struct BufferDepthStatistics
+{
+    bool            bAdaptive;
+    VmbUint32_t     Planned;            // Frames announced at start
+    VmbUint32_t     Depth;              // Frames announced now
+    VmbUint32_t     Limit;              // Most frames the memory budget allows
+    VmbUint64_t     Grows;
+    VmbUint64_t     StarvedFrames;      // Frames missing after the source ran out of free buffers
+    double          FrameRate;          // Frames per second the depth was planned for, 0 if unknown
+    double          MaxHoldTime;        // Seconds, the longest a frame was away from the source
+    double          RecentHoldTime;     // Seconds, the longest hold of the last one or two windows
+
+    BufferDepthStatistics()
+        : bAdaptive( false )
+        , Planned( 0 )
+        , Depth( 0 )
+        , Limit( 0 )
+        , Grows( 0 )
+        , StarvedFrames( 0 )
+        , FrameRate( 0.0 )
+        , MaxHoldTime( 0.0 )
+        , RecentHoldTime( 0.0 )
+    {}
+};
+
+/**
+ * @brief Decides how many frames a source announces. At start the depth covers the frames arriving
+ * while one is processed, estimated from the frame rate, within the memory budget for the payload size.
+ * While streaming every frame is timed from its arrival until it is handed back; when the longest
+ * recent hold time at the frame rate needs more frames, or frames go missing right after the source ran
+ * out of free buffers, the source is asked to announce more. Missing frames while buffers were free are
+ * lost on the wire and do not count. The depth grows up to the budget while streaming; a new set of
+ * buffers is planned from the recent hold times only, so a single stall is forgotten after two windows
+ */
+class FrameBufferSizer
+{
+    public:
+        // Frames beyond those held by the processing: one being filled, one queued
+        static const VmbUint32_t SPARE_FRAMES = 2;
+        // Seconds a hold time counts for at least, it is forgotten one window later
+        static const double HOLD_WINDOW;
+
+        /**
+         * @param Config Fixed count or adaptive with a memory budget
+         * @param nMinimum Frames announced at least, the fixed count if not adaptive
+         * @param dHoldWindow Seconds a hold time is remembered for at least and at most twice as long
+         */
+        FrameBufferSizer( const FrameBufferConfig &Config, VmbUint32_t nMinimum, double dHoldWindow = HOLD_WINDOW );
+
+        /**
+         * @brief Plans the depth for a new set of buffers, none of them held
+         *
+         * @param dFrameRate Frames per second, 0 if unknown
+         * @return The frames to announce
+         */
+        VmbUint32_t             Plan( VmbUint32_t nPayloadSize, double dFrameRate );
+
+        /**
+         * @brief A frame left the source, called in the order of arrival
+         *
+         * @return Whether the source should announce GetTarget() frames now, asked once until Grown
+         */
+        bool                    Delivered( const SourceFrame &Frame );
+
+        /**
+         * @brief A frame of the current buffers came back, from any thread
+         */
+        void                    Requeued( const SourceFrame &Frame );
+
+        /**
+         * @brief The source announced nDepth frames, less than GetTarget() ends adapting
+         */
+        void                    Grown( VmbUint32_t nDepth );
+
+        /**
+         * @brief The device restarted with its frame IDs, e.g. after reconnecting with the same buffers
+         */
+        void                    Restarted();
+
+        VmbUint32_t             GetTarget() const;
+        BufferDepthStatistics   GetStatistics() const;
+
+    private:
+        FrameBufferSizer( const FrameBufferSizer& );
+        FrameBufferSizer& operator=( const FrameBufferSizer& );
+
+        bool                    Raise( VmbUint32_t nTarget );
+        VmbUint64_t             RecentHold() const;
+
+        const bool                  m_bAdaptive;
+        const VmbUint64_t           m_nBudget;
+        const VmbUint32_t           m_nMinimum;
+        const VmbUint64_t           m_nHoldWindow;      // Nanoseconds
+        mutable std::mutex          m_Mutex;            // Serialises planning and growing
+        std::atomic<double>         m_dFrameRate;
+        VmbUint32_t                 m_nPlanned;
+        std::atomic<VmbUint32_t>    m_nLimit;
+        VmbUint64_t                 m_nGrows;
+        std::atomic<bool>           m_bAdapting;
+        std::atomic<VmbUint32_t>    m_nDepth;
+        std::atomic<VmbUint32_t>    m_nTarget;
+        std::atomic<bool>           m_bGrowPending;
+        std::atomic<int>            m_nHeld;
+        std::atomic<VmbUint64_t>    m_nMaxHold;         // Nanoseconds, since the start
+        std::atomic<VmbUint64_t>    m_nWindowStart;     // Host time the current hold window began
+        std::atomic<VmbUint64_t>    m_nWindowHold;      // Nanoseconds, the longest hold of the current window
+        std::atomic<VmbUint64_t>    m_nPreviousHold;    // Nanoseconds, the longest hold of the window before
+        std::atomic<VmbUint64_t>    m_nStarved;
+        std::atomic<bool>           m_bRestarted;
+        std::atomic<VmbUint64_t>    m_nRestartTime;     // Frames received before were held across an outage, not processed
+
+        // Only touched by the delivering thread
+        bool                        m_bLastValid;
+        VmbUint64_t                 m_nLastFrameID;
+        bool                        m_bRanDry;          // No buffer was left free after the last frame
+};
+
+void    PrintBufferDepthStatistics( std::ostream &s, const BufferDepthStatistics &Statistics );
+
+}} // namespace AVT::VmbAPI
+
+#endif
@@ -0,0 +1,118 @@
+#ifndef AVT_VMBAPI_EXAMPLES_FRAMEINFOLOGGER
+#define AVT_VMBAPI_EXAMPLES_FRAMEINFOLOGGER
+
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+#include "VimbaCPP/Include/VimbaCPP.h"
+#include "ProgramConfig.h"
+#include "BoundedQueue.h"
+#include "FrameSource.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+/**
+ * @brief Everything the frame infos need of one frame, captured on the callback thread
+ */
+struct FrameInfoRecord
+{
+    VmbUint64_t         FrameID;
+    VmbUint64_t         Timestamp;          // Device timestamp
+    VmbUint64_t         ReceiveTime;        // GetHostTime() at arrival, nanoseconds
+    VmbUint32_t         ImageSize;
+    VmbUint32_t         Width;
+    VmbUint32_t         Height;
+    VmbPixelFormatType  PixelFormat;
+    VmbFrameStatusType  ReceiveStatus;
+    bool                bFrameIDValid;
+    bool                bPixelFormatValid;
+    bool                bReceiveStatusValid;
+    bool                bAfterDrop;         // Records were dropped right before this one
+
+    FrameInfoRecord()
+        : FrameID( 0 )
+        , Timestamp( 0 )
+        , ReceiveTime( 0 )
+        , ImageSize( 0 )
+        , Width( 0 )
+        , Height( 0 )
+        , PixelFormat( 0 )
+        , ReceiveStatus( VmbFrameStatusInvalid )
+        , bFrameIDValid( false )
+        , bPixelFormatValid( false )
+        , bReceiveStatusValid( false )
+        , bAfterDrop( false )
+    {}
+};
+
+/**
+ * @brief Prints the frame infos of /i and /a on a thread of its own.
+ * The callback only copies a fixed size record into a lock-free ring, the writer thread
+ * detects missing frames, computes the frame rate and writes the text in batches
+ */
+class FrameInfoLogger
+{
+    public:
+        /**
+         * @brief Starts the writer thread
+         *
+         * @param eFrameInfos FrameInfos_Show prints every frame, FrameInfos_Automatic only the interesting ones
+         * @param nTimestampFrequency Device timestamp ticks per second, the frame rate follows the sensor cadence
+         * @param nCapacity Records the ring holds, records that do not fit are counted and dropped
+         */
+        FrameInfoLogger( FrameInfos eFrameInfos, VmbUint64_t nTimestampFrequency, size_t nCapacity = 16384 );
+        ~FrameInfoLogger();
+
+        /**
+         * @brief Queues the infos of a frame, never blocks and never allocates.
+         * Must always be called from the same thread, the order of the frames matters
+         */
+        void        Log( const SourceFrame &Frame );
+
+        /**
+         * @brief Writes what is still queued and joins the writer thread
+         */
+        void        Stop();
+
+        /**
+         * @brief Records lost because the writer thread fell behind
+         */
+        VmbUint64_t GetDropped() const;
+
+    private:
+        FrameInfoLogger( const FrameInfoLogger& );
+        FrameInfoLogger& operator=( const FrameInfoLogger& );
+
+        void        WriterLoop();
+        void        Drain();
+        void        Format( const FrameInfoRecord &Record );
+        void        Flush();
+
+        const FrameInfos                m_eFrameInfos;
+        const VmbUint64_t               m_nTimestampFrequency;
+        BoundedQueue<FrameInfoRecord>   m_Records;
+        std::atomic<VmbUint64_t>        m_nDropped;
+        std::atomic<bool>               m_bStopping;
+        std::mutex                      m_WakeMutex;
+        std::condition_variable         m_WakeCondition;
+        std::thread                     m_Writer;
+
+        // Only touched by the logging thread
+        bool                            m_bDropPending;
+
+        // Only touched by the writer thread
+        std::string                     m_Batch;
+        VmbUint64_t                     m_nReportedDrops;
+        bool                            m_bLastValid;
+        VmbUint64_t                     m_nLastFrameID;
+        VmbUint64_t                     m_nLastTimestamp;
+        VmbUint64_t                     m_nLastReceiveTime;
+};
+
+}} // namespace AVT::VmbAPI
+
+#endif
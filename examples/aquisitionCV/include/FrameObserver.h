@@ -2,77 +2,132 @@
 #define AVT_VMBAPI_EXAMPLES_FRAMEOBSERVER
 
 #include <queue>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
 #include "VimbaCPP/Include/VimbaCPP.h"
 #include "ProgramConfig.h"
 #include "FrameProcessing.h"
+#include "BoundedQueue.h"
+#include "FrameSource.h"
+#include "FrameInfoLogger.h"
+#include "LatencyMonitor.h"
+#include "FrameSynchronizer.h"
+#include "FrameRecorder.h"
+#include "PreviewDisplay.h"
+#include "Pipeline.h"
 
 namespace AVT {
 namespace VmbAPI {
 
-class FrameObserver : virtual public IFrameObserver
+/**
+ * @brief Counters of the hand-off queue between the callback and the worker threads
+ */
+struct FrameQueueStatistics
+{
+    VmbUint64_t     Received;       // Frames delivered by the source
+    VmbUint64_t     Processed;      // Frames that went through FrameProcessing
+    VmbUint64_t     ProcessedBytes; // Image bytes of the processed frames
+    VmbUint64_t     Overflows;      // Frames requeued unprocessed because the queue was full
+    VmbUint64_t     Incomplete;     // Frames requeued unprocessed because they arrived incomplete
+    size_t          QueueDepth;     // Frames currently waiting for a worker
+    size_t          MaxQueueDepth;  // Highest queue depth seen so far
+    size_t          QueueCapacity;
+
+    FrameQueueStatistics()
+        : Received( 0 )
+        , Processed( 0 )
+        , ProcessedBytes( 0 )
+        , Overflows( 0 )
+        , Incomplete( 0 )
+        , QueueDepth( 0 )
+        , MaxQueueDepth( 0 )
+        , QueueCapacity( 0 )
+    {}
+};
+
+class FrameObserver
 {
     public:
         /**
          * @brief Construct a new Frame Observer object
+         * With zero worker threads configured every frame is processed on the callback thread,
+         * otherwise the callback only hands the frame over to the worker pool; with a pipeline
+         * configured and no synchronizer the frames flow through its stages instead
          * 
-         * @param pCamera The camera the frame was queued at
-         * @param eFrameInfos Indicates how the frame will be displayed
-         * @param eColorProcessing Indicates how color processing is applied
-         * @param bRGBValue 
+         * @param Source The source the frames are handed back to
+         * @param Config Frame infos, color processing, worker threads, queue capacity and latency report
+         * @param Cpus CPUs the callback and worker threads are pinned to, empty for no restriction
+         * @param pSynchronizer Bundles the frames of several cameras, processes them and hands them back
+         *                      instead of this observer, NULL to process them here
+         * @param nInput The input of the synchronizer and the preview this camera feeds
+         * @param pRecorder Writes every frame to disk before it is processed, NULL to not record
+         * @param pDisplay Gets every processed frame offered, NULL for no preview
          */
-        FrameObserver( CameraPtr pCamera, FrameInfos eFrameInfos, ColorProcessing eColorProcessing, bool bRGBValue );
+        FrameObserver( IFrameSource &Source, const ProgramConfig &Config, const std::vector<unsigned int> &Cpus = std::vector<unsigned int>(),
+                       FrameSynchronizer *pSynchronizer = NULL, size_t nInput = 0, FrameRecorder *pRecorder = NULL, PreviewDisplay *pDisplay = NULL );
+        ~FrameObserver();
         
         /**
          * @brief This is our callback routine that will be executed on every received frame.
-         * Triggered by the API
+         * Triggered by the frame source, always from the same thread
          * 
-         * @param pFrame The frame returned from the API
+         * @param Frame The frame delivered by the source
          */
-        virtual void FrameReceived( const FramePtr pFrame );
+        void FrameReceived( const SourceFrame &Frame );
 
-    private:
-        void ShowFrameInfos( const FramePtr & );
-        double GetTime();
+        /**
+         * @brief Stops accepting frames for processing, drains the queue and joins the workers.
+         * Frames arriving afterwards are requeued right away
+         */
+        void Stop();
 
-        template <typename T>
-        class ValueWithState
-        {
-            private:
-                T m_Value;
-                bool m_State;
-            public:
-                ValueWithState()
-                    : m_State( false )
-                {}
-                ValueWithState( T &value )
-                    : m_Value ( value )
-                    , m_State( true )
-                {}
-                const T& operator()() const
-                {
-                    return m_Value;
-                }
-                void operator()( const T &value )
-                {
-                    m_Value = value;
-                    m_State = true;
-                }
-                bool IsValid() const
-                {
-                    return m_State;
-                }
-                void Invalidate()
-                {
-                    m_State = false;
-                }
-        };
+        /**
+         * @brief Snapshot of the queue counters, safe to call while streaming.
+         * With a pipeline processed counts the frames every stage is done with
+         */
+        FrameQueueStatistics GetStatistics() const;
+
+        /**
+         * @brief Snapshot of the stage counters, empty without a pipeline
+         */
+        PipelineStatistics GetPipelineStatistics() const;
 
+    private:
+        void ProcessFrame( const SourceFrame &, FrameProcessing & );
+        void WorkerLoop( FrameProcessing * );
+
+        IFrameSource &              m_Source;
         const FrameInfos            m_eFrameInfos;
         const bool                  m_bRGB;
         const ColorProcessing       m_eColorProcessing;
-        ValueWithState<double>      m_FrameTime;
-        ValueWithState<VmbUint64_t> m_FrameID;
-        FrameProcessing *           proc;
+        const std::vector<unsigned int> m_Cpus;
+        bool                        m_bCallbackPinned;      // Only touched by the callback thread
+        FrameSynchronizer * const   m_pSynchronizer;
+        const size_t                m_nSynchronizerInput;
+        FrameRecorder * const       m_pRecorder;
+        PreviewDisplay * const      m_pDisplay;
+        std::unique_ptr<FrameInfoLogger> m_pFrameInfoLogger;    // Only with frame infos enabled
+        std::unique_ptr<LatencyMonitor>  m_pLatencyMonitor;     // Only with the latency report enabled
+        std::unique_ptr<Pipeline>   m_pPipeline;                // Only with /g and without bundling
+        bool                        m_bPipelineRecords;         // A record stage takes the frames instead of the callback
+        std::vector< std::unique_ptr<FrameProcessing> > m_Processors;  // One per worker, the first one doubles for the callback thread
+
+        BoundedQueue<SourceFrame>   m_FrameQueue;
+        std::vector<std::thread>    m_Workers;
+        std::mutex                  m_WakeMutex;
+        std::condition_variable     m_WakeCondition;
+        std::atomic<unsigned int>   m_nSleepingWorkers;
+        std::atomic<bool>           m_bStopping;
+        std::atomic<VmbUint64_t>    m_nReceived;
+        std::atomic<VmbUint64_t>    m_nProcessed;
+        std::atomic<VmbUint64_t>    m_nProcessedBytes;
+        std::atomic<VmbUint64_t>    m_nOverflows;
+        std::atomic<VmbUint64_t>    m_nIncomplete;
+        std::atomic<size_t>         m_nMaxQueueDepth;
 };
 
 }} // namespace AVT::VmbAPI
@@ -5,24 +5,78 @@
 #include "VimbaImageTransform/Include/VmbTransform.h"
 #include <opencv2/opencv.hpp>
 
+#include "FrameSource.h"
+#include "ProgramConfig.h"
+#include "ConversionContext.h"
+
 namespace AVT {
 namespace VmbAPI {
 
 class FrameProcessing {
     public: 
-        FrameProcessing();
+        /**
+         * @brief Construct a new Frame Processing object
+         * 
+         * @param bColor Demosaic Bayer frames to BGR8 instead of showing them raw
+         * @param eColorProcessing Whether colour frames get the colour correction matrix applied
+         * @param eDemosaic Who demosaics 8 bit Bayer frames, the in-tree kernels or VmbImageTransform
+         * @param nImageBuffers Converted images that may be leased at the same time, see TakeLease
+         */
+        explicit FrameProcessing( bool bColor = false, ColorProcessing eColorProcessing = ColorProcessing_Off, DemosaicProcessing eDemosaic = DemosaicProcessing_Bilinear,
+                                  size_t nImageBuffers = 2 );
         
-        void        ProcessImage(const FramePtr);
+        /**
+         * @brief Makes the frame available as cv::Mat.
+         * Formats OpenCV understands are wrapped without a copy, all others are converted
+         * into a pooled buffer of the conversion context
+         * 
+         * @return false if the frame could not be converted
+         */
+        bool        ProcessImage(const SourceFrame &);
+
+        /**
+         * @brief Drops the view on the frame buffer and hands the converted image back to the pool,
+         * must be called before the frame is requeued
+         */
+        void        Release();
+
+        /**
+         * @brief Hands the pooled buffer of the converted image over, the image stays valid for as
+         * long as the lease is held instead of until Release(). Empty if the image is the frame buffer
+         */
+        ImageBufferLease TakeLease();
+
+        /**
+         * @brief Shows the image in a window and waits for the GUI, far too slow for the acquisition
+         * path; the preview of /v draws on a thread of its own, see PreviewDisplay
+         */
         void        Show();
 
         VmbImage    GetImage();
+
+        /**
+         * @brief The image of the last processed frame, it may point into the frame buffer
+         * and is only valid until Release()
+         */
         cv::Mat     GetCVImage();
 
     private: 
+        FrameProcessing( const FrameProcessing& );
+        FrameProcessing& operator=( const FrameProcessing& );
+
+        bool        Convert( const SourceFrame &, const char *pDestinationFormat, int nType );
+
+        bool        m_bColor;
+        ColorProcessing m_eColorProcessing;
+        DemosaicProcessing m_eDemosaic;
+        VmbPixelFormatType m_eImageInfoFormat;
         VmbImage    sourceImage;
         cv::Mat     cvImage;
+        const size_t m_nImageBuffers;
+        ConversionContext m_Context;
+        ImageBufferLease m_Lease;
 };
 
 }}
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,177 @@
+#ifndef AVT_VMBAPI_EXAMPLES_FRAMERECORDER
+#define AVT_VMBAPI_EXAMPLES_FRAMERECORDER
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+
+#include "VimbaCPP/Include/VimbaCPP.h"
+#include "FrameSource.h"
+#include "RecordingFormat.h"
+#include "ThreadPool.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+/**
+ * @brief Counters of a recording
+ */
+struct RecordStatistics
+{
+    VmbUint64_t     Frames;         // Frames written to the file
+    VmbUint64_t     PayloadBytes;   // Image bytes of the written frames
+    VmbUint64_t     StoredBytes;    // Bytes the written frames take in the file, compressed or not
+    VmbUint64_t     FileBytes;      // Bytes handed to the disk so far
+    VmbUint64_t     Dropped;        // Frames left out because the disk fell behind or failed
+    bool            bDirectIO;      // The file bypasses the page cache
+    bool            bCompressed;    // Frames go through the lossless codec
+    VmbUint64_t     CodedBytes;     // Image bytes run through the codec
+    double          CodecSeconds;   // Time the codec threads spent on them, summed over the threads
+
+    RecordStatistics()
+        : Frames( 0 )
+        , PayloadBytes( 0 )
+        , StoredBytes( 0 )
+        , FileBytes( 0 )
+        , Dropped( 0 )
+        , bDirectIO( false )
+        , bCompressed( false )
+        , CodedBytes( 0 )
+        , CodecSeconds( 0.0 )
+    {}
+};
+
+/**
+ * @brief Streams the raw frames of one camera into a file laid out as described in RecordingFormat.h.
+ * The callback thread copies each frame into a large block aligned staging buffer and hands the
+ * camera buffer back at once; full staging buffers are written by a thread of its own with
+ * O_DIRECT, so the page cache neither slows the writes down nor evicts everything else.
+ * While one buffer is on its way to the disk the next ones fill, and if all of them are waiting
+ * for the disk a frame is left out of the recording instead of holding up the camera.
+ * With compression the callback thread only copies the frame aside; an encoder thread splits it into
+ * stripes of STRIPE_ROWS rows, codes them on a thread pool with the lossless codec of StripeCodec.h
+ * and appends the result. A frame finding the encoder backed up is left out as well
+ */
+class FrameRecorder
+{
+    public:
+        static const size_t BUFFER_SIZE     = 32 * 1024 * 1024;
+        static const size_t BUFFER_COUNT    = 4;
+        // Alignment of the buffers, the write sizes and the file offsets O_DIRECT requires
+        static const size_t BLOCK_SIZE      = 4096;
+        // Frames copied aside for the encoder at most
+        static const size_t CODEC_FRAMES    = 4;
+        // Rows per independently coded stripe, a multiple of the two rows of a Bayer pattern
+        static const VmbUint32_t STRIPE_ROWS = 64;
+
+        /**
+         * @param bCompress Code the frames losslessly, a frame that does not get smaller is stored as is
+         * @param nCodecThreads Threads coding the stripes of a frame, 0 for one per core
+         */
+        explicit FrameRecorder( bool bCompress = false, unsigned int nCodecThreads = 0 );
+        ~FrameRecorder();
+
+        /**
+         * @brief Creates the file, writes the file header and starts the writer thread.
+         * Falls back to buffered writes on file systems without O_DIRECT support, e.g. tmpfs
+         *
+         * @param strFileName The file to create, an existing one is overwritten
+         * @param strCameraID Stored in the file header
+         * @param nTimestampFrequency Device timestamp ticks per second, stored in the file header
+         */
+        VmbErrorType Open( const std::string &strFileName, const std::string &strCameraID, VmbUint64_t nTimestampFrequency );
+
+        /**
+         * @brief Appends a frame, never blocks on the disk.
+         * Must always be called from the same thread, the buffer may be requeued as soon as it returns
+         */
+        void        Record( const SourceFrame &Frame );
+
+        /**
+         * @brief Writes what is still buffered followed by the index and trailer and closes the file.
+         * Must not run concurrently to Record
+         *
+         * @return VmbErrorOther if any write failed, the file then lacks its index
+         */
+        VmbErrorType Close();
+
+        /**
+         * @brief Snapshot of the counters, safe to call while recording
+         */
+        RecordStatistics GetStatistics() const;
+
+    private:
+        FrameRecorder( const FrameRecorder& );
+        FrameRecorder& operator=( const FrameRecorder& );
+
+        struct StagingBuffer
+        {
+            VmbUchar_t *    pData;              // BUFFER_SIZE bytes aligned to BLOCK_SIZE
+            VmbUint64_t     nFileOffset;        // Where the buffer goes
+            size_t          nSize;              // Bytes to write, a multiple of BLOCK_SIZE
+        };
+
+        struct CodecFrame
+        {
+            RecordingFrameHeader        Header;
+            std::vector<VmbUchar_t>     Data;               // The image as delivered
+        };
+
+        size_t      GetFreeSpace();
+        bool        BeginRecord( RecordingFrameHeader &Header, size_t nStoredSize );
+        void        EndRecord( const RecordingFrameHeader &Header );
+        void        Append( const void *pData, size_t nSize );
+        void        Submit( size_t nSize );
+        void        WriterLoop();
+        void        EncoderLoop();
+        void        Encode( CodecFrame &Frame );
+
+        const bool                      m_bCompress;
+        const unsigned int              m_nCodecThreads;
+        int                             m_hFile;
+        bool                            m_bDirectIO;
+        std::vector<StagingBuffer>      m_Buffers;
+
+        // Only touched by the recording thread, with compression by the encoder thread
+        StagingBuffer *                 m_pFill;            // NULL until the next free buffer is taken
+        size_t                          m_nFill;            // Bytes in m_pFill
+        VmbUint64_t                     m_nOffset;          // File offset of the next byte appended
+        std::deque<RecordingIndexEntry> m_Index;
+
+        mutable std::mutex              m_Mutex;            // Guards the buffer lists and m_bStopping
+        std::condition_variable         m_WriteCondition;   // Signalled when a buffer is ready for the disk
+        std::condition_variable         m_FreeCondition;    // Signalled when a buffer was written
+        std::deque<StagingBuffer*>      m_FreeBuffers;
+        std::deque<StagingBuffer*>      m_FullBuffers;      // In file order
+        bool                            m_bStopping;
+        std::thread                     m_Writer;
+
+        std::vector<CodecFrame>         m_CodecFrames;
+        std::mutex                      m_CodecMutex;       // Guards the frame lists and m_bCodecStopping
+        std::condition_variable         m_CodecCondition;   // Signalled when a frame is ready for the encoder
+        std::deque<CodecFrame*>         m_FreeCodecFrames;
+        std::deque<CodecFrame*>         m_PendingCodecFrames;   // In arrival order
+        bool                            m_bCodecStopping;
+        std::thread                     m_Encoder;
+        std::unique_ptr<ThreadPool>     m_pCodecPool;
+        std::vector<VmbUchar_t>         m_Coded;            // Only touched by the encoder, one slot per stripe
+        std::vector<VmbUint32_t>        m_StripeSizes;
+
+        std::atomic<bool>               m_bFailed;          // A write failed, nothing more is recorded
+        std::atomic<VmbUint64_t>        m_nFrames;
+        std::atomic<VmbUint64_t>        m_nPayloadBytes;
+        std::atomic<VmbUint64_t>        m_nStoredBytes;
+        std::atomic<VmbUint64_t>        m_nCodedBytes;
+        std::atomic<VmbUint64_t>        m_nCodecNanoseconds;
+        std::atomic<VmbUint64_t>        m_nFileBytes;
+        std::atomic<VmbUint64_t>        m_nDropped;
+};
+
+}} // namespace AVT::VmbAPI
+
+#endif
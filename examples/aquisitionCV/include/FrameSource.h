@@ -0,0 +1,165 @@
+#ifndef AVT_VMBAPI_EXAMPLES_FRAMESOURCE
+#define AVT_VMBAPI_EXAMPLES_FRAMESOURCE
+
+#include <string>
+
+#include "VimbaCPP/Include/VimbaCPP.h"
+#include "ReconnectMonitor.h"
+#include "FrameBufferSizer.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+class FrameObserver;
+class ICameraFeatures;
+
+/**
+ * @brief Everything the pipeline needs to know about an acquired frame.
+ * Filled once when the frame arrives, so later stages never call back into the API.
+ * The buffer stays valid until the frame is handed back with IFrameSource::QueueFrame
+ */
+struct SourceFrame
+{
+    FramePtr            pFrame;             // The Vimba frame, NULL for frames not coming from a camera
+    VmbUint32_t         nSlot;              // Buffer index within the source
+    VmbUchar_t *        pBuffer;            // First byte of the image
+    VmbUint32_t         ImageSize;          // Bytes of image data in pBuffer
+    VmbUint32_t         Width;              // 0 if unknown
+    VmbUint32_t         Height;             // 0 if unknown
+    VmbUint32_t         OffsetX;
+    VmbUint32_t         OffsetY;
+    VmbPixelFormatType  PixelFormat;
+    bool                bPixelFormatValid;
+    VmbUint64_t         FrameID;
+    bool                bFrameIDValid;
+    VmbUint64_t         Timestamp;          // Device timestamp in camera ticks
+    VmbUint64_t         ReceiveTime;        // GetHostTime() when the frame reached the application
+    VmbFrameStatusType  ReceiveStatus;
+    bool                bReceiveStatusValid;
+
+    SourceFrame()
+        : nSlot( 0 )
+        , pBuffer( NULL )
+        , ImageSize( 0 )
+        , Width( 0 )
+        , Height( 0 )
+        , OffsetX( 0 )
+        , OffsetY( 0 )
+        , PixelFormat( VmbPixelFormatMono8 )
+        , bPixelFormatValid( false )
+        , FrameID( 0 )
+        , bFrameIDValid( false )
+        , Timestamp( 0 )
+        , ReceiveTime( 0 )
+        , ReceiveStatus( VmbFrameStatusInvalid )
+        , bReceiveStatusValid( false )
+    {}
+
+    bool IsComplete() const
+    {
+        return bReceiveStatusValid && VmbFrameStatusComplete == ReceiveStatus;
+    }
+};
+
+/**
+ * @brief Device timestamp in nanoseconds, split so ticks * 1e9 cannot overflow for a long running camera
+ *
+ * @param nTimestamp Device timestamp in camera ticks
+ * @param nFrequency Ticks per second as reported by IFrameSource::GetTimestampFrequency, not 0
+ */
+inline VmbUint64_t TimestampToNanoseconds( VmbUint64_t nTimestamp, VmbUint64_t nFrequency )
+{
+    return ( nTimestamp / nFrequency ) * 1000000000ULL + ( nTimestamp % nFrequency ) * 1000000000ULL / nFrequency;
+}
+
+/**
+ * @brief A device delivering frames to a FrameObserver, e.g. a Vimba camera or a synthetic generator.
+ * Every delivered frame must be handed back with QueueFrame exactly once
+ */
+class IFrameSource
+{
+    public:
+        virtual ~IFrameSource() {}
+
+        /**
+         * @brief Opens the device and prepares the image format
+         */
+        virtual VmbErrorType Open() = 0;
+
+        /**
+         * @brief Announces the frame buffers and starts delivering frames
+         *
+         * @param pObserver Receives every frame, must outlive StopAcquisition
+         */
+        virtual VmbErrorType StartAcquisition( FrameObserver *pObserver ) = 0;
+
+        /**
+         * @brief Stops delivering frames and revokes the buffers
+         */
+        virtual VmbErrorType StopAcquisition() = 0;
+
+        /**
+         * @brief Closes the device
+         */
+        virtual VmbErrorType Close() = 0;
+
+        /**
+         * @brief Hands a delivered frame back so its buffer can be filled again.
+         * Safe to call from any thread
+         */
+        virtual VmbErrorType QueueFrame( const SourceFrame &Frame ) = 0;
+
+        /**
+         * @brief ID of the device as shown to the user
+         */
+        virtual std::string GetID() const = 0;
+
+        /**
+         * @brief Device timestamp ticks per second, valid after Open
+         */
+        virtual VmbUint64_t GetTimestampFrequency() const = 0;
+
+        /**
+         * @brief The feature tree of the device, valid after Open
+         *
+         * @return NULL for devices without one
+         */
+        virtual ICameraFeatures* GetFeatures()
+        {
+            return NULL;
+        }
+
+        /**
+         * @brief ID of the interface the device is attached to, devices on one interface share its bandwidth
+         *
+         * @return Empty if not attached to a network
+         */
+        virtual std::string GetInterfaceID() const
+        {
+            return std::string();
+        }
+
+        /**
+         * @brief Outages of a device that reconnects on its own while streaming
+         *
+         * @return All 0 for devices that never reconnect
+         */
+        virtual ReconnectStatistics GetReconnectStatistics() const
+        {
+            return ReconnectStatistics();
+        }
+
+        /**
+         * @brief Frames announced and how their number was chosen
+         *
+         * @return All 0 for devices that do not size their buffers
+         */
+        virtual BufferDepthStatistics GetBufferStatistics() const
+        {
+            return BufferDepthStatistics();
+        }
+};
+
+}} // namespace AVT::VmbAPI
+
+#endif
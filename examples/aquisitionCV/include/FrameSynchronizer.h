@@ -0,0 +1,152 @@
+#ifndef AVT_VMBAPI_EXAMPLES_FRAMESYNCHRONIZER
+#define AVT_VMBAPI_EXAMPLES_FRAMESYNCHRONIZER
+
+#include <deque>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "VimbaCPP/Include/VimbaCPP.h"
+#include "ProgramConfig.h"
+#include "FrameProcessing.h"
+#include "FrameSource.h"
+#include "PreviewDisplay.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+/**
+ * @brief Counters of the frame synchronizer
+ */
+struct BundleStatistics
+{
+    VmbUint64_t     Bundles;        // Bundles processed
+    VmbUint64_t     BundleBytes;    // Image bytes of the processed bundles
+    VmbUint64_t     Dropped;        // Complete bundles requeued unprocessed because the bundle thread was busy
+    VmbUint64_t     Unmatched;      // Frames without a partner within the tolerance, or incomplete
+    VmbUint64_t     Late;           // Frames arriving after a bundle past them was formed
+    VmbUint64_t     Overflows;      // Frames pushed out because their camera had too many waiting
+    VmbUint64_t     Restarts;       // Times a camera started its keys over, e.g. after reconnecting
+
+    BundleStatistics()
+        : Bundles( 0 )
+        , BundleBytes( 0 )
+        , Dropped( 0 )
+        , Unmatched( 0 )
+        , Late( 0 )
+        , Overflows( 0 )
+        , Restarts( 0 )
+    {}
+};
+
+/**
+ * @brief Groups the frames of several cameras by exposure and processes them as one bundle.
+ * Every camera is an input fed by its FrameObserver. A bundle is formed as soon as every started
+ * input has a frame whose key, device timestamp or frame ID, lies within the tolerance of the
+ * others; frames that can no longer get a partner go straight back to their camera. At most
+ * MAX_PENDING frames per camera wait for partners and MAX_BUNDLES bundles for the bundle thread,
+ * so a camera needs HELD_FRAMES buffers more than it would without bundling.
+ * A camera whose keys go backwards was restarted; its keys are rebased onto where the camera that
+ * delivered last has got to by the time the frame was received, so bundling resumes at once
+ */
+class FrameSynchronizer
+{
+    public:
+        static const VmbUint32_t MAX_PENDING    = 2;
+        static const VmbUint32_t MAX_BUNDLES    = 1;
+        // Frames of one camera the synchronizer holds at most: waiting, queued and in processing
+        static const VmbUint32_t HELD_FRAMES    = MAX_PENDING + MAX_BUNDLES + 1;
+
+        /**
+         * @brief Starts the bundle thread, frames are requeued right away until Start
+         *
+         * @param nInputs Number of cameras
+         * @param Config Matching, tolerance and the processing applied to every frame
+         * @param pDisplay Gets the processed frames offered, NULL for no preview
+         */
+        FrameSynchronizer( size_t nInputs, const ProgramConfig &Config, PreviewDisplay *pDisplay = NULL );
+        ~FrameSynchronizer();
+
+        /**
+         * @brief Tells which source an input's frames are handed back to, before its first frame.
+         * An input without source, e.g. a camera that failed to open, is left out of the bundles.
+         * Inputs must not change after Start
+         */
+        void        SetInput( size_t nInput, IFrameSource *pSource );
+
+        /**
+         * @brief Starts matching once every input got its source
+         */
+        void        Start();
+
+        /**
+         * @brief Takes a frame of a camera, called on the callback thread of that camera.
+         * The frame goes back to its source here, in a dropped bundle or after processing
+         */
+        void        Push( size_t nInput, const SourceFrame &Frame );
+
+        /**
+         * @brief Processes the queued bundles, hands every held frame back and joins the bundle thread.
+         * Frames pushed afterwards are requeued right away
+         */
+        void        Stop();
+
+        /**
+         * @brief Snapshot of the counters, safe to call while streaming
+         */
+        BundleStatistics GetStatistics() const;
+
+    private:
+        FrameSynchronizer( const FrameSynchronizer& );
+        FrameSynchronizer& operator=( const FrameSynchronizer& );
+
+        struct PendingFrame
+        {
+            SourceFrame     Frame;
+            VmbInt64_t      Key;            // Device nanoseconds or frame ID
+        };
+
+        struct Input
+        {
+            IFrameSource *                      pSource;
+            VmbUint64_t                         nTimestampFrequency;
+            std::deque<PendingFrame>            Pending;        // Oldest first, at most MAX_PENDING
+            bool                                bKeyValid;      // Got a frame with a key
+            VmbInt64_t                          nLastRawKey;    // Key of the newest frame as the camera sent it
+            VmbInt64_t                          nLastKey;       // The same rebased
+            VmbUint64_t                         nLastReceive;   // Host time of the newest frame
+            double                              dKeyPeriod;     // Host nanoseconds per key, 0 while unknown
+            VmbInt64_t                          nKeyOffset;     // Added to the keys of the camera since it restarted
+            std::unique_ptr<FrameProcessing>    pProcessing;    // Used by the bundle thread only
+        };
+
+        typedef std::vector<SourceFrame> FrameBundle;          // One frame per input, inputs left out have none
+
+        bool        GetKey( const Input &In, const SourceFrame &Frame, VmbInt64_t &nKey ) const;
+        void        Rebase( Input &In, const SourceFrame &Frame, VmbInt64_t nRawKey );
+        void        TrackKey( Input &In, const SourceFrame &Frame, VmbInt64_t nRawKey, VmbInt64_t nKey ) const;
+        void        Match();
+        void        ReleaseBundle( const FrameBundle &Bundle );
+        void        BundleLoop();
+
+        const BundleMatching        m_eMatching;
+        PreviewDisplay * const      m_pDisplay;
+        const VmbInt64_t            m_nTolerance;               // In key units
+        std::vector<Input>          m_Inputs;
+
+        mutable std::mutex          m_Mutex;                    // Guards everything below
+        std::condition_variable     m_BundleCondition;
+        std::deque<FrameBundle>     m_Bundles;
+        bool                        m_bStarted;
+        bool                        m_bStopping;
+        bool                        m_bLastKeyValid;
+        VmbInt64_t                  m_nLastKey;                 // Key of the newest frame in the last bundle
+        BundleStatistics            m_Statistics;
+        std::thread                 m_BundleThread;
+};
+
+}} // namespace AVT::VmbAPI
+
+#endif
@@ -0,0 +1,125 @@
+#ifndef AVT_VMBAPI_EXAMPLES_FRAMETIMINGANALYZER
+#define AVT_VMBAPI_EXAMPLES_FRAMETIMINGANALYZER
+
+#include <atomic>
+
+#include "VimbaCPP/Include/VimbaCPP.h"
+#include "LatencyHistogram.h"
+#include "FrameSource.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+/**
+ * @brief Sensor cadence and clock relation derived from the device timestamps
+ */
+struct FrameTimingStatistics
+{
+    VmbUint64_t     Frames;         // Frames with a device timestamp
+    double          SensorFPS;      // Frame IDs per second of device time, lost frames do not lower it
+    double          DriftPPM;       // Camera clock rate against the host clock, positive when the camera runs fast
+    bool            bFPSValid;
+    bool            bDriftValid;    // Only after a second of device time, before that jitter dominates
+
+    FrameTimingStatistics()
+        : Frames( 0 )
+        , SensorFPS( 0.0 )
+        , DriftPPM( 0.0 )
+        , bFPSValid( false )
+        , bDriftValid( false )
+    {}
+};
+
+/**
+ * @brief Relates the device timestamps of the frames to their host arrival times.
+ * A running least squares fit of host against device time, weighted to the last FIT_TIME_CONSTANT
+ * seconds, tracks offset and drift of the two clocks, frames delayed by a stall are kept out of it.
+ * What a frame arrives later than the fit predicts, above the earliest arrivals, is its transport delay. Intervals between device
+ * timestamps show camera side stalls, transport delay and arrival intervals host side ones
+ */
+class FrameTimingAnalyzer
+{
+    public:
+        /**
+         * @param nTimestampFrequency Device timestamp ticks per second
+         */
+        explicit FrameTimingAnalyzer( VmbUint64_t nTimestampFrequency );
+
+        /**
+         * @brief Adds a frame to the fit and the interval histograms.
+         * Must always be called from the same thread in arrival order, never blocks
+         */
+        void        Update( const SourceFrame &Frame );
+
+        /**
+         * @brief Nanoseconds a frame arrived later than the earliest arrivals the clock fit predicts.
+         * Safe from any thread, 0 until two frames were seen
+         */
+        VmbUint64_t GetTransportDelay( const SourceFrame &Frame ) const;
+
+        /**
+         * @brief Snapshot of sensor rate and clock drift, safe from any thread
+         */
+        FrameTimingStatistics GetStatistics() const;
+
+        /**
+         * @brief Device time per frame ID in nanoseconds, the sensor cadence
+         */
+        const LatencyHistogram& GetDeviceIntervals() const  { return m_DeviceIntervals; }
+
+        /**
+         * @brief Host time between consecutive arrivals in nanoseconds
+         */
+        const LatencyHistogram& GetArrivalIntervals() const { return m_ArrivalIntervals; }
+
+    private:
+        FrameTimingAnalyzer( const FrameTimingAnalyzer& );
+        FrameTimingAnalyzer& operator=( const FrameTimingAnalyzer& );
+
+        /**
+         * @brief Fit state handed from the callback thread to readers, each field a relaxed atomic
+         * so a torn read is only detected by the sequence counter, never undefined
+         */
+        struct ClockModel
+        {
+            double      MeanDevice;         // Weighted means, nanoseconds since the first frame
+            double      MeanHost;
+            double      Slope;              // Host nanoseconds per device nanosecond
+            double      Floor;              // Smallest recent residual, the arrival of an undelayed frame
+            double      DeviceSpan;         // Device time covered so far
+            double      FirstFrameNumber;   // Frame ID, or the arrival count without IDs
+            double      LastFrameNumber;
+        };
+
+        void        Publish( const ClockModel &Model );
+        bool        ReadModel( ClockModel &Model ) const;
+
+        const VmbUint64_t           m_nTimestampFrequency;
+        LatencyHistogram            m_DeviceIntervals;
+        LatencyHistogram            m_ArrivalIntervals;
+
+        // Seqlock protected copy of the model, odd while the callback thread writes it
+        std::atomic<unsigned int>   m_nSequence;
+        static const size_t         MODEL_FIELDS = sizeof( ClockModel ) / sizeof( double );
+        std::atomic<double>         m_Published[ MODEL_FIELDS ];
+        std::atomic<VmbUint64_t>    m_nFrames;
+
+        // Written once before the first Publish, read only afterwards
+        VmbUint64_t                 m_nOriginDevice;
+        VmbUint64_t                 m_nOriginHost;
+
+        // Only touched by the updating thread
+        ClockModel                  m_Model;
+        double                      m_dWeight;
+        double                      m_dCovDeviceDevice;
+        double                      m_dCovDeviceHost;
+        unsigned int                m_nGatedFrames;     // Consecutive frames kept out of the fit
+        bool                        m_bHasLast;
+        VmbUint64_t                 m_nLastFrameNumber;
+        VmbUint64_t                 m_nLastDevice;
+        VmbUint64_t                 m_nLastHost;
+};
+
+}} // namespace AVT::VmbAPI
+
+#endif
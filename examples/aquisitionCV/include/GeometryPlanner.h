@@ -0,0 +1,73 @@
+#ifndef AVT_VMBAPI_EXAMPLES_GEOMETRYPLANNER
+#define AVT_VMBAPI_EXAMPLES_GEOMETRYPLANNER
+
+#include <string>
+#include <vector>
+#include <ostream>
+
+#include "VimbaCPP/Include/VimbaCPP.h"
+#include "ProgramConfig.h"
+#include "CameraFeatures.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+/**
+ * @brief How the camera ended up being set, read back after applying
+ */
+struct GeometryPlan
+{
+    std::string         PixelFormat;
+    GeometryReduction   Reduction;      // Roi if neither binning nor decimation is used
+    VmbInt64_t          Factor;         // Of binning or decimation, 1 for none
+    VmbInt64_t          Width;
+    VmbInt64_t          Height;
+    VmbInt64_t          OffsetX;        // In binned or decimated pixels
+    VmbInt64_t          OffsetY;
+    VmbInt64_t          SensorWidth;    // Full resolution
+    VmbInt64_t          SensorHeight;
+
+    GeometryPlan()
+        : Reduction( GeometryReduction_Roi )
+        , Factor( 1 )
+        , Width( 0 )
+        , Height( 0 )
+        , OffsetX( 0 )
+        , OffsetY( 0 )
+        , SensorWidth( 0 )
+        , SensorHeight( 0 )
+    {}
+};
+
+/**
+ * @brief The pixel format with the smallest payload that still carries what the processing needs:
+ * an 8 bit Bayer format for colour, Mono8 otherwise
+ *
+ * @param Available The formats the camera offers
+ * @param bColor Whether the processing demosaics
+ * @param strCurrent Kept if nothing better is offered
+ */
+std::string     ChoosePixelFormat( const std::vector<std::string> &Available, bool bColor, const std::string &strCurrent );
+
+/**
+ * @brief Sets the camera up to deliver the requested image and no more. Features are written in
+ * the order their ranges depend on each other: binning and decimation cleared, pixel format,
+ * binning or decimation, the offsets cleared so the size may grow, the size, then the offsets.
+ * Without a request the full sensor is read out in the current format, with width and height
+ * even as the image transform needs.
+ * The factor is the largest integer keeping the region at least as large as the requested image,
+ * the rest of the scaling is left to the processing
+ *
+ * @param bColor Whether the processing demosaics, binning would lose the colour on most sensors
+ * @param Plan Receives the settings read back from the camera
+ */
+VmbErrorType    ApplyGeometry( ICameraFeatures &Features, const GeometryRequest &Request, bool bColor, GeometryPlan &Plan );
+
+/**
+ * @brief One line describing the plan, e.g. "816x680+0+2 Mono8, binning 3 of 2448x2048"
+ */
+void            PrintGeometryPlan( std::ostream &s, const GeometryPlan &Plan );
+
+}} // namespace AVT::VmbAPI
+
+#endif
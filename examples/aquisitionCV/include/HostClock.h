@@ -0,0 +1,29 @@
+#ifndef AVT_VMBAPI_EXAMPLES_HOSTCLOCK
+#define AVT_VMBAPI_EXAMPLES_HOSTCLOCK
+
+#include <time.h>
+
+#include "VimbaCPP/Include/VimbaCPP.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+/**
+ * @brief Monotonic host time in nanoseconds, read through the vDSO without a system call.
+ * All host timestamps of the pipeline come from here so they can be subtracted from each other.
+ * The raw clock is not slewed by NTP, so its rate against the camera clock only shows real drift
+ */
+inline VmbUint64_t GetHostTime()
+{
+    struct timespec now;
+#ifdef CLOCK_MONOTONIC_RAW
+    clock_gettime( CLOCK_MONOTONIC_RAW, &now );
+#else
+    clock_gettime( CLOCK_MONOTONIC, &now );
+#endif
+    return static_cast<VmbUint64_t>( now.tv_sec ) * 1000000000ULL + static_cast<VmbUint64_t>( now.tv_nsec );
+}
+
+}} // namespace AVT::VmbAPI
+
+#endif
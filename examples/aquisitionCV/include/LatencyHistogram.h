@@ -0,0 +1,68 @@
+#ifndef AVT_VMBAPI_EXAMPLES_LATENCYHISTOGRAM
+#define AVT_VMBAPI_EXAMPLES_LATENCYHISTOGRAM
+
+#include <atomic>
+
+#include "VimbaCPP/Include/VimbaCPP.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+/**
+ * @brief Histogram of durations in nanoseconds with a bounded relative error, like HdrHistogram.
+ * Values below 256 ns are counted exactly, above that every power of two is split into 128 buckets,
+ * so a reported value is at most 0.8 % above the real one. Values from 2^40 ns (18 minutes) on
+ * share the last bucket. Recording is lock-free and may happen from any number of threads
+ */
+class LatencyHistogram
+{
+    public:
+        LatencyHistogram();
+
+        /**
+         * @brief Counts one value, two relaxed atomic increments and an occasional max update
+         */
+        void        Record( VmbUint64_t nNanoseconds );
+
+        VmbUint64_t GetCount() const;
+        VmbUint64_t GetMax() const;
+
+        /**
+         * @brief Smallest value that at least the given share of the recorded values do not exceed
+         *
+         * @param dPercentile Share in percent, e.g. 99.9
+         * @return The upper end of the bucket holding the percentile, never above the maximum, 0 if empty
+         */
+        VmbUint64_t GetPercentile( double dPercentile ) const;
+
+        /**
+         * @brief Values recorded above a threshold, at bucket resolution
+         *
+         * @param nThreshold Values in buckets entirely above the bucket of the threshold are counted
+         */
+        VmbUint64_t GetCountAbove( VmbUint64_t nThreshold ) const;
+
+        /**
+         * @brief Forgets all values, must not race with Record
+         */
+        void        Reset();
+
+    private:
+        LatencyHistogram( const LatencyHistogram& );
+        LatencyHistogram& operator=( const LatencyHistogram& );
+
+        static const unsigned int   SUB_BUCKET_BITS = 7;
+        static const unsigned int   MAX_VALUE_BITS  = 40;
+        static const unsigned int   BUCKET_COUNT    = ( MAX_VALUE_BITS - SUB_BUCKET_BITS - 1 ) * ( 1u << SUB_BUCKET_BITS ) + ( 2u << SUB_BUCKET_BITS );
+
+        static unsigned int BucketIndex( VmbUint64_t nValue );
+        static VmbUint64_t  BucketUpperValue( unsigned int nIndex );
+
+        std::atomic<VmbUint64_t>    m_Buckets[ BUCKET_COUNT ];
+        std::atomic<VmbUint64_t>    m_nCount;
+        std::atomic<VmbUint64_t>    m_nMax;
+};
+
+}} // namespace AVT::VmbAPI
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef AVT_VMBAPI_EXAMPLES_LATENCYMONITOR
+#define AVT_VMBAPI_EXAMPLES_LATENCYMONITOR
+
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+#include "VimbaCPP/Include/VimbaCPP.h"
+#include "LatencyHistogram.h"
+#include "FrameTimingAnalyzer.h"
+#include "FrameSource.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+enum LatencyStage
+{
+    LatencyStage_Transport,     // Device timestamp to callback entry, above the earliest arrivals
+    LatencyStage_QueueWait,     // Callback entry to processing start
+    LatencyStage_Processing,    // Processing of a complete frame
+    LatencyStage_Requeue,       // Processing end to the buffer being back at the source
+    LatencyStage_Total,         // Device timestamp to processing end, transport measured like above
+    LatencyStage_Count
+};
+
+/**
+ * @brief Latency histograms of the pipeline stages, the frame timing and the thread printing them.
+ * Camera and host clocks are not synchronised, so the transport stage is the delay a frame had on
+ * top of the earliest arrivals, as predicted by the drift compensating clock fit of the
+ * FrameTimingAnalyzer. A report is printed on SIGUSR1, every report interval and when stopping
+ */
+class LatencyMonitor
+{
+    public:
+        /**
+         * @brief Starts the report thread
+         *
+         * @param strCameraID Camera the report is headed with
+         * @param nTimestampFrequency Device timestamp ticks per second
+         * @param dReportInterval Seconds between reports, 0 for reports on SIGUSR1 and at stop only
+         */
+        LatencyMonitor( const std::string &strCameraID, VmbUint64_t nTimestampFrequency, double dReportInterval );
+        ~LatencyMonitor();
+
+        /**
+         * @brief Updates the frame timing and records the transport latency of a frame.
+         * Called on the callback thread in arrival order
+         */
+        void        FrameArrived( const SourceFrame &Frame );
+
+        /**
+         * @brief Transport latency of a frame against the current baseline, safe from any thread
+         */
+        VmbUint64_t GetTransportLatency( const SourceFrame &Frame ) const;
+
+        /**
+         * @brief Counts one duration, lock-free and safe from any thread
+         */
+        void        Record( LatencyStage eStage, VmbUint64_t nNanoseconds );
+
+        /**
+         * @brief Joins the report thread and prints the final report
+         */
+        void        Stop();
+
+        /**
+         * @brief Prints count, p50, p99, p99.9 and max of every stage, then sensor rate, jitter,
+         * stalls and clock drift
+         */
+        void        Print() const;
+
+    private:
+        LatencyMonitor( const LatencyMonitor& );
+        LatencyMonitor& operator=( const LatencyMonitor& );
+
+        void        ReporterLoop();
+
+        const std::string           m_strCameraID;
+        const double                m_dReportInterval;
+        LatencyHistogram            m_Histograms[ LatencyStage_Count ];
+        FrameTimingAnalyzer         m_Timing;
+        std::atomic<bool>           m_bStopping;
+        std::mutex                  m_WakeMutex;
+        std::condition_variable     m_WakeCondition;
+        std::thread                 m_Reporter;
+};
+
+}} // namespace AVT::VmbAPI
+
+#endif
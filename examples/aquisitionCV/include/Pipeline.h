@@ -0,0 +1,207 @@
+#ifndef AVT_VMBAPI_EXAMPLES_PIPELINE
+#define AVT_VMBAPI_EXAMPLES_PIPELINE
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+#include <opencv2/opencv.hpp>
+
+#include "VimbaCPP/Include/VimbaCPP.h"
+#include "ProgramConfig.h"
+#include "BoundedQueue.h"
+#include "FrameSource.h"
+#include "ConversionContext.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+/**
+ * @brief What travels between the stages: the frame and the image derived from it so far.
+ * The frame goes back to its source when the last packet referring to it is gone, so the
+ * image may point into the frame buffer, or into a pooled buffer the packet leases for as long.
+ * Packets are shared between the stages a stage feeds, a stage replaces the image instead of
+ * modifying it
+ */
+struct PipelinePacket
+{
+    std::shared_ptr<const SourceFrame>  pFrame;
+    cv::Mat                             Image;          // Empty until a convert stage ran
+    std::shared_ptr<ImageBufferLease>   pImageBuffer;   // Holds a converted image, NULL if it is the frame buffer
+};
+
+/**
+ * @brief A step of the pipeline, run by the threads of its node
+ */
+class PipelineStage
+{
+    public:
+        virtual ~PipelineStage() {}
+
+        virtual std::string GetName() const = 0;
+
+        /**
+         * @brief Called once before the threads start, e.g. to set up per thread state
+         *
+         * @param nThreads The threads that will call Process, numbered from 0
+         */
+        virtual void        Prepare( unsigned int nThreads ) { (void)nThreads; }
+
+        /**
+         * @brief Works on a packet, concurrently on every thread of the stage
+         *
+         * @param nThread The calling thread, below the count given to Prepare
+         *
+         * @return false to not pass the packet on
+         */
+        virtual bool        Process( PipelinePacket &Packet, unsigned int nThread ) = 0;
+
+        /**
+         * @brief One line describing the results of the stage, empty for none
+         */
+        virtual std::string GetSummary() const { return std::string(); }
+};
+
+/**
+ * @brief Counters of a stage
+ */
+struct PipelineStageStatistics
+{
+    std::string     Name;
+    unsigned int    Threads;
+    VmbUint64_t     Processed;      // Packets the stage worked on
+    VmbUint64_t     Dropped;        // Packets lost to a full queue, by the overflow policy
+    size_t          QueueDepth;
+    size_t          MaxQueueDepth;
+    size_t          QueueCapacity;
+    double          BusySeconds;    // Summed over the threads of the stage
+    std::string     Summary;
+
+    PipelineStageStatistics()
+        : Threads( 0 )
+        , Processed( 0 )
+        , Dropped( 0 )
+        , QueueDepth( 0 )
+        , MaxQueueDepth( 0 )
+        , QueueCapacity( 0 )
+        , BusySeconds( 0.0 )
+    {}
+};
+
+struct PipelineStatistics
+{
+    VmbUint64_t     Pushed;         // Frames handed to the pipeline
+    VmbUint64_t     Completed;      // Frames every stage is done with, handed back to the source
+    VmbUint64_t     CompletedBytes;
+    std::vector<PipelineStageStatistics> Stages;
+
+    PipelineStatistics()
+        : Pushed( 0 )
+        , Completed( 0 )
+        , CompletedBytes( 0 )
+    {}
+};
+
+/**
+ * @brief A graph of stages the frames of one source flow through. Every stage has a bounded
+ * queue and threads of its own and feeds the stages connected to it; what a full queue does
+ * is chosen per stage: block the producer, so the backpressure reaches the source, or drop the
+ * oldest or the newest packet. Stages only take input from stages added before them
+ */
+class Pipeline
+{
+    public:
+        static const size_t SOURCE = 0;
+
+        explicit Pipeline( IFrameSource &Source );
+        ~Pipeline();
+
+        /**
+         * @brief Appends a stage, before Start
+         *
+         * @param nQueueCapacity Packets waiting for the stage at most
+         *
+         * @return The number of the stage, the first one is 1
+         */
+        size_t      AddStage( std::unique_ptr<PipelineStage> pStage, unsigned int nThreads, size_t nQueueCapacity, OverflowPolicy eOverflow );
+
+        /**
+         * @brief Passes the packets of a stage on to a later one, before Start
+         *
+         * @param nFrom SOURCE or a stage number below nTo
+         */
+        void        Connect( size_t nFrom, size_t nTo );
+
+        /**
+         * @brief Starts the threads of every stage
+         *
+         * @param Cpus CPUs the threads are pinned to, empty for no restriction
+         */
+        void        Start( const std::vector<unsigned int> &Cpus );
+
+        /**
+         * @brief Feeds a frame to the stages connected to the source, may block with the block policy.
+         * The frame goes back to the source once every stage is done with it
+         */
+        void        Push( const SourceFrame &Frame );
+
+        /**
+         * @brief Stops the stages in order, each finishes its queue first, and joins their threads.
+         * Frames pushed concurrently or afterwards are requeued right away
+         */
+        void        Stop();
+
+        /**
+         * @brief Snapshot of the counters, safe to call while streaming
+         */
+        PipelineStatistics GetStatistics() const;
+
+    private:
+        Pipeline( const Pipeline& );
+        Pipeline& operator=( const Pipeline& );
+
+        struct Node
+        {
+            std::unique_ptr<PipelineStage>  pStage;
+            const unsigned int              nThreads;
+            const OverflowPolicy            eOverflow;
+            std::vector<size_t>             Outputs;
+            BoundedQueue<PipelinePacket>    Queue;
+            std::vector<std::thread>        Workers;
+            std::mutex                      WakeMutex;
+            std::condition_variable         WakeCondition;      // A packet arrived
+            std::condition_variable         SpaceCondition;     // A packet left, for blocked producers
+            std::atomic<unsigned int>       nSleepingWorkers;
+            std::atomic<unsigned int>       nBlockedProducers;
+            std::atomic<bool>               bStopping;
+            std::atomic<VmbUint64_t>        nProcessed;
+            std::atomic<VmbUint64_t>        nDropped;
+            std::atomic<size_t>             nMaxQueueDepth;
+            std::atomic<VmbUint64_t>        nBusyNanoseconds;
+
+            Node( std::unique_ptr<PipelineStage> pStage, unsigned int nThreads, size_t nQueueCapacity, OverflowPolicy eOverflow );
+        };
+
+        void        Forward( const std::vector<size_t> &Outputs, const PipelinePacket &Packet );
+        bool        Enqueue( Node &Target, const PipelinePacket &Packet );
+        void        Execute( Node &Target, PipelinePacket &Packet, unsigned int nThread );
+        void        WorkerLoop( Node *pNode, unsigned int nThread );
+        void        Complete( const SourceFrame *pFrame );
+
+        IFrameSource &              m_Source;
+        std::vector<size_t>         m_SourceOutputs;
+        std::vector< std::unique_ptr<Node> > m_Nodes;        // Stage i is m_Nodes[i - 1]
+        std::atomic<bool>           m_bStopping;
+        std::atomic<unsigned int>   m_nPushing;                 // Push calls past the stopping check
+        std::atomic<VmbUint64_t>    m_nPushed;
+        std::atomic<VmbUint64_t>    m_nCompleted;
+        std::atomic<VmbUint64_t>    m_nCompletedBytes;
+};
+
+}} // namespace AVT::VmbAPI
+
+#endif
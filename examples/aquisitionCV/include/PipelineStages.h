@@ -0,0 +1,139 @@
+#ifndef AVT_VMBAPI_EXAMPLES_PIPELINESTAGES
+#define AVT_VMBAPI_EXAMPLES_PIPELINESTAGES
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+
+#include <opencv2/opencv.hpp>
+
+#include "ProgramConfig.h"
+#include "Pipeline.h"
+#include "FrameProcessing.h"
+#include "FrameRecorder.h"
+#include "PreviewDisplay.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+/**
+ * @brief Turns the raw frame into an image with FrameProcessing, one per thread.
+ * An image wrapping the frame buffer is passed on as is, a converted one stays in its pooled
+ * buffer and the packet takes over the lease, so the buffer returns when the last stage is done
+ */
+class ConvertStage : public PipelineStage
+{
+    public:
+        /**
+         * @param nImageBuffers Converted images of one thread alive at the same time at most, the
+         *                      packets the stages behind it can hold
+         */
+        ConvertStage( const ProgramConfig &Config, size_t nImageBuffers );
+
+        virtual std::string GetName() const;
+        virtual void        Prepare( unsigned int nThreads );
+        virtual bool        Process( PipelinePacket &Packet, unsigned int nThread );
+
+    private:
+        const bool                  m_bRGB;
+        const ColorProcessing       m_eColorProcessing;
+        const DemosaicProcessing    m_eDemosaic;
+        const size_t                m_nImageBuffers;
+        std::vector< std::unique_ptr<FrameProcessing> > m_Processors;
+};
+
+/**
+ * @brief Narrows the image to a region without copying it, clipped to the image
+ */
+class CropStage : public PipelineStage
+{
+    public:
+        CropStage( unsigned int nX, unsigned int nY, unsigned int nWidth, unsigned int nHeight );
+
+        virtual std::string GetName() const;
+        virtual bool        Process( PipelinePacket &Packet, unsigned int nThread );
+
+    private:
+        const cv::Rect      m_Region;
+};
+
+/**
+ * @brief Scales the image to a fixed size, by pixel area averaging
+ */
+class ResizeStage : public PipelineStage
+{
+    public:
+        ResizeStage( unsigned int nWidth, unsigned int nHeight );
+
+        virtual std::string GetName() const;
+        virtual bool        Process( PipelinePacket &Packet, unsigned int nThread );
+
+    private:
+        const cv::Size      m_Size;
+};
+
+/**
+ * @brief Measures the mean intensity of every image and its range over all images,
+ * a stand-in for the analysis an application runs
+ */
+class AnalyzeStage : public PipelineStage
+{
+    public:
+        AnalyzeStage();
+
+        virtual std::string GetName() const;
+        virtual bool        Process( PipelinePacket &Packet, unsigned int nThread );
+        virtual std::string GetSummary() const;
+
+    private:
+        mutable std::mutex  m_Mutex;                // Guards the results, taken once per image
+        VmbUint64_t         m_nImages;
+        double              m_dLastMean;
+        double              m_dMinMean;
+        double              m_dMaxMean;
+};
+
+/**
+ * @brief Hands the raw frame to the recorder, which copies it; needs exactly one thread
+ */
+class RecordStage : public PipelineStage
+{
+    public:
+        explicit RecordStage( FrameRecorder &Recorder );
+
+        virtual std::string GetName() const;
+        virtual bool        Process( PipelinePacket &Packet, unsigned int nThread );
+
+    private:
+        FrameRecorder &     m_Recorder;
+};
+
+/**
+ * @brief Offers the image to the preview, which only takes it when it is ready for the next picture
+ */
+class DisplayStage : public PipelineStage
+{
+    public:
+        DisplayStage( PreviewDisplay &Display, size_t nInput );
+
+        virtual std::string GetName() const;
+        virtual bool        Process( PipelinePacket &Packet, unsigned int nThread );
+
+    private:
+        PreviewDisplay &    m_Display;
+        const size_t        m_nInput;
+};
+
+/**
+ * @brief Adds the stages and connections of /g to an empty pipeline
+ *
+ * @param pRecorder The recorder of the camera, needed by record stages
+ * @param pDisplay The preview, needed by display stages
+ * @param nInput The preview input of the camera
+ */
+void BuildPipeline( Pipeline &Target, const ProgramConfig &Config, FrameRecorder *pRecorder, PreviewDisplay *pDisplay, size_t nInput );
+
+}} // namespace AVT::VmbAPI
+
+#endif
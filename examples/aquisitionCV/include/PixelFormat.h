@@ -0,0 +1,166 @@
+#ifndef AVT_VMBAPI_EXAMPLES_PIXELFORMAT
+#define AVT_VMBAPI_EXAMPLES_PIXELFORMAT
+
+#include <cstring>
+
+#include "VimbaCPP/Include/VimbaCPP.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+struct PixelFormatName
+{
+    VmbPixelFormatType  Format;
+    const char *        Name;       // GenICam name as used by the PixelFormat feature
+};
+
+static const PixelFormatName g_PixelFormatNames[] =
+{
+    { VmbPixelFormatMono8,              "Mono8" },
+    { VmbPixelFormatMono10,             "Mono10" },
+    { VmbPixelFormatMono10p,            "Mono10p" },
+    { VmbPixelFormatMono12,             "Mono12" },
+    { VmbPixelFormatMono12Packed,       "Mono12Packed" },
+    { VmbPixelFormatMono12p,            "Mono12p" },
+    { VmbPixelFormatMono14,             "Mono14" },
+    { VmbPixelFormatMono16,             "Mono16" },
+    { VmbPixelFormatBayerGR8,           "BayerGR8" },
+    { VmbPixelFormatBayerRG8,           "BayerRG8" },
+    { VmbPixelFormatBayerGB8,           "BayerGB8" },
+    { VmbPixelFormatBayerBG8,           "BayerBG8" },
+    { VmbPixelFormatBayerGR10,          "BayerGR10" },
+    { VmbPixelFormatBayerRG10,          "BayerRG10" },
+    { VmbPixelFormatBayerGB10,          "BayerGB10" },
+    { VmbPixelFormatBayerBG10,          "BayerBG10" },
+    { VmbPixelFormatBayerGR12,          "BayerGR12" },
+    { VmbPixelFormatBayerRG12,          "BayerRG12" },
+    { VmbPixelFormatBayerGB12,          "BayerGB12" },
+    { VmbPixelFormatBayerBG12,          "BayerBG12" },
+    { VmbPixelFormatBayerGR12Packed,    "BayerGR12Packed" },
+    { VmbPixelFormatBayerRG12Packed,    "BayerRG12Packed" },
+    { VmbPixelFormatBayerGB12Packed,    "BayerGB12Packed" },
+    { VmbPixelFormatBayerBG12Packed,    "BayerBG12Packed" },
+    { VmbPixelFormatBayerGR16,          "BayerGR16" },
+    { VmbPixelFormatBayerRG16,          "BayerRG16" },
+    { VmbPixelFormatBayerGB16,          "BayerGB16" },
+    { VmbPixelFormatBayerBG16,          "BayerBG16" },
+    { VmbPixelFormatRgb8,               "RGB8" },
+    { VmbPixelFormatBgr8,               "BGR8" },
+    { VmbPixelFormatRgba8,              "RGBa8" },
+    { VmbPixelFormatBgra8,              "BGRa8" },
+};
+
+/**
+ * @brief Looks up a pixel format by its GenICam name
+ *
+ * @param pName The name, e.g. "BayerRG8"
+ * @param eFormat Receives the format on success
+ * @return true if the name is known
+ */
+inline bool PixelFormatFromName( const char *pName, VmbPixelFormatType &eFormat )
+{
+    if( NULL == pName )
+    {
+        return false;
+    }
+    for( size_t i = 0; i < sizeof( g_PixelFormatNames ) / sizeof( g_PixelFormatNames[0] ); ++i )
+    {
+        if( 0 == std::strcmp( pName, g_PixelFormatNames[i].Name ))
+        {
+            eFormat = g_PixelFormatNames[i].Format;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief GenICam name of a pixel format
+ *
+ * @return The name or NULL for formats not in the table
+ */
+inline const char* PixelFormatToName( VmbPixelFormatType eFormat )
+{
+    for( size_t i = 0; i < sizeof( g_PixelFormatNames ) / sizeof( g_PixelFormatNames[0] ); ++i )
+    {
+        if( eFormat == g_PixelFormatNames[i].Format )
+        {
+            return g_PixelFormatNames[i].Name;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief True for the colour filter array formats, whatever their bit depth or packing
+ */
+inline bool PixelFormatIsBayer( VmbPixelFormatType eFormat )
+{
+    switch( eFormat )
+    {
+    case VmbPixelFormatBayerGR8:
+    case VmbPixelFormatBayerRG8:
+    case VmbPixelFormatBayerGB8:
+    case VmbPixelFormatBayerBG8:
+    case VmbPixelFormatBayerGR10:
+    case VmbPixelFormatBayerRG10:
+    case VmbPixelFormatBayerGB10:
+    case VmbPixelFormatBayerBG10:
+    case VmbPixelFormatBayerGR12:
+    case VmbPixelFormatBayerRG12:
+    case VmbPixelFormatBayerGB12:
+    case VmbPixelFormatBayerBG12:
+    case VmbPixelFormatBayerGR12Packed:
+    case VmbPixelFormatBayerRG12Packed:
+    case VmbPixelFormatBayerGB12Packed:
+    case VmbPixelFormatBayerBG12Packed:
+    case VmbPixelFormatBayerGR16:
+    case VmbPixelFormatBayerRG16:
+    case VmbPixelFormatBayerGB16:
+    case VmbPixelFormatBayerBG16:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/**
+ * @brief True for the single channel grey formats, whatever their bit depth or packing
+ */
+inline bool PixelFormatIsMono( VmbPixelFormatType eFormat )
+{
+    switch( eFormat )
+    {
+    case VmbPixelFormatMono8:
+    case VmbPixelFormatMono10:
+    case VmbPixelFormatMono10p:
+    case VmbPixelFormatMono12:
+    case VmbPixelFormatMono12Packed:
+    case VmbPixelFormatMono12p:
+    case VmbPixelFormatMono14:
+    case VmbPixelFormatMono16:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/**
+ * @brief Bits a pixel occupies in the frame buffer, the middle byte of the GenICam pixel format id
+ */
+inline VmbUint32_t PixelFormatBitsPerPixel( VmbPixelFormatType eFormat )
+{
+    return ( eFormat >> 16 ) & 0xFF;
+}
+
+/**
+ * @brief Number of buffer bytes a frame of the given geometry occupies
+ */
+inline VmbUint32_t PixelFormatImageSize( VmbPixelFormatType eFormat, VmbUint32_t nWidth, VmbUint32_t nHeight )
+{
+    return static_cast<VmbUint32_t>(( static_cast<VmbUint64_t>( PixelFormatBitsPerPixel( eFormat )) * nWidth * nHeight + 7 ) / 8 );
+}
+
+}} // namespace AVT::VmbAPI
+
+#endif
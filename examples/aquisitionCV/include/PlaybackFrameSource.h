@@ -0,0 +1,106 @@
+#ifndef AVT_VMBAPI_EXAMPLES_PLAYBACKFRAMESOURCE
+#define AVT_VMBAPI_EXAMPLES_PLAYBACKFRAMESOURCE
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <chrono>
+
+#include "FrameSource.h"
+#include "ProgramConfig.h"
+#include "RecordingFormat.h"
+#include "ThreadPool.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+/**
+ * @brief Plays a recording made with FrameRecorder back into the pipeline as if a camera delivered it.
+ * The file is memory mapped and every frame handed out points straight into the mapping, so
+ * playback copies nothing and the page cache keeps a recording that fits into memory for the next
+ * run. The trailing index makes seeking O(1); a recording cut short is indexed by walking its
+ * records once at Open. Frames are delivered at the pace of their device timestamps, at a fixed
+ * rate or, waiting for a buffer to be requeued, as fast as the pipeline takes them.
+ * Compressed frames are the exception, their stripes are decoded in parallel into a buffer per slot
+ */
+class PlaybackFrameSource : public IFrameSource
+{
+    public:
+        /**
+         * @brief Construct a new Playback Frame Source object
+         *
+         * @param strFileName The recording
+         * @param Playback Timing, first frame and looping
+         * @param nBufferCount Frames in flight at most, like the buffers of a camera
+         * @param nDecodeThreads Threads decoding the stripes of a compressed frame, 0 for one per core
+         */
+        PlaybackFrameSource( const std::string &strFileName, const PlaybackConfig &Playback, VmbUint32_t nBufferCount, unsigned int nDecodeThreads = 0 );
+        ~PlaybackFrameSource();
+
+        virtual VmbErrorType    Open();
+        virtual VmbErrorType    StartAcquisition( FrameObserver *pObserver );
+        virtual VmbErrorType    StopAcquisition();
+        virtual VmbErrorType    Close();
+        virtual VmbErrorType    QueueFrame( const SourceFrame &Frame );
+
+        /**
+         * @brief The ID of the camera the recording was made with
+         */
+        virtual std::string     GetID() const;
+        virtual VmbUint64_t     GetTimestampFrequency() const;
+
+        /**
+         * @brief Frames in the recording, valid after Open
+         */
+        VmbUint64_t             GetFrameCount() const;
+
+        /**
+         * @brief Continues the playback at the given frame, safe to call while playing
+         */
+        VmbErrorType            Seek( VmbUint64_t nFrame );
+
+    private:
+        PlaybackFrameSource( const PlaybackFrameSource& );
+        PlaybackFrameSource& operator=( const PlaybackFrameSource& );
+
+        typedef std::chrono::steady_clock Clock;
+
+        const RecordingFrameHeader* GetFrame( VmbUint64_t nOffset, VmbUint64_t nEnd ) const;
+        bool                    LoadIndex();
+        bool                    Decode( const RecordingFrameHeader &Frame, std::vector<VmbUchar_t> &Image );
+        bool                    WaitUntil( const Clock::time_point &tWakeUp ) const;
+        void                    PlaybackLoop();
+        void                    PrintSummary( VmbUint64_t nDelivered, double dSeconds, bool bFinished ) const;
+
+        const std::string       m_strFileName;
+        const PlaybackConfig    m_Playback;
+        const VmbUint32_t       m_nBufferCount;
+        const unsigned int      m_nDecodeThreads;
+        int                     m_hFile;
+        VmbUchar_t *            m_pMapping;
+        size_t                  m_nMappingSize;
+        const RecordingFileHeader * m_pHeader;
+        const RecordingIndexEntry * m_pIndex;           // Into the mapping or m_RebuiltIndex
+        VmbUint64_t             m_nFrames;
+        std::vector<RecordingIndexEntry> m_RebuiltIndex;    // Only for a recording without trailer
+        VmbUint64_t             m_nFrameIDSpan;         // Frame IDs and timestamps advance by this per loop
+        VmbUint64_t             m_nTimestampSpan;
+        std::unique_ptr< std::atomic<bool>[] > m_pQueued;  // One per buffer, frames are only delivered on a queued one
+        FrameObserver *         m_pObserver;
+        std::thread             m_Player;
+        std::atomic<bool>       m_bRunning;
+        std::atomic<VmbUint64_t> m_nSeek;               // Pending Seek target, NO_SEEK if none
+
+        // Only touched by the playback thread
+        std::unique_ptr<ThreadPool> m_pDecodePool;      // Created with the first compressed frame
+        std::vector< std::vector<VmbUchar_t> > m_Decoded;  // One image per buffer
+        std::vector<size_t>     m_StripeOffsets;
+        VmbUint64_t             m_nDecodedBytes;
+        std::atomic<VmbUint64_t> m_nDecodeNanoseconds;  // Summed over the decoding threads
+};
+
+}} // namespace AVT::VmbAPI
+
+#endif
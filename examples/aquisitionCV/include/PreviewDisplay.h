@@ -0,0 +1,115 @@
+#ifndef AVT_VMBAPI_EXAMPLES_PREVIEWDISPLAY
+#define AVT_VMBAPI_EXAMPLES_PREVIEWDISPLAY
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <opencv2/opencv.hpp>
+
+#include "VimbaCPP/Include/VimbaCPP.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+/**
+ * @brief Counters of the preview of one camera
+ */
+struct PreviewStatistics
+{
+    VmbUint64_t     Offered;        // Processed frames offered to the preview
+    VmbUint64_t     Shown;          // Frames drawn, the others were skipped
+
+    PreviewStatistics()
+        : Offered( 0 )
+        , Shown( 0 )
+    {}
+};
+
+/**
+ * @brief Shows a downscaled preview of every camera on a thread of its own, so GUI rendering never
+ * holds up acquisition, processing or recording. Each camera has a single slot mailbox: when the
+ * display thread is ready for the next picture it marks the mailbox as wanted, and the first
+ * processed frame arriving afterwards is downscaled into it. All other frames pass with one atomic
+ * increment, so the producers never wait and only pay for the downscaling at the display rate,
+ * while the picture shown is the newest one at the time the display asked for it
+ */
+class PreviewDisplay
+{
+    public:
+        /**
+         * @param Names Window title per camera
+         * @param nMaxWidth Width the preview is scaled down to at most, keeping the aspect ratio
+         * @param nMaxHeight Height the preview is scaled down to at most
+         */
+        PreviewDisplay( const std::vector<std::string> &Names, VmbUint32_t nMaxWidth, VmbUint32_t nMaxHeight );
+        ~PreviewDisplay();
+
+        /**
+         * @brief Opens the windows and starts the display thread
+         */
+        void        Start();
+
+        /**
+         * @brief Joins the display thread and closes the windows
+         */
+        void        Stop();
+
+        /**
+         * @brief Offers a processed frame, never blocks.
+         * Safe to call from several threads, the image only needs to be valid during the call
+         *
+         * @param nInput The camera
+         * @param Image The processed frame, 8 or 16 bit mono or BGR
+         * @param nFrameID Shown in the preview
+         */
+        void        Offer( size_t nInput, const cv::Mat &Image, VmbUint64_t nFrameID );
+
+        /**
+         * @brief Snapshot of the counters of a camera, safe to call while streaming
+         */
+        PreviewStatistics GetStatistics( size_t nInput ) const;
+
+    private:
+        PreviewDisplay( const PreviewDisplay& );
+        PreviewDisplay& operator=( const PreviewDisplay& );
+
+        enum MailboxState
+        {
+            Mailbox_Idle,       // The display thread draws or waits to ask again
+            Mailbox_Wanted,     // The next frame offered is taken
+            Mailbox_Filling,    // A producer downscales into Preview
+            Mailbox_Full,       // Preview waits for the display thread
+        };
+
+        struct Mailbox
+        {
+            std::string                 Window;
+            std::atomic<int>            State;          // MailboxState
+            cv::Mat                     Preview;        // Owned by the producer while filling, by the display thread otherwise
+            cv::Mat                     Display;        // 8 bit copy of a 16 bit preview
+            VmbUint64_t                 FrameID;
+            std::atomic<VmbUint64_t>    nOffered;
+            std::atomic<VmbUint64_t>    nShown;
+        };
+
+        cv::Size    GetPreviewSize( const cv::Size &ImageSize ) const;
+        bool        AnyFull() const;
+        void        Draw( Mailbox &Box );
+        void        DisplayLoop();
+
+        const VmbUint32_t                       m_nMaxWidth;
+        const VmbUint32_t                       m_nMaxHeight;
+        std::vector< std::unique_ptr<Mailbox> > m_Mailboxes;
+        std::mutex                              m_Mutex;
+        std::condition_variable                 m_Condition;    // Signalled when a mailbox was filled
+        std::atomic<bool>                       m_bStopping;
+        std::thread                             m_Display;
+};
+
+}} // namespace AVT::VmbAPI
+
+#endif
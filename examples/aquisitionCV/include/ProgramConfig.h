@@ -2,8 +2,15 @@
 #define PROGRAM_CONFIG_H_
 
 #include <cstring>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstdio>
+#include <string>
+#include <vector>
 
 #include "BaseException.h"
+#include "PixelFormat.h"
 
 namespace AVT {
 namespace VmbAPI {
@@ -32,27 +39,244 @@ enum ColorProcessing
     ColorProcessing_Matrix,
 };
 
+enum DemosaicProcessing
+{
+    DemosaicProcessing_Bilinear,    // In-tree SIMD kernels
+    DemosaicProcessing_EdgeAware,   // In-tree SIMD kernels
+    DemosaicProcessing_Vimba,       // VmbImageTransform
+};
+
+enum BundleMatching
+{
+    BundleMatching_Off,
+    BundleMatching_Timestamp,       // Device timestamps, the camera clocks must be synchronised, e.g. by PTP
+    BundleMatching_FrameID,         // Frame IDs, for triggered cameras started together
+};
+
+enum PlaybackTiming
+{
+    PlaybackTiming_Original,        // Recorded frames at the pace of their device timestamps
+    PlaybackTiming_FixedRate,       // Recorded frames at PlaybackConfig::FrameRate
+    PlaybackTiming_Fast,            // Recorded frames as fast as they are processed
+};
+
+struct PlaybackConfig
+{
+    PlaybackTiming      Timing;
+    double              FrameRate;          // Frames per second of PlaybackTiming_FixedRate
+    VmbUint64_t         FirstFrame;         // Position in the recording to start at
+    bool                bLoop;              // Start over at the end instead of finishing
+
+    PlaybackConfig()
+        : Timing( PlaybackTiming_Original )
+        , FrameRate( 0.0 )
+        , FirstFrame( 0 )
+        , bLoop( false )
+    {}
+};
+
+enum PipelineStageType
+{
+    PipelineStage_Convert,          // FrameProcessing, the image every later stage works on
+    PipelineStage_Crop,             // A region of the image, without copying it
+    PipelineStage_Resize,           // The image scaled to a fixed size
+    PipelineStage_Analyze,          // Mean and range of the intensities
+    PipelineStage_Record,           // The raw frame to the recording of /o
+    PipelineStage_Display,          // The image to the preview of /v
+};
+
+enum OverflowPolicy
+{
+    Overflow_Block,                 // The producer waits for room, backpressure reaches the camera
+    Overflow_DropOldest,            // The oldest queued frame makes room
+    Overflow_DropNewest,            // The frame that does not fit is dropped
+};
+
+struct PipelineStageConfig
+{
+    PipelineStageType   Type;
+    unsigned int        X;                  // Crop: top left corner
+    unsigned int        Y;
+    unsigned int        Width;              // Crop and resize: size of the result
+    unsigned int        Height;
+    unsigned int        Threads;
+    unsigned int        QueueCapacity;      // 0 for the capacity of /q
+    OverflowPolicy      Overflow;
+    std::vector<unsigned int> Inputs;       // 0 for the camera, i for the i-th stage
+
+    PipelineStageConfig()
+        : Type( PipelineStage_Convert )
+        , X( 0 )
+        , Y( 0 )
+        , Width( 0 )
+        , Height( 0 )
+        , Threads( 1 )
+        , QueueCapacity( 0 )
+        , Overflow( Overflow_DropNewest )
+    {}
+};
+
+enum GeometryReduction
+{
+    GeometryReduction_Auto,         // Binning, or decimation where binning would lose the colour
+    GeometryReduction_Roi,          // Full resolution, only the region is read out
+    GeometryReduction_Binning,      // Neighbouring pixels summed on the sensor
+    GeometryReduction_Decimation,   // Pixels skipped on the sensor
+};
+
+/**
+ * The image the processing needs, the camera is set up to deliver no more than that
+ */
+struct GeometryRequest
+{
+    VmbUint32_t         Width;              // Output pixels needed at least, 0 to read out the full sensor as is
+    VmbUint32_t         Height;
+    VmbUint32_t         RegionX;            // Field of view in sensor pixels, width 0 for the full sensor
+    VmbUint32_t         RegionY;
+    VmbUint32_t         RegionWidth;
+    VmbUint32_t         RegionHeight;
+    GeometryReduction   Reduction;
+    bool                bPixelFormat;       // Use PixelFormat instead of the smallest suitable one
+    VmbPixelFormatType  PixelFormat;
+
+    GeometryRequest()
+        : Width( 0 )
+        , Height( 0 )
+        , RegionX( 0 )
+        , RegionY( 0 )
+        , RegionWidth( 0 )
+        , RegionHeight( 0 )
+        , Reduction( GeometryReduction_Auto )
+        , bPixelFormat( false )
+        , PixelFormat( VmbPixelFormatMono8 )
+    {}
+};
+
+struct SyntheticCameraConfig
+{
+    VmbPixelFormatType  PixelFormat;
+    VmbUint32_t         Width;
+    VmbUint32_t         Height;
+    double              FrameRate;          // Frames per second, 0 delivers as fast as the frames are requeued
+    double              IncompletePercent;  // Share of frames delivered with VmbFrameStatusIncomplete
+    double              GapPercent;         // Share of frames followed by a frame ID gap
+    double              DropoutInterval;    // Seconds of streaming before the camera disappears, 0 never
+    double              DropoutDuration;    // Seconds until it comes back
+
+    SyntheticCameraConfig()
+        : PixelFormat( VmbPixelFormatMono8 )
+        , Width( 1920 )
+        , Height( 1080 )
+        , FrameRate( 0.0 )
+        , IncompletePercent( 0.0 )
+        , GapPercent( 0.0 )
+        , DropoutInterval( 0.0 )
+        , DropoutDuration( 0.0 )
+    {}
+};
+
+// Most worker threads /w: and codec threads /m: accept
+static const unsigned int MaxWorkerThreads = 256;
+// Largest frame queue /q: and a pipeline stage's #<n> accept, each slot holds a frame
+static const unsigned int MaxQueueCapacity = 65536;
+// Most cameras /n: accepts
+static const unsigned int MaxCameraCount   = 64;
+
+// NUMA placement of the frame buffers
+static const int FrameBufferNode_None   = -1;   // Wherever the kernel puts them
+static const int FrameBufferNode_Auto   = -2;   // The node of the network interface, else of the camera's CPUs
+
+/**
+ * Frame buffers the program allocates and announces instead of the API
+ */
+struct FrameBufferConfig
+{
+    bool                bOwnBuffers;        // Allocate the buffers, otherwise the API or transport layer does
+    VmbUint32_t         Count;              // Frames per camera if not adaptive, 0 for the default
+    bool                bAdaptive;          // Size the frames per camera from payload, frame rate and hold times
+    VmbUint64_t         Budget;             // Bytes of frame buffers per camera an adaptive depth stays within
+    bool                bHugePages;         // Back the buffers with 2 MB pages
+    bool                bLock;              // Lock the buffers into memory
+    int                 NumaNode;           // Node to place the buffers on, or FrameBufferNode_None or _Auto
+    std::vector<unsigned int> Cpus;         // Set per camera: the CPUs of its threads, for FrameBufferNode_Auto
+
+    FrameBufferConfig()
+        : bOwnBuffers( false )
+        , Count( 0 )
+        , bAdaptive( true )
+        , Budget( 256ULL * 1024 * 1024 )
+        , bHugePages( false )
+        , bLock( false )
+        , NumaNode( FrameBufferNode_None )
+    {}
+};
+
 struct ProgramConfig
 {
     FrameInfos          m_FrameInfos;
     bool                m_RGBValue;
     ColorProcessing     m_ColorProcessing;
-    std::string         m_CameraID;
+    DemosaicProcessing  m_DemosaicProcessing;
+    std::vector<std::string> m_CameraIDs;       // Streamed concurrently, the first one is the camera of single camera use
+    unsigned int        m_CameraCount;
+    std::vector< std::vector<unsigned int> > m_CpuAffinity;    // CPUs per camera, cycled if there are more cameras
     bool                m_PrintHelp;
     bool                m_UseAllocAndAnnounce;
+    unsigned int        m_WorkerThreads;
+    unsigned int        m_QueueCapacity;
+    bool                m_UseSyntheticCamera;
+    SyntheticCameraConfig m_SyntheticCamera;
+    GeometryRequest     m_Geometry;
+    bool                m_LatencyReport;
+    double              m_LatencyReportInterval;
+    BundleMatching      m_BundleMatching;
+    double              m_BundleTolerance;      // Microseconds or frame IDs, depending on the matching
+    std::string         m_RecordFile;           // Empty if not recording
+    bool                m_Compression;          // Record with the lossless codec
+    unsigned int        m_CodecThreads;         // Threads coding the stripes of a frame, 0 for one per core
+    bool                m_UsePlayback;          // The camera IDs are recordings to play back
+    bool                m_Preview;              // Show every camera in a window
+    unsigned int        m_PreviewWidth;         // The preview is scaled down to fit into this size
+    unsigned int        m_PreviewHeight;
+    std::vector<PipelineStageConfig> m_Pipeline;    // Empty for the fixed processing path
+    PlaybackConfig      m_Playback;
+    bool                m_BandwidthPlanning;    // Set packet size and bandwidth cap of GigE cameras
+    double              m_LinkSpeed;            // Megabits per second of every network interface
+    std::string         m_PresetFile;           // Empty without presets
+    std::string         m_PresetName;           // Applied at start, empty for the first preset of the file
+    FrameBufferConfig   m_FrameBuffers;
 public:
     ProgramConfig()
         : m_FrameInfos(  AVT::VmbAPI::FrameInfos_Off )
         , m_RGBValue( false )
         , m_ColorProcessing( ColorProcessing_Off )
+        , m_DemosaicProcessing( DemosaicProcessing_Bilinear )
+        , m_CameraCount( 0 )
         , m_PrintHelp( false )
         , m_UseAllocAndAnnounce( false )
+        , m_WorkerThreads( 0 )
+        , m_QueueCapacity( 16 )
+        , m_UseSyntheticCamera( false )
+        , m_LatencyReport( false )
+        , m_LatencyReportInterval( 0.0 )
+        , m_BundleMatching( BundleMatching_Off )
+        , m_BundleTolerance( 0.0 )
+        , m_Compression( false )
+        , m_CodecThreads( 0 )
+        , m_UsePlayback( false )
+        , m_Preview( false )
+        , m_PreviewWidth( 1280 )
+        , m_PreviewHeight( 720 )
+        , m_BandwidthPlanning( false )
+        , m_LinkSpeed( 1000.0 )
     {
     }
     VmbErrorType ParseCommandline( int argc, char* argv[] )
     {
         VmbErrorType    Result          = VmbErrorSuccess;
         char *          pParameter      = NULL;                         // The command line parameter
+        size_t          nRecordings     = 0;                            // Camera IDs given by /y
+        bool            bPlaybackTiming = false;
         for( int i = 1; i < argc; ++i )
         {
             pParameter = argv[i];
@@ -114,15 +338,291 @@ public:
                     setColorProcessing( ColorProcessing_Matrix );
                     setRGBValue( true );
                 }
-                else if( 0 == std::strcmp( pParameter, "/x" ))
+                else if( 0 == std::strncmp( pParameter, "/d:", 3 ))
                 {
                     if( getPrintHelp() )
                     {
                         return  VmbErrorBadParameter;
                     }
 
+                    const char *pMethod = pParameter + 3;
+                    if( 0 == std::strcmp( pMethod, "bilinear" ))
+                    {
+                        setDemosaicProcessing( DemosaicProcessing_Bilinear );
+                    }
+                    else if( 0 == std::strcmp( pMethod, "edge" ))
+                    {
+                        setDemosaicProcessing( DemosaicProcessing_EdgeAware );
+                    }
+                    else if( 0 == std::strcmp( pMethod, "vimba" ))
+                    {
+                        setDemosaicProcessing( DemosaicProcessing_Vimba );
+                    }
+                    else
+                    {
+                        return  VmbErrorBadParameter;
+                    }
+                }
+                else if( 0 == std::strcmp( pParameter, "/x" ))
+                {
+                    if(     ( m_FrameBuffers.bOwnBuffers )
+                        ||  ( getPrintHelp() ))
+                    {
+                        return  VmbErrorBadParameter;
+                    }
+
                     setAllocAndAnnounce( true );
                 }
+                else if( 0 == std::strncmp( pParameter, "/x:", 3 ))
+                {
+                    if(     ( m_FrameBuffers.bOwnBuffers || getAllocAndAnnounce() )
+                        ||  ( !ParseFrameBuffers( pParameter + 3, m_FrameBuffers ))
+                        ||  ( getPrintHelp() ))
+                    {
+                        return  VmbErrorBadParameter;
+                    }
+                }
+                else if( 0 == std::strncmp( pParameter, "/w:", 3 ))
+                {
+                    unsigned long nThreads = 0;
+                    if(     ( !ParseCount( pParameter + 3, MaxWorkerThreads, nThreads ))
+                        ||  ( getPrintHelp() ))
+                    {
+                        return  VmbErrorBadParameter;
+                    }
+
+                    setWorkerThreads( static_cast<unsigned int>( nThreads ));
+                }
+                else if( 0 == std::strncmp( pParameter, "/q:", 3 ))
+                {
+                    unsigned long nCapacity = 0;
+                    if(     ( !ParseCount( pParameter + 3, MaxQueueCapacity, nCapacity ))
+                        ||  ( 0 == nCapacity )
+                        ||  ( getPrintHelp() ))
+                    {
+                        return  VmbErrorBadParameter;
+                    }
+
+                    setQueueCapacity( static_cast<unsigned int>( nCapacity ));
+                }
+                else if(    ( 0 == std::strcmp( pParameter, "/s" ))
+                        ||  ( 0 == std::strncmp( pParameter, "/s:", 3 )))
+                {
+                    if(     ( getUseSyntheticCamera() )
+                        ||  ( getPrintHelp() ))
+                    {
+                        return  VmbErrorBadParameter;
+                    }
+
+                    if( !ParseSyntheticCamera( '\0' == pParameter[2] ? "" : pParameter + 3, m_SyntheticCamera ))
+                    {
+                        return  VmbErrorBadParameter;
+                    }
+                    setUseSyntheticCamera( true );
+                }
+                else if( 0 == std::strncmp( pParameter, "/t:", 3 ))
+                {
+                    if(     ( 0 != m_Geometry.Width )
+                        ||  ( !ParseGeometryRequest( pParameter + 3, m_Geometry ))
+                        ||  ( getPrintHelp() ))
+                    {
+                        return  VmbErrorBadParameter;
+                    }
+                }
+                else if( 0 == std::strncmp( pParameter, "/y:", 3 ))
+                {
+                    if(     ( '\0' == pParameter[3] )
+                        ||  ( getPrintHelp() ))
+                    {
+                        return  VmbErrorBadParameter;
+                    }
+                    for( size_t j = 0; j < m_CameraIDs.size(); ++j )
+                    {
+                        if( m_CameraIDs[j] == pParameter + 3 )
+                        {
+                            return  VmbErrorBadParameter;
+                        }
+                    }
+
+                    m_CameraIDs.push_back( std::string( pParameter + 3 ));
+                    setUsePlayback( true );
+                    ++nRecordings;
+                }
+                else if( 0 == std::strncmp( pParameter, "/f:", 3 ))
+                {
+                    if(     ( bPlaybackTiming )
+                        ||  ( !ParsePlaybackTiming( pParameter + 3, m_Playback ))
+                        ||  ( getPrintHelp() ))
+                    {
+                        return  VmbErrorBadParameter;
+                    }
+                    bPlaybackTiming = true;
+                }
+                else if( 0 == std::strncmp( pParameter, "/k:", 3 ))
+                {
+                    char *pEnd = NULL;
+                    const unsigned long long nFirst = std::strtoull( pParameter + 3, &pEnd, 10 );
+                    if(     ( pEnd == pParameter + 3 || '\0' != *pEnd )
+                        ||  ( getPrintHelp() ))
+                    {
+                        return  VmbErrorBadParameter;
+                    }
+
+                    m_Playback.FirstFrame = nFirst;
+                }
+                else if( 0 == std::strcmp( pParameter, "/z" ))
+                {
+                    if( getPrintHelp() )
+                    {
+                        return  VmbErrorBadParameter;
+                    }
+
+                    m_Playback.bLoop = true;
+                }
+                else if( 0 == std::strncmp( pParameter, "/e:", 3 ))
+                {
+                    double dIncomplete  = 0.0;
+                    double dGap         = 0.0;
+                    double dInterval    = 0.0;
+                    double dDuration    = 0.0;
+                    const int nFields   = std::sscanf( pParameter + 3, "%lf,%lf,%lf:%lf", &dIncomplete, &dGap, &dInterval, &dDuration );
+                    if(     ( 2 != nFields && 4 != nFields )
+                        ||  ( dIncomplete < 0.0 || dIncomplete > 100.0 )
+                        ||  ( dGap < 0.0 || dGap > 100.0 )
+                        ||  ( 4 == nFields && ( dInterval <= 0.0 || dDuration < 0.0 ))
+                        ||  ( getPrintHelp() ))
+                    {
+                        return  VmbErrorBadParameter;
+                    }
+
+                    m_SyntheticCamera.IncompletePercent = dIncomplete;
+                    m_SyntheticCamera.GapPercent        = dGap;
+                    m_SyntheticCamera.DropoutInterval   = dInterval;
+                    m_SyntheticCamera.DropoutDuration   = dDuration;
+                }
+                else if(    ( 0 == std::strcmp( pParameter, "/l" ))
+                        ||  ( 0 == std::strncmp( pParameter, "/l:", 3 )))
+                {
+                    const double dInterval = '\0' == pParameter[2] ? 0.0 : std::atof( pParameter + 3 );
+                    if(     ( getLatencyReport() )
+                        ||  ( dInterval < 0.0 )
+                        ||  ( getPrintHelp() ))
+                    {
+                        return  VmbErrorBadParameter;
+                    }
+
+                    setLatencyReport( true );
+                    setLatencyReportInterval( dInterval );
+                }
+                else if( 0 == std::strncmp( pParameter, "/b:", 3 ))
+                {
+                    if(     ( BundleMatching_Off != getBundleMatching() )
+                        ||  ( !ParseBundleMatching( pParameter + 3, m_BundleMatching, m_BundleTolerance ))
+                        ||  ( getPrintHelp() ))
+                    {
+                        return  VmbErrorBadParameter;
+                    }
+                }
+                else if( 0 == std::strncmp( pParameter, "/o:", 3 ))
+                {
+                    if(     ( !getRecordFile().empty() )
+                        ||  ( 0 == std::strlen( pParameter + 3 ))
+                        ||  ( getPrintHelp() ))
+                    {
+                        return  VmbErrorBadParameter;
+                    }
+
+                    setRecordFile( std::string( pParameter + 3 ));
+                }
+                else if(    ( 0 == std::strcmp( pParameter, "/m" ))
+                        ||  ( 0 == std::strncmp( pParameter, "/m:", 3 )))
+                {
+                    unsigned long nThreads = 0;
+                    if(     ( getCompression() )
+                        ||  ( '\0' != pParameter[2] && !ParseCount( pParameter + 3, MaxWorkerThreads, nThreads ))
+                        ||  ( getPrintHelp() ))
+                    {
+                        return  VmbErrorBadParameter;
+                    }
+
+                    setCompression( true );
+                    setCodecThreads( static_cast<unsigned int>( nThreads ));
+                }
+                else if(    ( 0 == std::strcmp( pParameter, "/v" ))
+                        ||  ( 0 == std::strncmp( pParameter, "/v:", 3 )))
+                {
+                    unsigned int nWidth     = getPreviewWidth();
+                    unsigned int nHeight    = getPreviewHeight();
+                    char cEnd = '\0';
+                    if(     ( getPreview() )
+                        ||  ( '\0' != pParameter[2] && 2 != std::sscanf( pParameter + 3, "%ux%u%c", &nWidth, &nHeight, &cEnd ))
+                        ||  ( 0 == nWidth || 0 == nHeight )
+                        ||  ( getPrintHelp() ))
+                    {
+                        return  VmbErrorBadParameter;
+                    }
+
+                    setPreview( true );
+                    setPreviewSize( nWidth, nHeight );
+                }
+                else if(    ( 0 == std::strcmp( pParameter, "/u" ))
+                        ||  ( 0 == std::strncmp( pParameter, "/u:", 3 )))
+                {
+                    const double dSpeed = '\0' == pParameter[2] ? getLinkSpeed() : std::atof( pParameter + 3 );
+                    if(     ( getBandwidthPlanning() )
+                        ||  ( 0.0 >= dSpeed )
+                        ||  ( getPrintHelp() ))
+                    {
+                        return  VmbErrorBadParameter;
+                    }
+
+                    setBandwidthPlanning( true );
+                    setLinkSpeed( dSpeed );
+                }
+                else if( 0 == std::strncmp( pParameter, "/j:", 3 ))
+                {
+                    const std::string strSpec( pParameter + 3 );
+                    const std::string::size_type nAt = strSpec.find_last_of( '@' );
+                    if(     ( !getPresetFile().empty() )
+                        ||  ( strSpec.empty() || 0 == nAt || strSpec.size() - 1 == nAt )
+                        ||  ( getPrintHelp() ))
+                    {
+                        return  VmbErrorBadParameter;
+                    }
+
+                    setPresetFile( strSpec.substr( 0, nAt ));
+                    setPresetName( std::string::npos == nAt ? std::string() : strSpec.substr( nAt + 1 ));
+                }
+                else if( 0 == std::strncmp( pParameter, "/g:", 3 ))
+                {
+                    if(     ( !m_Pipeline.empty() )
+                        ||  ( !ParsePipeline( pParameter + 3, m_Pipeline ))
+                        ||  ( getPrintHelp() ))
+                    {
+                        return  VmbErrorBadParameter;
+                    }
+                }
+                else if( 0 == std::strncmp( pParameter, "/n:", 3 ))
+                {
+                    unsigned long nCount = 0;
+                    if(     ( !ParseCount( pParameter + 3, MaxCameraCount, nCount ))
+                        ||  ( 0 == nCount )
+                        ||  ( getPrintHelp() ))
+                    {
+                        return  VmbErrorBadParameter;
+                    }
+
+                    setCameraCount( static_cast<unsigned int>( nCount ));
+                }
+                else if( 0 == std::strncmp( pParameter, "/p:", 3 ))
+                {
+                    if(     ( !m_CpuAffinity.empty() )
+                        ||  ( !ParseCpuAffinity( pParameter + 3, m_CpuAffinity ))
+                        ||  ( getPrintHelp() ))
+                    {
+                        return  VmbErrorBadParameter;
+                    }
+                }
                 else
                 {
                     return  VmbErrorBadParameter;
@@ -130,14 +630,61 @@ public:
             }
             else
             {
-                if( !getCameraID().empty() )
+                for( size_t j = 0; j < m_CameraIDs.size(); ++j )
                 {
-                    return  VmbErrorBadParameter;
+                    if( m_CameraIDs[j] == pParameter )
+                    {
+                        return  VmbErrorBadParameter;
+                    }
                 }
 
-                setCameraID( pParameter );
+                m_CameraIDs.push_back( std::string( pParameter ));
             }
         }
+        // Playback replaces the cameras, /f, /k and /z only make sense with it
+        if(     ( !getUsePlayback() )
+            &&  ( bPlaybackTiming || 0 != m_Playback.FirstFrame || m_Playback.bLoop ))
+        {
+            return VmbErrorBadParameter;
+        }
+        if(     ( getUsePlayback() )
+            &&  ( getUseSyntheticCamera() || nRecordings != m_CameraIDs.size() || 0 != m_Geometry.Width ))
+        {
+            return VmbErrorBadParameter;
+        }
+        // Only cameras on a network have bandwidth to plan, presets need the features of a camera
+        if(     ( getBandwidthPlanning() || !getPresetFile().empty() )
+            &&  ( getUseSyntheticCamera() || getUsePlayback() ))
+        {
+            return VmbErrorBadParameter;
+        }
+        // Recordings are played back from buffers of their own at the pace of the processing, only a fixed frame count applies
+        if(     ( getUsePlayback() )
+            &&  ( m_FrameBuffers.bHugePages || m_FrameBuffers.bLock || FrameBufferNode_None != m_FrameBuffers.NumaNode ))
+        {
+            return VmbErrorBadParameter;
+        }
+        // The pipeline replaces the workers and the bundle processing, its record and display stages
+        // need a recording and a preview
+        for( size_t j = 0; j < m_Pipeline.size(); ++j )
+        {
+            if(     ( PipelineStage_Record == m_Pipeline[j].Type && getRecordFile().empty() )
+                ||  ( PipelineStage_Display == m_Pipeline[j].Type && !getPreview() ))
+            {
+                return VmbErrorBadParameter;
+            }
+        }
+        if(     ( !m_Pipeline.empty() )
+            &&  ( 0 != getWorkerThreads() || BundleMatching_Off != getBundleMatching() ))
+        {
+            return VmbErrorBadParameter;
+        }
+        // /m compresses a recording or sets the threads decoding one
+        if(     ( getCompression() )
+            &&  ( getRecordFile().empty() && !getUsePlayback() ))
+        {
+            return VmbErrorBadParameter;
+        }
         return Result;
     }
     FrameInfos getFrameInfos() const
@@ -163,6 +710,14 @@ public:
     void setColorProcessing( ColorProcessing processing )
     {
         m_ColorProcessing = processing;
+    }
+    DemosaicProcessing getDemosaicProcessing() const
+    {
+        return m_DemosaicProcessing;
+    }
+    void setDemosaicProcessing( DemosaicProcessing processing )
+    {
+        m_DemosaicProcessing = processing;
     }
 	bool getAllocAndAnnounce() const
 	{
@@ -172,19 +727,622 @@ public:
 	{
 		m_UseAllocAndAnnounce = useAllocAndAnnounce;
 	}
-    const std::string& getCameraID() const
+    unsigned int getWorkerThreads() const
+    {
+        return m_WorkerThreads;
+    }
+    void setWorkerThreads( unsigned int nThreads )
+    {
+        m_WorkerThreads = nThreads;
+    }
+    unsigned int getQueueCapacity() const
+    {
+        return m_QueueCapacity;
+    }
+    void setQueueCapacity( unsigned int nCapacity )
+    {
+        m_QueueCapacity = nCapacity;
+    }
+    bool getUseSyntheticCamera() const
+    {
+        return m_UseSyntheticCamera;
+    }
+    void setUseSyntheticCamera( bool useSynthetic )
+    {
+        m_UseSyntheticCamera = useSynthetic;
+    }
+    const SyntheticCameraConfig& getSyntheticCamera() const
+    {
+        return m_SyntheticCamera;
+    }
+    bool getBandwidthPlanning() const
+    {
+        return m_BandwidthPlanning;
+    }
+    void setBandwidthPlanning( bool planning )
+    {
+        m_BandwidthPlanning = planning;
+    }
+    double getLinkSpeed() const
+    {
+        return m_LinkSpeed;
+    }
+    void setLinkSpeed( double dSpeed )
+    {
+        m_LinkSpeed = dSpeed;
+    }
+    const std::string& getPresetFile() const
+    {
+        return m_PresetFile;
+    }
+    void setPresetFile( const std::string &fileName )
+    {
+        m_PresetFile = fileName;
+    }
+    const std::string& getPresetName() const
+    {
+        return m_PresetName;
+    }
+    void setPresetName( const std::string &name )
+    {
+        m_PresetName = name;
+    }
+    const FrameBufferConfig& getFrameBuffers() const
+    {
+        return m_FrameBuffers;
+    }
+    //
+    // Parses a decimal count of at most nMax, digits only: strtoul would wrap a negative count
+    // around and atoi takes trailing garbage
+    //
+    static bool ParseCount( const char *pText, unsigned long nMax, unsigned long &nCount )
+    {
+        char *pEnd = NULL;
+        errno = 0;
+        const unsigned long nValue = std::strtoul( pText, &pEnd, 10 );
+        if(     ( !std::isdigit( static_cast<unsigned char>( pText[0] )) || '\0' != *pEnd )
+            ||  ( ERANGE == errno || nValue > nMax ))
+        {
+            return false;
+        }
+        nCount = nValue;
+        return true;
+    }
+    //
+    // Parses "<n>|auto[=<MB>][:huge][:lock][:numa[=<node>]]", the options in any order
+    //
+    static bool ParseFrameBuffers( const char* const &spec, FrameBufferConfig &buffers )
+    {
+        const std::string strSpec( spec );
+        std::string::size_type nStart = 0;
+        bool bFirst = true;
+        while( nStart <= strSpec.size() )
+        {
+            std::string::size_type nEnd = strSpec.find( ':', nStart );
+            if( std::string::npos == nEnd )
+            {
+                nEnd = strSpec.size();
+            }
+            const std::string strField = strSpec.substr( nStart, nEnd - nStart );
+            nStart = nEnd + 1;
+
+            char *pEnd = NULL;
+            if(     ( bFirst )
+                &&  ( 0 == strField.compare( 0, 4, "auto" )))
+            {
+                bFirst = false;
+                if( 4 != strField.size() )
+                {
+                    const unsigned long nMegabytes = std::strtoul( strField.c_str() + 5, &pEnd, 10 );
+                    if(     ( '=' != strField[4] || 5 == strField.size() || '\0' != *pEnd )
+                        ||  ( 0 == nMegabytes ))
+                    {
+                        return false;
+                    }
+                    buffers.Budget = static_cast<VmbUint64_t>( nMegabytes ) * 1024 * 1024;
+                }
+                buffers.bAdaptive = true;
+            }
+            else if( bFirst )
+            {
+                bFirst = false;
+                const unsigned long nCount = std::strtoul( strField.c_str(), &pEnd, 10 );
+                if(     ( strField.empty() || '\0' != *pEnd )
+                    ||  ( 0 == nCount || nCount > 1024 ))
+                {
+                    return false;
+                }
+                buffers.Count       = static_cast<VmbUint32_t>( nCount );
+                buffers.bAdaptive   = false;
+            }
+            else if( "huge" == strField )
+            {
+                buffers.bHugePages = true;
+            }
+            else if( "lock" == strField )
+            {
+                buffers.bLock = true;
+            }
+            else if( "numa" == strField )
+            {
+                buffers.NumaNode = FrameBufferNode_Auto;
+            }
+            else if( 0 == strField.compare( 0, 5, "numa=" ))
+            {
+                const unsigned long nNode = std::strtoul( strField.c_str() + 5, &pEnd, 10 );
+                if(     ( 5 == strField.size() || '\0' != *pEnd )
+                    ||  ( nNode >= 1024 ))
+                {
+                    return false;
+                }
+                buffers.NumaNode = static_cast<int>( nNode );
+            }
+            else
+            {
+                return false;
+            }
+        }
+        buffers.bOwnBuffers = true;
+        return true;
+    }
+    const GeometryRequest& getGeometry() const
+    {
+        return m_Geometry;
+    }
+    //
+    // Parses "<w>x<h>[:<rw>x<rh>+<x>+<y>][:roi|bin|dec][:<format>]", the fields after the size in any order
+    //
+    static bool ParseGeometryRequest( const char* const &spec, GeometryRequest &geometry )
+    {
+        const std::string strSpec( spec );
+        std::string::size_type nStart = 0;
+        bool bFirst = true;
+        while( nStart <= strSpec.size() )
+        {
+            std::string::size_type nEnd = strSpec.find( ':', nStart );
+            if( std::string::npos == nEnd )
+            {
+                nEnd = strSpec.size();
+            }
+            const std::string strField = strSpec.substr( nStart, nEnd - nStart );
+            nStart = nEnd + 1;
+
+            char cEnd = '\0';
+            if( bFirst )
+            {
+                bFirst = false;
+                if(     ( 2 != std::sscanf( strField.c_str(), "%ux%u%c", &geometry.Width, &geometry.Height, &cEnd ))
+                    ||  ( 0 == geometry.Width || 0 == geometry.Height ))
+                {
+                    return false;
+                }
+            }
+            else if( "roi" == strField || "bin" == strField || "dec" == strField )
+            {
+                geometry.Reduction  = "roi" == strField ? GeometryReduction_Roi
+                                    : "bin" == strField ? GeometryReduction_Binning : GeometryReduction_Decimation;
+            }
+            else if( 4 == std::sscanf( strField.c_str(), "%ux%u+%u+%u%c", &geometry.RegionWidth, &geometry.RegionHeight, &geometry.RegionX, &geometry.RegionY, &cEnd ))
+            {
+                if( 0 == geometry.RegionWidth || 0 == geometry.RegionHeight )
+                {
+                    return false;
+                }
+            }
+            else if( PixelFormatFromName( strField.c_str(), geometry.PixelFormat ))
+            {
+                geometry.bPixelFormat = true;
+            }
+            else
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    bool getLatencyReport() const
+    {
+        return m_LatencyReport;
+    }
+    void setLatencyReport( bool latencyReport )
+    {
+        m_LatencyReport = latencyReport;
+    }
+    double getLatencyReportInterval() const
+    {
+        return m_LatencyReportInterval;
+    }
+    void setLatencyReportInterval( double dSeconds )
+    {
+        m_LatencyReportInterval = dSeconds;
+    }
+    //
+    // Parses "<format>[:<width>x<height>[@<fps>]]", an empty string keeps the defaults
+    //
+    static bool ParseSyntheticCamera( const char* const &spec, SyntheticCameraConfig &camera )
+    {
+        const std::string strSpec( spec );
+        if( strSpec.empty() )
+        {
+            return true;
+        }
+        const std::string::size_type nColon = strSpec.find( ':' );
+        const std::string strFormat = strSpec.substr( 0, nColon );
+        if( !PixelFormatFromName( strFormat.c_str(), camera.PixelFormat ))
+        {
+            return false;
+        }
+        if( std::string::npos == nColon )
+        {
+            return true;
+        }
+        const std::string strGeometry = strSpec.substr( nColon + 1 );
+        unsigned int nWidth     = 0;
+        unsigned int nHeight    = 0;
+        double       dFrameRate = camera.FrameRate;
+        const int nFields = std::sscanf( strGeometry.c_str(), "%ux%u@%lf", &nWidth, &nHeight, &dFrameRate );
+        if(     ( nFields < 2 )
+            ||  ( 0 == nWidth || 0 == nHeight )
+            ||  ( dFrameRate < 0.0 ))
+        {
+            return false;
+        }
+        camera.Width        = nWidth;
+        camera.Height       = nHeight;
+        camera.FrameRate    = dFrameRate;
+        return true;
+    }
+    BundleMatching getBundleMatching() const
+    {
+        return m_BundleMatching;
+    }
+    double getBundleTolerance() const
+    {
+        return m_BundleTolerance;
+    }
+    const PlaybackConfig& getPlayback() const
+    {
+        return m_Playback;
+    }
+    bool getUsePlayback() const
+    {
+        return m_UsePlayback;
+    }
+    void setUsePlayback( bool usePlayback )
+    {
+        m_UsePlayback = usePlayback;
+    }
+    //
+    // Parses "max" or "<fps>"
+    //
+    static bool ParsePlaybackTiming( const char* const &spec, PlaybackConfig &playback )
+    {
+        const std::string strSpec( spec );
+        if( "max" == strSpec )
+        {
+            playback.Timing = PlaybackTiming_Fast;
+            return true;
+        }
+        char *pEnd = NULL;
+        const double dFrameRate = std::strtod( strSpec.c_str(), &pEnd );
+        if(     ( '\0' != *pEnd )
+            ||  ( !( dFrameRate > 0.0 )))
+        {
+            return false;
+        }
+        playback.Timing     = PlaybackTiming_FixedRate;
+        playback.FrameRate  = dFrameRate;
+        return true;
+    }
+    const std::string& getRecordFile() const
+    {
+        return m_RecordFile;
+    }
+    void setRecordFile( const std::string &fileName )
+    {
+        m_RecordFile = fileName;
+    }
+    bool getPreview() const
+    {
+        return m_Preview;
+    }
+    void setPreview( bool preview )
+    {
+        m_Preview = preview;
+    }
+    unsigned int getPreviewWidth() const
+    {
+        return m_PreviewWidth;
+    }
+    unsigned int getPreviewHeight() const
+    {
+        return m_PreviewHeight;
+    }
+    void setPreviewSize( unsigned int width, unsigned int height )
+    {
+        m_PreviewWidth  = width;
+        m_PreviewHeight = height;
+    }
+    const std::vector<PipelineStageConfig>& getPipeline() const
+    {
+        return m_Pipeline;
+    }
+    //
+    // Parses comma separated stages "<type>[:<args>][*<threads>][#<capacity>][!block|!oldest|!newest][<<input>...]",
+    // type is convert, crop:<w>x<h>+<x>+<y>, resize:<w>x<h>, analyze, record or display; the input
+    // is the previous stage unless given, 0 is the camera and i the i-th stage
+    //
+    static bool ParsePipeline( const char* const &spec, std::vector<PipelineStageConfig> &pipeline )
+    {
+        const std::string strSpec( spec );
+        std::string::size_type nStart = 0;
+        while( nStart <= strSpec.size() )
+        {
+            std::string::size_type nEnd = strSpec.find( ',', nStart );
+            if( std::string::npos == nEnd )
+            {
+                nEnd = strSpec.size();
+            }
+            const std::string strStage = strSpec.substr( nStart, nEnd - nStart );
+            nStart = nEnd + 1;
+
+            PipelineStageConfig stage;
+            std::string::size_type nPos = strStage.find_first_of( ":*#!<" );
+            const std::string strType = strStage.substr( 0, nPos );
+            std::string strArgs;
+            if(     ( std::string::npos != nPos )
+                &&  ( ':' == strStage[ nPos ] ))
+            {
+                const std::string::size_type nArgsEnd = strStage.find_first_of( "*#!<", nPos );
+                strArgs = strStage.substr( nPos + 1, nArgsEnd - nPos - 1 );
+                nPos    = nArgsEnd;
+            }
+            char cEnd = '\0';
+            if( "convert" == strType || "analyze" == strType || "record" == strType || "display" == strType )
+            {
+                stage.Type  = "convert" == strType ? PipelineStage_Convert
+                            : "analyze" == strType ? PipelineStage_Analyze
+                            : "record" == strType ? PipelineStage_Record : PipelineStage_Display;
+                if( !strArgs.empty() )
+                {
+                    return false;
+                }
+            }
+            else if( "crop" == strType )
+            {
+                stage.Type = PipelineStage_Crop;
+                if( 4 != std::sscanf( strArgs.c_str(), "%ux%u+%u+%u%c", &stage.Width, &stage.Height, &stage.X, &stage.Y, &cEnd ))
+                {
+                    return false;
+                }
+            }
+            else if( "resize" == strType )
+            {
+                stage.Type = PipelineStage_Resize;
+                if( 2 != std::sscanf( strArgs.c_str(), "%ux%u%c", &stage.Width, &stage.Height, &cEnd ))
+                {
+                    return false;
+                }
+            }
+            else
+            {
+                return false;
+            }
+            if(     ( PipelineStage_Crop == stage.Type || PipelineStage_Resize == stage.Type )
+                &&  ( 0 == stage.Width || 0 == stage.Height ))
+            {
+                return false;
+            }
+
+            // Suffixes in any order
+            while( std::string::npos != nPos && nPos < strStage.size() )
+            {
+                const char cMarker = strStage[ nPos ];
+                const std::string::size_type nNext = strStage.find_first_of( "*#!<", nPos + 1 );
+                const std::string strValue = strStage.substr( nPos + 1, nNext - nPos - 1 );
+                char *pEnd = NULL;
+                const unsigned long nValue = std::strtoul( strValue.c_str(), &pEnd, 10 );
+                const bool bNumber = !strValue.empty() && '\0' == *pEnd;
+                if( '*' == cMarker && bNumber && nValue > 0 )
+                {
+                    stage.Threads = static_cast<unsigned int>( nValue );
+                }
+                else if( '#' == cMarker && bNumber && nValue > 0 && nValue <= MaxQueueCapacity )
+                {
+                    stage.QueueCapacity = static_cast<unsigned int>( nValue );
+                }
+                else if( '!' == cMarker && ( "block" == strValue || "oldest" == strValue || "newest" == strValue ))
+                {
+                    stage.Overflow  = "block" == strValue ? Overflow_Block
+                                    : "oldest" == strValue ? Overflow_DropOldest : Overflow_DropNewest;
+                }
+                else if( '<' == cMarker && bNumber && nValue <= pipeline.size() )
+                {
+                    stage.Inputs.push_back( static_cast<unsigned int>( nValue ));
+                }
+                else
+                {
+                    return false;
+                }
+                nPos = nNext;
+            }
+            if( stage.Inputs.empty() )
+            {
+                stage.Inputs.push_back( static_cast<unsigned int>( pipeline.size() ));
+            }
+            // The recorder takes its frames from one thread
+            if(     ( PipelineStage_Record == stage.Type )
+                &&  ( stage.Threads > 1 ))
+            {
+                return false;
+            }
+            // Only the convert and record stages work on the raw frame, the others need a convert stage before them
+            for( size_t j = 0; j < stage.Inputs.size(); ++j )
+            {
+                if(     ( PipelineStage_Convert != stage.Type && PipelineStage_Record != stage.Type )
+                    &&  ( 0 == stage.Inputs[j] || !HasImage( pipeline, stage.Inputs[j] )))
+                {
+                    return false;
+                }
+            }
+            pipeline.push_back( stage );
+        }
+        return !pipeline.empty();
+    }
+    //
+    // Whether the packets of the i-th stage carry an image: a convert stage lies on every path from the camera
+    //
+    static bool HasImage( const std::vector<PipelineStageConfig> &pipeline, unsigned int nStage )
+    {
+        const PipelineStageConfig &stage = pipeline[ nStage - 1 ];
+        if( PipelineStage_Convert == stage.Type )
+        {
+            return true;
+        }
+        for( size_t j = 0; j < stage.Inputs.size(); ++j )
+        {
+            if(     ( 0 == stage.Inputs[j] )
+                ||  ( !HasImage( pipeline, stage.Inputs[j] )))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    bool getCompression() const
+    {
+        return m_Compression;
+    }
+    void setCompression( bool compression )
+    {
+        m_Compression = compression;
+    }
+    unsigned int getCodecThreads() const
+    {
+        return m_CodecThreads;
+    }
+    void setCodecThreads( unsigned int threads )
+    {
+        m_CodecThreads = threads;
+    }
+    //
+    // Parses "ts[:<us>]" or "id[:<ids>]", the tolerance defaults to 500 us and 0 IDs
+    //
+    static bool ParseBundleMatching( const char* const &spec, BundleMatching &matching, double &tolerance )
+    {
+        const std::string strSpec( spec );
+        const std::string::size_type nColon = strSpec.find( ':' );
+        const std::string strMode = strSpec.substr( 0, nColon );
+        if( "ts" == strMode )
+        {
+            matching    = BundleMatching_Timestamp;
+            tolerance   = 500.0;
+        }
+        else if( "id" == strMode )
+        {
+            matching    = BundleMatching_FrameID;
+            tolerance   = 0.0;
+        }
+        else
+        {
+            return false;
+        }
+        if( std::string::npos != nColon )
+        {
+            char *pEnd = NULL;
+            const char *pTolerance = spec + nColon + 1;
+            tolerance = std::strtod( pTolerance, &pEnd );
+            if(     ( pEnd == pTolerance )
+                ||  ( '\0' != *pEnd )
+                ||  ( tolerance < 0.0 ))
+            {
+                matching = BundleMatching_Off;
+                return false;
+            }
+        }
+        return true;
+    }
+    //
+    // Parses "<cpu>[-<cpu>][,...]", every comma separated item is the CPU set of one camera
+    //
+    static bool ParseCpuAffinity( const char* const &spec, std::vector< std::vector<unsigned int> > &affinity )
+    {
+        const char *p = spec;
+        affinity.clear();
+        for( ;; )
+        {
+            unsigned int nFirst = 0;
+            unsigned int nLast  = 0;
+            int          nUsed  = 0;
+            if( 2 != std::sscanf( p, "%u-%u%n", &nFirst, &nLast, &nUsed ))
+            {
+                if( 1 != std::sscanf( p, "%u%n", &nFirst, &nUsed ))
+                {
+                    return false;
+                }
+                nLast = nFirst;
+            }
+            if( nLast < nFirst || nLast >= 1024 )
+            {
+                return false;
+            }
+            std::vector<unsigned int> cpus;
+            for( unsigned int nCpu = nFirst; nCpu <= nLast; ++nCpu )
+            {
+                cpus.push_back( nCpu );
+            }
+            affinity.push_back( cpus );
+            p += nUsed;
+            if( '\0' == *p )
+            {
+                return true;
+            }
+            if( ',' != *p++ )
+            {
+                return false;
+            }
+        }
+    }
+    //
+    // CPUs the threads of the given camera are pinned to, empty for no restriction
+    //
+    std::vector<unsigned int> getCpuAffinity( size_t nCamera ) const
+    {
+        if( m_CpuAffinity.empty() )
+        {
+            return std::vector<unsigned int>();
+        }
+        return m_CpuAffinity[ nCamera % m_CpuAffinity.size() ];
+    }
+    unsigned int getCameraCount() const
+    {
+        return m_CameraCount;
+    }
+    void setCameraCount( unsigned int nCount )
+    {
+        m_CameraCount = nCount;
+    }
+    const std::vector<std::string>& getCameraIDs() const
+    {
+        return m_CameraIDs;
+    }
+    void setCameraIDs( const std::vector<std::string> &IDs )
+    {
+        m_CameraIDs = IDs;
+    }
+    std::string getCameraID() const
     {
-        return m_CameraID;
+        return m_CameraIDs.empty() ? std::string() : m_CameraIDs[0];
     }
     void setCameraID( const std::string &name )
     {
-        m_CameraID = name;
+        m_CameraIDs.assign( 1, name );
     }
     void setCameraID( const char* const&name )
     {
         if( NULL != name )
         {
-            m_CameraID = std::string( name );
+            m_CameraIDs.assign( 1, std::string( name ));
         }
         else
         {
@@ -202,14 +1360,70 @@ public:
     template <typename STREAM_TYPE>
     static STREAM_TYPE& PrintHelp( STREAM_TYPE &s ) 
     {
-        s<<"Usage: AsynchronousGrab [CameraID] [/i] [/h]\n";
-        s<<"Parameters: CameraID    ID of the camera to use (using first camera if not specified)\n";
+        s<<"Usage: AsynchronousGrab [CameraID...] [/i] [/h]\n";
+        s<<"Parameters: CameraID    IDs of the cameras to stream concurrently (using first camera if not specified)\n";
+        s<<"                        or serial numbers of cameras in the inventory cache of listCam\n";
         s<<"            /i          Show frame infos\n";
         s<<"            /a          Automatically only show frame infos of corrupt frames\n";
         s<<"            /h          Print out help\n";
         s<<"            /r          Convert to RGB and show RGB values\n";
         s<<"            /c          Color correction (includes /r)\n";
+        s<<"            /d:<m>      Demosaic method for 8 bit Bayer frames: bilinear (default), edge or vimba\n";
         s<<"            /x          Use AllocAndAnnounceFrame instead of AnnounceFrame\n";
+        s<<"            /x:<n>|auto[=<MB>][:huge][:lock][:numa[=<node>]]\n";
+        s<<"                        Announce <n> frames per camera, or as many as frame rate, processing\n";
+        s<<"                        time and drops need within <MB> per camera (default, 256 MB), over page\n";
+        s<<"                        aligned buffers of the program, backed by 2 MB huge pages, locked into\n";
+        s<<"                        memory and placed on NUMA node <node>, by default the node of the\n";
+        s<<"                        network interface or else of the CPUs given by /p\n";
+        s<<"            /w:<n>      Process frames on <n> worker threads (at most 256) instead of the callback thread\n";
+        s<<"            /q:<n>      Capacity of the frame queue feeding the workers (default 16, at most 65536)\n";
+        s<<"            /s[:<format>[:<w>x<h>[@<fps>]]]\n";
+        s<<"                        Use a synthetic camera instead of Vimba (default Mono8:1920x1080,\n";
+        s<<"                        fps 0 or omitted delivers frames as fast as they are processed)\n";
+        s<<"            /t:<w>x<h>[:<rw>x<rh>+<x>+<y>][:roi|bin|dec][:<format>]\n";
+        s<<"                        Set the camera up to deliver no more than a <w>x<h> image: the sensor\n";
+        s<<"                        region <rw>x<rh>+<x>+<y> (default full sensor), reduced by binning or\n";
+        s<<"                        decimation (default binning, decimation for colour with /r) and read\n";
+        s<<"                        out in the smallest format carrying the image unless <format> is given\n";
+        s<<"            /j:<file>[@<preset>]\n";
+        s<<"                        Apply <preset> (default the first) of a JSON, XML or YAML file of presets\n";
+        s<<"                        when opening, other presets can be entered while streaming\n";
+        s<<"            /u[:<Mbit/s>]\n";
+        s<<"                        Set the largest packet size the network carries and split the bandwidth\n";
+        s<<"                        of every interface, <Mbit/s> each (default 1000), among its GigE cameras\n";
+        s<<"            /e:<i>,<g>[,<every>:<for>]\n";
+        s<<"                        Synthetic camera: percent of incomplete frames and of frame ID gaps,\n";
+        s<<"                        disappear every <every> seconds for <for> seconds and reconnect\n";
+        s<<"            /l[:<s>]    Latency histograms per pipeline stage, sensor rate, jitter and clock\n";
+        s<<"                        drift, printed at stop, on SIGUSR1 and every <s> seconds if given\n";
+        s<<"            /v[:<w>x<h>]\n";
+        s<<"                        Show a preview of every camera scaled down to fit into <w>x<h> (default\n";
+        s<<"                        1280x720), drawn on a thread of its own that skips frames as needed\n";
+        s<<"            /g:<stage>[,<stage>...]\n";
+        s<<"                        Process every camera in a pipeline of stages, each with its own\n";
+        s<<"                        threads and queue: <type>[*<threads>][#<capacity>][!<overflow>][<<in>...]\n";
+        s<<"                        type: convert, crop:<w>x<h>+<x>+<y>, resize:<w>x<h>, analyze, record\n";
+        s<<"                        (with /o) or display (with /v); overflow: block, oldest or newest\n";
+        s<<"                        (default); input: 0 the camera, i the i-th stage (default previous)\n";
+        s<<"            /n:<n>      Stream the first <n> cameras found, or <n> synthetic cameras (at most 64)\n";
+        s<<"            /p:<cpus>   Pin the threads of the i-th camera to the i-th comma separated CPU or\n";
+        s<<"                        CPU range, e.g. /p:0-1,2-3 (cycled if there are more cameras)\n";
+        s<<"            /b:ts[:<us>]\n";
+        s<<"            /b:id[:<n>] Process the frames of all cameras in bundles matched by device timestamp\n";
+        s<<"                        within <us> microseconds (default 500, clocks synchronised by PTP)\n";
+        s<<"                        or by frame ID within <n> (default 0)\n";
+        s<<"            /o:<file>   Record the raw frames and their metadata to <file>, with several cameras\n";
+        s<<"                        the camera ID is added to the name, e.g. run_DEV_1234.vrec\n";
+        s<<"            /m[:<n>]    Recording: compress the frames losslessly in stripes coded on <n>\n";
+        s<<"                        threads (default one per core); playback: decode on <n> threads\n";
+        s<<"            /y:<file>   Play back a recording made with /o instead of streaming cameras,\n";
+        s<<"                        repeat for several recordings played back concurrently\n";
+        s<<"            /f:<fps>|max\n";
+        s<<"                        Playback: deliver at <fps> or as fast as the frames are processed\n";
+        s<<"                        instead of at the recorded pace\n";
+        s<<"            /k:<n>      Playback: start at the <n>-th recorded frame\n";
+        s<<"            /z          Playback: start over at the end of a recording\n";
         return s;
     }
 };
@@ -0,0 +1,87 @@
+#ifndef AVT_VMBAPI_EXAMPLES_RECONNECTMONITOR
+#define AVT_VMBAPI_EXAMPLES_RECONNECTMONITOR
+
+#include <mutex>
+#include <atomic>
+
+#include "VimbaCPP/Include/VimbaCPP.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+/**
+ * @brief How often a source lost its device and how fast it came back
+ */
+struct ReconnectStatistics
+{
+    VmbUint64_t Losses;                 // Times the device disappeared while streaming
+    VmbUint64_t Reconnects;             // Times it was reopened and delivered again
+    VmbUint64_t Reallocations;          // Reconnects that could not reuse the frame buffers
+    double      LastTimeToFirstFrame;   // Seconds from the device reappearing to its first frame
+    double      MaxTimeToFirstFrame;
+    double      Downtime;               // Seconds without frames from losing the device to its first frame, summed
+
+    ReconnectStatistics()
+        : Losses( 0 )
+        , Reconnects( 0 )
+        , Reallocations( 0 )
+        , LastTimeToFirstFrame( 0.0 )
+        , MaxTimeToFirstFrame( 0.0 )
+        , Downtime( 0.0 )
+    {}
+};
+
+/**
+ * @brief Times the outages of a source: the source reports losing and reopening its device,
+ * and every delivered frame; the first frame after a reopen ends the outage.
+ * Frame costs one relaxed atomic load unless an outage is open
+ */
+class ReconnectMonitor
+{
+    public:
+        ReconnectMonitor();
+
+        /**
+         * @brief The device disappeared, ignored while an outage is already open
+         */
+        void                Lost();
+
+        /**
+         * @brief The device is back, reopening it starts
+         */
+        void                Reappeared();
+
+        /**
+         * @brief The device is about to stream again, ignored outside an outage
+         *
+         * @param bReallocated Whether new frame buffers had to be allocated
+         */
+        void                Restarted( bool bReallocated );
+
+        /**
+         * @brief A frame arrived, called for every frame
+         */
+        void                Frame()
+        {
+            if( m_bAwaitingFrame.load( std::memory_order_relaxed ))
+            {
+                FirstFrame();
+            }
+        }
+
+        ReconnectStatistics GetStatistics() const;
+
+    private:
+        void                FirstFrame();
+
+        mutable std::mutex  m_Mutex;
+        std::atomic<bool>   m_bAwaitingFrame;   // Restarted, the first frame is due
+        bool                m_bLost;            // An outage is open
+        VmbUint64_t         m_nLostTime;        // GetHostTime() of the loss
+        VmbUint64_t         m_nReappearTime;
+        ReconnectStatistics m_Statistics;
+};
+
+}} // namespace AVT::VmbAPI
+
+#endif
@@ -0,0 +1,116 @@
+#ifndef AVT_VMBAPI_EXAMPLES_RECORDINGFORMAT
+#define AVT_VMBAPI_EXAMPLES_RECORDINGFORMAT
+
+#include "VimbaCPP/Include/VimbaCPP.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+/*
+ * Layout of a raw recording, all fields little endian:
+ *
+ *  RecordingFileHeader
+ *  RecordingFrameHeader, payload, zero padding to RECORDING_ALIGNMENT     once per frame
+ *  ...
+ *  RecordingIndexEntry                                                     once per frame
+ *  ...
+ *  RecordingTrailer                                                        last bytes of the file
+ *
+ * The trailer is written when the recording is closed. A file cut short, e.g. by a crash, has no
+ * trailer, but every frame record starts with RECORDING_FRAME_MAGIC so the frames can be recovered
+ * by walking the records from the file header on.
+ *
+ * The payload of a frame with RecordingFrame_Compressed set is coded by StripeCodec.h:
+ *
+ *  RecordingStripesHeader
+ *  VmbUint32_t coded size of every stripe, zero padding to RECORDING_ALIGNMENT
+ *  the coded stripes back to back
+ *
+ * Version 1 files lack StoredSize and Reserved in the frame header and are never compressed
+ */
+
+const VmbUint64_t RECORDING_FILE_MAGIC      = 0x31434552424D5641ULL;    // "AVMBREC1"
+const VmbUint64_t RECORDING_TRAILER_MAGIC   = 0x31584449424D5641ULL;    // "AVMBIDX1"
+const VmbUint32_t RECORDING_FRAME_MAGIC     = 0x4D415246;               // "FRAM"
+const VmbUint32_t RECORDING_VERSION         = 2;
+// Frame records start at multiples of this, relative to the start of the file
+const VmbUint32_t RECORDING_ALIGNMENT       = 8;
+
+enum RecordingFrameFlags
+{
+    RecordingFrame_FrameIDValid         = 1,
+    RecordingFrame_PixelFormatValid     = 2,
+    RecordingFrame_ReceiveStatusValid   = 4,
+    RecordingFrame_Compressed           = 8,
+};
+
+struct RecordingFileHeader
+{
+    VmbUint64_t     Magic;                  // RECORDING_FILE_MAGIC
+    VmbUint32_t     Version;                // RECORDING_VERSION
+    VmbUint32_t     HeaderSize;             // sizeof( RecordingFileHeader ), the first frame follows
+    VmbUint64_t     TimestampFrequency;     // Device timestamp ticks per second
+    VmbUint64_t     StartTime;              // GetHostTime() when the recording was opened
+    char            CameraID[96];           // Zero terminated, truncated if longer
+};
+
+struct RecordingFrameHeader
+{
+    VmbUint32_t     Magic;                  // RECORDING_FRAME_MAGIC
+    VmbUint32_t     HeaderSize;             // sizeof( RecordingFrameHeader ), the payload follows
+    VmbUint64_t     FrameID;
+    VmbUint64_t     Timestamp;              // Device timestamp in camera ticks
+    VmbUint64_t     ReceiveTime;            // GetHostTime() at arrival
+    VmbUint32_t     ImageSize;              // Bytes of the image as the camera delivered it
+    VmbUint32_t     Width;
+    VmbUint32_t     Height;
+    VmbUint32_t     OffsetX;
+    VmbUint32_t     OffsetY;
+    VmbUint32_t     PixelFormat;
+    VmbInt32_t      ReceiveStatus;
+    VmbUint32_t     Flags;                  // RecordingFrameFlags
+    VmbUint32_t     StoredSize;             // Bytes of payload, the record is padded to RECORDING_ALIGNMENT
+    VmbUint32_t     Reserved;
+};
+
+struct RecordingStripesHeader
+{
+    VmbUint32_t     StripeCount;
+    VmbUint32_t     RowsPerStripe;          // The last stripe may have fewer rows
+};
+
+struct RecordingIndexEntry
+{
+    VmbUint64_t     Offset;                 // Of the RecordingFrameHeader from the start of the file
+    VmbUint64_t     FrameID;
+    VmbUint64_t     Timestamp;
+};
+
+struct RecordingTrailer
+{
+    VmbUint64_t     Magic;                  // RECORDING_TRAILER_MAGIC
+    VmbUint64_t     IndexOffset;            // Of the first RecordingIndexEntry
+    VmbUint64_t     FrameCount;             // Index entries
+    VmbUint64_t     PayloadBytes;           // Sum of the ImageSize of all frames
+};
+
+// Frame headers of version 1 files end before StoredSize
+const VmbUint32_t RECORDING_FRAME_HEADER_SIZE_V1 = 64;
+
+/**
+ * @brief Bytes of payload following a frame header of any version
+ */
+inline VmbUint32_t RecordingStoredSize( const RecordingFrameHeader &Header )
+{
+    return Header.HeaderSize >= sizeof( RecordingFrameHeader ) ? Header.StoredSize : Header.ImageSize;
+}
+
+static_assert( sizeof( RecordingFileHeader ) == 128, "RecordingFileHeader layout" );
+static_assert( sizeof( RecordingFrameHeader ) == 72, "RecordingFrameHeader layout" );
+static_assert( sizeof( RecordingStripesHeader ) == 8, "RecordingStripesHeader layout" );
+static_assert( sizeof( RecordingIndexEntry ) == 24, "RecordingIndexEntry layout" );
+static_assert( sizeof( RecordingTrailer ) == 32, "RecordingTrailer layout" );
+
+}} // namespace AVT::VmbAPI
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef AVT_VMBAPI_EXAMPLES_SIMDLEVEL
+#define AVT_VMBAPI_EXAMPLES_SIMDLEVEL
+
+namespace AVT {
+namespace VmbAPI {
+
+enum SimdLevel
+{
+    SimdLevel_Auto,                 // Best level the CPU supports
+    SimdLevel_Scalar,               // Reference implementation, every other level matches it bit by bit
+    SimdLevel_SSE41,
+    SimdLevel_AVX2,
+};
+
+/**
+ * @brief Best instruction set level of this CPU, detected once at runtime
+ */
+SimdLevel   DetectSimdLevel();
+
+/**
+ * @brief Best available level not above the requested one, never SimdLevel_Auto
+ */
+SimdLevel   ResolveSimdLevel( SimdLevel eRequested );
+
+/**
+ * @brief Printable name of an instruction set level
+ */
+const char* SimdLevelToName( SimdLevel eLevel );
+
+}} // namespace AVT::VmbAPI
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef AVT_VMBAPI_EXAMPLES_SIMULATEDCAMERAFEATURES
+#define AVT_VMBAPI_EXAMPLES_SIMULATEDCAMERAFEATURES
+
+#include <string>
+#include <vector>
+
+#include "CameraFeatures.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+/**
+ * @brief The image format features of a camera, modelled the way GenICam cameras behave:
+ * binning and decimation shrink WidthMax and HeightMax, Width and OffsetX limit each other,
+ * values off the increment or out of range are rejected and a size no longer fitting after
+ * binning is cut down by the camera. Like many colour sensors the simulated one only bins
+ * in mono formats. Of the GigE stream it has the packet size, the payload size following the image,
+ * the frame rate and StreamBytesPerSecond, whose range and increment are checked like the others.
+ * Gain has a value of its own for every entry of GainSelector
+ */
+class SimulatedCameraFeatures : public ICameraFeatures
+{
+    public:
+        static const VmbInt64_t WIDTH_INCREMENT        = 8;
+        static const VmbInt64_t HEIGHT_INCREMENT       = 2;
+        static const VmbInt64_t OFFSET_X_INCREMENT     = 8;
+        static const VmbInt64_t OFFSET_Y_INCREMENT     = 2;
+        static const VmbInt64_t MIN_SIZE               = 16;
+        static const VmbInt64_t MAX_FACTOR             = 8;
+        static const VmbInt64_t PACKET_SIZE            = 1500;
+        static const VmbInt64_t STREAM_BYTES_MIN       = 1000000;
+        static const VmbInt64_t STREAM_BYTES_MAX       = 124000000;
+        static const VmbInt64_t STREAM_BYTES_INCREMENT = 1000;
+        static const double     FRAME_RATE;
+        static const double     FRAME_RATE_MAX;
+        static const double     GAIN_MAX;
+
+        /**
+         * @brief Starts at full resolution, no binning or decimation, the first format, FRAME_RATE
+         * and the most stream bytes per second
+         *
+         * @param PixelFormats GenICam names of the formats the camera offers, not empty
+         */
+        SimulatedCameraFeatures( VmbInt64_t nSensorWidth, VmbInt64_t nSensorHeight, const std::vector<std::string> &PixelFormats );
+
+        virtual VmbErrorType    GetInt( const char *pName, VmbInt64_t &nValue );
+        virtual VmbErrorType    GetIntRange( const char *pName, VmbInt64_t &nMin, VmbInt64_t &nMax, VmbInt64_t &nIncrement );
+        virtual VmbErrorType    SetInt( const char *pName, VmbInt64_t nValue );
+        virtual VmbErrorType    GetEnum( const char *pName, std::string &strValue );
+        virtual VmbErrorType    GetEnumEntries( const char *pName, std::vector<std::string> &Entries );
+        virtual VmbErrorType    SetEnum( const char *pName, const std::string &strValue );
+        virtual VmbErrorType    GetFloat( const char *pName, double &dValue );
+        virtual VmbErrorType    GetFloatRange( const char *pName, double &dMin, double &dMax, double &dIncrement );
+        virtual VmbErrorType    SetFloat( const char *pName, double dValue );
+        virtual VmbErrorType    GetBool( const char *pName, bool &bValue );
+        virtual VmbErrorType    SetBool( const char *pName, bool bValue );
+        virtual VmbErrorType    RunCommand( const char *pName );
+
+    private:
+        VmbInt64_t              WidthMax() const;
+        VmbInt64_t              HeightMax() const;
+        bool                    IsBayer( const std::string &strFormat ) const;
+        size_t                  GainIndex() const;
+        void                    FitImage();
+
+        const VmbInt64_t        m_nSensorWidth;
+        const VmbInt64_t        m_nSensorHeight;
+        const std::vector<std::string> m_PixelFormats;
+        std::string             m_strPixelFormat;
+        VmbInt64_t              m_nBinningHorizontal;
+        VmbInt64_t              m_nBinningVertical;
+        VmbInt64_t              m_nDecimationHorizontal;
+        VmbInt64_t              m_nDecimationVertical;
+        VmbInt64_t              m_nWidth;
+        VmbInt64_t              m_nHeight;
+        VmbInt64_t              m_nOffsetX;
+        VmbInt64_t              m_nOffsetY;
+        VmbInt64_t              m_nPacketSize;
+        VmbInt64_t              m_nStreamBytesPerSecond;
+        double                  m_dFrameRate;
+        std::string             m_strGainSelector;
+        double                  m_Gains[3];         // dB, for All, AnalogAll and DigitalAll of GainSelector
+};
+
+}} // namespace AVT::VmbAPI
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef AVT_VMBAPI_EXAMPLES_STRIPECODEC
+#define AVT_VMBAPI_EXAMPLES_STRIPECODEC
+
+#include <cstddef>
+
+#include "VimbaCPP/Include/VimbaCPP.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+/**
+ * @brief How the lossless codec sees a frame: rows of 8 or 16 bit samples, and the distance to the
+ * nearest sample of the same colour to the left and above, which the prediction is based on
+ */
+struct StripeLayout
+{
+    VmbUint32_t     SampleBytes;    // 1 or 2, 16 bit samples are little endian
+    VmbUint32_t     RowBytes;
+    VmbUint32_t     Rows;
+    VmbUint32_t     DX;             // Samples to the same colour left, 2 for Bayer, 3 for RGB8 or a packed 12 bit group
+    VmbUint32_t     DY;             // Rows to the same colour above, 2 for Bayer
+
+    StripeLayout()
+        : SampleBytes( 1 )
+        , RowBytes( 0 )
+        , Rows( 0 )
+        , DX( 1 )
+        , DY( 1 )
+    {}
+};
+
+/**
+ * @brief Picks the layout for a frame. Formats with whole bytes per pixel are coded per pixel, 16 bit
+ * words as one sample; packed formats are coded byte by byte against the byte of the previous group
+ *
+ * @return false if the frame is not made of whole rows, it is then stored as is
+ */
+bool            GetStripeLayout( VmbPixelFormatType eFormat, VmbUint32_t nWidth, VmbUint32_t nHeight, VmbUint32_t nImageSize, StripeLayout &Layout );
+
+/**
+ * @brief Bytes EncodeStripe writes at most for nRows rows, incompressible data included
+ */
+size_t          MaxEncodedStripeSize( const StripeLayout &Layout, VmbUint32_t nRows );
+
+/**
+ * @brief Codes rows losslessly: every sample is predicted from its neighbours to the left and above
+ * (median edge detector as in LOCO-I), the residuals are Rice coded in blocks of 32 with a parameter
+ * chosen per block. A stripe only refers to its own rows, so stripes code and decode independently
+ *
+ * @param pRows First byte of the first row, nRows * Layout.RowBytes bytes
+ * @param pOutput At least MaxEncodedStripeSize bytes
+ *
+ * @return Bytes written
+ */
+size_t          EncodeStripe( const StripeLayout &Layout, const VmbUchar_t *pRows, VmbUint32_t nRows, VmbUchar_t *pOutput );
+
+/**
+ * @brief Restores the rows coded by EncodeStripe
+ *
+ * @param pInput The coded stripe
+ * @param nInputSize Its size, decoding never reads past it
+ * @param pRows nRows * Layout.RowBytes bytes
+ *
+ * @return false if the input is damaged
+ */
+bool            DecodeStripe( const StripeLayout &Layout, const VmbUchar_t *pInput, size_t nInputSize, VmbUint32_t nRows, VmbUchar_t *pRows );
+
+}} // namespace AVT::VmbAPI
+
+#endif
@@ -0,0 +1,97 @@
+#ifndef AVT_VMBAPI_EXAMPLES_SYNTHETICFRAMESOURCE
+#define AVT_VMBAPI_EXAMPLES_SYNTHETICFRAMESOURCE
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <memory>
+
+#include "FrameSource.h"
+#include "ProgramConfig.h"
+#include "ReconnectMonitor.h"
+#include "FrameBufferPool.h"
+#include "FrameBufferSizer.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+/**
+ * @brief In-process camera generating test patterns, so the acquisition path can run without hardware.
+ * Frames are delivered from a generator thread just like the API delivers them from its capture thread.
+ * With a fixed frame rate a frame finding no queued buffer is lost and shows up as frame ID gap,
+ * with frame rate 0 the generator waits for a buffer instead and runs as fast as the pipeline allows.
+ * A camera configured to drop out stops delivering for a while like an unplugged camera, then
+ * reconnects with its frame buffers and restarts its frame IDs and timestamps like a power cycled one.
+ * That exercises what comes after the source; the reconnect of CameraFrameSource itself is
+ * tested against a simulated ICameraDevice.
+ * The generator thread grows the buffers itself when the FrameBufferSizer asks for more
+ */
+class SyntheticFrameSource : public IFrameSource
+{
+    public:
+        /**
+         * @brief Construct a new Synthetic Frame Source object
+         *
+         * @param strID ID reported for the camera
+         * @param Camera Pixel format, geometry, frame rate and simulated faults
+         * @param nBufferCount Number of frame buffers cycling between source and observer, the least if Buffers is adaptive
+         * @param Geometry The image the processing needs, applied to a simulated feature tree of the sensor
+         * @param bColor Whether the processing demosaics, decides pixel format and binning
+         * @param Buffers Number, page size, locking and NUMA node of the frame buffers
+         */
+        SyntheticFrameSource( const std::string &strID, const SyntheticCameraConfig &Camera, VmbUint32_t nBufferCount,
+                              const GeometryRequest &Geometry = GeometryRequest(), bool bColor = false,
+                              const FrameBufferConfig &Buffers = FrameBufferConfig() );
+        ~SyntheticFrameSource();
+
+        virtual VmbErrorType    Open();
+        virtual VmbErrorType    StartAcquisition( FrameObserver *pObserver );
+        virtual VmbErrorType    StopAcquisition();
+        virtual VmbErrorType    Close();
+        virtual VmbErrorType    QueueFrame( const SourceFrame &Frame );
+        virtual std::string     GetID() const;
+        virtual VmbUint64_t     GetTimestampFrequency() const;
+        virtual ReconnectStatistics GetReconnectStatistics() const;
+        virtual BufferDepthStatistics GetBufferStatistics() const;
+
+        /**
+         * @brief Frames lost because no buffer was queued when they were due
+         */
+        VmbUint64_t             GetStarvedFrames() const;
+
+    private:
+        struct Slot
+        {
+            VmbUchar_t *            pBuffer;            // In m_Pools
+            std::atomic<bool>       bQueued;
+        };
+
+        VmbErrorType            PrepareCamera();
+        void                    GeneratorLoop();
+        void                    FillPattern( VmbUchar_t *pBuffer ) const;
+        bool                    Chance( double dPercent );
+        bool                    DropOut();
+        VmbErrorType            AddBuffers( VmbUint32_t nCount );
+
+        const std::string       m_strID;
+        SyntheticCameraConfig   m_Camera;           // Format and size as set up by Open
+        const GeometryRequest   m_Geometry;
+        const bool              m_bColor;
+        const FrameBufferConfig m_Buffers;
+        VmbUint32_t             m_nImageSize;
+        std::vector< std::unique_ptr<FrameBufferPool> > m_Pools;   // One per growth
+        std::unique_ptr<Slot[]> m_pSlots;           // As many as the sizer allows at most
+        std::atomic<VmbUint32_t> m_nSlots;          // Slots with a buffer, only grown by the generator thread
+        FrameBufferSizer        m_Sizer;
+        FrameObserver *         m_pObserver;
+        std::thread             m_Generator;
+        std::atomic<bool>       m_bRunning;
+        std::atomic<VmbUint64_t> m_nStarved;
+        VmbUint64_t             m_nRandomState;     // xorshift state, only touched by the generator thread
+        ReconnectMonitor        m_Reconnects;
+};
+
+}} // namespace AVT::VmbAPI
+
+#endif
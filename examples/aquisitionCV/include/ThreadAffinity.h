@@ -0,0 +1,47 @@
+#ifndef AVT_VMBAPI_EXAMPLES_THREADAFFINITY
+#define AVT_VMBAPI_EXAMPLES_THREADAFFINITY
+
+#include <vector>
+#include <thread>
+#include <pthread.h>
+#include <sched.h>
+
+namespace AVT {
+namespace VmbAPI {
+
+/**
+ * @brief Restricts a thread to the given CPUs, an empty list leaves it unrestricted
+ *
+ * @return false if the system refused, e.g. for a CPU that does not exist
+ */
+inline bool SetThreadAffinity( pthread_t Thread, const std::vector<unsigned int> &Cpus )
+{
+    if( Cpus.empty() )
+    {
+        return true;
+    }
+    cpu_set_t set;
+    CPU_ZERO( &set );
+    for( size_t i = 0; i < Cpus.size(); ++i )
+    {
+        if( Cpus[i] < CPU_SETSIZE )
+        {
+            CPU_SET( Cpus[i], &set );
+        }
+    }
+    return 0 == pthread_setaffinity_np( Thread, sizeof( set ), &set );
+}
+
+inline bool SetThreadAffinity( std::thread &Thread, const std::vector<unsigned int> &Cpus )
+{
+    return SetThreadAffinity( Thread.native_handle(), Cpus );
+}
+
+inline bool SetCurrentThreadAffinity( const std::vector<unsigned int> &Cpus )
+{
+    return SetThreadAffinity( pthread_self(), Cpus );
+}
+
+}} // namespace AVT::VmbAPI
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef AVT_VMBAPI_EXAMPLES_THREADPOOL
+#define AVT_VMBAPI_EXAMPLES_THREADPOOL
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+
+#include "VimbaCPP/Include/VimbaCPP.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+/**
+ * @brief A fixed set of threads running the iterations of a parallel loop.
+ * The calling thread takes part in the loop, so a pool of one thread runs everything inline
+ */
+class ThreadPool
+{
+    public:
+        /**
+         * @param nThreads Threads the loops are spread over, the caller included, 0 for one per core
+         */
+        explicit ThreadPool( unsigned int nThreads );
+        ~ThreadPool();
+
+        unsigned int    GetThreadCount() const;
+
+        /**
+         * @brief Calls Task( i ) for every i below nTasks and returns when all calls returned.
+         * Only one Run at a time, Task must not call Run itself
+         */
+        void            Run( size_t nTasks, const std::function<void( size_t )> &Task );
+
+    private:
+        ThreadPool( const ThreadPool& );
+        ThreadPool& operator=( const ThreadPool& );
+
+        void            WorkerLoop();
+        void            RunTasks();
+
+        std::vector<std::thread>                m_Workers;
+        std::mutex                              m_Mutex;
+        std::condition_variable                 m_StartCondition;   // Signalled when a loop starts or the pool shuts down
+        std::condition_variable                 m_DoneCondition;    // Signalled when the last worker left a loop
+        const std::function<void( size_t )> *   m_pTask;
+        size_t                                  m_nTasks;
+        std::atomic<size_t>                     m_nNextTask;
+        VmbUint64_t                             m_nGeneration;      // Counts the loops so a worker joins each one once
+        unsigned int                            m_nBusyWorkers;
+        bool                                    m_bStopping;
+};
+
+}} // namespace AVT::VmbAPI
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef AVT_VMBAPI_EXAMPLES_UNPACK
+#define AVT_VMBAPI_EXAMPLES_UNPACK
+
+#include "VimbaCPP/Include/VimbaCPP.h"
+#include "SimdLevel.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+/**
+ * @brief Significant bits per pixel of the high bit depth mono formats the unpack functions handle:
+ * Mono10p, Mono12p and Mono12Packed as well as Mono10, Mono12, Mono14 and Mono16 in 16 bit words
+ *
+ * @return The bit depth or 0 if the format is not handled
+ */
+VmbUint32_t UnpackBitDepth( VmbPixelFormatType eFormat );
+
+/**
+ * @brief Unpacks a high bit depth mono image to one 16 bit word per pixel, the value keeps its bit depth.
+ * Packed formats are one continuous bit stream, row ends need not fall on byte boundaries
+ *
+ * @param pSource       First byte of the image
+ * @param nPixelCount   Pixels in the image, width times height
+ * @param eFormat       One of the formats UnpackBitDepth knows
+ * @param pDestination  nPixelCount words
+ * @param eSimd         Instruction set to use, levels the CPU lacks fall back to the best available one
+ *
+ * @return VmbErrorBadParameter for NULL buffers, VmbErrorNotSupported for other formats
+ */
+VmbErrorType UnpackMono16( const VmbUchar_t *pSource, VmbUint32_t nPixelCount, VmbPixelFormatType eFormat,
+                           VmbUint16_t *pDestination, SimdLevel eSimd = SimdLevel_Auto );
+
+/**
+ * @brief Unpacks a high bit depth mono image to 8 bit.
+ * Without a table the 8 most significant bits are kept, with a table every value is mapped through it
+ *
+ * @param pLut          NULL or a table of 2^bit depth entries, e.g. a gamma or window/level curve
+ *
+ * @see UnpackMono16 for the other parameters
+ */
+VmbErrorType UnpackMono8( const VmbUchar_t *pSource, VmbUint32_t nPixelCount, VmbPixelFormatType eFormat,
+                          VmbUchar_t *pDestination, const VmbUchar_t *pLut = NULL, SimdLevel eSimd = SimdLevel_Auto );
+
+}} // namespace AVT::VmbAPI
+
+#endif
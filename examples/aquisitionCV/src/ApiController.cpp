@@ -1,7 +1,12 @@
 #include <sstream>
+#include <cctype>
 #include <iostream>
+#include <thread>
 
 #include "ApiController.h"
+#include "CameraFrameSource.h"
+#include "SyntheticFrameSource.h"
+#include "PlaybackFrameSource.h"
 #include "Common/StreamSystemInfo.h"
 #include "Common/ErrorCodeToMessage.h"
 
@@ -10,13 +15,46 @@ namespace VmbAPI {
 
 #define NUM_FRAMES 3
 
+// Share of a link planned for the streams, the rest is left to resends and control traffic
+static const double BANDWIDTH_USABLE = 0.9;
+
+//
+// Gets the file a camera records to, with several cameras the camera ID goes in front of the extension
+//
+static std::string GetRecordFileName( const std::string &strFileName, const std::string &strCameraID, bool bSeveralCameras )
+{
+    if( !bSeveralCameras )
+    {
+        return strFileName;
+    }
+    std::string strSuffix( "_" + strCameraID );
+    for( size_t i = 1; i < strSuffix.size(); ++i )
+    {
+        const char c = strSuffix[i];
+        if( !( isalnum( static_cast<unsigned char>( c )) || '-' == c || '.' == c ))
+        {
+            strSuffix[i] = '_';
+        }
+    }
+    const std::string::size_type nSlash = strFileName.find_last_of( '/' );
+    std::string::size_type       nDot   = strFileName.find_last_of( '.' );
+    if(     ( std::string::npos == nDot )
+        ||  ( std::string::npos != nSlash && nDot < nSlash ))
+    {
+        nDot = strFileName.size();
+    }
+    return strFileName.substr( 0, nDot ) + strSuffix + strFileName.substr( nDot );
+}
+
 ApiController::ApiController()
     // Get a reference to the Vimba singleton
     : m_system ( VimbaSystem::GetInstance() )
+    , m_pStartPreset( NULL )
 {}
 
 ApiController::~ApiController()
 {
+    StopContinuousImageAcquisition();
 }
 
 //
@@ -54,119 +92,620 @@ void ApiController::ShutDown()
 }
 
 //
-// Opens the given camera
-// Sets the maximum possible Ethernet packet size
+// Opens the given cameras, synthetic cameras or recordings if configured, each on a thread of its own
 // Adjusts the image format
-// Sets up the observer that will be notified on every incoming frame
-// Calls the API convenience function to start image acquisition
-// Closes the camera in case of failure
+// Sets the largest packet size the network carries and splits the bandwidth of every interface among
+// its cameras if configured
+// Applies the configured preset
+// Sets up one observer per camera that will be notified on every incoming frame
+// Creates the recording file of every camera if configured
+// Opens the preview windows if configured
+// Announces the frames and starts image acquisition
+// Closes a camera in case of failure, the others keep streaming
+// A camera lost while streaming is reconnected with its configuration and frames
 //
 // Parameters:
-//  [in]    Config      A configuration struct including the camera ID and other settings
+//  [in]    Config      A configuration struct including the camera IDs and other settings
 //
 // Returns:
-//  An API status code
+//  VmbErrorSuccess if at least one camera streams, else the error of the first camera
 //
 VmbErrorType ApiController::StartContinuousImageAcquisition( const ProgramConfig& Config )
 {
-    // Open the desired camera by its ID
-    VmbErrorType res = m_system.OpenCameraByID( Config.getCameraID().c_str(), VmbAccessModeFull, m_pCamera );
-    if ( VmbErrorSuccess == res )
+    if( !m_Streams.empty() )
+    {
+        StopContinuousImageAcquisition();
+        m_Streams.clear();
+    }
+
+    const std::vector<std::string> &IDs = Config.getCameraIDs();
+    if( IDs.empty() )
+    {
+        return VmbErrorBadParameter;
+    }
+    m_LastBundleStatistics = BundleStatistics();
+    m_Presets.clear();
+    m_pStartPreset = NULL;
+    if( !Config.getPresetFile().empty() )
     {
-        if ( VmbErrorSuccess == res )
+        std::string strError;
+        if( !LoadCameraPresets( Config.getPresetFile(), m_Presets, strError ))
         {
-            /**
-             * @brief La funzione estrae altezza e larghezza dell'immagine direttamente dalle informazioni della camera
-             * perchè verranno utilizzate per l'allocamento del buffer che ospiterà le vere immagini
-             */
-            res = PrepareCamera();
-            if ( VmbErrorSuccess == res )
-            {
-                // Create a frame observer for this camera (This will be wrapped in a shared_ptr so we don't delete it)
-                m_pFrameObserver = new FrameObserver( m_pCamera, Config.getFrameInfos(), Config.getColorProcessing(), Config.getRGBValue() );
-                // Start streaming
-                res = m_pCamera->StartContinuousImageAcquisition( NUM_FRAMES, IFrameObserverPtr( m_pFrameObserver ), Config.getAllocAndAnnounce() ? FrameAllocation_AllocAndAnnounceFrame : FrameAllocation_AnnounceFrame );
-            }
+            std::cout<<"Could not load presets: "<<strError<<"\n";
+            return VmbErrorBadParameter;
+        }
+        m_pStartPreset = Config.getPresetName().empty() ? &m_Presets[0] : FindCameraPreset( m_Presets, Config.getPresetName() );
+        if( NULL == m_pStartPreset )
+        {
+            std::cout<<"No preset "<<Config.getPresetName()<<" in "<<Config.getPresetFile()<<"\n";
+            return VmbErrorBadParameter;
+        }
+    }
+    m_pDisplay.reset();
+    if( Config.getPreview() )
+    {
+        std::vector<std::string> names;
+        for( size_t i = 0; i < IDs.size(); ++i )
+        {
+            names.push_back( IDs.size() > 1 ? "Streaming Vimba " + IDs[i] : std::string( "Streaming Vimba" ));
+        }
+        m_pDisplay.reset( new PreviewDisplay( names, Config.getPreviewWidth(), Config.getPreviewHeight() ));
+    }
+    if(     ( BundleMatching_Off != Config.getBundleMatching() )
+        &&  ( IDs.size() > 1 ))
+    {
+        m_pSynchronizer.reset( new FrameSynchronizer( IDs.size(), Config, m_pDisplay.get() ));
+    }
+    for( size_t i = 0; i < IDs.size(); ++i )
+    {
+        m_Streams.push_back( std::unique_ptr<CameraStream>( new CameraStream() ));
+        m_Streams.back()->CameraID  = IDs[i];
+        m_Streams.back()->Result    = VmbErrorOther;
+    }
+
+    // Opening a camera can take seconds or time out, one slow camera must not hold up the others
+    std::vector<std::thread> openers;
+    for( size_t i = 0; i < m_Streams.size(); ++i )
+    {
+        openers.push_back( std::thread( &ApiController::OpenStream, this, std::ref( *m_Streams[i] ), std::cref( Config ), i ));
+    }
+    for( size_t i = 0; i < openers.size(); ++i )
+    {
+        openers[i].join();
+    }
+
+    // The cameras sharing an interface are only known once all are open
+    if( Config.getBandwidthPlanning() )
+    {
+        PlanStreamBandwidth( Config.getLinkSpeed() );
+    }
+
+    std::vector<std::thread> starters;
+    for( size_t i = 0; i < m_Streams.size(); ++i )
+    {
+        if( VmbErrorSuccess == m_Streams[i]->Result )
+        {
+            starters.push_back( std::thread( &ApiController::StartStream, this, std::ref( *m_Streams[i] ), std::cref( Config ), i ));
+        }
+    }
+    for( size_t i = 0; i < starters.size(); ++i )
+    {
+        starters[i].join();
+    }
+    if( m_pSynchronizer )
+    {
+        // Bundles only contain the cameras that came up
+        m_pSynchronizer->Start();
+    }
+    if( m_pDisplay )
+    {
+        m_pDisplay->Start();
+    }
+
+    for( size_t i = 0; i < m_Streams.size(); ++i )
+    {
+        if( VmbErrorSuccess == m_Streams[i]->Result )
+        {
+            return VmbErrorSuccess;
         }
+    }
+    return m_Streams[0]->Result;
+}
+
+//
+// Opens one camera and creates its recording file, runs concurrently for all cameras
+//
+// Parameters:
+//  [in,out]    Stream      The camera to open, its result is set
+//  [in]        Config      A configuration struct with the settings shared by all cameras
+//  [in]        nStream     Index of the camera, selects its CPU affinity and the NUMA node of its frame buffers
+//
+void ApiController::OpenStream( CameraStream &Stream, const ProgramConfig &Config, size_t nStream )
+{
+    FrameBufferConfig Buffers = Config.getFrameBuffers();
+    Buffers.Cpus = Config.getCpuAffinity( nStream );
+    // The fixed count, or the least the sizer starts with. Frames waiting for their partners must not starve the camera
+    const VmbUint32_t nBaseFrames = 0 != Buffers.Count ? Buffers.Count : NUM_FRAMES;
+    const VmbUint32_t nFrames = m_pSynchronizer ? nBaseFrames + FrameSynchronizer::HELD_FRAMES : nBaseFrames;
+    if( Config.getUsePlayback() )
+    {
+        // The camera ID names the recording
+        Stream.pSource.reset( new PlaybackFrameSource( Stream.CameraID, Config.getPlayback(), nFrames, Config.getCodecThreads() ));
+    }
+    else if( Config.getUseSyntheticCamera() )
+    {
+        Stream.pSource.reset( new SyntheticFrameSource( Stream.CameraID, Config.getSyntheticCamera(), nFrames, Config.getGeometry(), Config.getRGBValue(), Buffers ));
+    }
+    else
+    {
+        Stream.pSource.reset( new CameraFrameSource( m_system, Stream.CameraID, nFrames, Config.getAllocAndAnnounce() ? FrameAllocation_AllocAndAnnounceFrame : FrameAllocation_AnnounceFrame,
+                                                      Config.getGeometry(), Config.getRGBValue(), m_pStartPreset, Buffers ));
+    }
 
+    VmbErrorType res = Stream.pSource->Open();
+    if(     ( VmbErrorSuccess == res )
+        &&  ( !Config.getRecordFile().empty() ))
+    {
+        Stream.pRecorder.reset( new FrameRecorder( Config.getCompression(), Config.getCodecThreads() ));
+        res = Stream.pRecorder->Open( GetRecordFileName( Config.getRecordFile(), Stream.CameraID, m_Streams.size() > 1 ), Stream.pSource->GetID(), Stream.pSource->GetTimestampFrequency() );
         if ( VmbErrorSuccess != res )
         {
-            // If anything fails after opening the camera we close it
-            m_pCamera->Close();
+            Stream.pSource->Close();
+        }
+    }
+    // Adjusting the packet size sends test packets for a while, done here so the cameras do it concurrently
+    if(     ( VmbErrorSuccess == res )
+        &&  ( Config.getBandwidthPlanning() )
+        &&  ( NULL != Stream.pSource->GetFeatures() ))
+    {
+        Stream.bBandwidthDemand = ( VmbErrorSuccess == ReadBandwidthDemand( *Stream.pSource->GetFeatures(), Stream.Demand ));
+        Stream.Demand.InterfaceID = Stream.pSource->GetInterfaceID();
+    }
+
+    Stream.Result = res;
+    if( VmbErrorSuccess != res && m_pSynchronizer )
+    {
+        m_pSynchronizer->SetInput( nStream, NULL );
+    }
+    if ( VmbErrorSuccess != res )
+    {
+        ReleaseStream( Stream );
+    }
+}
+
+//
+// Splits the bandwidth of every interface among the opened GigE cameras on it and sets their caps
+//
+// Parameters:
+//  [in]    dLinkSpeed  Megabits per second of every interface
+//
+void ApiController::PlanStreamBandwidth( double dLinkSpeed )
+{
+    std::vector<BandwidthDemand> demands;
+    std::vector<CameraStream*> streams;
+    for( size_t i = 0; i < m_Streams.size(); ++i )
+    {
+        if(     ( VmbErrorSuccess == m_Streams[i]->Result )
+            &&  ( m_Streams[i]->bBandwidthDemand ))
+        {
+            demands.push_back( m_Streams[i]->Demand );
+            streams.push_back( m_Streams[i].get() );
+        }
+    }
+    const std::vector<BandwidthAllocation> allocations = PlanBandwidth( demands, dLinkSpeed * 1.0e6 / 8.0 * BANDWIDTH_USABLE );
+    for( size_t i = 0; i < streams.size(); ++i )
+    {
+        BandwidthAllocation allocation = allocations[i];
+        if( VmbErrorSuccess == ApplyBandwidth( *streams[i]->pSource->GetFeatures(), allocation ))
+        {
+            streams[i]->Bandwidth = allocation;
+        }
+    }
+}
+
+//
+// Starts streaming an opened camera, runs concurrently for all cameras
+//
+// Parameters:
+//  [in,out]    Stream      The camera to start, its result is set
+//  [in]        Config      A configuration struct with the settings shared by all cameras
+//  [in]        nStream     Index of the camera, selects its CPU affinity
+//
+void ApiController::StartStream( CameraStream &Stream, const ProgramConfig &Config, size_t nStream )
+{
+    if( m_pSynchronizer )
+    {
+        m_pSynchronizer->SetInput( nStream, Stream.pSource.get() );
+    }
+    // Create a frame observer for this camera
+    Stream.pFrameObserver.reset( new FrameObserver( *Stream.pSource, Config, Config.getCpuAffinity( nStream ), m_pSynchronizer.get(), nStream, Stream.pRecorder.get(), m_pDisplay.get() ));
+    // Start streaming
+    VmbErrorType res = Stream.pSource->StartAcquisition( Stream.pFrameObserver.get() );
+
+    if ( VmbErrorSuccess != res )
+    {
+        // If anything fails after opening the camera we close it
+        Stream.pFrameObserver->Stop();
+        Stream.pSource->Close();
+    }
+
+    Stream.Result = res;
+    if( VmbErrorSuccess != res && m_pSynchronizer )
+    {
+        m_pSynchronizer->SetInput( nStream, NULL );
+    }
+    if ( VmbErrorSuccess != res )
+    {
+        ReleaseStream( Stream );
+    }
+}
+
+//
+// Stops image acquisition of all cameras
+// Closes the cameras
+//
+// Returns:
+//  An API status code, the first error of any camera
+//
+VmbErrorType ApiController::StopContinuousImageAcquisition()
+{
+    // The synchronizer holds frames of every camera, they go back before any camera stops
+    if( m_pSynchronizer )
+    {
+        m_pSynchronizer->Stop();
+        m_LastBundleStatistics = m_pSynchronizer->GetStatistics();
+    }
+
+    bool bStreaming = false;
+    for( size_t i = 0; i < m_Streams.size(); ++i )
+    {
+        bStreaming = bStreaming || ( NULL != m_Streams[i]->pSource.get() );
+    }
+    if( !bStreaming )
+    {
+        m_pSynchronizer.reset();
+        if( m_pDisplay )
+        {
+            m_pDisplay->Stop();
         }
+        return VmbErrorInvalidCall;
     }
 
+    std::vector<VmbErrorType>   results( m_Streams.size(), VmbErrorSuccess );
+    std::vector<std::thread>    stoppers;
+    for( size_t i = 0; i < m_Streams.size(); ++i )
+    {
+        if( NULL != m_Streams[i]->pSource.get() )
+        {
+            stoppers.push_back( std::thread( [this, i, &results]() { results[i] = StopStream( *m_Streams[i] ); } ));
+        }
+    }
+    for( size_t i = 0; i < stoppers.size(); ++i )
+    {
+        stoppers[i].join();
+    }
+
+    m_pSynchronizer.reset();
+    if( m_pDisplay )
+    {
+        m_pDisplay->Stop();
+    }
+
+    for( size_t i = 0; i < results.size(); ++i )
+    {
+        if( VmbErrorSuccess != results[i] )
+        {
+            return results[i];
+        }
+    }
+    return VmbErrorSuccess;
+}
+
+//
+// Stops one camera and closes it
+//
+VmbErrorType ApiController::StopStream( CameraStream &Stream )
+{
+    // Let the workers finish and hand back every buffer before the frames get revoked
+    Stream.pFrameObserver->Stop();
+
+    // Stop streaming
+    Stream.pSource->StopAcquisition();
+
+    // Close camera
+    VmbErrorType res = Stream.pSource->Close();
+
+    // No more frames arrive, the index can be written
+    if( Stream.pRecorder )
+    {
+        const VmbErrorType resRecord = Stream.pRecorder->Close();
+        Stream.LastRecordStatistics = Stream.pRecorder->GetStatistics();
+        if( VmbErrorSuccess == res )
+        {
+            res = resRecord;
+        }
+    }
+
+    // Keep the counters for GetQueueStatistics
+    Stream.LastStatistics = Stream.pFrameObserver->GetStatistics();
+    Stream.LastPipelineStatistics = Stream.pFrameObserver->GetPipelineStatistics();
+    Stream.LastReconnectStatistics = Stream.pSource->GetReconnectStatistics();
+    Stream.LastBufferStatistics = Stream.pSource->GetBufferStatistics();
+    ReleaseStream( Stream );
     return res;
 }
 
-/**setting a feature to maximum value that is a multiple of 2 and a multiple of the increment*/
-VmbErrorType SetIntFeatureValueModulo2( const CameraPtr &pCamera, const char* const& Name )
+//
+// Deletes observer and source of a stream
+//
+void ApiController::ReleaseStream( CameraStream &Stream )
 {
-    VmbErrorType    result;
-    FeaturePtr      feature;
-    VmbInt64_t      value_min = 0;
-    VmbInt64_t      value_max = 0;
-    VmbInt64_t      value_increment = 0;
+    Stream.pFrameObserver.reset();
+    Stream.pRecorder.reset();
+    Stream.pSource.reset();
+}
 
-    result = SP_ACCESS( pCamera )->GetFeatureByName( Name, feature );
-    if( VmbErrorSuccess != result )
+//
+// Applies a preset of the file given at start to all streaming cameras, each on a thread of its own
+// A preset changing the image format of a camera is rejected for it, its buffers would no longer fit
+//
+// Parameters:
+//  [in]    strName     Name of the preset
+//  [out]   Reports     One per camera of the last start, VmbErrorInvalidCall for cameras not streaming,
+//                      VmbErrorInvalidAccess with the features listed for a change of the image format
+//
+// Returns:
+//  VmbErrorNotFound if there is no such preset, else the first error of any camera
+//
+VmbErrorType ApiController::ApplyPreset( const std::string &strName, std::vector<PresetReport> &Reports )
+{
+    Reports.assign( m_Streams.size(), PresetReport() );
+    const CameraPreset *pPreset = FindCameraPreset( m_Presets, strName );
+    if( NULL == pPreset )
+    {
+        return VmbErrorNotFound;
+    }
+    std::vector<std::thread> appliers;
+    for( size_t i = 0; i < m_Streams.size(); ++i )
+    {
+        IFrameSource *pSource = m_Streams[i]->pSource.get();
+        if(     ( NULL == pSource )
+            ||  ( NULL == pSource->GetFeatures() ))
+        {
+            Reports[i].Result = VmbErrorInvalidCall;
+            continue;
+        }
+        appliers.push_back( std::thread( [pSource, pPreset, i, &Reports]() { ApplyCameraPreset( *pSource->GetFeatures(), *pPreset, Reports[i], true ); } ));
+    }
+    for( size_t i = 0; i < appliers.size(); ++i )
     {
-        return result;
+        appliers[i].join();
     }
+    for( size_t i = 0; i < Reports.size(); ++i )
+    {
+        if(     ( VmbErrorSuccess != Reports[i].Result )
+            &&  ( VmbErrorInvalidCall != Reports[i].Result ))
+        {
+            return Reports[i].Result;
+        }
+    }
+    return VmbErrorSuccess;
+}
 
-    result = SP_ACCESS( feature )->GetRange( value_min, value_max );
-    if( VmbErrorSuccess != result )
+size_t ApiController::GetStreamCount() const
+{
+    return m_Streams.size();
+}
+
+std::string ApiController::GetStreamCameraID( size_t nStream ) const
+{
+    return nStream < m_Streams.size() ? m_Streams[ nStream ]->CameraID : std::string();
+}
+
+VmbErrorType ApiController::GetStreamResult( size_t nStream ) const
+{
+    return nStream < m_Streams.size() ? m_Streams[ nStream ]->Result : VmbErrorBadParameter;
+}
+
+//
+// Gets the hand-off queue counters of one camera
+//
+// Returns:
+//  Received, processed, overflowed and incomplete frames plus queue depth
+//
+FrameQueueStatistics ApiController::GetQueueStatistics( size_t nStream ) const
+{
+    if( nStream >= m_Streams.size() )
     {
-        return result;
+        return FrameQueueStatistics();
     }
+    const CameraStream &Stream = *m_Streams[ nStream ];
+    if( NULL == Stream.pFrameObserver.get() )
+    {
+        return Stream.LastStatistics;
+    }
+    return Stream.pFrameObserver->GetStatistics();
+}
 
-    result = SP_ACCESS( feature )->GetIncrement( value_increment );
-    if( VmbErrorSuccess != result )
+//
+// Gets the hand-off queue counters summed over all cameras
+//
+// Returns:
+//  Received, processed, overflowed and incomplete frames plus queue depth, the highest depth of any camera
+//
+FrameQueueStatistics ApiController::GetQueueStatistics() const
+{
+    FrameQueueStatistics total;
+    for( size_t i = 0; i < m_Streams.size(); ++i )
     {
-        return result;
+        const FrameQueueStatistics stats = GetQueueStatistics( i );
+        total.Received          += stats.Received;
+        total.Processed         += stats.Processed;
+        total.ProcessedBytes    += stats.ProcessedBytes;
+        total.Overflows         += stats.Overflows;
+        total.Incomplete        += stats.Incomplete;
+        total.QueueDepth        += stats.QueueDepth;
+        total.QueueCapacity     += stats.QueueCapacity;
+        if( stats.MaxQueueDepth > total.MaxQueueDepth )
+        {
+            total.MaxQueueDepth = stats.MaxQueueDepth;
+        }
     }
+    return total;
+}
 
-    value_max = value_max - ( value_max % value_increment);
-    if( value_max % 2 != 0)
+//
+// Gets the counters of the recording of one camera
+//
+// Returns:
+//  Recorded and dropped frames and bytes written, all 0 without recording
+//
+RecordStatistics ApiController::GetRecordStatistics( size_t nStream ) const
+{
+    if( nStream >= m_Streams.size() )
+    {
+        return RecordStatistics();
+    }
+    const CameraStream &Stream = *m_Streams[ nStream ];
+    if( NULL == Stream.pRecorder.get() )
     {
-        value_max -= value_increment;
+        return Stream.LastRecordStatistics;
     }
+    return Stream.pRecorder->GetStatistics();
+}
 
-    result = SP_ACCESS( feature )->SetValue ( value_max );
-    return result;
+//
+// Gets the counters of the frame bundling across cameras
+//
+// Returns:
+//  Processed bundles, unmatched, late and dropped frames, all 0 without bundling
+//
+BundleStatistics ApiController::GetBundleStatistics() const
+{
+    if( m_pSynchronizer )
+    {
+        return m_pSynchronizer->GetStatistics();
+    }
+    return m_LastBundleStatistics;
 }
 
-/**prepare camera so that the delivered image will not fail in image transform*/
-VmbErrorType ApiController::PrepareCamera()
+PreviewStatistics ApiController::GetPreviewStatistics( size_t nStream ) const
+{
+    return m_pDisplay ? m_pDisplay->GetStatistics( nStream ) : PreviewStatistics();
+}
+
+//
+// Gets the counters of the processing pipeline of one camera
+//
+// Returns:
+//  Frames pushed and completed and the counters of every stage, empty without pipeline
+//
+PipelineStatistics ApiController::GetPipelineStatistics( size_t nStream ) const
 {
-    VmbErrorType result;
-    result = SetIntFeatureValueModulo2( m_pCamera, "Width" );
-    if( VmbErrorSuccess != result )
+    if( nStream >= m_Streams.size() )
     {
-        return result;
+        return PipelineStatistics();
     }
-    result = SetIntFeatureValueModulo2( m_pCamera, "Height" );
-    if( VmbErrorSuccess != result )
+    const CameraStream &Stream = *m_Streams[ nStream ];
+    if( NULL == Stream.pFrameObserver.get() )
     {
-        return result;
+        return Stream.LastPipelineStatistics;
     }
-    return result;
+    return Stream.pFrameObserver->GetPipelineStatistics();
 }
 
 //
-// Calls the API convenience function to stop image acquisition
-// Closes the camera
+// Gets the outages of one camera
 //
 // Returns:
-//  An API status code
+//  Losses, reconnects and the time to the first frame after reconnecting, all 0 for a camera never lost
 //
-VmbErrorType ApiController::StopContinuousImageAcquisition()
+ReconnectStatistics ApiController::GetReconnectStatistics( size_t nStream ) const
 {
-    // Stop streaming
-    m_pCamera->StopContinuousImageAcquisition();
+    if( nStream >= m_Streams.size() )
+    {
+        return ReconnectStatistics();
+    }
+    const CameraStream &Stream = *m_Streams[ nStream ];
+    if( NULL == Stream.pSource.get() )
+    {
+        return Stream.LastReconnectStatistics;
+    }
+    return Stream.pSource->GetReconnectStatistics();
+}
 
-    // Close camera
-    return  m_pCamera->Close();
+//
+// Gets the frame buffers of one camera
+//
+// Returns:
+//  Frames announced at start and now, the growths and the hold times they were sized for
+//
+BufferDepthStatistics ApiController::GetBufferStatistics( size_t nStream ) const
+{
+    if( nStream >= m_Streams.size() )
+    {
+        return BufferDepthStatistics();
+    }
+    const CameraStream &Stream = *m_Streams[ nStream ];
+    if( NULL == Stream.pSource.get() )
+    {
+        return Stream.LastBufferStatistics;
+    }
+    return Stream.pSource->GetBufferStatistics();
+}
+
+//
+// Gets the bandwidth planned for one camera
+//
+// Returns:
+//  Cap and planned frame rate, all 0 without planning or for cameras not on a network
+//
+BandwidthAllocation ApiController::GetBandwidthPlan( size_t nStream ) const
+{
+    return nStream < m_Streams.size() ? m_Streams[ nStream ]->Bandwidth : BandwidthAllocation();
+}
+
+//
+// Finds the cameras to open through the camera inventory and its cache
+//
+// Parameters:
+//  [in]    nCount      The number of cameras to take if no IDs are given
+//  [in,out] IDs        The camera IDs or serial numbers given, receives the IDs to open
+//
+// Returns:
+//  VmbErrorNotFound if no camera is found
+//
+VmbErrorType ApiController::FindCameras( size_t nCount, std::vector<std::string> &IDs )
+{
+    CameraInventory inventory( m_system, CameraInventory::GetDefaultCacheFile() );
+    if( IDs.empty() )
+    {
+        VmbErrorType res = inventory.Validate( nCount );
+        if( VmbErrorSuccess != res )
+        {
+            return res;
+        }
+        const std::vector<CameraRecord> &cameras = inventory.GetCameras();
+        for( size_t i = 0; i < cameras.size() && i < nCount; ++i )
+        {
+            IDs.push_back( cameras[i].ID );
+        }
+        return IDs.empty() ? VmbErrorNotFound : VmbErrorSuccess;
+    }
+
+    // Opening the cameras checks them anyway, the cache only translates serial numbers
+    if( VmbErrorSuccess == inventory.LoadCache() )
+    {
+        for( size_t i = 0; i < IDs.size(); ++i )
+        {
+            const CameraRecord *pRecord = inventory.Find( IDs[i] );
+            if( NULL != pRecord )
+            {
+                IDs[i] = pRecord->ID;
+            }
+        }
+    }
+    return VmbErrorSuccess;
 }
 
 //
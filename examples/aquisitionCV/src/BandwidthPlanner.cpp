@@ -0,0 +1,122 @@
+#include <cmath>
+#include <algorithm>
+#include <limits>
+
+#include "BandwidthPlanner.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+static const double GVSP_HEADER_BYTES       = 20 + 8 + 8;           // IP, UDP and GVSP header, counted in the packet size
+static const double ETHERNET_OVERHEAD_BYTES = 14 + 4 + 8 + 12;      // Ethernet header, FCS, preamble and inter-frame gap
+static const double LEADER_TRAILER_BYTES    = 2 * ( 20 + 8 + 8 + 48 + 14 + 4 + 8 + 12 );
+static const double RESEND_HEADROOM         = 1.05;                 // On top of the demand, for resent packets
+
+double GetWireBytesPerFrame( VmbInt64_t nPayloadSize, VmbInt64_t nPacketSize )
+{
+    const double dPacketPayload = std::max( 1.0, static_cast<double>( nPacketSize ) - GVSP_HEADER_BYTES );
+    const double dPackets       = std::ceil( static_cast<double>( nPayloadSize ) / dPacketPayload );
+    return dPackets * ( static_cast<double>( nPacketSize ) + ETHERNET_OVERHEAD_BYTES ) + LEADER_TRAILER_BYTES;
+}
+
+/**
+ * @brief The frame rate a cap allows, no more than the camera is set to
+ */
+static double GetPlannedFrameRate( const BandwidthAllocation &Allocation )
+{
+    if( Allocation.WireBytesPerFrame <= 0.0 )
+    {
+        return 0.0;
+    }
+    const double dRate = Allocation.CapBytesPerSecond / Allocation.WireBytesPerFrame;
+    return Allocation.DemandBytesPerSecond > 0.0 ? std::min( dRate, Allocation.DemandBytesPerSecond / Allocation.WireBytesPerFrame ) : dRate;
+}
+
+std::vector<BandwidthAllocation> PlanBandwidth( const std::vector<BandwidthDemand> &Demands, double dInterfaceBytesPerSecond )
+{
+    std::vector<BandwidthAllocation> allocations( Demands.size() );
+    std::vector<double> wanted( Demands.size() );
+    for( size_t i = 0; i < Demands.size(); ++i )
+    {
+        BandwidthAllocation &allocation = allocations[i];
+        allocation.WireBytesPerFrame    = GetWireBytesPerFrame( Demands[i].PayloadSize, Demands[i].PacketSize );
+        allocation.DemandBytesPerSecond = Demands[i].FrameRate > 0.0 ? allocation.WireBytesPerFrame * Demands[i].FrameRate : 0.0;
+        wanted[i] = allocation.DemandBytesPerSecond > 0.0 ? allocation.DemandBytesPerSecond * RESEND_HEADROOM : std::numeric_limits<double>::infinity();
+    }
+
+    std::vector<bool> bPlanned( Demands.size(), false );
+    for( size_t i = 0; i < Demands.size(); ++i )
+    {
+        if( bPlanned[i] )
+        {
+            continue;
+        }
+        std::vector<size_t> members;
+        for( size_t j = i; j < Demands.size(); ++j )
+        {
+            if( Demands[j].InterfaceID == Demands[i].InterfaceID )
+            {
+                members.push_back( j );
+                bPlanned[j] = true;
+            }
+        }
+        // Filled in ascending demand, what a small camera leaves is shared by the larger ones
+        std::stable_sort( members.begin(), members.end(), [&wanted]( size_t a, size_t b ) { return wanted[a] < wanted[b]; } );
+        double dLeft = dInterfaceBytesPerSecond;
+        for( size_t j = 0; j < members.size(); ++j )
+        {
+            BandwidthAllocation &allocation = allocations[ members[j] ];
+            allocation.CapBytesPerSecond    = std::min( wanted[ members[j] ], dLeft / ( members.size() - j ));
+            allocation.PlannedFrameRate     = GetPlannedFrameRate( allocation );
+            dLeft -= allocation.CapBytesPerSecond;
+        }
+    }
+    return allocations;
+}
+
+VmbErrorType ReadBandwidthDemand( ICameraFeatures &Features, BandwidthDemand &Demand )
+{
+    // Older firmware lacks the command, the configured packet size is used then
+    Features.RunCommand( "GVSPAdjustPacketSize" );
+    VmbErrorType res = Features.GetInt( "GVSPPacketSize", Demand.PacketSize );
+    if( VmbErrorNotFound == res )
+    {
+        res = Features.GetInt( "GevSCPSPacketSize", Demand.PacketSize );
+    }
+    if( VmbErrorSuccess == res )
+    {
+        res = Features.GetInt( "PayloadSize", Demand.PayloadSize );
+    }
+    if(     ( VmbErrorSuccess == res )
+        &&  ( VmbErrorSuccess != Features.GetFloat( "AcquisitionFrameRateAbs", Demand.FrameRate ))
+        &&  ( VmbErrorSuccess != Features.GetFloat( "AcquisitionFrameRate", Demand.FrameRate )))
+    {
+        Demand.FrameRate = 0.0;
+    }
+    return res;
+}
+
+VmbErrorType ApplyBandwidth( ICameraFeatures &Features, BandwidthAllocation &Allocation )
+{
+    VmbInt64_t nMin         = 0;
+    VmbInt64_t nMax         = 0;
+    VmbInt64_t nIncrement   = 1;
+    VmbErrorType res = Features.GetIntRange( "StreamBytesPerSecond", nMin, nMax, nIncrement );
+    if( VmbErrorSuccess != res )
+    {
+        return res;
+    }
+    // Rounded down, the caps of an interface must not add up to more than it carries
+    VmbInt64_t nCap = static_cast<VmbInt64_t>( std::min( Allocation.CapBytesPerSecond, static_cast<double>( nMax )));
+    nCap = std::max( nMin, nCap );
+    nCap = nMin + ( nCap - nMin ) / nIncrement * nIncrement;
+    res = Features.SetInt( "StreamBytesPerSecond", nCap );
+    if( VmbErrorSuccess == res )
+    {
+        Allocation.CapBytesPerSecond    = static_cast<double>( nCap );
+        Allocation.PlannedFrameRate     = GetPlannedFrameRate( Allocation );
+    }
+    return res;
+}
+
+}} // namespace AVT::VmbAPI
@@ -0,0 +1,213 @@
+#include <iostream>
+
+#include "CameraDevice.h"
+#include "HostClock.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+/**
+ * @brief Vimba observer translating a frame of the camera into a SourceFrame for the listener.
+ * There is one per frame, it tells the listener the slot of its frame
+ */
+class CameraFrameObserver : virtual public IFrameObserver
+{
+    public:
+        CameraFrameObserver( CameraPtr pCamera, ICameraDeviceListener &Listener, VmbUint32_t nSlot )
+            :   IFrameObserver( pCamera )
+            ,   m_Listener( Listener )
+            ,   m_nSlot( nSlot )
+        {}
+
+        /**
+         * @brief Reads the frame metadata once and passes the frame on
+         *
+         * @param pFrame The frame returned from the API
+         */
+        virtual void FrameReceived( const FramePtr pFrame )
+        {
+            const VmbUint64_t nReceiveTime = GetHostTime();
+            if( SP_ISNULL( pFrame ))
+            {
+                std::cout <<" frame pointer NULL\n";
+                return;
+            }
+
+            SourceFrame frame;
+            frame.pFrame = pFrame;
+            frame.nSlot = m_nSlot;
+            frame.ReceiveTime = nReceiveTime;
+            Frame &f = *SP_ACCESS( pFrame );
+            if( VmbErrorSuccess != f.GetImage( frame.pBuffer ))
+            {
+                frame.pBuffer = NULL;
+            }
+            f.GetImageSize( frame.ImageSize );
+            f.GetWidth( frame.Width );
+            f.GetHeight( frame.Height );
+            f.GetOffsetX( frame.OffsetX );
+            f.GetOffsetY( frame.OffsetY );
+            frame.bPixelFormatValid     = ( VmbErrorSuccess == f.GetPixelFormat( frame.PixelFormat ));
+            frame.bFrameIDValid         = ( VmbErrorSuccess == f.GetFrameID( frame.FrameID ));
+            f.GetTimestamp( frame.Timestamp );
+            frame.bReceiveStatusValid   = ( VmbErrorSuccess == f.GetReceiveStatus( frame.ReceiveStatus ));
+
+            m_Listener.FrameReceived( frame );
+        }
+
+    private:
+        ICameraDeviceListener & m_Listener;
+        const VmbUint32_t       m_nSlot;
+};
+
+/**
+ * @brief Tells the listener when its camera leaves or joins the camera list
+ */
+class CameraListObserver : public ICameraListObserver
+{
+    public:
+        CameraListObserver( const std::string &strCameraID, ICameraDeviceListener &Listener )
+            :   m_strCameraID( strCameraID )
+            ,   m_Listener( Listener )
+        {}
+
+        virtual void CameraListChanged( CameraPtr pCamera, UpdateTriggerType eReason )
+        {
+            std::string strID;
+            if(     ( !SP_ISNULL( pCamera ))
+                &&  ( VmbErrorSuccess == SP_ACCESS( pCamera )->GetID( strID ))
+                &&  ( strID == m_strCameraID ))
+            {
+                m_Listener.CameraListChanged( eReason );
+            }
+        }
+
+    private:
+        const std::string       m_strCameraID;
+        ICameraDeviceListener & m_Listener;
+};
+
+static VmbErrorType RunCameraCommand( const CameraPtr &pCamera, const char *pName )
+{
+    FeaturePtr pFeature;
+    VmbErrorType res = SP_ACCESS( pCamera )->GetFeatureByName( pName, pFeature );
+    if( VmbErrorSuccess == res )
+    {
+        res = SP_ACCESS( pFeature )->RunCommand();
+    }
+    return res;
+}
+
+VimbaCameraDevice::VimbaCameraDevice( VimbaSystem &system, const std::string &strCameraID )
+    :   m_system( system )
+    ,   m_strCameraID( strCameraID )
+    ,   m_pListener( NULL )
+{}
+
+VimbaCameraDevice::~VimbaCameraDevice()
+{
+    SetListener( NULL );
+}
+
+VmbErrorType VimbaCameraDevice::Open()
+{
+    CameraPtr pCamera;
+    const VmbErrorType res = m_system.OpenCameraByID( m_strCameraID.c_str(), VmbAccessModeFull, pCamera );
+    if( VmbErrorSuccess == res )
+    {
+        m_pCamera = pCamera;
+        m_pFeatures.reset( new VimbaCameraFeatures( m_pCamera ));
+    }
+    return res;
+}
+
+VmbErrorType VimbaCameraDevice::Close()
+{
+    m_pFeatures.reset();
+    return m_pCamera->Close();
+}
+
+ICameraFeatures* VimbaCameraDevice::GetFeatures()
+{
+    return m_pFeatures.get();
+}
+
+VmbErrorType VimbaCameraDevice::GetPayloadSize( VmbUint32_t &nPayloadSize )
+{
+    return m_pCamera->GetPayloadSize( nPayloadSize );
+}
+
+/**
+ * @brief Registers an observer knowing the slot on the frame and announces it.
+ * The frames only talk to the camera through their observers, they are replaced along with the camera
+ */
+VmbErrorType VimbaCameraDevice::AnnounceFrame( const FramePtr &pFrame, VmbUint32_t nSlot )
+{
+    if( NULL == m_pListener )
+    {
+        return VmbErrorInvalidCall;
+    }
+    SP_ACCESS( pFrame )->UnregisterObserver();
+    IFrameObserverPtr pObserver;
+    SP_SET( pObserver, new CameraFrameObserver( m_pCamera, *m_pListener, nSlot ));
+    VmbErrorType res = SP_ACCESS( pFrame )->RegisterObserver( pObserver );
+    if( VmbErrorSuccess == res )
+    {
+        res = m_pCamera->AnnounceFrame( pFrame );
+    }
+    return res;
+}
+
+VmbErrorType VimbaCameraDevice::StartCapture()
+{
+    return m_pCamera->StartCapture();
+}
+
+VmbErrorType VimbaCameraDevice::QueueFrame( const FramePtr &pFrame )
+{
+    return m_pCamera->QueueFrame( pFrame );
+}
+
+VmbErrorType VimbaCameraDevice::StartAcquisition()
+{
+    return RunCameraCommand( m_pCamera, "AcquisitionStart" );
+}
+
+void VimbaCameraDevice::EndCapture()
+{
+    RunCameraCommand( m_pCamera, "AcquisitionStop" );
+    m_pCamera->EndCapture();
+    m_pCamera->FlushQueue();
+    m_pCamera->RevokeAllFrames();
+}
+
+std::string VimbaCameraDevice::GetInterfaceID() const
+{
+    std::string strInterfaceID;
+    if(     ( SP_ISNULL( m_pCamera ))
+        ||  ( VmbErrorSuccess != SP_ACCESS( m_pCamera )->GetInterfaceID( strInterfaceID )))
+    {
+        strInterfaceID.clear();
+    }
+    return strInterfaceID;
+}
+
+/**
+ * @brief Registers a camera list observer for the new listener, replacing the one of the previous
+ */
+void VimbaCameraDevice::SetListener( ICameraDeviceListener *pListener )
+{
+    if( !SP_ISNULL( m_pListObserver ))
+    {
+        m_system.UnregisterCameraListObserver( m_pListObserver );
+        SP_RESET( m_pListObserver );
+    }
+    m_pListener = pListener;
+    if( NULL != m_pListener )
+    {
+        SP_SET( m_pListObserver, new CameraListObserver( m_strCameraID, *m_pListener ));
+        m_system.RegisterCameraListObserver( m_pListObserver );
+    }
+}
+
+}} // namespace AVT::VmbAPI
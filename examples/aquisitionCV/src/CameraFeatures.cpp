@@ -0,0 +1,475 @@
+#include <chrono>
+#include <thread>
+
+#include "CameraFeatures.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+/**
+ * @brief Vimba observer passing the change notifications of every feature on to the registry
+ */
+class VimbaCameraFeatures::ChangeObserver : public IFeatureObserver
+{
+    public:
+        explicit ChangeObserver( VimbaCameraFeatures &Features )
+            :   m_Features( Features )
+        {}
+
+        virtual void FeatureChanged( const FeaturePtr &pFeature )
+        {
+            m_Features.FeatureChanged( pFeature );
+        }
+
+    private:
+        VimbaCameraFeatures &m_Features;
+};
+
+/**
+ * @brief Resolves every feature of the camera, then registers for their changes. Vimba may call
+ * FeatureChanged as soon as the first observer is registered, so the map must be complete by then
+ */
+VimbaCameraFeatures::VimbaCameraFeatures( const CameraPtr &pCamera )
+    :   m_pCamera( pCamera )
+    ,   m_pObserver( new ChangeObserver( *this ))
+{
+    FeaturePtrVector features;
+    if( VmbErrorSuccess != SP_ACCESS( m_pCamera )->GetFeatures( features ))
+    {
+        return;
+    }
+    m_Entries.reserve( features.size() );
+    for( size_t i = 0; i < features.size(); ++i )
+    {
+        Entry entry = Entry();
+        std::string strName;
+        entry.pFeature = features[i];
+        if(     ( VmbErrorSuccess != SP_ACCESS( entry.pFeature )->GetName( strName ))
+            ||  ( VmbErrorSuccess != SP_ACCESS( entry.pFeature )->GetDataType( entry.eType )))
+        {
+            continue;
+        }
+        VmbFeatureFlagsType eFlags = VmbFeatureFlagsNone;
+        entry.bVolatile = ( VmbErrorSuccess != SP_ACCESS( entry.pFeature )->GetFlags( eFlags )) || ( 0 != ( eFlags & VmbFeatureFlagsVolatile ));
+        m_Entries[ strName ] = entry;
+    }
+
+    for( std::unordered_map<std::string, Entry>::iterator it = m_Entries.begin(); it != m_Entries.end(); ++it )
+    {
+        // Without notifications nothing of the feature can be cached
+        if( VmbErrorSuccess != SP_ACCESS( it->second.pFeature )->RegisterObserver( m_pObserver ))
+        {
+            it->second.bVolatile = true;
+        }
+    }
+}
+
+/**
+ * @brief Unregisters from every feature before anything FeatureChanged touches goes away
+ */
+VimbaCameraFeatures::~VimbaCameraFeatures()
+{
+    for( std::unordered_map<std::string, Entry>::iterator it = m_Entries.begin(); it != m_Entries.end(); ++it )
+    {
+        SP_ACCESS( it->second.pFeature )->UnregisterObserver( m_pObserver );
+    }
+}
+
+/**
+ * @brief Looks a feature up by name
+ *
+ * @return VmbErrorNotFound if the camera lacks it, VmbErrorWrongType if it is of another type
+ */
+VmbErrorType VimbaCameraFeatures::Find( const char *pName, VmbFeatureDataType eType, Entry *&pEntry )
+{
+    const std::unordered_map<std::string, Entry>::iterator it = m_Entries.find( pName );
+    if( m_Entries.end() == it )
+    {
+        return VmbErrorNotFound;
+    }
+    if( eType != it->second.eType )
+    {
+        return VmbErrorWrongType;
+    }
+    pEntry = &it->second;
+    return VmbErrorSuccess;
+}
+
+/**
+ * @brief Called by Vimba when a feature changed, its value, range or availability may be different now
+ */
+void VimbaCameraFeatures::FeatureChanged( const FeaturePtr &pFeature )
+{
+    std::string strName;
+    if( VmbErrorSuccess != SP_ACCESS( pFeature )->GetName( strName ))
+    {
+        Invalidate();
+        return;
+    }
+    const std::unordered_map<std::string, Entry>::iterator it = m_Entries.find( strName );
+    if( m_Entries.end() != it )
+    {
+        std::lock_guard<std::mutex> lock( m_Mutex );
+        Invalidate( it->second );
+    }
+}
+
+void VimbaCameraFeatures::Invalidate()
+{
+    std::lock_guard<std::mutex> lock( m_Mutex );
+    for( std::unordered_map<std::string, Entry>::iterator it = m_Entries.begin(); it != m_Entries.end(); ++it )
+    {
+        Invalidate( it->second );
+    }
+}
+
+/**
+ * @brief Drops what is cached of one feature, called with the mutex held
+ */
+void VimbaCameraFeatures::Invalidate( Entry &entry )
+{
+    entry.bValue = false;
+    entry.bRange = false;
+    ++entry.nGeneration;
+}
+
+// Every getter serves the cache if valid. Otherwise it reads the camera without holding the mutex,
+// Vimba may call FeatureChanged from a thread of its own meanwhile, and caches the result only if
+// no change was reported during the read
+
+VmbErrorType VimbaCameraFeatures::GetInt( const char *pName, VmbInt64_t &nValue )
+{
+    Entry *pEntry = NULL;
+    VmbErrorType res = Find( pName, VmbFeatureDataInt, pEntry );
+    if( VmbErrorSuccess != res )
+    {
+        return res;
+    }
+    std::unique_lock<std::mutex> lock( m_Mutex );
+    if( pEntry->bValue )
+    {
+        nValue = pEntry->nValue;
+        return VmbErrorSuccess;
+    }
+    const unsigned int nGeneration = pEntry->nGeneration;
+    lock.unlock();
+
+    VmbInt64_t n = 0;
+    res = SP_ACCESS( pEntry->pFeature )->GetValue( n );
+    if( VmbErrorSuccess == res )
+    {
+        nValue = n;
+        lock.lock();
+        if( !pEntry->bVolatile && nGeneration == pEntry->nGeneration )
+        {
+            pEntry->nValue = n;
+            pEntry->bValue = true;
+        }
+    }
+    return res;
+}
+
+VmbErrorType VimbaCameraFeatures::GetIntRange( const char *pName, VmbInt64_t &nMin, VmbInt64_t &nMax, VmbInt64_t &nIncrement )
+{
+    Entry *pEntry = NULL;
+    VmbErrorType res = Find( pName, VmbFeatureDataInt, pEntry );
+    if( VmbErrorSuccess != res )
+    {
+        return res;
+    }
+    std::unique_lock<std::mutex> lock( m_Mutex );
+    if( pEntry->bRange )
+    {
+        nMin        = pEntry->nMin;
+        nMax        = pEntry->nMax;
+        nIncrement  = pEntry->nIncrement;
+        return VmbErrorSuccess;
+    }
+    const unsigned int nGeneration = pEntry->nGeneration;
+    lock.unlock();
+
+    res = SP_ACCESS( pEntry->pFeature )->GetRange( nMin, nMax );
+    if( VmbErrorSuccess == res )
+    {
+        // Features without increment accept every value
+        if(     ( VmbErrorSuccess != SP_ACCESS( pEntry->pFeature )->GetIncrement( nIncrement ))
+            ||  ( nIncrement <= 0 ))
+        {
+            nIncrement = 1;
+        }
+        lock.lock();
+        if( !pEntry->bVolatile && nGeneration == pEntry->nGeneration )
+        {
+            pEntry->nMin        = nMin;
+            pEntry->nMax        = nMax;
+            pEntry->nIncrement  = nIncrement;
+            pEntry->bRange      = true;
+        }
+    }
+    return res;
+}
+
+VmbErrorType VimbaCameraFeatures::SetInt( const char *pName, VmbInt64_t nValue )
+{
+    Entry *pEntry = NULL;
+    VmbErrorType res = Find( pName, VmbFeatureDataInt, pEntry );
+    if( VmbErrorSuccess == res )
+    {
+        res = SP_ACCESS( pEntry->pFeature )->SetValue( nValue );
+        // The camera may have adjusted the value, it is read back when needed
+        std::lock_guard<std::mutex> lock( m_Mutex );
+        Invalidate( *pEntry );
+    }
+    return res;
+}
+
+VmbErrorType VimbaCameraFeatures::GetEnum( const char *pName, std::string &strValue )
+{
+    Entry *pEntry = NULL;
+    VmbErrorType res = Find( pName, VmbFeatureDataEnum, pEntry );
+    if( VmbErrorSuccess != res )
+    {
+        return res;
+    }
+    std::unique_lock<std::mutex> lock( m_Mutex );
+    if( pEntry->bValue )
+    {
+        strValue = pEntry->strValue;
+        return VmbErrorSuccess;
+    }
+    const unsigned int nGeneration = pEntry->nGeneration;
+    lock.unlock();
+
+    std::string str;
+    res = SP_ACCESS( pEntry->pFeature )->GetValue( str );
+    if( VmbErrorSuccess == res )
+    {
+        strValue = str;
+        lock.lock();
+        if( !pEntry->bVolatile && nGeneration == pEntry->nGeneration )
+        {
+            pEntry->strValue = str;
+            pEntry->bValue = true;
+        }
+    }
+    return res;
+}
+
+VmbErrorType VimbaCameraFeatures::GetEnumEntries( const char *pName, std::vector<std::string> &Entries )
+{
+    Entries.clear();
+    Entry *pEntry = NULL;
+    VmbErrorType res = Find( pName, VmbFeatureDataEnum, pEntry );
+    if( VmbErrorSuccess != res )
+    {
+        return res;
+    }
+    std::unique_lock<std::mutex> lock( m_Mutex );
+    if( pEntry->bRange )
+    {
+        Entries = pEntry->Entries;
+        return VmbErrorSuccess;
+    }
+    const unsigned int nGeneration = pEntry->nGeneration;
+    lock.unlock();
+
+    StringVector values;
+    res = SP_ACCESS( pEntry->pFeature )->GetValues( values );
+    for( size_t i = 0; VmbErrorSuccess == res && i < values.size(); ++i )
+    {
+        // The enumeration lists every entry the camera knows, not all of them are available
+        bool bAvailable = false;
+        if(     ( VmbErrorSuccess == SP_ACCESS( pEntry->pFeature )->IsValueAvailable( values[i].c_str(), bAvailable ))
+            &&  ( bAvailable ))
+        {
+            Entries.push_back( values[i] );
+        }
+    }
+    if( VmbErrorSuccess == res )
+    {
+        lock.lock();
+        if( !pEntry->bVolatile && nGeneration == pEntry->nGeneration )
+        {
+            pEntry->Entries = Entries;
+            pEntry->bRange  = true;
+        }
+    }
+    return res;
+}
+
+VmbErrorType VimbaCameraFeatures::SetEnum( const char *pName, const std::string &strValue )
+{
+    Entry *pEntry = NULL;
+    VmbErrorType res = Find( pName, VmbFeatureDataEnum, pEntry );
+    if( VmbErrorSuccess == res )
+    {
+        res = SP_ACCESS( pEntry->pFeature )->SetValue( strValue.c_str() );
+        std::lock_guard<std::mutex> lock( m_Mutex );
+        Invalidate( *pEntry );
+    }
+    return res;
+}
+
+VmbErrorType VimbaCameraFeatures::GetFloat( const char *pName, double &dValue )
+{
+    Entry *pEntry = NULL;
+    VmbErrorType res = Find( pName, VmbFeatureDataFloat, pEntry );
+    if( VmbErrorSuccess != res )
+    {
+        return res;
+    }
+    std::unique_lock<std::mutex> lock( m_Mutex );
+    if( pEntry->bValue )
+    {
+        dValue = pEntry->dValue;
+        return VmbErrorSuccess;
+    }
+    const unsigned int nGeneration = pEntry->nGeneration;
+    lock.unlock();
+
+    double d = 0.0;
+    res = SP_ACCESS( pEntry->pFeature )->GetValue( d );
+    if( VmbErrorSuccess == res )
+    {
+        dValue = d;
+        lock.lock();
+        if( !pEntry->bVolatile && nGeneration == pEntry->nGeneration )
+        {
+            pEntry->dValue = d;
+            pEntry->bValue = true;
+        }
+    }
+    return res;
+}
+
+VmbErrorType VimbaCameraFeatures::GetFloatRange( const char *pName, double &dMin, double &dMax, double &dIncrement )
+{
+    Entry *pEntry = NULL;
+    VmbErrorType res = Find( pName, VmbFeatureDataFloat, pEntry );
+    if( VmbErrorSuccess != res )
+    {
+        return res;
+    }
+    std::unique_lock<std::mutex> lock( m_Mutex );
+    if( pEntry->bRange )
+    {
+        dMin        = pEntry->dMin;
+        dMax        = pEntry->dMax;
+        dIncrement  = pEntry->dIncrement;
+        return VmbErrorSuccess;
+    }
+    const unsigned int nGeneration = pEntry->nGeneration;
+    lock.unlock();
+
+    res = SP_ACCESS( pEntry->pFeature )->GetRange( dMin, dMax );
+    if( VmbErrorSuccess == res )
+    {
+        VmbBool_t bHasIncrement = false;
+        if(     ( VmbErrorSuccess != SP_ACCESS( pEntry->pFeature )->HasIncrement( bHasIncrement ))
+            ||  ( !bHasIncrement )
+            ||  ( VmbErrorSuccess != SP_ACCESS( pEntry->pFeature )->GetIncrement( dIncrement )))
+        {
+            dIncrement = 0.0;
+        }
+        lock.lock();
+        if( !pEntry->bVolatile && nGeneration == pEntry->nGeneration )
+        {
+            pEntry->dMin        = dMin;
+            pEntry->dMax        = dMax;
+            pEntry->dIncrement  = dIncrement;
+            pEntry->bRange      = true;
+        }
+    }
+    return res;
+}
+
+VmbErrorType VimbaCameraFeatures::SetFloat( const char *pName, double dValue )
+{
+    Entry *pEntry = NULL;
+    VmbErrorType res = Find( pName, VmbFeatureDataFloat, pEntry );
+    if( VmbErrorSuccess == res )
+    {
+        res = SP_ACCESS( pEntry->pFeature )->SetValue( dValue );
+        std::lock_guard<std::mutex> lock( m_Mutex );
+        Invalidate( *pEntry );
+    }
+    return res;
+}
+
+VmbErrorType VimbaCameraFeatures::GetBool( const char *pName, bool &bValue )
+{
+    Entry *pEntry = NULL;
+    VmbErrorType res = Find( pName, VmbFeatureDataBool, pEntry );
+    if( VmbErrorSuccess != res )
+    {
+        return res;
+    }
+    std::unique_lock<std::mutex> lock( m_Mutex );
+    if( pEntry->bValue )
+    {
+        bValue = pEntry->bBoolValue;
+        return VmbErrorSuccess;
+    }
+    const unsigned int nGeneration = pEntry->nGeneration;
+    lock.unlock();
+
+    bool b = false;
+    res = SP_ACCESS( pEntry->pFeature )->GetValue( b );
+    if( VmbErrorSuccess == res )
+    {
+        bValue = b;
+        lock.lock();
+        if( !pEntry->bVolatile && nGeneration == pEntry->nGeneration )
+        {
+            pEntry->bBoolValue  = b;
+            pEntry->bValue      = true;
+        }
+    }
+    return res;
+}
+
+VmbErrorType VimbaCameraFeatures::SetBool( const char *pName, bool bValue )
+{
+    Entry *pEntry = NULL;
+    VmbErrorType res = Find( pName, VmbFeatureDataBool, pEntry );
+    if( VmbErrorSuccess == res )
+    {
+        res = SP_ACCESS( pEntry->pFeature )->SetValue( bValue );
+        std::lock_guard<std::mutex> lock( m_Mutex );
+        Invalidate( *pEntry );
+    }
+    return res;
+}
+
+/**
+ * @brief Commands are rare and may change any feature, everything cached is dropped afterwards
+ */
+VmbErrorType VimbaCameraFeatures::RunCommand( const char *pName )
+{
+    Entry *pEntry = NULL;
+    VmbErrorType res = Find( pName, VmbFeatureDataCommand, pEntry );
+    if( VmbErrorSuccess == res )
+    {
+        res = SP_ACCESS( pEntry->pFeature )->RunCommand();
+    }
+    const std::chrono::steady_clock::time_point tEnd = std::chrono::steady_clock::now() + std::chrono::seconds( 1 );
+    bool bDone = false;
+    while(      ( VmbErrorSuccess == res )
+            &&  ( VmbErrorSuccess == ( res = SP_ACCESS( pEntry->pFeature )->IsCommandDone( bDone )))
+            &&  ( !bDone ))
+    {
+        if( std::chrono::steady_clock::now() > tEnd )
+        {
+            res = VmbErrorTimeout;
+            break;
+        }
+        std::this_thread::sleep_for( std::chrono::milliseconds( 10 ));
+    }
+    if( NULL != pEntry )
+    {
+        Invalidate();
+    }
+    return res;
+}
+
+}} // namespace AVT::VmbAPI
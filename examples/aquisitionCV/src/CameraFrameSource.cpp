@@ -0,0 +1,616 @@
+#include <iostream>
+#include <chrono>
+
+#include "CameraFrameSource.h"
+#include "FrameObserver.h"
+#include "HostClock.h"
+#include "GeometryPlanner.h"
+#include "Common/ErrorCodeToMessage.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+// A camera coming back without showing up in the camera list, e.g. after a missed event, is found by trying
+static const std::chrono::milliseconds RECONNECT_RETRY( 1000 );
+
+/**
+ * @brief Construct a new Camera Frame Source:: Camera Frame Source object
+ *
+ * @param system The started Vimba singleton
+ * @param strCameraID ID of the camera to open
+ * @param nBufferCount Number of frames announced to the camera, the least if Buffers is adaptive
+ * @param eAllocation Whether the API or the transport layer allocates the frame buffers
+ * @param Geometry The image the processing needs, the camera is set up to deliver no more
+ * @param bColor Whether the processing demosaics, decides pixel format and binning
+ * @param pPreset Applied after the geometry, replaces the default geometry if there is no request; must outlive the source
+ * @param Buffers Number of the frames, page size, locking and NUMA node of the frame buffers if the source allocates them
+ */
+CameraFrameSource::CameraFrameSource( VimbaSystem &system, const std::string &strCameraID, VmbUint32_t nBufferCount, FrameAllocationMode eAllocation,
+                                      const GeometryRequest &Geometry, bool bColor, const CameraPreset *pPreset, const FrameBufferConfig &Buffers )
+    :   CameraFrameSource( std::unique_ptr<ICameraDevice>( new VimbaCameraDevice( system, strCameraID )), strCameraID, nBufferCount, eAllocation,
+                           Geometry, bColor, pPreset, Buffers )
+{}
+
+/**
+ * @brief Construct a new Camera Frame Source:: Camera Frame Source object
+ *
+ * @param pDevice The camera to stream from
+ * @param strCameraID ID of the camera
+ * @param nBufferCount Number of frames announced to the camera, the least if Buffers is adaptive
+ * @param eAllocation Whether the API or the transport layer allocates the frame buffers
+ * @param Geometry The image the processing needs, the camera is set up to deliver no more
+ * @param bColor Whether the processing demosaics, decides pixel format and binning
+ * @param pPreset Applied after the geometry, replaces the default geometry if there is no request; must outlive the source
+ * @param Buffers Number of the frames, page size, locking and NUMA node of the frame buffers if the source allocates them
+ */
+CameraFrameSource::CameraFrameSource( std::unique_ptr<ICameraDevice> pDevice, const std::string &strCameraID, VmbUint32_t nBufferCount, FrameAllocationMode eAllocation,
+                                      const GeometryRequest &Geometry, bool bColor, const CameraPreset *pPreset, const FrameBufferConfig &Buffers )
+    :   m_pDevice( std::move( pDevice ))
+    ,   m_strCameraID( strCameraID )
+    ,   m_eAllocation( eAllocation )
+    ,   m_Geometry( Geometry )
+    ,   m_bColor( bColor )
+    ,   m_pPreset( pPreset )
+    ,   m_Buffers( Buffers )
+    ,   m_bOpen( false )
+    ,   m_nTimestampFrequency( 1000000000ULL )
+    ,   m_pObserver( NULL )
+    ,   m_nFrameSize( 0 )
+    ,   m_nSlots( 0 )
+    ,   m_nQueueing( 0 )
+    ,   m_Sizer( Buffers, nBufferCount )
+    ,   m_bConnected( false )
+    ,   m_bLost( false )
+    ,   m_bAppeared( false )
+    ,   m_bGrow( false )
+    ,   m_bStopping( false )
+{}
+
+/**
+ * @brief Opens the camera by its ID and adjusts the image format
+ * Closes the camera in case of failure
+ */
+VmbErrorType CameraFrameSource::Open()
+{
+    // Open the desired camera by its ID
+    VmbErrorType res = m_pDevice->Open();
+    if ( VmbErrorSuccess == res )
+    {
+        m_bOpen = true;
+        m_Journal.SetTarget( m_pDevice->GetFeatures() );
+        /**
+         * @brief La funzione estrae altezza e larghezza dell'immagine direttamente dalle informazioni della camera
+         * perchè verranno utilizzate per l'allocamento del buffer che ospiterà le vere immagini
+         */
+        res = PrepareCamera();
+        if ( VmbErrorSuccess == res )
+        {
+            // GigE cameras report their tick rate, USB cameras count nanoseconds
+            VmbInt64_t nFrequency = 0;
+            if(     ( VmbErrorSuccess == m_Journal.GetInt( "GevTimestampTickFrequency", nFrequency ))
+                &&  ( nFrequency > 0 ))
+            {
+                m_nTimestampFrequency = static_cast<VmbUint64_t>( nFrequency );
+            }
+        }
+        if ( VmbErrorSuccess != res )
+        {
+            // If anything fails after opening the camera we close it
+            m_Journal.SetTarget( NULL );
+            m_pDevice->Close();
+            m_bOpen = false;
+        }
+    }
+    return res;
+}
+
+/**
+ * @brief Announces the frames, starts image acquisition and watches the camera list for the camera
+ * disappearing
+ *
+ * @param pObserver Receives every frame
+ */
+VmbErrorType CameraFrameSource::StartAcquisition( FrameObserver *pObserver )
+{
+    m_pObserver = pObserver;
+    m_pDevice->SetListener( this );
+    bool bReallocated = false;
+    VmbErrorType res = StartCamera( bReallocated );
+    if( VmbErrorSuccess == res )
+    {
+        m_bStopping = false;
+        m_bGrow = false;
+        m_Reconnector = std::thread( &CameraFrameSource::ReconnectLoop, this );
+    }
+    else
+    {
+        m_pDevice->SetListener( NULL );
+    }
+    return res;
+}
+
+/**
+ * @brief Stops watching the camera list, then stops image acquisition and revokes the frames
+ */
+VmbErrorType CameraFrameSource::StopAcquisition()
+{
+    {
+        std::lock_guard<std::mutex> lock( m_Mutex );
+        m_bStopping = true;
+    }
+    m_Changed.notify_all();
+    if( m_Reconnector.joinable() )
+    {
+        m_Reconnector.join();
+    }
+    m_pDevice->SetListener( NULL );
+    bool bConnected = false;
+    {
+        std::lock_guard<std::mutex> lock( m_Mutex );
+        bConnected = m_bConnected.load();
+        m_bConnected.store( false );
+    }
+    // A camera lost and not back was released by the reconnect thread
+    if( bConnected )
+    {
+        StopCamera();
+    }
+    return VmbErrorSuccess;
+}
+
+VmbErrorType CameraFrameSource::Close()
+{
+    m_Journal.SetTarget( NULL );
+    m_RetiredPools.clear();
+    if( !m_bOpen )
+    {
+        return VmbErrorSuccess;
+    }
+    m_bOpen = false;
+    return m_pDevice->Close();
+}
+
+/**
+ * @brief Requeues the Vimba frame at the camera, or keeps it for the camera to come back.
+ * While the camera streams neither the slot nor the camera change, so the mutex is only taken without it
+ */
+VmbErrorType CameraFrameSource::QueueFrame( const SourceFrame &Frame )
+{
+    // Counted before looking at the connection, StopCamera waits for it after clearing it
+    m_nQueueing.fetch_add( 1 );
+    if( m_bConnected.load() )
+    {
+        VmbErrorType res = VmbErrorSuccess;
+        FrameSlot * const pSlot = FindSlot( Frame );
+        if( NULL != pSlot )
+        {
+            pSlot->bHeld.store( false, std::memory_order_release );
+            m_Sizer.Requeued( Frame );
+            res = m_pDevice->QueueFrame( Frame.pFrame );
+        }
+        m_nQueueing.fetch_sub( 1 );
+        return res;
+    }
+    m_nQueueing.fetch_sub( 1 );
+
+    std::lock_guard<std::mutex> lock( m_Mutex );
+    FrameSlot * const pSlot = FindSlot( Frame );
+    if( NULL == pSlot )
+    {
+        // A frame of buffers replaced on reconnect, freed with its last reference
+        return VmbErrorSuccess;
+    }
+    pSlot->bHeld.store( false, std::memory_order_release );
+    m_Sizer.Requeued( Frame );
+    return m_bConnected.load() ? m_pDevice->QueueFrame( Frame.pFrame ) : VmbErrorSuccess;
+}
+
+/**
+ * @brief The slot of a frame of the current buffers
+ *
+ * @return NULL for a frame of buffers replaced since it was delivered
+ */
+CameraFrameSource::FrameSlot* CameraFrameSource::FindSlot( const SourceFrame &Frame ) const
+{
+    if(     ( Frame.nSlot >= m_nSlots.load( std::memory_order_acquire ))
+        ||  ( !SP_ISEQUAL( m_pSlots[ Frame.nSlot ].pFrame, Frame.pFrame )))
+    {
+        return NULL;
+    }
+    return &m_pSlots[ Frame.nSlot ];
+}
+
+/**
+ * @brief Announces the frames, allocating them only if there are none yet or the camera needs larger
+ * ones, queues all frames not held by the processing and starts image acquisition
+ *
+ * @param bReallocated Set if new frame buffers were allocated
+ */
+VmbErrorType CameraFrameSource::StartCamera( bool &bReallocated )
+{
+    VmbUint32_t nPayloadSize = 0;
+    VmbErrorType res = m_pDevice->GetPayloadSize( nPayloadSize );
+    if( VmbErrorSuccess != res )
+    {
+        return res;
+    }
+    // Buffers the transport layer allocates are freed when they are revoked
+    const bool bNewSlots = 0 == m_nSlots.load() || nPayloadSize > m_nFrameSize;
+    bReallocated = bNewSlots || FrameAllocation_AllocAndAnnounceFrame == m_eAllocation;
+    if( bNewSlots )
+    {
+        double dFrameRate = 0.0;
+        if(     ( VmbErrorSuccess != m_Journal.GetFloat( "AcquisitionFrameRateAbs", dFrameRate ))
+            &&  ( VmbErrorSuccess != m_Journal.GetFloat( "AcquisitionFrameRate", dFrameRate )))
+        {
+            dFrameRate = 0.0;
+        }
+        const VmbUint32_t nFrames = m_Sizer.Plan( nPayloadSize, dFrameRate );
+        {
+            std::lock_guard<std::mutex> lock( m_Mutex );
+            for( size_t i = 0; i < m_Pools.size(); ++i )
+            {
+                m_RetiredPools.push_back( std::move( m_Pools[i] ));
+            }
+            m_Pools.clear();
+            // Not connected, no frame is handed back without the mutex
+            m_nSlots.store( 0 );
+            m_pSlots.reset( new FrameSlot[ m_Sizer.GetStatistics().Limit ] );
+            res = AddFrames( nFrames, nPayloadSize );
+            if( VmbErrorSuccess != res )
+            {
+                return res;
+            }
+            m_nSlots.store( nFrames, std::memory_order_release );
+            m_nFrameSize = nPayloadSize;
+        }
+        std::cout<<"Camera "<<m_strCameraID<<" buffers: ";
+        PrintBufferDepthStatistics( std::cout, m_Sizer.GetStatistics() );
+        std::cout<<"\n";
+        if( !m_Pools.empty() )
+        {
+            std::cout<<"Camera "<<m_strCameraID<<" frame buffers: ";
+            PrintFrameBufferInfo( std::cout, m_Pools[0]->GetInfo() );
+            std::cout<<"\n";
+        }
+    }
+    else
+    {
+        m_Sizer.Restarted();
+    }
+
+    for( VmbUint32_t i = 0; i < m_nSlots.load() && VmbErrorSuccess == res; ++i )
+    {
+        res = m_pDevice->AnnounceFrame( m_pSlots[i].pFrame, i );
+    }
+    if( VmbErrorSuccess == res )
+    {
+        res = m_pDevice->StartCapture();
+    }
+    if( VmbErrorSuccess == res )
+    {
+        std::lock_guard<std::mutex> lock( m_Mutex );
+        m_bLost = false;
+        for( VmbUint32_t i = 0; i < m_nSlots.load(); ++i )
+        {
+            if( !m_pSlots[i].bHeld.load( std::memory_order_acquire ))
+            {
+                m_pDevice->QueueFrame( m_pSlots[i].pFrame );
+            }
+        }
+        // Set last: a frame handed back from here on is queued without the mutex and must not be queued above too
+        m_bConnected.store( true );
+    }
+    if( VmbErrorSuccess == res )
+    {
+        // Armed before the start, the first frame may arrive before the command returns
+        m_Reconnects.Restarted( bReallocated );
+        res = m_pDevice->StartAcquisition();
+    }
+    if( VmbErrorSuccess != res )
+    {
+        {
+            std::lock_guard<std::mutex> lock( m_Mutex );
+            m_bConnected.store( false );
+        }
+        StopCamera();
+    }
+    return res;
+}
+
+/**
+ * @brief Stops image acquisition and revokes the frames, errors of a camera already gone are ignored.
+ * Called once m_bConnected is cleared, after the frames still being queued without the mutex
+ */
+void CameraFrameSource::StopCamera()
+{
+    while( 0 != m_nQueueing.load() )
+    {
+        std::this_thread::yield();
+    }
+    m_pDevice->EndCapture();
+}
+
+/**
+ * @brief Fills nCount slots behind the published ones with frames, in a FrameBufferPool of their own if
+ * the source allocates the buffers. The caller publishes them in m_nSlots. Called with the mutex held
+ */
+VmbErrorType CameraFrameSource::AddFrames( VmbUint32_t nCount, VmbUint32_t nPayloadSize )
+{
+    FrameBufferPool *pPool = NULL;
+    if( m_Buffers.bOwnBuffers )
+    {
+        std::unique_ptr<FrameBufferPool> pNew( new FrameBufferPool );
+        const VmbErrorType res = pNew->Allocate( nCount, nPayloadSize, m_Buffers, GetInterfaceID() );
+        if( VmbErrorSuccess != res )
+        {
+            return res;
+        }
+        pPool = pNew.get();
+        m_Pools.push_back( std::move( pNew ));
+    }
+    const VmbUint32_t nFirst = m_nSlots.load();
+    for( VmbUint32_t i = 0; i < nCount; ++i )
+    {
+        FrameSlot &slot = m_pSlots[ nFirst + i ];
+        if( NULL != pPool )
+        {
+            SP_SET( slot.pFrame, new Frame( pPool->GetBuffer( i ), nPayloadSize ));
+        }
+        else
+        {
+            SP_SET( slot.pFrame, new Frame( nPayloadSize, m_eAllocation ));
+        }
+        slot.bHeld.store( false );
+    }
+    return VmbErrorSuccess;
+}
+
+/**
+ * @brief Announces and queues the frames the sizer asks for while the camera streams.
+ * Frames that cannot be announced are dropped and the depth stays where it got
+ */
+void CameraFrameSource::GrowBuffers()
+{
+    const VmbUint32_t nTarget = m_Sizer.GetTarget();
+    VmbUint32_t nFirst = 0;
+    VmbErrorType res = VmbErrorSuccess;
+    {
+        std::lock_guard<std::mutex> lock( m_Mutex );
+        nFirst = m_nSlots.load();
+        if( nTarget <= nFirst )
+        {
+            m_Sizer.Grown( nFirst );
+            return;
+        }
+        res = AddFrames( nTarget - nFirst, m_nFrameSize );
+    }
+    // Only this thread changes the slots, the new ones are not delivered before they are queued
+    VmbUint32_t nAnnounced = nFirst;
+    while( VmbErrorSuccess == res && nAnnounced < nTarget )
+    {
+        res = m_pDevice->AnnounceFrame( m_pSlots[ nAnnounced ].pFrame, nAnnounced );
+        if( VmbErrorSuccess == res )
+        {
+            ++nAnnounced;
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock( m_Mutex );
+        for( VmbUint32_t i = nAnnounced; i < nTarget; ++i )
+        {
+            SP_RESET( m_pSlots[i].pFrame );
+        }
+        // Published before they are queued, a frame is only handed back after it was delivered
+        m_nSlots.store( nAnnounced, std::memory_order_release );
+        for( VmbUint32_t i = nFirst; i < nAnnounced && m_bConnected.load(); ++i )
+        {
+            m_pDevice->QueueFrame( m_pSlots[i].pFrame );
+        }
+    }
+    m_Sizer.Grown( nAnnounced );
+    if( VmbErrorSuccess == res )
+    {
+        std::cout<<"Camera "<<m_strCameraID<<" buffers grown to "<<nAnnounced<<" frames\n";
+    }
+    else
+    {
+        std::cout<<"Camera "<<m_strCameraID<<" buffers kept at "<<nAnnounced<<" frames, announcing more failed: "<<ErrorCodeToMessage( res )<<"\n";
+    }
+}
+
+/**
+ * @brief Reopens the camera, writes the configuration of the journal and starts it again
+ *
+ * @param bReallocated Set if new frame buffers were allocated
+ */
+VmbErrorType CameraFrameSource::Reconnect( bool &bReallocated )
+{
+    m_Reconnects.Reappeared();
+    VmbErrorType res = m_pDevice->Open();
+    if( VmbErrorSuccess != res )
+    {
+        return res;
+    }
+    m_bOpen = true;
+    PresetReport report;
+    res = m_Journal.Replay( *m_pDevice->GetFeatures(), report );
+    if( VmbErrorSuccess == res )
+    {
+        m_Journal.SetTarget( m_pDevice->GetFeatures() );
+        res = StartCamera( bReallocated );
+    }
+    if( VmbErrorSuccess == res )
+    {
+        std::cout<<"Camera "<<m_strCameraID<<" reconnected, "<<report.Written<<" features written, "<<( bReallocated ? "frames reallocated\n" : "frames reused\n" );
+    }
+    else
+    {
+        std::cout<<"Camera "<<m_strCameraID<<" reconnect failed"<<( report.Feature.empty() ? "" : " at " )<<report.Feature<<": "<<ErrorCodeToMessage( res )<<"\n";
+        m_Journal.SetTarget( NULL );
+        m_pDevice->Close();
+        m_bOpen = false;
+    }
+    return res;
+}
+
+/**
+ * @brief Waits for the camera to get lost, releases it and reconnects it once it is back, until StopAcquisition.
+ * Grows the buffers in between when the sizer asks for it
+ */
+void CameraFrameSource::ReconnectLoop()
+{
+    std::unique_lock<std::mutex> lock( m_Mutex );
+    while( !m_bStopping )
+    {
+        if(     ( m_bGrow )
+            &&  ( m_bConnected.load() ))
+        {
+            m_bGrow = false;
+            lock.unlock();
+            GrowBuffers();
+            lock.lock();
+            continue;
+        }
+        if( !m_bLost )
+        {
+            m_Changed.wait( lock );
+            continue;
+        }
+        lock.unlock();
+
+        // Frames handed back from now on wait for the new camera, the old one is released
+        std::cout<<"Camera "<<m_strCameraID<<" lost, waiting for it to come back\n";
+        m_Journal.SetTarget( NULL );
+        StopCamera();
+        m_pDevice->Close();
+        m_bOpen = false;
+
+        lock.lock();
+        while( !m_bStopping && m_bLost )
+        {
+            m_Changed.wait_for( lock, RECONNECT_RETRY, [this]() { return m_bStopping || m_bAppeared; } );
+            if( m_bStopping )
+            {
+                break;
+            }
+            m_bAppeared = false;
+            lock.unlock();
+            bool bReallocated = false;
+            Reconnect( bReallocated );
+            lock.lock();
+        }
+    }
+}
+
+/**
+ * @brief Marks the frame as held by the processing and passes it on.
+ * The device set the slot, the mutex is only taken to ask the reconnect thread for more frames
+ */
+void CameraFrameSource::FrameReceived( SourceFrame &Frame )
+{
+    m_Reconnects.Frame();
+    m_pSlots[ Frame.nSlot ].bHeld.store( true, std::memory_order_release );
+    if( m_Sizer.Delivered( Frame ))
+    {
+        {
+            std::lock_guard<std::mutex> lock( m_Mutex );
+            m_bGrow = true;
+        }
+        m_Changed.notify_all();
+    }
+    m_pObserver->FrameReceived( Frame );
+}
+
+/**
+ * @brief Called by the device when the camera list changes
+ */
+void CameraFrameSource::CameraListChanged( UpdateTriggerType eReason )
+{
+    {
+        std::lock_guard<std::mutex> lock( m_Mutex );
+        if( UpdateTriggerPluggedOut == eReason )
+        {
+            if( !m_bConnected.load() || m_bStopping )
+            {
+                return;
+            }
+            m_bConnected.store( false );
+            m_bLost = true;
+            m_Reconnects.Lost();
+        }
+        else if( UpdateTriggerPluggedIn == eReason )
+        {
+            m_bAppeared = true;
+        }
+        else
+        {
+            return;
+        }
+    }
+    m_Changed.notify_all();
+}
+
+std::string CameraFrameSource::GetID() const
+{
+    return m_strCameraID;
+}
+
+VmbUint64_t CameraFrameSource::GetTimestampFrequency() const
+{
+    return m_nTimestampFrequency;
+}
+
+ICameraFeatures* CameraFrameSource::GetFeatures()
+{
+    return &m_Journal;
+}
+
+ReconnectStatistics CameraFrameSource::GetReconnectStatistics() const
+{
+    return m_Reconnects.GetStatistics();
+}
+
+BufferDepthStatistics CameraFrameSource::GetBufferStatistics() const
+{
+    return m_Sizer.GetStatistics();
+}
+
+std::string CameraFrameSource::GetInterfaceID() const
+{
+    return m_pDevice->GetInterfaceID();
+}
+
+/**
+ * @brief Sets ROI, binning or decimation and pixel format so the camera delivers no more than the
+ * processing needs, and the image does not fail in the image transform, then applies the preset
+ */
+VmbErrorType CameraFrameSource::PrepareCamera()
+{
+    VmbErrorType result = VmbErrorSuccess;
+    // A preset brings its own format, the full sensor default would only be overwritten
+    if(     ( NULL == m_pPreset )
+        ||  ( 0 != m_Geometry.Width ))
+    {
+        GeometryPlan plan;
+        result = ApplyGeometry( m_Journal, m_Geometry, m_bColor, plan );
+        if( VmbErrorSuccess == result )
+        {
+            std::cout<<"Camera "<<m_strCameraID<<" delivers ";
+            PrintGeometryPlan( std::cout, plan );
+            std::cout<<"\n";
+        }
+    }
+    if(     ( VmbErrorSuccess == result )
+        &&  ( NULL != m_pPreset ))
+    {
+        PresetReport report;
+        result = ApplyCameraPreset( m_Journal, *m_pPreset, report );
+        std::cout<<"Camera "<<m_strCameraID<<" ";
+        PrintPresetReport( std::cout, *m_pPreset, report );
+        std::cout<<"\n";
+    }
+    return result;
+}
+
+}} // namespace AVT::VmbAPI
@@ -0,0 +1,399 @@
+#include <cstdio>
+#include <cstdlib>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <fstream>
+#include <sstream>
+#include <functional>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "CameraInventory.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+static const char * const CACHE_HEADER = "#vimba-camera-inventory 1";
+
+// Queries wait on the network, not the CPU, so more threads than cores pay off
+static const size_t MAX_QUERY_THREADS = 16;
+
+/**
+ * @brief Calls Task( i ) for every i below nCount, on up to MAX_QUERY_THREADS threads
+ */
+static void RunConcurrently( size_t nCount, const std::function<void( size_t )> &Task )
+{
+    std::atomic<size_t> nNext( 0 );
+    const auto Worker = [&]()
+    {
+        for( size_t i = nNext++; i < nCount; i = nNext++ )
+        {
+            Task( i );
+        }
+    };
+    std::vector<std::thread> threads;
+    for( size_t i = 1; i < nCount && i < MAX_QUERY_THREADS; ++i )
+    {
+        threads.push_back( std::thread( Worker ));
+    }
+    Worker();
+    for( size_t i = 0; i < threads.size(); ++i )
+    {
+        threads[i].join();
+    }
+}
+
+static VmbErrorType QueryCameraRecord( const CameraPtr &pCamera, CameraRecord &Record )
+{
+    VmbErrorType res = pCamera->GetID( Record.ID );
+    if( VmbErrorSuccess == res )
+    {
+        res = pCamera->GetName( Record.Name );
+    }
+    if( VmbErrorSuccess == res )
+    {
+        res = pCamera->GetModel( Record.Model );
+    }
+    if( VmbErrorSuccess == res )
+    {
+        res = pCamera->GetSerialNumber( Record.SerialNumber );
+    }
+    if( VmbErrorSuccess == res )
+    {
+        res = pCamera->GetInterfaceID( Record.InterfaceID );
+    }
+    return res;
+}
+
+VmbErrorType QueryCameraRecords( const CameraPtrVector &Cameras, std::vector<CameraRecord> &Records )
+{
+    Records.assign( Cameras.size(), CameraRecord() );
+    std::vector<VmbErrorType> results( Cameras.size(), VmbErrorSuccess );
+    RunConcurrently( Cameras.size(), [&]( size_t i )
+    {
+        results[i] = QueryCameraRecord( Cameras[i], Records[i] );
+    });
+    for( size_t i = 0; i < results.size(); ++i )
+    {
+        if( VmbErrorSuccess != results[i] )
+        {
+            return results[i];
+        }
+    }
+    return VmbErrorSuccess;
+}
+
+CameraInventory::CameraInventory( VimbaSystem &system, const std::string &strCacheFile )
+    :   m_system( system )
+    ,   m_strCacheFile( strCacheFile )
+{}
+
+VmbErrorType CameraInventory::Enumerate()
+{
+    const std::chrono::steady_clock::time_point tStart = std::chrono::steady_clock::now();
+    CameraPtrVector cameras;
+    VmbErrorType res = m_system.GetCameras( cameras );
+    if( VmbErrorSuccess == res )
+    {
+        res = QueryCameraRecords( cameras, m_Cameras );
+    }
+    if( VmbErrorSuccess == res )
+    {
+        m_Statistics.bEnumerated = true;
+        WriteCache();
+    }
+    else
+    {
+        m_Cameras.clear();
+    }
+    m_Statistics.Seconds += std::chrono::duration<double>( std::chrono::steady_clock::now() - tStart ).count();
+    return res;
+}
+
+VmbErrorType CameraInventory::Validate( size_t nMinimum )
+{
+    const std::chrono::steady_clock::time_point tStart = std::chrono::steady_clock::now();
+    std::vector<CameraRecord> cached;
+    if( !ReadCache( cached ) || cached.empty() )
+    {
+        return Enumerate();
+    }
+    m_Statistics.Cached = cached.size();
+
+    // Every camera is asked by its ID, which for GigE cameras is a query of that camera instead of a discovery
+    std::vector<CameraRecord>   answers( cached.size() );
+    std::vector<VmbErrorType>   results( cached.size(), VmbErrorNotFound );
+    RunConcurrently( cached.size(), [&]( size_t i )
+    {
+        CameraPtr pCamera;
+        results[i] = m_system.GetCameraByID( cached[i].ID.c_str(), pCamera );
+        if( VmbErrorSuccess == results[i] )
+        {
+            results[i] = QueryCameraRecord( pCamera, answers[i] );
+        }
+    });
+
+    m_Cameras.clear();
+    for( size_t i = 0; i < cached.size(); ++i )
+    {
+        if( VmbErrorSuccess != results[i] )
+        {
+            ++m_Statistics.Missing;
+        }
+        else if(    ( answers[i].SerialNumber != cached[i].SerialNumber )
+                ||  ( answers[i].InterfaceID != cached[i].InterfaceID ))
+        {
+            ++m_Statistics.Changed;
+        }
+        else
+        {
+            ++m_Statistics.Validated;
+            answers[i].Source = CameraRecord_Validated;
+            m_Cameras.push_back( answers[i] );
+        }
+    }
+    m_Statistics.Seconds += std::chrono::duration<double>( std::chrono::steady_clock::now() - tStart ).count();
+
+    // A camera that moved or was swapped may have come back under another ID, only a discovery finds it.
+    // Missing cameras stay in the cache, they may only be switched off for now
+    if( m_Cameras.size() < nMinimum || 0 != m_Statistics.Changed )
+    {
+        return Enumerate();
+    }
+    return VmbErrorSuccess;
+}
+
+VmbErrorType CameraInventory::LoadCache()
+{
+    std::vector<CameraRecord> cached;
+    if( !ReadCache( cached ))
+    {
+        return VmbErrorNotFound;
+    }
+    m_Cameras.swap( cached );
+    m_Statistics.Cached = m_Cameras.size();
+    return VmbErrorSuccess;
+}
+
+const CameraRecord* CameraInventory::Find( const std::string &strIDOrSerial ) const
+{
+    for( size_t i = 0; i < m_Cameras.size(); ++i )
+    {
+        if( m_Cameras[i].ID == strIDOrSerial )
+        {
+            return &m_Cameras[i];
+        }
+    }
+    for( size_t i = 0; i < m_Cameras.size(); ++i )
+    {
+        if( m_Cameras[i].SerialNumber == strIDOrSerial )
+        {
+            return &m_Cameras[i];
+        }
+    }
+    return NULL;
+}
+
+const std::vector<CameraRecord>& CameraInventory::GetCameras() const
+{
+    return m_Cameras;
+}
+
+const InventoryStatistics& CameraInventory::GetStatistics() const
+{
+    return m_Statistics;
+}
+
+std::string CameraInventory::GetDefaultCacheFile()
+{
+    const char *pCache = std::getenv( "XDG_CACHE_HOME" );
+    if( NULL != pCache && '\0' != pCache[0] )
+    {
+        return std::string( pCache ) + "/vimba-cameras.tsv";
+    }
+    const char *pHome = std::getenv( "HOME" );
+    if( NULL != pHome && '\0' != pHome[0] )
+    {
+        return std::string( pHome ) + "/.cache/vimba-cameras.tsv";
+    }
+    return std::string();
+}
+
+/**
+ * @brief Tabs and line breaks would split the record, names never need them
+ */
+static std::string ToCacheField( const std::string &strValue )
+{
+    std::string strField( strValue );
+    for( size_t i = 0; i < strField.size(); ++i )
+    {
+        if( '\t' == strField[i] || '\n' == strField[i] || '\r' == strField[i] )
+        {
+            strField[i] = ' ';
+        }
+    }
+    return strField;
+}
+
+bool CameraInventory::ReadCache( std::vector<CameraRecord> &Records ) const
+{
+    Records.clear();
+    std::ifstream file( m_strCacheFile.c_str() );
+    std::string strLine;
+    if(     ( m_strCacheFile.empty() )
+        ||  ( !std::getline( file, strLine ))
+        ||  ( CACHE_HEADER != strLine ))
+    {
+        return false;
+    }
+    while( std::getline( file, strLine ))
+    {
+        // Empty fields are kept, a camera may have no name
+        std::vector<std::string> fields;
+        std::string::size_type nStart = 0;
+        for( std::string::size_type nTab = strLine.find( '\t' ); std::string::npos != nTab; nTab = strLine.find( '\t', nStart ))
+        {
+            fields.push_back( strLine.substr( nStart, nTab - nStart ));
+            nStart = nTab + 1;
+        }
+        fields.push_back( strLine.substr( nStart ));
+        if( 5 != fields.size() || fields[0].empty() )
+        {
+            // A damaged cache is as good as none
+            Records.clear();
+            return false;
+        }
+        CameraRecord Record;
+        Record.ID           = fields[0];
+        Record.Name         = fields[1];
+        Record.Model        = fields[2];
+        Record.SerialNumber = fields[3];
+        Record.InterfaceID  = fields[4];
+        Record.Source       = CameraRecord_Cached;
+        Records.push_back( Record );
+    }
+    return true;
+}
+
+/**
+ * @brief Writes the cache to a temporary file renamed over the old one, so a concurrent reader
+ * never sees half a cache
+ */
+bool CameraInventory::WriteCache() const
+{
+    if( m_strCacheFile.empty() )
+    {
+        return false;
+    }
+    const std::string::size_type nSlash = m_strCacheFile.find_last_of( '/' );
+    if( std::string::npos != nSlash && 0 != nSlash )
+    {
+        // ~/.cache may not exist yet, failing because it does is fine
+        mkdir( m_strCacheFile.substr( 0, nSlash ).c_str(), 0755 );
+    }
+    // Named by the process, so two programs listing at once never write the same file
+    std::ostringstream tmp;
+    tmp<<m_strCacheFile<<"."<<getpid()<<".tmp";
+    const std::string strTemporary = tmp.str();
+    {
+        std::ofstream file( strTemporary.c_str(), std::ios::trunc );
+        file<<CACHE_HEADER<<"\n";
+        for( size_t i = 0; i < m_Cameras.size(); ++i )
+        {
+            const CameraRecord &Record = m_Cameras[i];
+            file<<ToCacheField( Record.ID )<<"\t"<<ToCacheField( Record.Name )<<"\t"<<ToCacheField( Record.Model )<<"\t"
+                <<ToCacheField( Record.SerialNumber )<<"\t"<<ToCacheField( Record.InterfaceID )<<"\n";
+        }
+        file.flush();
+        if( !file )
+        {
+            std::remove( strTemporary.c_str() );
+            return false;
+        }
+    }
+    return 0 == std::rename( strTemporary.c_str(), m_strCacheFile.c_str() );
+}
+
+static const char* GetSourceName( CameraRecordSource eSource )
+{
+    switch( eSource )
+    {
+    case CameraRecord_Validated:    return "validated";
+    case CameraRecord_Cached:       return "cached";
+    default:                        return "enumerated";
+    }
+}
+
+static void PrintJsonString( std::ostream &s, const std::string &strValue )
+{
+    s<<'"';
+    for( size_t i = 0; i < strValue.size(); ++i )
+    {
+        const unsigned char c = static_cast<unsigned char>( strValue[i] );
+        if( '"' == c || '\\' == c )
+        {
+            s<<'\\'<<c;
+        }
+        else if( c < 0x20 )
+        {
+            char szEscape[8];
+            std::snprintf( szEscape, sizeof( szEscape ), "\\u%04x", c );
+            s<<szEscape;
+        }
+        else
+        {
+            s<<c;
+        }
+    }
+    s<<'"';
+}
+
+void PrintCameraRecords( std::ostream &s, const std::vector<CameraRecord> &Records, InventoryFormat eFormat )
+{
+    switch( eFormat )
+    {
+    case InventoryFormat_Json:
+        s<<"[";
+        for( size_t i = 0; i < Records.size(); ++i )
+        {
+            const CameraRecord &Record = Records[i];
+            s<<( 0 == i ? "\n" : ",\n" )<<"  { \"id\": ";
+            PrintJsonString( s, Record.ID );
+            s<<", \"name\": ";
+            PrintJsonString( s, Record.Name );
+            s<<", \"model\": ";
+            PrintJsonString( s, Record.Model );
+            s<<", \"serial\": ";
+            PrintJsonString( s, Record.SerialNumber );
+            s<<", \"interface\": ";
+            PrintJsonString( s, Record.InterfaceID );
+            s<<", \"source\": \""<<GetSourceName( Record.Source )<<"\" }";
+        }
+        s<<"\n]\n";
+        break;
+    case InventoryFormat_Tsv:
+        s<<"id\tname\tmodel\tserial\tinterface\tsource\n";
+        for( size_t i = 0; i < Records.size(); ++i )
+        {
+            const CameraRecord &Record = Records[i];
+            s<<ToCacheField( Record.ID )<<"\t"<<ToCacheField( Record.Name )<<"\t"<<ToCacheField( Record.Model )<<"\t"
+             <<ToCacheField( Record.SerialNumber )<<"\t"<<ToCacheField( Record.InterfaceID )<<"\t"<<GetSourceName( Record.Source )<<"\n";
+        }
+        break;
+    default:
+        for( size_t i = 0; i < Records.size(); ++i )
+        {
+            const CameraRecord &Record = Records[i];
+            s   << "/// Camera Name    : " << Record.Name           << "\n"
+                << "/// Model Name     : " << Record.Model          << "\n"
+                << "/// Camera ID      : " << Record.ID             << "\n"
+                << "/// Serial Number  : " << Record.SerialNumber   << "\n"
+                << "/// @ Interface ID : " << Record.InterfaceID    << "\n\n";
+        }
+        break;
+    }
+}
+
+}} // namespace AVT::VmbAPI
@@ -0,0 +1,754 @@
+#include <cmath>
+#include <algorithm>
+
+#include <opencv2/opencv.hpp>
+
+#include "CameraPreset.h"
+#include "Common/ErrorCodeToMessage.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+enum SettingType
+{
+    Setting_Int,
+    Setting_Float,
+    Setting_Enum,
+    Setting_Bool,
+};
+
+static bool EndsWith( const std::string &str, const char *pSuffix )
+{
+    const std::string strSuffix( pSuffix );
+    return str.size() >= strSuffix.size() && 0 == str.compare( str.size() - strSuffix.size(), strSuffix.size(), strSuffix );
+}
+
+static bool StartsWith( const std::string &str, const char *pPrefix )
+{
+    return 0 == str.compare( 0, std::string( pPrefix ).size(), pPrefix );
+}
+
+/**
+ * @brief Position of a feature in the batch, features ranking lower are written first
+ */
+static int GetRank( const std::string &strFeature )
+{
+    if( "PixelFormat" == strFeature )
+    {
+        return 0;
+    }
+    if( StartsWith( strFeature, "Binning" ) || StartsWith( strFeature, "Decimation" ))
+    {
+        return 1;
+    }
+    if( "Width" == strFeature || "Height" == strFeature )
+    {
+        return 2;
+    }
+    if( "OffsetX" == strFeature || "OffsetY" == strFeature )
+    {
+        return 3;
+    }
+    if( "GVSPPacketSize" == strFeature || "GevSCPSPacketSize" == strFeature || "StreamBytesPerSecond" == strFeature )
+    {
+        return 4;
+    }
+    if( EndsWith( strFeature, "Selector" ))
+    {
+        return 5;
+    }
+    if( EndsWith( strFeature, "Mode" ) || EndsWith( strFeature, "Auto" ) || EndsWith( strFeature, "Enable" ))
+    {
+        return 6;
+    }
+    if( StartsWith( strFeature, "AcquisitionFrameRate" ))
+    {
+        return 8;
+    }
+    return 7;
+}
+
+/**
+ * @brief Finds out which type the feature has and whether the value fits it, without writing
+ *
+ * @return VmbErrorNotFound if the camera lacks the feature, VmbErrorWrongType if the value does not fit
+ */
+static VmbErrorType ResolveType( ICameraFeatures &Features, const PresetSetting &Setting, SettingType &eType )
+{
+    const char *pName = Setting.Feature.c_str();
+    VmbErrorType    resInt  = VmbErrorNotFound;
+    VmbErrorType    resFloat= VmbErrorNotFound;
+    VmbErrorType    resEnum = VmbErrorNotFound;
+    VmbErrorType    resBool = VmbErrorNotFound;
+    VmbInt64_t      nValue  = 0;
+    double          dValue  = 0.0;
+    std::string     strValue;
+    bool            bValue  = false;
+    if( Setting.bText )
+    {
+        if( VmbErrorSuccess == ( resEnum = Features.GetEnum( pName, strValue )))
+        {
+            eType = Setting_Enum;
+            return VmbErrorSuccess;
+        }
+        if(     ( VmbErrorSuccess == ( resBool = Features.GetBool( pName, bValue )))
+            &&  ( "true" == Setting.Text || "false" == Setting.Text ))
+        {
+            eType = Setting_Bool;
+            return VmbErrorSuccess;
+        }
+    }
+    else
+    {
+        if( VmbErrorSuccess == ( resInt = Features.GetInt( pName, nValue )))
+        {
+            eType = Setting_Int;
+            return Setting.Number == std::floor( Setting.Number ) ? VmbErrorSuccess : VmbErrorWrongType;
+        }
+        if( VmbErrorSuccess == ( resFloat = Features.GetFloat( pName, dValue )))
+        {
+            eType = Setting_Float;
+            return VmbErrorSuccess;
+        }
+        if(     ( VmbErrorSuccess == ( resBool = Features.GetBool( pName, bValue )))
+            &&  ( 0.0 == Setting.Number || 1.0 == Setting.Number ))
+        {
+            eType = Setting_Bool;
+            return VmbErrorSuccess;
+        }
+    }
+    const bool bMissing = VmbErrorNotFound == resInt && VmbErrorNotFound == resFloat && VmbErrorNotFound == resEnum && VmbErrorNotFound == resBool;
+    return bMissing ? VmbErrorNotFound : VmbErrorWrongType;
+}
+
+/**
+ * @brief Whether the feature sets the image format and with it the payload of the announced buffers
+ */
+static bool IsPayloadFeature( const std::string &strFeature )
+{
+    return GetRank( strFeature ) <= 2;
+}
+
+/**
+ * @brief Whether an integer, enumeration or boolean feature already has the value of the setting
+ */
+static bool HasValue( ICameraFeatures &Features, const PresetSetting &Setting, SettingType eType )
+{
+    const char *pName = Setting.Feature.c_str();
+    VmbInt64_t  nCurrent = 0;
+    std::string strCurrent;
+    bool        bCurrent = false;
+    switch( eType )
+    {
+    case Setting_Int:
+        return VmbErrorSuccess == Features.GetInt( pName, nCurrent ) && nCurrent == static_cast<VmbInt64_t>( Setting.Number );
+    case Setting_Enum:
+        return VmbErrorSuccess == Features.GetEnum( pName, strCurrent ) && strCurrent == Setting.Text;
+    case Setting_Bool:
+        return VmbErrorSuccess == Features.GetBool( pName, bCurrent ) && bCurrent == ( Setting.bText ? "true" == Setting.Text : 0.0 != Setting.Number );
+    case Setting_Float:
+        break;
+    }
+    return false;
+}
+
+/**
+ * @brief Writes one setting unless the feature already has the value
+ *
+ * @param bWritten Set if the feature was written
+ */
+static VmbErrorType ApplySetting( ICameraFeatures &Features, const PresetSetting &Setting, SettingType eType, bool &bWritten )
+{
+    const char *pName = Setting.Feature.c_str();
+    VmbErrorType res = VmbErrorSuccess;
+    bWritten = false;
+    switch( eType )
+    {
+    case Setting_Int:
+        {
+            const VmbInt64_t nValue = static_cast<VmbInt64_t>( Setting.Number );
+            VmbInt64_t nCurrent = 0;
+            if(     ( VmbErrorSuccess == Features.GetInt( pName, nCurrent ))
+                &&  ( nCurrent == nValue ))
+            {
+                return VmbErrorSuccess;
+            }
+            VmbInt64_t nMin         = 0;
+            VmbInt64_t nMax         = 0;
+            VmbInt64_t nIncrement   = 1;
+            res = Features.GetIntRange( pName, nMin, nMax, nIncrement );
+            if(     ( VmbErrorSuccess == res )
+                &&  ( nValue < nMin || nValue > nMax || 0 != ( nValue - nMin ) % nIncrement ))
+            {
+                res = VmbErrorInvalidValue;
+            }
+            if( VmbErrorSuccess == res )
+            {
+                res = Features.SetInt( pName, nValue );
+            }
+        }
+        break;
+    case Setting_Float:
+        {
+            double dMin         = 0.0;
+            double dMax         = 0.0;
+            double dIncrement   = 0.0;
+            res = Features.GetFloatRange( pName, dMin, dMax, dIncrement );
+            if( VmbErrorSuccess != res )
+            {
+                return res;
+            }
+            // Cameras keep floats on a grid of their own, closer than half a step counts as the same value
+            const double dTolerance = std::max( dIncrement / 2.0, 1.0e-9 * std::max( 1.0, std::fabs( Setting.Number )));
+            double dCurrent = 0.0;
+            if(     ( VmbErrorSuccess == Features.GetFloat( pName, dCurrent ))
+                &&  ( std::fabs( dCurrent - Setting.Number ) <= dTolerance ))
+            {
+                return VmbErrorSuccess;
+            }
+            if( Setting.Number < dMin || Setting.Number > dMax )
+            {
+                res = VmbErrorInvalidValue;
+            }
+            else if( dIncrement > 0.0 )
+            {
+                const double dSteps = ( Setting.Number - dMin ) / dIncrement;
+                if( std::fabs( dSteps - std::floor( dSteps + 0.5 )) > 1.0e-6 )
+                {
+                    res = VmbErrorInvalidValue;
+                }
+            }
+            if( VmbErrorSuccess == res )
+            {
+                res = Features.SetFloat( pName, Setting.Number );
+            }
+        }
+        break;
+    case Setting_Enum:
+        {
+            std::string strCurrent;
+            if(     ( VmbErrorSuccess == Features.GetEnum( pName, strCurrent ))
+                &&  ( strCurrent == Setting.Text ))
+            {
+                return VmbErrorSuccess;
+            }
+            std::vector<std::string> entries;
+            res = Features.GetEnumEntries( pName, entries );
+            if(     ( VmbErrorSuccess == res )
+                &&  ( entries.end() == std::find( entries.begin(), entries.end(), Setting.Text )))
+            {
+                res = VmbErrorInvalidValue;
+            }
+            if( VmbErrorSuccess == res )
+            {
+                res = Features.SetEnum( pName, Setting.Text );
+            }
+        }
+        break;
+    case Setting_Bool:
+        {
+            const bool bValue = Setting.bText ? "true" == Setting.Text : 0.0 != Setting.Number;
+            bool bCurrent = false;
+            if(     ( VmbErrorSuccess == Features.GetBool( pName, bCurrent ))
+                &&  ( bCurrent == bValue ))
+            {
+                return VmbErrorSuccess;
+            }
+            res = Features.SetBool( pName, bValue );
+        }
+        break;
+    }
+    bWritten = VmbErrorSuccess == res;
+    return res;
+}
+
+/**
+ * @brief A larger size may not fit next to the current offset. If the preset sets the offset anyway,
+ * it is cleared before the size is written
+ */
+static VmbErrorType MakeRoomForSize( ICameraFeatures &Features, const CameraPreset &Preset, const PresetSetting &Size, PresetReport &Report )
+{
+    const char *pOffset = "Width" == Size.Feature ? "OffsetX" : ( "Height" == Size.Feature ? "OffsetY" : NULL );
+    if( NULL == pOffset )
+    {
+        return VmbErrorSuccess;
+    }
+    bool bPresetOffset = false;
+    for( size_t i = 0; i < Preset.Settings.size(); ++i )
+    {
+        bPresetOffset = bPresetOffset || pOffset == Preset.Settings[i].Feature;
+    }
+    VmbInt64_t nMin         = 0;
+    VmbInt64_t nMax         = 0;
+    VmbInt64_t nIncrement   = 1;
+    VmbInt64_t nOffset      = 0;
+    if(     ( !bPresetOffset )
+        ||  ( VmbErrorSuccess != Features.GetIntRange( Size.Feature.c_str(), nMin, nMax, nIncrement ))
+        ||  ( Size.Number <= static_cast<double>( nMax ))
+        ||  ( VmbErrorSuccess != Features.GetIntRange( pOffset, nMin, nMax, nIncrement ))
+        ||  ( VmbErrorSuccess == Features.GetInt( pOffset, nOffset ) && nOffset == nMin ))
+    {
+        return VmbErrorSuccess;
+    }
+    const VmbErrorType res = Features.SetInt( pOffset, nMin );
+    if( VmbErrorSuccess == res )
+    {
+        ++Report.Written;
+    }
+    return res;
+}
+
+bool LoadCameraPresets( const std::string &strFile, std::vector<CameraPreset> &Presets, std::string &strError )
+{
+    Presets.clear();
+    try
+    {
+        cv::FileStorage file( strFile, cv::FileStorage::READ );
+        if( !file.isOpened() )
+        {
+            strError = "cannot open " + strFile;
+            return false;
+        }
+        const cv::FileNode root = file.root();
+        if( !root.isMap() )
+        {
+            strError = "expected a map of preset names to presets";
+            return false;
+        }
+        for( cv::FileNodeIterator itPreset = root.begin(); itPreset != root.end(); ++itPreset )
+        {
+            const cv::FileNode preset = *itPreset;
+            CameraPreset p;
+            p.Name = preset.name();
+            if( !preset.isMap() )
+            {
+                strError = "preset " + p.Name + " is not a map of features to values";
+                return false;
+            }
+            for( cv::FileNodeIterator itSetting = preset.begin(); itSetting != preset.end(); ++itSetting )
+            {
+                const cv::FileNode value = *itSetting;
+                PresetSetting setting;
+                setting.Feature = value.name();
+                if( value.isString() )
+                {
+                    setting.bText   = true;
+                    setting.Text    = static_cast<std::string>( value );
+                }
+                else if( value.isInt() || value.isReal() )
+                {
+                    setting.Number  = static_cast<double>( value );
+                }
+                else
+                {
+                    strError = "preset " + p.Name + ": " + setting.Feature + " needs a number or a text";
+                    return false;
+                }
+                p.Settings.push_back( setting );
+            }
+            Presets.push_back( p );
+        }
+    }
+    catch( const cv::Exception &e )
+    {
+        strError = e.what();
+        return false;
+    }
+    if( Presets.empty() )
+    {
+        strError = "no presets in " + strFile;
+        return false;
+    }
+    return true;
+}
+
+const CameraPreset* FindCameraPreset( const std::vector<CameraPreset> &Presets, const std::string &strName )
+{
+    for( size_t i = 0; i < Presets.size(); ++i )
+    {
+        if( strName == Presets[i].Name )
+        {
+            return &Presets[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Resolves the type of every setting, so nothing is written if one does not fit the camera
+ */
+static VmbErrorType ResolveTypes( ICameraFeatures &Features, const CameraPreset &Preset, std::vector<SettingType> &Types, PresetReport &Report )
+{
+    Types.assign( Preset.Settings.size(), Setting_Int );
+    for( size_t i = 0; i < Preset.Settings.size(); ++i )
+    {
+        const VmbErrorType res = ResolveType( Features, Preset.Settings[i], Types[i] );
+        if( VmbErrorSuccess != res )
+        {
+            Report.Result   = res;
+            Report.Feature  = Preset.Settings[i].Feature;
+            return res;
+        }
+    }
+    return VmbErrorSuccess;
+}
+
+/**
+ * @brief Writes the settings in the given order, stops at the first failing one
+ */
+static VmbErrorType ApplyInOrder( ICameraFeatures &Features, const CameraPreset &Preset, const std::vector<SettingType> &Types, const std::vector<size_t> &Order, PresetReport &Report )
+{
+    for( size_t i = 0; i < Order.size(); ++i )
+    {
+        const PresetSetting &setting = Preset.Settings[ Order[i] ];
+        bool bWritten = false;
+        VmbErrorType res = MakeRoomForSize( Features, Preset, setting, Report );
+        if( VmbErrorSuccess == res )
+        {
+            res = ApplySetting( Features, setting, Types[ Order[i] ], bWritten );
+        }
+        if( VmbErrorSuccess != res )
+        {
+            Report.Result   = res;
+            Report.Feature  = setting.Feature;
+            return res;
+        }
+        if( bWritten )
+        {
+            ++Report.Written;
+        }
+        else
+        {
+            ++Report.Unchanged;
+        }
+    }
+    return VmbErrorSuccess;
+}
+
+VmbErrorType ApplyCameraPreset( ICameraFeatures &Features, const CameraPreset &Preset, PresetReport &Report, bool bStreaming )
+{
+    Report = PresetReport();
+    std::vector<SettingType> types;
+    VmbErrorType res = ResolveTypes( Features, Preset, types, Report );
+    if( VmbErrorSuccess != res )
+    {
+        return res;
+    }
+    // The camera keeps these locked while streaming, or would send frames larger than the buffers
+    for( size_t i = 0; i < Preset.Settings.size() && bStreaming; ++i )
+    {
+        if(     ( IsPayloadFeature( Preset.Settings[i].Feature ))
+            &&  ( !HasValue( Features, Preset.Settings[i], types[i] )))
+        {
+            Report.Locked.push_back( Preset.Settings[i].Feature );
+        }
+    }
+    if( !Report.Locked.empty() )
+    {
+        Report.Result   = VmbErrorInvalidAccess;
+        Report.Feature  = Report.Locked[0];
+        return Report.Result;
+    }
+
+    std::vector<size_t> order;
+    for( size_t i = 0; i < Preset.Settings.size(); ++i )
+    {
+        order.push_back( i );
+    }
+    std::stable_sort( order.begin(), order.end(), [&Preset]( size_t a, size_t b ) { return GetRank( Preset.Settings[a].Feature ) < GetRank( Preset.Settings[b].Feature ); } );
+    return ApplyInOrder( Features, Preset, types, order, Report );
+}
+
+void PrintPresetReport( std::ostream &s, const CameraPreset &Preset, const PresetReport &Report )
+{
+    s<<"preset "<<Preset.Name;
+    if( !Report.Locked.empty() )
+    {
+        s<<" needs the camera stopped to change ";
+        for( size_t i = 0; i < Report.Locked.size(); ++i )
+        {
+            s<<( 0 == i ? "" : ", " )<<Report.Locked[i];
+        }
+    }
+    else if( VmbErrorSuccess != Report.Result )
+    {
+        s<<" failed at "<<Report.Feature<<" after "<<Report.Written<<" written: "<<ErrorCodeToMessage( Report.Result );
+    }
+    else
+    {
+        s<<": "<<Report.Written<<" written, "<<Report.Unchanged<<" unchanged";
+    }
+}
+
+FeatureJournal::FeatureJournal()
+    :   m_pTarget( NULL )
+{}
+
+void FeatureJournal::SetTarget( ICameraFeatures *pTarget )
+{
+    std::lock_guard<std::mutex> lock( m_Mutex );
+    m_pTarget = pTarget;
+}
+
+static bool IsSelector( const char *pName )
+{
+    return EndsWith( pName, "Selector" );
+}
+
+static bool SameValue( const PresetSetting &a, const PresetSetting &b )
+{
+    return a.Feature == b.Feature && a.bText == b.bText && a.Text == b.Text && a.Number == b.Number;
+}
+
+/**
+ * @brief Puts the selectors an entry was written under in front of it, where they differ from
+ * those written before, and the last values of all selectors at the end
+ */
+VmbErrorType FeatureJournal::Replay( ICameraFeatures &Features, PresetReport &Report ) const
+{
+    std::vector<Entry>          entries;
+    std::vector<PresetSetting>  selectors;
+    std::vector<std::string>    commands;
+    {
+        std::lock_guard<std::mutex> lock( m_Mutex );
+        entries     = m_Entries;
+        selectors   = m_Selectors;
+        commands    = m_Commands;
+    }
+    // Commands like GVSPAdjustPacketSize set features of their own, written values take precedence
+    for( size_t i = 0; i < commands.size(); ++i )
+    {
+        Features.RunCommand( commands[i].c_str() );
+    }
+
+    // Dependency order as for a preset, the entries of a rank in the order written
+    std::stable_sort( entries.begin(), entries.end(), []( const Entry &a, const Entry &b ) { return GetRank( a.Setting.Feature ) < GetRank( b.Setting.Feature ); } );
+    CameraPreset journal;
+    journal.Name = "last applied";
+    std::vector<bool> bSelected( selectors.size(), false );
+    std::vector<PresetSetting> selected( selectors.size() );
+    for( size_t i = 0; i < entries.size(); ++i )
+    {
+        for( size_t j = 0; j < entries[i].Selectors.size(); ++j )
+        {
+            if( !bSelected[j] || !SameValue( selected[j], entries[i].Selectors[j] ))
+            {
+                bSelected[j]    = true;
+                selected[j]     = entries[i].Selectors[j];
+                journal.Settings.push_back( selected[j] );
+            }
+        }
+        journal.Settings.push_back( entries[i].Setting );
+    }
+    for( size_t j = 0; j < selectors.size(); ++j )
+    {
+        if( !bSelected[j] || !SameValue( selected[j], selectors[j] ))
+        {
+            journal.Settings.push_back( selectors[j] );
+        }
+    }
+
+    Report = PresetReport();
+    std::vector<SettingType> types;
+    VmbErrorType res = ResolveTypes( Features, journal, types, Report );
+    if( VmbErrorSuccess == res )
+    {
+        std::vector<size_t> order;
+        for( size_t i = 0; i < journal.Settings.size(); ++i )
+        {
+            order.push_back( i );
+        }
+        res = ApplyInOrder( Features, journal, types, order, Report );
+    }
+    return res;
+}
+
+/**
+ * @brief Remembers the value a selector had before it was first written through the journal,
+ * entries written before keep that value as theirs
+ *
+ * @param bText Whether the selector is an enumeration, otherwise an integer
+ */
+void FeatureJournal::KnowSelector( const char *pName, bool bText )
+{
+    for( size_t i = 0; i < m_Selectors.size(); ++i )
+    {
+        if( m_Selectors[i].Feature == pName )
+        {
+            return;
+        }
+    }
+    PresetSetting selector;
+    selector.Feature    = pName;
+    selector.bText      = bText;
+    VmbInt64_t nValue   = 0;
+    const VmbErrorType res = bText ? m_pTarget->GetEnum( pName, selector.Text ) : m_pTarget->GetInt( pName, nValue );
+    if( VmbErrorSuccess != res )
+    {
+        return;
+    }
+    selector.Number = static_cast<double>( nValue );
+    m_Selectors.push_back( selector );
+    for( size_t i = 0; i < m_Entries.size(); ++i )
+    {
+        m_Entries[i].Selectors.push_back( selector );
+    }
+}
+
+/**
+ * @brief Replaces an earlier setting of the feature made under the same selector values, the setting
+ * moves to the end. A selector written only changes the values later settings are made under
+ */
+void FeatureJournal::Record( const PresetSetting &Setting )
+{
+    for( size_t i = 0; i < m_Selectors.size(); ++i )
+    {
+        if( m_Selectors[i].Feature == Setting.Feature )
+        {
+            m_Selectors[i] = Setting;
+            return;
+        }
+    }
+    Entry entry;
+    entry.Setting = Setting;
+    for( size_t i = 0; i < m_Selectors.size(); ++i )
+    {
+        entry.Selectors.push_back( m_Selectors[i] );
+    }
+    for( size_t i = 0; i < m_Entries.size(); ++i )
+    {
+        bool bSame = m_Entries[i].Setting.Feature == Setting.Feature;
+        for( size_t j = 0; j < entry.Selectors.size() && bSame; ++j )
+        {
+            bSame = SameValue( m_Entries[i].Selectors[j], entry.Selectors[j] );
+        }
+        if( bSame )
+        {
+            m_Entries.erase( m_Entries.begin() + i );
+            break;
+        }
+    }
+    m_Entries.push_back( entry );
+}
+
+VmbErrorType FeatureJournal::GetInt( const char *pName, VmbInt64_t &nValue )
+{
+    std::lock_guard<std::mutex> lock( m_Mutex );
+    return NULL == m_pTarget ? VmbErrorDeviceNotOpen : m_pTarget->GetInt( pName, nValue );
+}
+
+VmbErrorType FeatureJournal::GetIntRange( const char *pName, VmbInt64_t &nMin, VmbInt64_t &nMax, VmbInt64_t &nIncrement )
+{
+    std::lock_guard<std::mutex> lock( m_Mutex );
+    return NULL == m_pTarget ? VmbErrorDeviceNotOpen : m_pTarget->GetIntRange( pName, nMin, nMax, nIncrement );
+}
+
+VmbErrorType FeatureJournal::SetInt( const char *pName, VmbInt64_t nValue )
+{
+    std::lock_guard<std::mutex> lock( m_Mutex );
+    if( NULL != m_pTarget && IsSelector( pName ))
+    {
+        KnowSelector( pName, false );
+    }
+    const VmbErrorType res = NULL == m_pTarget ? VmbErrorDeviceNotOpen : m_pTarget->SetInt( pName, nValue );
+    if( VmbErrorSuccess == res )
+    {
+        PresetSetting setting;
+        setting.Feature = pName;
+        setting.Number  = static_cast<double>( nValue );
+        Record( setting );
+    }
+    return res;
+}
+
+VmbErrorType FeatureJournal::GetEnum( const char *pName, std::string &strValue )
+{
+    std::lock_guard<std::mutex> lock( m_Mutex );
+    return NULL == m_pTarget ? VmbErrorDeviceNotOpen : m_pTarget->GetEnum( pName, strValue );
+}
+
+VmbErrorType FeatureJournal::GetEnumEntries( const char *pName, std::vector<std::string> &Entries )
+{
+    std::lock_guard<std::mutex> lock( m_Mutex );
+    return NULL == m_pTarget ? VmbErrorDeviceNotOpen : m_pTarget->GetEnumEntries( pName, Entries );
+}
+
+VmbErrorType FeatureJournal::SetEnum( const char *pName, const std::string &strValue )
+{
+    std::lock_guard<std::mutex> lock( m_Mutex );
+    if( NULL != m_pTarget && IsSelector( pName ))
+    {
+        KnowSelector( pName, true );
+    }
+    const VmbErrorType res = NULL == m_pTarget ? VmbErrorDeviceNotOpen : m_pTarget->SetEnum( pName, strValue );
+    if( VmbErrorSuccess == res )
+    {
+        PresetSetting setting;
+        setting.Feature = pName;
+        setting.bText   = true;
+        setting.Text    = strValue;
+        Record( setting );
+    }
+    return res;
+}
+
+VmbErrorType FeatureJournal::GetFloat( const char *pName, double &dValue )
+{
+    std::lock_guard<std::mutex> lock( m_Mutex );
+    return NULL == m_pTarget ? VmbErrorDeviceNotOpen : m_pTarget->GetFloat( pName, dValue );
+}
+
+VmbErrorType FeatureJournal::GetFloatRange( const char *pName, double &dMin, double &dMax, double &dIncrement )
+{
+    std::lock_guard<std::mutex> lock( m_Mutex );
+    return NULL == m_pTarget ? VmbErrorDeviceNotOpen : m_pTarget->GetFloatRange( pName, dMin, dMax, dIncrement );
+}
+
+VmbErrorType FeatureJournal::SetFloat( const char *pName, double dValue )
+{
+    std::lock_guard<std::mutex> lock( m_Mutex );
+    const VmbErrorType res = NULL == m_pTarget ? VmbErrorDeviceNotOpen : m_pTarget->SetFloat( pName, dValue );
+    if( VmbErrorSuccess == res )
+    {
+        PresetSetting setting;
+        setting.Feature = pName;
+        setting.Number  = dValue;
+        Record( setting );
+    }
+    return res;
+}
+
+VmbErrorType FeatureJournal::GetBool( const char *pName, bool &bValue )
+{
+    std::lock_guard<std::mutex> lock( m_Mutex );
+    return NULL == m_pTarget ? VmbErrorDeviceNotOpen : m_pTarget->GetBool( pName, bValue );
+}
+
+VmbErrorType FeatureJournal::SetBool( const char *pName, bool bValue )
+{
+    std::lock_guard<std::mutex> lock( m_Mutex );
+    const VmbErrorType res = NULL == m_pTarget ? VmbErrorDeviceNotOpen : m_pTarget->SetBool( pName, bValue );
+    if( VmbErrorSuccess == res )
+    {
+        PresetSetting setting;
+        setting.Feature = pName;
+        setting.bText   = true;
+        setting.Text    = bValue ? "true" : "false";
+        Record( setting );
+    }
+    return res;
+}
+
+VmbErrorType FeatureJournal::RunCommand( const char *pName )
+{
+    std::lock_guard<std::mutex> lock( m_Mutex );
+    const VmbErrorType res = NULL == m_pTarget ? VmbErrorDeviceNotOpen : m_pTarget->RunCommand( pName );
+    if(     ( VmbErrorSuccess == res )
+        &&  ( m_Commands.end() == std::find( m_Commands.begin(), m_Commands.end(), std::string( pName ))))
+    {
+        m_Commands.push_back( pName );
+    }
+    return res;
+}
+
+}} // namespace AVT::VmbAPI
@@ -0,0 +1,271 @@
+#include <cstring>
+
+#include "ConversionContext.h"
+#include "Demosaic.h"
+#include "Unpack.h"
+#include "PixelFormat.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+ImageBufferLease::ImageBufferLease()
+    :   m_pPool( NULL )
+    ,   m_pData( NULL )
+    ,   m_nSize( 0 )
+{}
+
+ImageBufferLease::ImageBufferLease( ImageBufferPool *pPool, VmbUchar_t *pData, size_t nSize )
+    :   m_pPool( pPool )
+    ,   m_pData( pData )
+    ,   m_nSize( nSize )
+{}
+
+ImageBufferLease::ImageBufferLease( ImageBufferLease &&other )
+    :   m_pPool( other.m_pPool )
+    ,   m_pData( other.m_pData )
+    ,   m_nSize( other.m_nSize )
+{
+    other.m_pPool   = NULL;
+    other.m_pData   = NULL;
+    other.m_nSize   = 0;
+}
+
+ImageBufferLease& ImageBufferLease::operator=( ImageBufferLease &&other )
+{
+    if( this != &other )
+    {
+        Release();
+        m_pPool         = other.m_pPool;
+        m_pData         = other.m_pData;
+        m_nSize         = other.m_nSize;
+        other.m_pPool   = NULL;
+        other.m_pData   = NULL;
+        other.m_nSize   = 0;
+    }
+    return *this;
+}
+
+ImageBufferLease::~ImageBufferLease()
+{
+    Release();
+}
+
+void ImageBufferLease::Release()
+{
+    if( NULL != m_pPool && NULL != m_pData )
+    {
+        m_pPool->Return( m_pData );
+    }
+    m_pPool = NULL;
+    m_pData = NULL;
+    m_nSize = 0;
+}
+
+ImageBufferPool::ImageBufferPool()
+    :   m_nBufferSize( 0 )
+    ,   m_nBufferCount( 0 )
+{}
+
+/**
+ * @brief Allocates all buffers in one block, every buffer starting at an aligned address
+ */
+VmbErrorType ImageBufferPool::Allocate( size_t nSize, size_t nCount, size_t nAlignment )
+{
+    if( 0 == nSize || 0 == nCount || 0 == nAlignment || 0 != ( nAlignment & ( nAlignment - 1 )))
+    {
+        return VmbErrorBadParameter;
+    }
+    const size_t nStride = ( nSize + nAlignment - 1 ) & ~( nAlignment - 1 );
+    m_Storage.assign( nStride * nCount + nAlignment, 0 );
+    m_pFree.reset( new BoundedQueue<VmbUchar_t*>( nCount ));
+    m_nBufferSize   = nSize;
+    m_nBufferCount  = nCount;
+
+    const size_t nMisalignment = reinterpret_cast<size_t>( &m_Storage[0] ) & ( nAlignment - 1 );
+    VmbUchar_t *pFirst = &m_Storage[0] + ( 0 == nMisalignment ? 0 : nAlignment - nMisalignment );
+    for( size_t i = 0; i < nCount; ++i )
+    {
+        m_pFree->TryPush( pFirst + i * nStride );
+    }
+    return VmbErrorSuccess;
+}
+
+VmbErrorType ImageBufferPool::Acquire( ImageBufferLease &Lease )
+{
+    VmbUchar_t *pData = NULL;
+    if( !m_pFree || !m_pFree->TryPop( pData ))
+    {
+        return VmbErrorResources;
+    }
+    Lease = ImageBufferLease( this, pData, m_nBufferSize );
+    return VmbErrorSuccess;
+}
+
+size_t ImageBufferPool::Available() const
+{
+    return m_pFree ? m_pFree->Size() : 0;
+}
+
+void ImageBufferPool::Return( VmbUchar_t *pData )
+{
+    m_pFree->TryPush( pData );
+}
+
+ConversionContext::ConversionContext()
+    :   m_bValid( false )
+    ,   m_eSourceFormat( VmbPixelFormatMono8 )
+    ,   m_nWidth( 0 )
+    ,   m_nHeight( 0 )
+    ,   m_bInTreeDemosaic( false )
+    ,   m_bInTreeUnpack( false )
+    ,   m_bEdgeAware( false )
+    ,   m_bMatrix( false )
+{
+    std::memset( &m_SourceImage, 0, sizeof( m_SourceImage ));
+    std::memset( &m_DestinationImage, 0, sizeof( m_DestinationImage ));
+    std::memset( &m_TransformInfo, 0, sizeof( m_TransformInfo ));
+    std::memset( m_Matrix, 0, sizeof( m_Matrix ));
+}
+
+/**
+ * @brief Prepares the conversion of a stream, all Vimba image transform setup happens here
+ */
+VmbErrorType ConversionContext::Setup( VmbPixelFormatType eSourceFormat, VmbUint32_t nWidth, VmbUint32_t nHeight, const char *pDestinationFormat,
+                                       const VmbFloat_t *pMatrix, DemosaicProcessing eDemosaic, size_t nBufferCount )
+{
+    m_bValid = false;
+    if( NULL == pDestinationFormat )
+    {
+        return VmbErrorBadParameter;
+    }
+
+    // Prepare destination image
+    m_DestinationImage.Size = sizeof( m_DestinationImage );
+    VmbErrorType Result = static_cast<VmbErrorType>( VmbSetImageInfoFromString( pDestinationFormat, static_cast<VmbUint32_t>( std::strlen( pDestinationFormat )), nWidth, nHeight, &m_DestinationImage ));
+    if( VmbErrorSuccess != Result )
+    {
+        return Result;
+    }
+    const size_t ByteCount = ( static_cast<size_t>( m_DestinationImage.ImageInfo.PixelInfo.BitsPerPixel ) * nWidth * nHeight ) / 8;
+
+    const bool bBGR8    = 0 == std::strcmp( pDestinationFormat, "BGR8" );
+    const bool bMono8   = 0 == std::strcmp( pDestinationFormat, "Mono8" );
+    const bool bMono16  = 0 == std::strcmp( pDestinationFormat, "Mono16" );
+    m_bMatrix           = NULL != pMatrix;
+    m_bInTreeDemosaic   = ( PixelFormatIsBayer( eSourceFormat ) && 8 == PixelFormatBitsPerPixel( eSourceFormat ))
+                        && ( bBGR8 || bMono8 )
+                        && ( DemosaicProcessing_Vimba != eDemosaic );
+    m_bEdgeAware        = DemosaicProcessing_EdgeAware == eDemosaic;
+    m_bInTreeUnpack     = ( 0 != UnpackBitDepth( eSourceFormat ))
+                        && ( bMono8 || bMono16 );
+    if( m_bMatrix )
+    {
+        std::memcpy( m_Matrix, pMatrix, sizeof( m_Matrix ));
+    }
+
+    if( !m_bInTreeDemosaic && !m_bInTreeUnpack )
+    {
+        // Prepare source image
+        m_SourceImage.Size = sizeof( m_SourceImage );
+        Result = static_cast<VmbErrorType>( VmbSetImageInfoFromPixelFormat( eSourceFormat, nWidth, nHeight, &m_SourceImage ));
+        if( VmbErrorSuccess != Result )
+        {
+            return Result;
+        }
+        if( m_bMatrix )
+        {
+            Result = static_cast<VmbErrorType>( VmbSetColorCorrectionMatrix3x3( pMatrix, &m_TransformInfo ));
+            if( VmbErrorSuccess != Result )
+            {
+                return Result;
+            }
+        }
+    }
+
+    if( !m_pPool || ByteCount != m_pPool->BufferSize() || nBufferCount != m_pPool->BufferCount() )
+    {
+        for( size_t i = m_RetiredPools.size(); i-- > 0; )
+        {
+            if( m_RetiredPools[i]->Available() == m_RetiredPools[i]->BufferCount() )
+            {
+                m_RetiredPools.erase( m_RetiredPools.begin() + i );
+            }
+        }
+        // Images still leased from the pool, e.g. travelling through a pipeline, keep it alive
+        if( m_pPool && m_pPool->Available() < m_pPool->BufferCount() )
+        {
+            m_RetiredPools.push_back( std::move( m_pPool ));
+        }
+        if( !m_pPool )
+        {
+            m_pPool.reset( new ImageBufferPool );
+        }
+        Result = m_pPool->Allocate( ByteCount, nBufferCount );
+        if( VmbErrorSuccess != Result )
+        {
+            return Result;
+        }
+    }
+
+    m_eSourceFormat = eSourceFormat;
+    m_nWidth        = nWidth;
+    m_nHeight       = nHeight;
+    m_bValid        = true;
+    return VmbErrorSuccess;
+}
+
+bool ConversionContext::Matches( VmbPixelFormatType eSourceFormat, VmbUint32_t nWidth, VmbUint32_t nHeight ) const
+{
+    return m_bValid && eSourceFormat == m_eSourceFormat && nWidth == m_nWidth && nHeight == m_nHeight;
+}
+
+/**
+ * @brief Converts one image into a buffer of the pool
+ */
+VmbErrorType ConversionContext::Transform( const VmbUchar_t *pSource, ImageBufferLease &Lease )
+{
+    if( !m_bValid || NULL == pSource )
+    {
+        return VmbErrorBadParameter;
+    }
+    VmbErrorType Result = m_pPool->Acquire( Lease );
+    if( VmbErrorSuccess != Result )
+    {
+        return Result;
+    }
+
+    if( m_bInTreeDemosaic )
+    {
+        Result = DemosaicBayer8( pSource, m_nWidth, m_nHeight, m_eSourceFormat, Lease.Data(),
+                                 24 == m_DestinationImage.ImageInfo.PixelInfo.BitsPerPixel ? DemosaicOutput_BGR8 : DemosaicOutput_Mono8,
+                                 m_bEdgeAware ? DemosaicMethod_EdgeAware : DemosaicMethod_Bilinear,
+                                 SimdLevel_Auto, m_bMatrix ? m_Matrix : NULL );
+    }
+    else if( m_bInTreeUnpack )
+    {
+        const VmbUint32_t nPixelCount = m_nWidth * m_nHeight;
+        if( 16 == m_DestinationImage.ImageInfo.PixelInfo.BitsPerPixel )
+        {
+            Result = UnpackMono16( pSource, nPixelCount, m_eSourceFormat, reinterpret_cast<VmbUint16_t*>( Lease.Data() ));
+        }
+        else
+        {
+            Result = UnpackMono8( pSource, nPixelCount, m_eSourceFormat, Lease.Data() );
+        }
+    }
+    else
+    {
+        m_SourceImage.Data      = const_cast<VmbUchar_t*>( pSource );
+        m_DestinationImage.Data = Lease.Data();
+        // Transform data
+        Result = static_cast<VmbErrorType>( VmbImageTransform( &m_SourceImage, &m_DestinationImage, m_bMatrix ? &m_TransformInfo : NULL, m_bMatrix ? 1 : 0 ));
+    }
+
+    if( VmbErrorSuccess != Result )
+    {
+        Lease.Release();
+    }
+    return Result;
+}
+
+}} // namespace AVT::VmbAPI
@@ -0,0 +1,538 @@
+#include <cstdlib>
+
+#include "Demosaic.h"
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+#define DEMOSAIC_X86
+#include <immintrin.h>
+#endif
+
+namespace AVT {
+namespace VmbAPI {
+
+namespace {
+
+/**
+ * @brief Where the colours sit in one row of the Bayer image
+ */
+struct BayerRow
+{
+    bool        bRedRow;        // The row holds red and green samples, otherwise blue and green
+    VmbUint32_t nGreenParity;   // Column parity of the green samples
+};
+
+/**
+ * @brief Colour layout of the given row for one of the four 8 bit Bayer formats
+ */
+bool GetBayerRow( VmbPixelFormatType eFormat, VmbUint32_t y, BayerRow &row )
+{
+    bool        bEvenRowRed;
+    VmbUint32_t nEvenRowGreenParity;
+    switch( eFormat )
+    {
+    case VmbPixelFormatBayerRG8: bEvenRowRed = true;  nEvenRowGreenParity = 1; break;
+    case VmbPixelFormatBayerGR8: bEvenRowRed = true;  nEvenRowGreenParity = 0; break;
+    case VmbPixelFormatBayerGB8: bEvenRowRed = false; nEvenRowGreenParity = 0; break;
+    case VmbPixelFormatBayerBG8: bEvenRowRed = false; nEvenRowGreenParity = 1; break;
+    default:
+        return false;
+    }
+    const bool bOddRow  = 0 != ( y & 1 );
+    row.bRedRow         = bOddRow ? !bEvenRowRed : bEvenRowRed;
+    row.nGreenParity    = bOddRow ? nEvenRowGreenParity ^ 1 : nEvenRowGreenParity;
+    return true;
+}
+
+/**
+ * @brief Interpolates a single pixel, the reference every vectorised kernel has to match.
+ * Columns outside the image are mirrored, the rows are mirrored by the caller
+ */
+inline void DemosaicPixel( const VmbUchar_t *pUp, const VmbUchar_t *pMid, const VmbUchar_t *pDown, VmbUint32_t x, VmbUint32_t nWidth,
+                           const BayerRow &row, DemosaicMethod eMethod, int &nRed, int &nGreen, int &nBlue )
+{
+    const VmbUint32_t xl = x > 0 ? x - 1 : 1;
+    const VmbUint32_t xr = x + 1 < nWidth ? x + 1 : nWidth - 2;
+    const int c = pMid[x];
+    const int l = pMid[xl];
+    const int r = pMid[xr];
+    const int u = pUp[x];
+    const int d = pDown[x];
+    const int nAvgH = ( l + r + 1 ) >> 1;
+    const int nAvgV = ( u + d + 1 ) >> 1;
+
+    if(( x & 1 ) == row.nGreenParity )
+    {
+        nGreen = c;
+        if( row.bRedRow )
+        {
+            nRed    = nAvgH;
+            nBlue   = nAvgV;
+        }
+        else
+        {
+            nBlue   = nAvgH;
+            nRed    = nAvgV;
+        }
+        return;
+    }
+
+    const int nAvgX = ( pUp[xl] + pUp[xr] + pDown[xl] + pDown[xr] + 2 ) >> 2;
+    const int nAvgP = ( l + r + u + d + 2 ) >> 2;
+    nGreen = nAvgP;
+    if( DemosaicMethod_EdgeAware == eMethod )
+    {
+        const int nGradH = std::abs( l - r );
+        const int nGradV = std::abs( u - d );
+        if( nGradH < nGradV )
+        {
+            nGreen = nAvgH;
+        }
+        else if( nGradV < nGradH )
+        {
+            nGreen = nAvgV;
+        }
+    }
+    if( row.bRedRow )
+    {
+        nRed    = c;
+        nBlue   = nAvgX;
+    }
+    else
+    {
+        nBlue   = c;
+        nRed    = nAvgX;
+    }
+}
+
+inline VmbUchar_t Luminance( int nRed, int nGreen, int nBlue )
+{
+    return static_cast<VmbUchar_t>(( 77 * nRed + 150 * nGreen + 29 * nBlue + 128 ) >> 8 );
+}
+
+// Colour correction coefficients are fixed point with 12 fractional bits, 1.0 is 4096
+const int           MATRIX_SHIFT    = 12;
+const int           MATRIX_ONE      = 1 << MATRIX_SHIFT;
+const VmbFloat_t    MATRIX_LIMIT    = 8.0f;
+
+/**
+ * @brief Converts a row major colour correction matrix to fixed point
+ *
+ * @return false if a coefficient is outside [-8, 8)
+ */
+bool MatrixToFixed( const VmbFloat_t *pMatrix, VmbInt16_t *pFixed )
+{
+    for( int i = 0; i < 9; ++i )
+    {
+        if( !( pMatrix[i] >= -MATRIX_LIMIT && pMatrix[i] < MATRIX_LIMIT ))
+        {
+            return false;
+        }
+        const VmbFloat_t fScaled = pMatrix[i] * MATRIX_ONE;
+        const int nFixed = static_cast<int>( fScaled < 0 ? fScaled - 0.5f : fScaled + 0.5f );
+        pFixed[i] = static_cast<VmbInt16_t>( nFixed < -32768 ? -32768 : nFixed > 32767 ? 32767 : nFixed );
+    }
+    return true;
+}
+
+inline int CorrectChannel( const VmbInt16_t *pRow, int nRed, int nGreen, int nBlue )
+{
+    const int nValue = ( pRow[0] * nRed + pRow[1] * nGreen + pRow[2] * nBlue + MATRIX_ONE / 2 ) >> MATRIX_SHIFT;
+    return nValue < 0 ? 0 : nValue > 255 ? 255 : nValue;
+}
+
+/**
+ * @brief Applies the fixed point colour correction to one pixel, the reference of the vector kernels
+ */
+inline void CorrectPixel( const VmbInt16_t *pMatrix, int &nRed, int &nGreen, int &nBlue )
+{
+    const int nR = nRed, nG = nGreen, nB = nBlue;
+    nRed    = CorrectChannel( pMatrix,     nR, nG, nB );
+    nGreen  = CorrectChannel( pMatrix + 3, nR, nG, nB );
+    nBlue   = CorrectChannel( pMatrix + 6, nR, nG, nB );
+}
+
+/**
+ * @brief Demosaics the pixels [xBegin, xEnd) of one row with the reference implementation
+ */
+void DemosaicSpan( const VmbUchar_t *pUp, const VmbUchar_t *pMid, const VmbUchar_t *pDown, VmbUint32_t nWidth, const BayerRow &row,
+                   DemosaicMethod eMethod, DemosaicOutput eOutput, const VmbInt16_t *pMatrix, VmbUchar_t *pDestination, VmbUint32_t xBegin, VmbUint32_t xEnd )
+{
+    int nRed, nGreen, nBlue;
+    for( VmbUint32_t x = xBegin; x < xEnd; ++x )
+    {
+        DemosaicPixel( pUp, pMid, pDown, x, nWidth, row, eMethod, nRed, nGreen, nBlue );
+        if( NULL != pMatrix )
+        {
+            CorrectPixel( pMatrix, nRed, nGreen, nBlue );
+        }
+        if( DemosaicOutput_BGR8 == eOutput )
+        {
+            pDestination[ 3 * x ]       = static_cast<VmbUchar_t>( nBlue );
+            pDestination[ 3 * x + 1 ]   = static_cast<VmbUchar_t>( nGreen );
+            pDestination[ 3 * x + 2 ]   = static_cast<VmbUchar_t>( nRed );
+        }
+        else
+        {
+            pDestination[ x ] = Luminance( nRed, nGreen, nBlue );
+        }
+    }
+}
+
+typedef void (*RowKernel)( const VmbUchar_t *pUp, const VmbUchar_t *pMid, const VmbUchar_t *pDown, VmbUint32_t nWidth, const BayerRow &row,
+                           DemosaicMethod eMethod, DemosaicOutput eOutput, const VmbInt16_t *pMatrix, VmbUchar_t *pDestination );
+
+void DemosaicRowScalar( const VmbUchar_t *pUp, const VmbUchar_t *pMid, const VmbUchar_t *pDown, VmbUint32_t nWidth, const BayerRow &row,
+                        DemosaicMethod eMethod, DemosaicOutput eOutput, const VmbInt16_t *pMatrix, VmbUchar_t *pDestination )
+{
+    DemosaicSpan( pUp, pMid, pDown, nWidth, row, eMethod, eOutput, pMatrix, pDestination, 0, nWidth );
+}
+
+#ifdef DEMOSAIC_X86
+
+// The vector kernels work on 16 pixels per step starting at an odd column,
+// so the colour of every lane is known up front. Column 0 and the tail go through DemosaicSpan.
+const VmbUint32_t SIMD_STEP = 16;
+
+/**
+ * @brief Interleaves 16 blue, green and red bytes into 48 bytes of BGR8
+ */
+__attribute__(( target( "sse4.1" )))
+inline void StoreBGR( VmbUchar_t *pDestination, __m128i b, __m128i g, __m128i r )
+{
+    const __m128i b0 = _mm_setr_epi8(  0, -1, -1,  1, -1, -1,  2, -1, -1,  3, -1, -1,  4, -1, -1,  5 );
+    const __m128i g0 = _mm_setr_epi8( -1,  0, -1, -1,  1, -1, -1,  2, -1, -1,  3, -1, -1,  4, -1, -1 );
+    const __m128i r0 = _mm_setr_epi8( -1, -1,  0, -1, -1,  1, -1, -1,  2, -1, -1,  3, -1, -1,  4, -1 );
+    const __m128i b1 = _mm_setr_epi8( -1, -1,  6, -1, -1,  7, -1, -1,  8, -1, -1,  9, -1, -1, 10, -1 );
+    const __m128i g1 = _mm_setr_epi8(  5, -1, -1,  6, -1, -1,  7, -1, -1,  8, -1, -1,  9, -1, -1, 10 );
+    const __m128i r1 = _mm_setr_epi8( -1,  5, -1, -1,  6, -1, -1,  7, -1, -1,  8, -1, -1,  9, -1, -1 );
+    const __m128i b2 = _mm_setr_epi8( -1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15, -1, -1 );
+    const __m128i g2 = _mm_setr_epi8( -1, -1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15, -1 );
+    const __m128i r2 = _mm_setr_epi8( 10, -1, -1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15 );
+    __m128i *pOut = reinterpret_cast<__m128i*>( pDestination );
+    _mm_storeu_si128( pOut,     _mm_or_si128( _mm_or_si128( _mm_shuffle_epi8( b, b0 ), _mm_shuffle_epi8( g, g0 )), _mm_shuffle_epi8( r, r0 )));
+    _mm_storeu_si128( pOut + 1, _mm_or_si128( _mm_or_si128( _mm_shuffle_epi8( b, b1 ), _mm_shuffle_epi8( g, g1 )), _mm_shuffle_epi8( r, r1 )));
+    _mm_storeu_si128( pOut + 2, _mm_or_si128( _mm_or_si128( _mm_shuffle_epi8( b, b2 ), _mm_shuffle_epi8( g, g2 )), _mm_shuffle_epi8( r, r2 )));
+}
+
+__attribute__(( target( "sse4.1" )))
+inline __m128i Load8x16( const VmbUchar_t *p )
+{
+    return _mm_cvtepu8_epi16( _mm_loadl_epi64( reinterpret_cast<const __m128i*>( p )));
+}
+
+/**
+ * @brief Interpolates 8 pixels in 16 bit lanes, same arithmetic as DemosaicPixel
+ */
+__attribute__(( target( "sse4.1" )))
+inline void Demosaic8SSE41( const VmbUchar_t *pUp, const VmbUchar_t *pMid, const VmbUchar_t *pDown, __m128i greenMask, bool bRedRow,
+                            DemosaicMethod eMethod, __m128i &red, __m128i &green, __m128i &blue )
+{
+    const __m128i c     = Load8x16( pMid );
+    const __m128i l     = Load8x16( pMid - 1 );
+    const __m128i r     = Load8x16( pMid + 1 );
+    const __m128i u     = Load8x16( pUp );
+    const __m128i d     = Load8x16( pDown );
+    const __m128i two   = _mm_set1_epi16( 2 );
+    const __m128i avgH  = _mm_avg_epu16( l, r );
+    const __m128i avgV  = _mm_avg_epu16( u, d );
+    const __m128i sumX  = _mm_add_epi16( _mm_add_epi16( Load8x16( pUp - 1 ), Load8x16( pUp + 1 )),
+                                         _mm_add_epi16( Load8x16( pDown - 1 ), Load8x16( pDown + 1 )));
+    const __m128i avgX  = _mm_srli_epi16( _mm_add_epi16( sumX, two ), 2 );
+    __m128i       gNon  = _mm_srli_epi16( _mm_add_epi16( _mm_add_epi16( _mm_add_epi16( l, r ), _mm_add_epi16( u, d )), two ), 2 );
+    if( DemosaicMethod_EdgeAware == eMethod )
+    {
+        const __m128i gradH = _mm_abs_epi16( _mm_sub_epi16( l, r ));
+        const __m128i gradV = _mm_abs_epi16( _mm_sub_epi16( u, d ));
+        gNon = _mm_blendv_epi8( gNon, avgH, _mm_cmplt_epi16( gradH, gradV ));
+        gNon = _mm_blendv_epi8( gNon, avgV, _mm_cmplt_epi16( gradV, gradH ));
+    }
+    green = _mm_blendv_epi8( gNon, c, greenMask );
+    const __m128i own   = _mm_blendv_epi8( c, avgH, greenMask );
+    const __m128i other = _mm_blendv_epi8( avgX, avgV, greenMask );
+    red   = bRedRow ? own : other;
+    blue  = bRedRow ? other : own;
+}
+
+__attribute__(( target( "sse4.1" )))
+inline __m128i Luminance16SSE41( __m128i red, __m128i green, __m128i blue )
+{
+    const __m128i sum = _mm_add_epi16( _mm_add_epi16( _mm_mullo_epi16( red, _mm_set1_epi16( 77 )), _mm_mullo_epi16( green, _mm_set1_epi16( 150 ))),
+                                       _mm_add_epi16( _mm_mullo_epi16( blue, _mm_set1_epi16( 29 )), _mm_set1_epi16( 128 )));
+    return _mm_srli_epi16( sum, 8 );
+}
+
+/**
+ * @brief Two 16 bit lanes in one 32 bit word, the low one first as _mm_madd_epi16 reads them.
+ * Shifted unsigned, a negative high coefficient must not be shifted as a signed value
+ */
+inline VmbInt32_t PackPair( VmbInt16_t nLow, VmbInt16_t nHigh )
+{
+    const VmbUint32_t nPair = static_cast<VmbUint16_t>( nLow ) | ( static_cast<VmbUint32_t>( static_cast<VmbUint16_t>( nHigh )) << 16 );
+    return static_cast<VmbInt32_t>( nPair );
+}
+
+/**
+ * @brief Pairs of fixed point coefficients for _mm_madd_epi16, red and green of each matrix row
+ * in one pair, blue and the rounding term in the other
+ */
+inline void MatrixPairs( const VmbInt16_t *pMatrix, VmbInt32_t *pPairs )
+{
+    for( int i = 0; i < 3; ++i )
+    {
+        pPairs[ 2 * i ]     = PackPair( pMatrix[ 3 * i ], pMatrix[ 3 * i + 1 ] );
+        pPairs[ 2 * i + 1 ] = PackPair( pMatrix[ 3 * i + 2 ], MATRIX_ONE / 2 );
+    }
+}
+
+/**
+ * @brief One corrected channel of 8 pixels, same arithmetic as CorrectChannel
+ */
+__attribute__(( target( "sse4.1" )))
+inline __m128i CorrectChannel8SSE41( __m128i rgLow, __m128i rgHigh, __m128i b1Low, __m128i b1High, VmbInt32_t nPairRG, VmbInt32_t nPairB1 )
+{
+    const __m128i pairRG    = _mm_set1_epi32( nPairRG );
+    const __m128i pairB1    = _mm_set1_epi32( nPairB1 );
+    const __m128i low       = _mm_srai_epi32( _mm_add_epi32( _mm_madd_epi16( rgLow, pairRG ), _mm_madd_epi16( b1Low, pairB1 )), MATRIX_SHIFT );
+    const __m128i high      = _mm_srai_epi32( _mm_add_epi32( _mm_madd_epi16( rgHigh, pairRG ), _mm_madd_epi16( b1High, pairB1 )), MATRIX_SHIFT );
+    return _mm_min_epi16( _mm_max_epi16( _mm_packs_epi32( low, high ), _mm_setzero_si128() ), _mm_set1_epi16( 255 ));
+}
+
+/**
+ * @brief Applies the colour correction to 8 pixels while they are still in 16 bit lanes
+ */
+__attribute__(( target( "sse4.1" )))
+inline void Correct8SSE41( const VmbInt32_t *pPairs, __m128i &red, __m128i &green, __m128i &blue )
+{
+    const __m128i one       = _mm_set1_epi16( 1 );
+    const __m128i rgLow     = _mm_unpacklo_epi16( red, green );
+    const __m128i rgHigh    = _mm_unpackhi_epi16( red, green );
+    const __m128i b1Low     = _mm_unpacklo_epi16( blue, one );
+    const __m128i b1High    = _mm_unpackhi_epi16( blue, one );
+    red     = CorrectChannel8SSE41( rgLow, rgHigh, b1Low, b1High, pPairs[0], pPairs[1] );
+    green   = CorrectChannel8SSE41( rgLow, rgHigh, b1Low, b1High, pPairs[2], pPairs[3] );
+    blue    = CorrectChannel8SSE41( rgLow, rgHigh, b1Low, b1High, pPairs[4], pPairs[5] );
+}
+
+__attribute__(( target( "sse4.1" )))
+void DemosaicRowSSE41( const VmbUchar_t *pUp, const VmbUchar_t *pMid, const VmbUchar_t *pDown, VmbUint32_t nWidth, const BayerRow &row,
+                       DemosaicMethod eMethod, DemosaicOutput eOutput, const VmbInt16_t *pMatrix, VmbUchar_t *pDestination )
+{
+    // Lane 0 is an odd column
+    const __m128i evenLanes = _mm_setr_epi16( -1, 0, -1, 0, -1, 0, -1, 0 );
+    const __m128i greenMask = 1 == row.nGreenParity ? evenLanes : _mm_xor_si128( evenLanes, _mm_set1_epi16( -1 ));
+    VmbInt32_t pairs[6];
+    if( NULL != pMatrix )
+    {
+        MatrixPairs( pMatrix, pairs );
+    }
+
+    DemosaicSpan( pUp, pMid, pDown, nWidth, row, eMethod, eOutput, pMatrix, pDestination, 0, 1 );
+    VmbUint32_t x = 1;
+    for( ; x + SIMD_STEP < nWidth; x += SIMD_STEP )
+    {
+        __m128i red0, green0, blue0, red1, green1, blue1;
+        Demosaic8SSE41( pUp + x,     pMid + x,     pDown + x,     greenMask, row.bRedRow, eMethod, red0, green0, blue0 );
+        Demosaic8SSE41( pUp + x + 8, pMid + x + 8, pDown + x + 8, greenMask, row.bRedRow, eMethod, red1, green1, blue1 );
+        if( NULL != pMatrix )
+        {
+            Correct8SSE41( pairs, red0, green0, blue0 );
+            Correct8SSE41( pairs, red1, green1, blue1 );
+        }
+        if( DemosaicOutput_BGR8 == eOutput )
+        {
+            StoreBGR( pDestination + 3 * x, _mm_packus_epi16( blue0, blue1 ), _mm_packus_epi16( green0, green1 ), _mm_packus_epi16( red0, red1 ));
+        }
+        else
+        {
+            _mm_storeu_si128( reinterpret_cast<__m128i*>( pDestination + x ),
+                              _mm_packus_epi16( Luminance16SSE41( red0, green0, blue0 ), Luminance16SSE41( red1, green1, blue1 )));
+        }
+    }
+    DemosaicSpan( pUp, pMid, pDown, nWidth, row, eMethod, eOutput, pMatrix, pDestination, x, nWidth );
+}
+
+__attribute__(( target( "avx2" )))
+inline __m256i Load16x16( const VmbUchar_t *p )
+{
+    return _mm256_cvtepu8_epi16( _mm_loadu_si128( reinterpret_cast<const __m128i*>( p )));
+}
+
+/**
+ * @brief Packs 16 lanes of 16 bit values below 256 into 16 bytes
+ */
+__attribute__(( target( "avx2" )))
+inline __m128i Pack16x16( __m256i v )
+{
+    return _mm_packus_epi16( _mm256_castsi256_si128( v ), _mm256_extracti128_si256( v, 1 ));
+}
+
+/**
+ * @brief Interpolates 16 pixels in 16 bit lanes, same arithmetic as DemosaicPixel
+ */
+__attribute__(( target( "avx2" )))
+inline void Demosaic16AVX2( const VmbUchar_t *pUp, const VmbUchar_t *pMid, const VmbUchar_t *pDown, __m256i greenMask, bool bRedRow,
+                            DemosaicMethod eMethod, __m256i &red, __m256i &green, __m256i &blue )
+{
+    const __m256i c     = Load16x16( pMid );
+    const __m256i l     = Load16x16( pMid - 1 );
+    const __m256i r     = Load16x16( pMid + 1 );
+    const __m256i u     = Load16x16( pUp );
+    const __m256i d     = Load16x16( pDown );
+    const __m256i two   = _mm256_set1_epi16( 2 );
+    const __m256i avgH  = _mm256_avg_epu16( l, r );
+    const __m256i avgV  = _mm256_avg_epu16( u, d );
+    const __m256i sumX  = _mm256_add_epi16( _mm256_add_epi16( Load16x16( pUp - 1 ), Load16x16( pUp + 1 )),
+                                            _mm256_add_epi16( Load16x16( pDown - 1 ), Load16x16( pDown + 1 )));
+    const __m256i avgX  = _mm256_srli_epi16( _mm256_add_epi16( sumX, two ), 2 );
+    __m256i       gNon  = _mm256_srli_epi16( _mm256_add_epi16( _mm256_add_epi16( _mm256_add_epi16( l, r ), _mm256_add_epi16( u, d )), two ), 2 );
+    if( DemosaicMethod_EdgeAware == eMethod )
+    {
+        const __m256i gradH = _mm256_abs_epi16( _mm256_sub_epi16( l, r ));
+        const __m256i gradV = _mm256_abs_epi16( _mm256_sub_epi16( u, d ));
+        gNon = _mm256_blendv_epi8( gNon, avgH, _mm256_cmpgt_epi16( gradV, gradH ));
+        gNon = _mm256_blendv_epi8( gNon, avgV, _mm256_cmpgt_epi16( gradH, gradV ));
+    }
+    green = _mm256_blendv_epi8( gNon, c, greenMask );
+    const __m256i own   = _mm256_blendv_epi8( c, avgH, greenMask );
+    const __m256i other = _mm256_blendv_epi8( avgX, avgV, greenMask );
+    red   = bRedRow ? own : other;
+    blue  = bRedRow ? other : own;
+}
+
+__attribute__(( target( "avx2" )))
+inline __m256i Luminance16AVX2( __m256i red, __m256i green, __m256i blue )
+{
+    const __m256i sum = _mm256_add_epi16( _mm256_add_epi16( _mm256_mullo_epi16( red, _mm256_set1_epi16( 77 )), _mm256_mullo_epi16( green, _mm256_set1_epi16( 150 ))),
+                                          _mm256_add_epi16( _mm256_mullo_epi16( blue, _mm256_set1_epi16( 29 )), _mm256_set1_epi16( 128 )));
+    return _mm256_srli_epi16( sum, 8 );
+}
+
+/**
+ * @brief One corrected channel of 16 pixels, same arithmetic as CorrectChannel.
+ * Unpack and pack both work within 128 bit halves, so the pixel order is kept
+ */
+__attribute__(( target( "avx2" )))
+inline __m256i CorrectChannel16AVX2( __m256i rgLow, __m256i rgHigh, __m256i b1Low, __m256i b1High, VmbInt32_t nPairRG, VmbInt32_t nPairB1 )
+{
+    const __m256i pairRG    = _mm256_set1_epi32( nPairRG );
+    const __m256i pairB1    = _mm256_set1_epi32( nPairB1 );
+    const __m256i low       = _mm256_srai_epi32( _mm256_add_epi32( _mm256_madd_epi16( rgLow, pairRG ), _mm256_madd_epi16( b1Low, pairB1 )), MATRIX_SHIFT );
+    const __m256i high      = _mm256_srai_epi32( _mm256_add_epi32( _mm256_madd_epi16( rgHigh, pairRG ), _mm256_madd_epi16( b1High, pairB1 )), MATRIX_SHIFT );
+    return _mm256_min_epi16( _mm256_max_epi16( _mm256_packs_epi32( low, high ), _mm256_setzero_si256() ), _mm256_set1_epi16( 255 ));
+}
+
+/**
+ * @brief Applies the colour correction to 16 pixels while they are still in 16 bit lanes
+ */
+__attribute__(( target( "avx2" )))
+inline void Correct16AVX2( const VmbInt32_t *pPairs, __m256i &red, __m256i &green, __m256i &blue )
+{
+    const __m256i one       = _mm256_set1_epi16( 1 );
+    const __m256i rgLow     = _mm256_unpacklo_epi16( red, green );
+    const __m256i rgHigh    = _mm256_unpackhi_epi16( red, green );
+    const __m256i b1Low     = _mm256_unpacklo_epi16( blue, one );
+    const __m256i b1High    = _mm256_unpackhi_epi16( blue, one );
+    red     = CorrectChannel16AVX2( rgLow, rgHigh, b1Low, b1High, pPairs[0], pPairs[1] );
+    green   = CorrectChannel16AVX2( rgLow, rgHigh, b1Low, b1High, pPairs[2], pPairs[3] );
+    blue    = CorrectChannel16AVX2( rgLow, rgHigh, b1Low, b1High, pPairs[4], pPairs[5] );
+}
+
+__attribute__(( target( "avx2" )))
+void DemosaicRowAVX2( const VmbUchar_t *pUp, const VmbUchar_t *pMid, const VmbUchar_t *pDown, VmbUint32_t nWidth, const BayerRow &row,
+                      DemosaicMethod eMethod, DemosaicOutput eOutput, const VmbInt16_t *pMatrix, VmbUchar_t *pDestination )
+{
+    // Lane 0 is an odd column
+    const __m256i evenLanes = _mm256_setr_epi16( -1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0 );
+    const __m256i greenMask = 1 == row.nGreenParity ? evenLanes : _mm256_xor_si256( evenLanes, _mm256_set1_epi16( -1 ));
+    VmbInt32_t pairs[6];
+    if( NULL != pMatrix )
+    {
+        MatrixPairs( pMatrix, pairs );
+    }
+
+    DemosaicSpan( pUp, pMid, pDown, nWidth, row, eMethod, eOutput, pMatrix, pDestination, 0, 1 );
+    VmbUint32_t x = 1;
+    for( ; x + SIMD_STEP < nWidth; x += SIMD_STEP )
+    {
+        __m256i red, green, blue;
+        Demosaic16AVX2( pUp + x, pMid + x, pDown + x, greenMask, row.bRedRow, eMethod, red, green, blue );
+        if( NULL != pMatrix )
+        {
+            Correct16AVX2( pairs, red, green, blue );
+        }
+        if( DemosaicOutput_BGR8 == eOutput )
+        {
+            StoreBGR( pDestination + 3 * x, Pack16x16( blue ), Pack16x16( green ), Pack16x16( red ));
+        }
+        else
+        {
+            _mm_storeu_si128( reinterpret_cast<__m128i*>( pDestination + x ), Pack16x16( Luminance16AVX2( red, green, blue )));
+        }
+    }
+    DemosaicSpan( pUp, pMid, pDown, nWidth, row, eMethod, eOutput, pMatrix, pDestination, x, nWidth );
+}
+
+#endif // DEMOSAIC_X86
+
+RowKernel SelectRowKernel( SimdLevel eLevel )
+{
+    switch( ResolveSimdLevel( eLevel ))
+    {
+#ifdef DEMOSAIC_X86
+    case SimdLevel_AVX2:
+        return DemosaicRowAVX2;
+    case SimdLevel_SSE41:
+        return DemosaicRowSSE41;
+#endif
+    default:
+        return DemosaicRowScalar;
+    }
+}
+
+} // namespace
+
+VmbErrorType DemosaicBayer8( const VmbUchar_t *pSource, VmbUint32_t nWidth, VmbUint32_t nHeight, VmbPixelFormatType eFormat,
+                             VmbUchar_t *pDestination, DemosaicOutput eOutput, DemosaicMethod eMethod, SimdLevel eSimd, const VmbFloat_t *pMatrix )
+{
+    return DemosaicBayer8Rows( pSource, nWidth, nHeight, eFormat, pDestination, eOutput, eMethod, eSimd, 0, nHeight, pMatrix );
+}
+
+VmbErrorType DemosaicBayer8Rows( const VmbUchar_t *pSource, VmbUint32_t nWidth, VmbUint32_t nHeight, VmbPixelFormatType eFormat,
+                                 VmbUchar_t *pDestination, DemosaicOutput eOutput, DemosaicMethod eMethod, SimdLevel eSimd,
+                                 VmbUint32_t nFirstRow, VmbUint32_t nRowCount, const VmbFloat_t *pMatrix )
+{
+    BayerRow row;
+    if( !GetBayerRow( eFormat, 0, row ))
+    {
+        return VmbErrorNotSupported;
+    }
+    if(     ( NULL == pSource || NULL == pDestination )
+        ||  ( nWidth < 2 || nHeight < 2 )
+        ||  ( nFirstRow > nHeight || nRowCount > nHeight - nFirstRow ))
+    {
+        return VmbErrorBadParameter;
+    }
+    VmbInt16_t fixedMatrix[9];
+    if( NULL != pMatrix && !MatrixToFixed( pMatrix, fixedMatrix ))
+    {
+        return VmbErrorBadParameter;
+    }
+
+    const RowKernel     kernel          = SelectRowKernel( eSimd );
+    const size_t        nChannels       = DemosaicOutput_BGR8 == eOutput ? 3 : 1;
+    for( VmbUint32_t y = nFirstRow; y < nFirstRow + nRowCount; ++y )
+    {
+        // Mirror the rows outside the image like the columns
+        const VmbUint32_t yUp   = y > 0 ? y - 1 : 1;
+        const VmbUint32_t yDown = y + 1 < nHeight ? y + 1 : nHeight - 2;
+        GetBayerRow( eFormat, y, row );
+        kernel( pSource + static_cast<size_t>( yUp ) * nWidth,
+                pSource + static_cast<size_t>( y ) * nWidth,
+                pSource + static_cast<size_t>( yDown ) * nWidth,
+                nWidth, row, eMethod, eOutput, NULL != pMatrix ? fixedMatrix : NULL,
+                pDestination + static_cast<size_t>( y ) * nWidth * nChannels );
+    }
+    return VmbErrorSuccess;
+}
+
+}} // namespace AVT::VmbAPI
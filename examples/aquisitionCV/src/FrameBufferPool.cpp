@@ -0,0 +1,219 @@
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <dirent.h>
+
+#include "FrameBufferPool.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+static const size_t PAGE_SIZE_SMALL = 4096;
+static const size_t PAGE_SIZE_HUGE  = 2 * 1024 * 1024;
+
+// From linux/mempolicy.h, the buffers prefer the node but may spill over instead of failing
+static const int    MPOL_PREFERRED_NODE = 1;
+static const int    MAX_NUMA_NODES      = 1024;
+
+static size_t RoundUp( size_t nValue, size_t nMultiple )
+{
+    return ( nValue + nMultiple - 1 ) / nMultiple * nMultiple;
+}
+
+/**
+ * @brief Maps anonymous memory aligned to 2 MB, so transparent huge pages can back all of it
+ */
+static void* MapAligned( size_t nBytes )
+{
+    const size_t nMapped = nBytes + PAGE_SIZE_HUGE;
+    void *p = mmap( NULL, nMapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+    if( MAP_FAILED == p )
+    {
+        return NULL;
+    }
+    char * const pStart = static_cast<char*>( p );
+    char * const pAligned = pStart + ( RoundUp( reinterpret_cast<size_t>( pStart ), PAGE_SIZE_HUGE ) - reinterpret_cast<size_t>( pStart ));
+    if( pAligned > pStart )
+    {
+        munmap( pStart, pAligned - pStart );
+    }
+    if( pStart + nMapped > pAligned + nBytes )
+    {
+        munmap( pAligned + nBytes, pStart + nMapped - ( pAligned + nBytes ));
+    }
+    return pAligned;
+}
+
+static bool BindToNode( void *p, size_t nBytes, int nNode )
+{
+    unsigned long mask[ MAX_NUMA_NODES / ( 8 * sizeof( unsigned long )) ];
+    std::memset( mask, 0, sizeof( mask ));
+    mask[ nNode / ( 8 * sizeof( unsigned long )) ] |= 1UL << ( nNode % ( 8 * sizeof( unsigned long )));
+    // The kernel reads one bit less than maxnode
+    return 0 == syscall( SYS_mbind, p, nBytes, MPOL_PREFERRED_NODE, mask, MAX_NUMA_NODES + 1, 0 );
+}
+
+/**
+ * @return The first number in the file, or nDefault
+ */
+static int ReadNumber( const std::string &strFile, int nDefault )
+{
+    std::ifstream file( strFile.c_str() );
+    int nValue = nDefault;
+    if( !( file >> nValue ))
+    {
+        return nDefault;
+    }
+    return nValue;
+}
+
+static int CpuNode( unsigned int nCpu )
+{
+    char path[64];
+    std::snprintf( path, sizeof( path ), "/sys/devices/system/cpu/cpu%u", nCpu );
+    DIR *pDir = opendir( path );
+    if( NULL == pDir )
+    {
+        return FrameBufferNode_None;
+    }
+    int nNode = FrameBufferNode_None;
+    while( const dirent *pEntry = readdir( pDir ))
+    {
+        if(     ( 0 == std::strncmp( pEntry->d_name, "node", 4 ))
+            &&  ( 1 == std::sscanf( pEntry->d_name + 4, "%d", &nNode )))
+        {
+            break;
+        }
+    }
+    closedir( pDir );
+    return nNode;
+}
+
+int ResolveNumaNode( const FrameBufferConfig &Config, const std::string &strInterfaceID )
+{
+    if( FrameBufferNode_Auto != Config.NumaNode )
+    {
+        return Config.NumaNode;
+    }
+    // The NIC writes the packets into memory of its node, the frame is assembled from them
+    if( !strInterfaceID.empty() && std::string::npos == strInterfaceID.find( '/' ))
+    {
+        const int nNode = ReadNumber( "/sys/class/net/" + strInterfaceID + "/device/numa_node", FrameBufferNode_None );
+        if( nNode >= 0 )
+        {
+            return nNode;
+        }
+    }
+    if( !Config.Cpus.empty() )
+    {
+        const int nNode = CpuNode( Config.Cpus[0] );
+        if( nNode >= 0 )
+        {
+            return nNode;
+        }
+    }
+    return FrameBufferNode_None;
+}
+
+FrameBufferPool::FrameBufferPool()
+    :   m_pMemory( NULL )
+{}
+
+FrameBufferPool::~FrameBufferPool()
+{
+    Release();
+}
+
+VmbErrorType FrameBufferPool::Allocate( VmbUint32_t nCount, VmbUint32_t nBufferSize, const FrameBufferConfig &Config, const std::string &strInterfaceID )
+{
+    Release();
+    if( 0 == nCount || 0 == nBufferSize )
+    {
+        return VmbErrorBadParameter;
+    }
+    FrameBufferInfo info;
+    info.Count      = nCount;
+    info.BufferSize = nBufferSize;
+    info.Stride     = RoundUp( nBufferSize, PAGE_SIZE_SMALL );
+    info.Bytes      = info.Stride * nCount;
+
+    void *p = NULL;
+    if( Config.bHugePages )
+    {
+        const size_t nBytes = RoundUp( info.Bytes, PAGE_SIZE_HUGE );
+        p = mmap( NULL, nBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0 );
+        if( MAP_FAILED != p )
+        {
+            info.Bytes      = nBytes;
+            info.PageSize   = FramePages_Huge;
+        }
+        else
+        {
+            p = MapAligned( nBytes );
+            if( NULL != p )
+            {
+                info.Bytes      = nBytes;
+                info.PageSize   = 0 == madvise( p, nBytes, MADV_HUGEPAGE ) ? FramePages_Transparent : FramePages_Normal;
+            }
+        }
+    }
+    else
+    {
+        p = mmap( NULL, info.Bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+    }
+    if( NULL == p || MAP_FAILED == p )
+    {
+        return VmbErrorResources;
+    }
+
+    // The pages are placed when they are faulted in, so the node is set first
+    const int nNode = ResolveNumaNode( Config, strInterfaceID );
+    if(     ( nNode >= 0 && nNode < MAX_NUMA_NODES )
+        &&  ( BindToNode( p, info.Bytes, nNode )))
+    {
+        info.NumaNode = nNode;
+    }
+    if( Config.bLock )
+    {
+        info.bLocked = ( 0 == mlock( p, info.Bytes ));
+    }
+    if( !info.bLocked )
+    {
+        std::memset( p, 0, info.Bytes );
+    }
+
+    m_pMemory   = p;
+    m_Info      = info;
+    return VmbErrorSuccess;
+}
+
+void FrameBufferPool::Release()
+{
+    if( NULL != m_pMemory )
+    {
+        munmap( m_pMemory, m_Info.Bytes );
+        m_pMemory = NULL;
+    }
+    m_Info = FrameBufferInfo();
+}
+
+const FrameBufferInfo& FrameBufferPool::GetInfo() const
+{
+    return m_Info;
+}
+
+void PrintFrameBufferInfo( std::ostream &s, const FrameBufferInfo &Info )
+{
+    s<<Info.Count<<" x "<<( Info.BufferSize / 1048576.0 )<<" MB, "
+     <<( FramePages_Huge == Info.PageSize ? "2 MB pages" : FramePages_Transparent == Info.PageSize ? "transparent huge pages" : "4 KB pages" )
+     <<( Info.bLocked ? ", locked" : "" );
+    if( FrameBufferNode_None != Info.NumaNode )
+    {
+        s<<", NUMA node "<<Info.NumaNode;
+    }
+}
+
+}} // namespace AVT::VmbAPI
@@ -0,0 +1,237 @@
+#include <cmath>
+#include <algorithm>
+
+#include "FrameBufferSizer.h"
+#include "FrameSource.h"
+#include "HostClock.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+// Processing time a frame is assumed to take before any was measured
+static const double         INITIAL_HOLD_TIME   = 0.05;
+static const VmbUint32_t    MAX_FRAMES          = 1024;
+
+const VmbUint32_t   FrameBufferSizer::SPARE_FRAMES;
+const double        FrameBufferSizer::HOLD_WINDOW   = 10.0;
+
+FrameBufferSizer::FrameBufferSizer( const FrameBufferConfig &Config, VmbUint32_t nMinimum, double dHoldWindow )
+    :   m_bAdaptive( Config.bAdaptive )
+    ,   m_nBudget( Config.Budget )
+    ,   m_nMinimum( nMinimum > 0 ? nMinimum : 1 )
+    ,   m_nHoldWindow( static_cast<VmbUint64_t>( std::max( dHoldWindow, 0.001 ) * 1.0e9 ))
+    ,   m_dFrameRate( 0.0 )
+    ,   m_nPlanned( 0 )
+    ,   m_nLimit( 0 )
+    ,   m_nGrows( 0 )
+    ,   m_bAdapting( false )
+    ,   m_nDepth( 0 )
+    ,   m_nTarget( 0 )
+    ,   m_bGrowPending( false )
+    ,   m_nHeld( 0 )
+    ,   m_nMaxHold( 0 )
+    ,   m_nWindowStart( GetHostTime() )
+    ,   m_nWindowHold( 0 )
+    ,   m_nPreviousHold( 0 )
+    ,   m_nStarved( 0 )
+    ,   m_bRestarted( false )
+    ,   m_nRestartTime( 0 )
+    ,   m_bLastValid( false )
+    ,   m_nLastFrameID( 0 )
+    ,   m_bRanDry( false )
+{}
+
+VmbUint32_t FrameBufferSizer::Plan( VmbUint32_t nPayloadSize, double dFrameRate )
+{
+    std::lock_guard<std::mutex> lock( m_Mutex );
+    const double dRate = dFrameRate > 0.0 ? dFrameRate : 0.0;
+    VmbUint32_t nDepth = m_nMinimum;
+    VmbUint32_t nLimit = m_nMinimum;
+    if( m_bAdaptive )
+    {
+        const VmbUint64_t nAffordable = 0 != nPayloadSize ? m_nBudget / nPayloadSize : MAX_FRAMES;
+        nLimit = static_cast<VmbUint32_t>( std::max<VmbUint64_t>( m_nMinimum, std::min<VmbUint64_t>( nAffordable, MAX_FRAMES )));
+        // Grown buffers are replaced by what the recent hold times need, an old stall no longer counts
+        const double dHold = std::max( INITIAL_HOLD_TIME, RecentHold() / 1.0e9 );
+        const VmbUint32_t nNeeded = static_cast<VmbUint32_t>( std::ceil( dHold * dRate )) + SPARE_FRAMES;
+        nDepth = std::min( nLimit, std::max( nDepth, nNeeded ));
+    }
+    m_dFrameRate.store( dRate );
+    m_nLimit.store( nLimit );
+    if( 0 == m_nPlanned )
+    {
+        m_nPlanned = nDepth;
+    }
+    m_nDepth.store( nDepth );
+    m_nTarget.store( nDepth );
+    m_nHeld.store( 0 );
+    m_bGrowPending.store( false );
+    m_nRestartTime.store( GetHostTime() );
+    m_bRestarted.store( true );
+    m_bAdapting.store( m_bAdaptive && nDepth < nLimit );
+    return nDepth;
+}
+
+bool FrameBufferSizer::Delivered( const SourceFrame &Frame )
+{
+    const int nHeld = m_nHeld.fetch_add( 1, std::memory_order_relaxed ) + 1;
+    if( !m_bAdapting.load( std::memory_order_relaxed ))
+    {
+        return false;
+    }
+    if( m_bRestarted.exchange( false, std::memory_order_relaxed ))
+    {
+        m_bLastValid    = false;
+        m_bRanDry       = false;
+    }
+    const VmbUint32_t nDepth = m_nDepth.load( std::memory_order_relaxed );
+
+    // Frames of a camera with no free buffer are never exposed, the next frame shows the gap
+    bool bRaise = false;
+    if(     ( Frame.bFrameIDValid )
+        &&  ( m_bLastValid )
+        &&  ( Frame.FrameID > m_nLastFrameID + 1 )
+        &&  ( m_bRanDry ))
+    {
+        m_nStarved.fetch_add( Frame.FrameID - m_nLastFrameID - 1, std::memory_order_relaxed );
+        bRaise = Raise( nDepth + std::max<VmbUint32_t>( SPARE_FRAMES, nDepth / 2 ));
+    }
+    m_bLastValid    = Frame.bFrameIDValid;
+    m_nLastFrameID  = Frame.FrameID;
+    m_bRanDry       = nHeld >= static_cast<int>( nDepth );
+
+    // Every frame arriving while the slowest one is processed needs a buffer of its own
+    const double dRate = m_dFrameRate.load( std::memory_order_relaxed );
+    if( !bRaise && 0.0 < dRate )
+    {
+        const double dHold = RecentHold() / 1.0e9;
+        const VmbUint32_t nNeeded = static_cast<VmbUint32_t>( std::ceil( dHold * dRate )) + SPARE_FRAMES;
+        if( nNeeded > nDepth )
+        {
+            bRaise = Raise( nNeeded );
+        }
+    }
+    return bRaise;
+}
+
+/**
+ * @brief Sets a higher target and asks the source once
+ */
+bool FrameBufferSizer::Raise( VmbUint32_t nTarget )
+{
+    nTarget = std::min( nTarget, m_nLimit.load( std::memory_order_relaxed ));
+    VmbUint32_t nCurrent = m_nTarget.load( std::memory_order_relaxed );
+    while( nTarget > nCurrent && !m_nTarget.compare_exchange_weak( nCurrent, nTarget ))
+    {}
+    return nTarget > m_nDepth.load( std::memory_order_relaxed ) && !m_bGrowPending.exchange( true );
+}
+
+void FrameBufferSizer::Requeued( const SourceFrame &Frame )
+{
+    m_nHeld.fetch_sub( 1, std::memory_order_relaxed );
+    const VmbUint64_t nNow = GetHostTime();
+    if(     ( nNow <= Frame.ReceiveTime )
+        ||  ( Frame.ReceiveTime < m_nRestartTime.load( std::memory_order_relaxed )))
+    {
+        return;
+    }
+    const VmbUint64_t nHold = nNow - Frame.ReceiveTime;
+    VmbUint64_t nMax = m_nMaxHold.load( std::memory_order_relaxed );
+    while( nHold > nMax && !m_nMaxHold.compare_exchange_weak( nMax, nHold, std::memory_order_relaxed ))
+    {}
+
+    // The thread that ends a window moves its longest hold back, a window without frames forgets it too
+    VmbUint64_t nStart = m_nWindowStart.load( std::memory_order_relaxed );
+    if(     ( nNow > nStart )
+        &&  ( nNow - nStart >= m_nHoldWindow )
+        &&  ( m_nWindowStart.compare_exchange_strong( nStart, nNow, std::memory_order_relaxed )))
+    {
+        const VmbUint64_t nLast = m_nWindowHold.exchange( 0, std::memory_order_relaxed );
+        m_nPreviousHold.store( nNow - nStart < 2 * m_nHoldWindow ? nLast : 0, std::memory_order_relaxed );
+    }
+    VmbUint64_t nWindow = m_nWindowHold.load( std::memory_order_relaxed );
+    while( nHold > nWindow && !m_nWindowHold.compare_exchange_weak( nWindow, nHold, std::memory_order_relaxed ))
+    {}
+}
+
+/**
+ * @brief The longest hold of the current and the previous window in nanoseconds, windows that ended
+ * without a frame coming back count as they would have been moved back
+ */
+VmbUint64_t FrameBufferSizer::RecentHold() const
+{
+    const VmbUint64_t nNow      = GetHostTime();
+    const VmbUint64_t nStart    = m_nWindowStart.load( std::memory_order_relaxed );
+    const VmbUint64_t nElapsed  = nNow > nStart ? nNow - nStart : 0;
+    const VmbUint64_t nWindow   = m_nWindowHold.load( std::memory_order_relaxed );
+    if( nElapsed >= 2 * m_nHoldWindow )
+    {
+        return 0;
+    }
+    if( nElapsed >= m_nHoldWindow )
+    {
+        return nWindow;
+    }
+    return std::max( nWindow, m_nPreviousHold.load( std::memory_order_relaxed ));
+}
+
+void FrameBufferSizer::Grown( VmbUint32_t nDepth )
+{
+    std::lock_guard<std::mutex> lock( m_Mutex );
+    if( nDepth > m_nDepth.load() )
+    {
+        ++m_nGrows;
+    }
+    m_nDepth.store( nDepth );
+    // A source that cannot announce more keeps what it has
+    if( nDepth < m_nTarget.load() || nDepth >= m_nLimit.load() )
+    {
+        m_bAdapting.store( false );
+    }
+    m_bGrowPending.store( false );
+}
+
+void FrameBufferSizer::Restarted()
+{
+    m_nRestartTime.store( GetHostTime() );
+    m_bRestarted.store( true );
+}
+
+VmbUint32_t FrameBufferSizer::GetTarget() const
+{
+    return m_nTarget.load();
+}
+
+BufferDepthStatistics FrameBufferSizer::GetStatistics() const
+{
+    std::lock_guard<std::mutex> lock( m_Mutex );
+    BufferDepthStatistics stats;
+    stats.bAdaptive     = m_bAdaptive;
+    stats.Planned       = m_nPlanned;
+    stats.Depth         = m_nDepth.load();
+    stats.Limit         = m_nLimit.load();
+    stats.Grows         = m_nGrows;
+    stats.StarvedFrames = m_nStarved.load();
+    stats.FrameRate     = m_dFrameRate.load();
+    stats.MaxHoldTime   = m_nMaxHold.load() / 1.0e9;
+    stats.RecentHoldTime= RecentHold() / 1.0e9;
+    return stats;
+}
+
+void PrintBufferDepthStatistics( std::ostream &s, const BufferDepthStatistics &Statistics )
+{
+    s<<Statistics.Depth<<" frames";
+    if( !Statistics.bAdaptive )
+    {
+        return;
+    }
+    s<<" (planned "<<Statistics.Planned;
+    if( Statistics.FrameRate > 0.0 )
+    {
+        s<<" for "<<Statistics.FrameRate<<" fps";
+    }
+    s<<", limit "<<Statistics.Limit<<", grown "<<Statistics.Grows<<" times) longest hold: "<<Statistics.MaxHoldTime * 1000.0
+     <<" ms, recently "<<Statistics.RecentHoldTime * 1000.0<<" ms starved frames: "<<Statistics.StarvedFrames;
+}
+
+}} // namespace AVT::VmbAPI
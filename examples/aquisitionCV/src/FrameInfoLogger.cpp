@@ -0,0 +1,305 @@
+#include <cstdio>
+#include <iostream>
+#include <chrono>
+
+#include "FrameInfoLogger.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+// The writer wakes up this often, everything queued meanwhile goes out in one write
+const std::chrono::milliseconds FLUSH_INTERVAL( 20 );
+// Text collected before it is written even in the middle of a batch
+const size_t                    BATCH_LIMIT = 64 * 1024;
+
+/**
+ * @brief Frame status codes as readable status messages
+ */
+static const char* FrameStatusToString( VmbFrameStatusType eFrameStatus )
+{
+    switch( eFrameStatus )
+    {
+    case VmbFrameStatusComplete:    return "Complete";
+    case VmbFrameStatusIncomplete:  return "Incomplete";
+    case VmbFrameStatusTooSmall:    return "Too small";
+    case VmbFrameStatusInvalid:     return "Invalid";
+    default:                        return "unknown frame status";
+    }
+}
+
+FrameInfoLogger::FrameInfoLogger( FrameInfos eFrameInfos, VmbUint64_t nTimestampFrequency, size_t nCapacity )
+    :   m_eFrameInfos( eFrameInfos )
+    ,   m_nTimestampFrequency( nTimestampFrequency )
+    ,   m_Records( nCapacity )
+    ,   m_nDropped( 0 )
+    ,   m_bStopping( false )
+    ,   m_bDropPending( false )
+    ,   m_nReportedDrops( 0 )
+    ,   m_bLastValid( false )
+    ,   m_nLastFrameID( 0 )
+    ,   m_nLastTimestamp( 0 )
+    ,   m_nLastReceiveTime( 0 )
+{
+    m_Batch.reserve( BATCH_LIMIT + 256 );
+    m_Writer = std::thread( &FrameInfoLogger::WriterLoop, this );
+}
+
+FrameInfoLogger::~FrameInfoLogger()
+{
+    Stop();
+}
+
+/**
+ * @brief Copies the infos of a frame into the ring, never blocks and never allocates
+ */
+void FrameInfoLogger::Log( const SourceFrame &Frame )
+{
+    FrameInfoRecord record;
+    record.FrameID              = Frame.FrameID;
+    record.Timestamp            = Frame.Timestamp;
+    record.ReceiveTime          = Frame.ReceiveTime;
+    record.ImageSize            = Frame.ImageSize;
+    record.Width                = Frame.Width;
+    record.Height               = Frame.Height;
+    record.PixelFormat          = Frame.PixelFormat;
+    record.ReceiveStatus        = Frame.ReceiveStatus;
+    record.bFrameIDValid        = Frame.bFrameIDValid;
+    record.bPixelFormatValid    = Frame.bPixelFormatValid;
+    record.bReceiveStatusValid  = Frame.bReceiveStatusValid;
+    record.bAfterDrop           = m_bDropPending;
+
+    if( m_Records.TryPush( record ))
+    {
+        m_bDropPending = false;
+    }
+    else
+    {
+        // The frame rate and gap detection of the writer must not bridge lost records
+        m_bDropPending = true;
+        m_nDropped.fetch_add( 1, std::memory_order_relaxed );
+    }
+}
+
+void FrameInfoLogger::Stop()
+{
+    m_bStopping.store( true );
+    {
+        std::lock_guard<std::mutex> lock( m_WakeMutex );
+    }
+    m_WakeCondition.notify_all();
+    if( m_Writer.joinable() )
+    {
+        m_Writer.join();
+    }
+}
+
+VmbUint64_t FrameInfoLogger::GetDropped() const
+{
+    return m_nDropped.load( std::memory_order_relaxed );
+}
+
+/**
+ * @brief Wakes up periodically instead of being signalled, so logging a frame costs no system call
+ */
+void FrameInfoLogger::WriterLoop()
+{
+    for( ;; )
+    {
+        {
+            std::unique_lock<std::mutex> lock( m_WakeMutex );
+            if( !m_bStopping.load() )
+            {
+                m_WakeCondition.wait_for( lock, FLUSH_INTERVAL );
+            }
+        }
+        const bool bStopping = m_bStopping.load();
+        Drain();
+        if( bStopping )
+        {
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Formats everything queued so far and writes it out
+ */
+void FrameInfoLogger::Drain()
+{
+    FrameInfoRecord record;
+    while( m_Records.TryPop( record ))
+    {
+        Format( record );
+        if( m_Batch.size() >= BATCH_LIMIT )
+        {
+            Flush();
+        }
+    }
+
+    const VmbUint64_t nDropped = m_nDropped.load( std::memory_order_relaxed );
+    if( nDropped != m_nReportedDrops )
+    {
+        char line[64];
+        std::snprintf( line, sizeof( line ), "%llu frame infos dropped\n", static_cast<unsigned long long>( nDropped - m_nReportedDrops ));
+        m_Batch += line;
+        m_nReportedDrops = nDropped;
+    }
+    Flush();
+}
+
+/**
+ * @brief Detects missing frames and the frame rate, then prints the details of a frame.
+ * In automatic mode only frames with something to report get a line, all others a dot
+ *
+ * @param Record The infos of the frame
+ */
+void FrameInfoLogger::Format( const FrameInfoRecord &Record )
+{
+    bool        bShowFrameInfos = FrameInfos_Show == m_eFrameInfos;
+    double      dFPS            = 0.0;
+    bool        bFPSValid       = false;
+    VmbUint64_t nFramesMissing  = 0;
+    char        line[256];
+
+    if( Record.bAfterDrop )
+    {
+        m_bLastValid = false;
+    }
+
+    if( Record.bFrameIDValid )
+    {
+        if( m_bLastValid )
+        {
+            if( Record.FrameID != ( m_nLastFrameID + 1 ) )
+            {
+                nFramesMissing = Record.FrameID - m_nLastFrameID - 1;
+                if( 1 == nFramesMissing )
+                {
+                    m_Batch += "1 missing frame detected\n";
+                }
+                else
+                {
+                    std::snprintf( line, sizeof( line ), "%llu missing frames detected\n", static_cast<unsigned long long>( nFramesMissing ));
+                    m_Batch += line;
+                }
+            }
+
+            if( 0 == nFramesMissing )
+            {
+                // The device timestamps give the sensor cadence, arrival times only without them
+                if(     ( 0 != m_nLastTimestamp )
+                    &&  ( Record.Timestamp > m_nLastTimestamp )
+                    &&  ( 0 != m_nTimestampFrequency ))
+                {
+                    dFPS = static_cast<double>( m_nTimestampFrequency ) / static_cast<double>( Record.Timestamp - m_nLastTimestamp );
+                    bFPSValid = true;
+                }
+                else if( Record.ReceiveTime > m_nLastReceiveTime )
+                {
+                    dFPS = 1.0e9 / static_cast<double>( Record.ReceiveTime - m_nLastReceiveTime );
+                    bFPSValid = true;
+                }
+                else
+                {
+                    bShowFrameInfos = true;
+                }
+            }
+        }
+
+        m_bLastValid        = true;
+        m_nLastFrameID      = Record.FrameID;
+        m_nLastTimestamp    = Record.Timestamp;
+        m_nLastReceiveTime  = Record.ReceiveTime;
+    }
+    else
+    {
+        bShowFrameInfos = true;
+        m_bLastValid    = false;
+    }
+
+    if(     ( !Record.bReceiveStatusValid )
+        ||  ( VmbFrameStatusComplete != Record.ReceiveStatus ))
+    {
+        bShowFrameInfos = true;
+    }
+
+    if( !bShowFrameInfos )
+    {
+        m_Batch += '.';
+        return;
+    }
+
+    m_Batch += "Frame ID:";
+    if( Record.bFrameIDValid )
+    {
+        std::snprintf( line, sizeof( line ), "%llu", static_cast<unsigned long long>( Record.FrameID ));
+        m_Batch += line;
+    }
+    else
+    {
+        m_Batch += "?";
+    }
+
+    m_Batch += " Status:";
+    m_Batch += Record.bReceiveStatusValid ? FrameStatusToString( Record.ReceiveStatus ) : "?";
+
+    m_Batch += " Size:";
+    if( 0 != Record.Width )
+    {
+        std::snprintf( line, sizeof( line ), "%u", Record.Width );
+        m_Batch += line;
+    }
+    else
+    {
+        m_Batch += "?";
+    }
+    m_Batch += "x";
+    if( 0 != Record.Height )
+    {
+        std::snprintf( line, sizeof( line ), "%u", Record.Height );
+        m_Batch += line;
+    }
+    else
+    {
+        m_Batch += "?";
+    }
+
+    m_Batch += " Format:";
+    if( Record.bPixelFormatValid )
+    {
+        std::snprintf( line, sizeof( line ), "0x%x", static_cast<unsigned int>( Record.PixelFormat ));
+        m_Batch += line;
+    }
+    else
+    {
+        m_Batch += "?";
+    }
+
+    std::snprintf( line, sizeof( line ), " Timestamp:%llu", static_cast<unsigned long long>( Record.Timestamp ));
+    m_Batch += line;
+
+    m_Batch += " FPS:";
+    if( bFPSValid )
+    {
+        std::snprintf( line, sizeof( line ), "%.2f", dFPS );
+        m_Batch += line;
+    }
+    else
+    {
+        m_Batch += "?";
+    }
+    m_Batch += "\n";
+}
+
+void FrameInfoLogger::Flush()
+{
+    if( m_Batch.empty() )
+    {
+        return;
+    }
+    std::cout.write( m_Batch.data(), static_cast<std::streamsize>( m_Batch.size() ));
+    std::cout.flush();
+    m_Batch.clear();
+}
+
+}} // namespace AVT::VmbAPI
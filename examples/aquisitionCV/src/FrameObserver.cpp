@@ -1,8 +1,10 @@
 #include <iostream>
-#include <iomanip>
-#include <time.h>
+#include <chrono>
 
 #include "FrameObserver.h"
+#include "HostClock.h"
+#include "ThreadAffinity.h"
+#include "PipelineStages.h"
 
 namespace AVT {
 namespace VmbAPI {
@@ -10,271 +12,338 @@ namespace VmbAPI {
 /**
  * @brief Construct a new Frame Observer:: Frame Observer object
  * 
- * @param pCamera  The camera the frame was queued at
- * @param eFrameInfos Indicates how the frame will be displayed
- * @param eColorProcessing Indicates how color processing is applied
- * @param bRGBValue 
+ * @param Source The source the frames are handed back to
+ * @param Config Frame infos, color processing, worker threads, queue capacity and latency report
+ * @param Cpus CPUs the callback and worker threads are pinned to, empty for no restriction
+ * @param pSynchronizer Bundles the frames of several cameras instead of this observer, NULL to process them here
+ * @param nInput The input of the synchronizer and the preview this camera feeds
+ * @param pRecorder Writes every frame to disk before it is processed, NULL to not record
+ * @param pDisplay Gets every processed frame offered, NULL for no preview
  */
-FrameObserver::FrameObserver( CameraPtr pCamera, FrameInfos eFrameInfos, ColorProcessing eColorProcessing, bool bRGBValue )
-    :   IFrameObserver( pCamera )
-    ,   m_eFrameInfos( eFrameInfos )
-    ,   m_bRGB( bRGBValue )
-    ,   m_eColorProcessing( eColorProcessing )
-    ,   proc (new FrameProcessing()) {}
-
-/**
- * @brief get current timestamp
- * 
- * @return double second timestamp
- */
-double FrameObserver::GetTime()
+FrameObserver::FrameObserver( IFrameSource &Source, const ProgramConfig &Config, const std::vector<unsigned int> &Cpus, FrameSynchronizer *pSynchronizer, size_t nInput, FrameRecorder *pRecorder, PreviewDisplay *pDisplay )
+    :   m_Source( Source )
+    ,   m_eFrameInfos( Config.getFrameInfos() )
+    ,   m_bRGB( Config.getRGBValue() )
+    ,   m_eColorProcessing( Config.getColorProcessing() )
+    ,   m_Cpus( Cpus )
+    ,   m_bCallbackPinned( false )
+    ,   m_pSynchronizer( pSynchronizer )
+    ,   m_nSynchronizerInput( nInput )
+    ,   m_pRecorder( pRecorder )
+    ,   m_pDisplay( pDisplay )
+    ,   m_bPipelineRecords( false )
+    ,   m_FrameQueue( Config.getQueueCapacity() )
+    ,   m_nSleepingWorkers( 0 )
+    ,   m_bStopping( false )
+    ,   m_nReceived( 0 )
+    ,   m_nProcessed( 0 )
+    ,   m_nProcessedBytes( 0 )
+    ,   m_nOverflows( 0 )
+    ,   m_nIncomplete( 0 )
+    ,   m_nMaxQueueDepth( 0 )
 {
-    double dTime = 0.0;
-
-    struct timespec now;
-    clock_gettime( CLOCK_REALTIME, &now );
-    dTime = ( (double)now.tv_sec ) + ( (double)now.tv_nsec ) / 1000000000.0;
+    const unsigned int nProcessors = Config.getWorkerThreads() > 0 ? Config.getWorkerThreads() : 1;
+    for( unsigned int i = 0; i < nProcessors; ++i )
+    {
+        m_Processors.push_back( std::unique_ptr<FrameProcessing>( new FrameProcessing( Config.getRGBValue(), Config.getColorProcessing(), Config.getDemosaicProcessing() )));
+    }
+    if( FrameInfos_Off != m_eFrameInfos )
+    {
+        m_pFrameInfoLogger.reset( new FrameInfoLogger( m_eFrameInfos, Source.GetTimestampFrequency() ));
+    }
+    if( Config.getLatencyReport() )
+    {
+        m_pLatencyMonitor.reset( new LatencyMonitor( Source.GetID(), Source.GetTimestampFrequency(), Config.getLatencyReportInterval() ));
+    }
+    // The pipeline brings its own threads
+    if(     ( NULL == m_pSynchronizer )
+        &&  ( !Config.getPipeline().empty() ))
+    {
+        m_pPipeline.reset( new Pipeline( Source ));
+        BuildPipeline( *m_pPipeline, Config, pRecorder, pDisplay, nInput );
+        for( size_t i = 0; i < Config.getPipeline().size(); ++i )
+        {
+            m_bPipelineRecords = m_bPipelineRecords || PipelineStage_Record == Config.getPipeline()[i].Type;
+        }
+        m_pPipeline->Start( m_Cpus );
+        return;
+    }
+    // With bundling the synchronizer processes the frames, workers would only idle
+    const unsigned int nWorkers = NULL == m_pSynchronizer ? Config.getWorkerThreads() : 0;
+    for( unsigned int i = 0; i < nWorkers; ++i )
+    {
+        m_Workers.push_back( std::thread( &FrameObserver::WorkerLoop, this, m_Processors[i].get() ));
+        if( !SetThreadAffinity( m_Workers.back(), m_Cpus ))
+        {
+            std::cout<<"Could not pin worker thread of camera "<<Source.GetID()<<"\n";
+        }
+    }
+}
 
-    return dTime;
+FrameObserver::~FrameObserver()
+{
+    Stop();
 }
 
 /**
- * @brief Prints out frame parameters such as w, h, pixel format
- * 
- * @param pFrame The frame to work on
+ * @brief Stops accepting frames for processing, drains the queue and joins the workers
  */
-void PrintFrameInfo( const FramePtr &pFrame )
+void FrameObserver::Stop()
 {
-    std::cout<<" Size:";
-    VmbUint32_t     nWidth = 0;
-    VmbErrorType    res;
-    res = pFrame->GetWidth(nWidth);
-    if( VmbErrorSuccess == res )
+    m_bStopping.store( true );
     {
-        std::cout<<nWidth;
+        std::lock_guard<std::mutex> lock( m_WakeMutex );
     }
-    else
+    m_WakeCondition.notify_all();
+
+    for( size_t i = 0; i < m_Workers.size(); ++i )
     {
-        std::cout<<"?";
+        if( m_Workers[i].joinable() )
+        {
+            m_Workers[i].join();
+        }
     }
+    m_Workers.clear();
 
-    std::cout<<"x";
-    VmbUint32_t nHeight = 0;
-    res = pFrame->GetHeight(nHeight);
-    if( VmbErrorSuccess == res )
+    if( m_pPipeline )
     {
-        std::cout<< nHeight;
+        m_pPipeline->Stop();
     }
-    else
+
+    // Anything the workers left behind (e.g. a frame pushed concurrently to Stop) goes back to the source
+    SourceFrame frame;
+    while( m_FrameQueue.TryPop( frame ))
     {
-        std::cout<<"?";
+        m_Source.QueueFrame( frame );
     }
 
-    std::cout<<" Format:";
-    VmbPixelFormatType ePixelFormat = VmbPixelFormatMono8;
-    res = pFrame->GetPixelFormat( ePixelFormat );
-    if( VmbErrorSuccess == res )
+    if( m_pFrameInfoLogger )
     {
-        std::cout<<"0x"<<std::hex<<ePixelFormat<<std::dec;
+        m_pFrameInfoLogger->Stop();
     }
-    else
+    if( m_pLatencyMonitor )
     {
-        std::cout<<"?";
+        m_pLatencyMonitor->Stop();
     }
 }
 
 /**
- * @brief Prints out frame status codes as readable status messages
+ * @brief Snapshot of the queue counters
  * 
- * @param eFrameStatus The error code to be converted and printed out
+ * @return FrameQueueStatistics 
  */
-void PrintFrameStatus( VmbFrameStatusType eFrameStatus )
+FrameQueueStatistics FrameObserver::GetStatistics() const
 {
-    switch( eFrameStatus )
+    FrameQueueStatistics stats;
+    stats.Received          = m_nReceived.load( std::memory_order_relaxed );
+    stats.Processed         = m_nProcessed.load( std::memory_order_relaxed );
+    stats.ProcessedBytes    = m_nProcessedBytes.load( std::memory_order_relaxed );
+    stats.Overflows         = m_nOverflows.load( std::memory_order_relaxed );
+    stats.Incomplete        = m_nIncomplete.load( std::memory_order_relaxed );
+    stats.QueueDepth        = m_FrameQueue.Size();
+    stats.MaxQueueDepth     = m_nMaxQueueDepth.load( std::memory_order_relaxed );
+    stats.QueueCapacity     = m_FrameQueue.Capacity();
+    if( m_pPipeline )
     {
-    case VmbFrameStatusComplete:
-        std::cout<<"Complete";
-        break;
-
-    case VmbFrameStatusIncomplete:
-        std::cout<<"Incomplete";
-        break;
-
-    case VmbFrameStatusTooSmall:
-        std::cout<<"Too small";
-        break;
-
-    case VmbFrameStatusInvalid:
-        std::cout<<"Invalid";
-        break;
-
-    default:
-        std::cout<<"unknown frame status";
-        break;
+        const PipelineStatistics pipeline = m_pPipeline->GetStatistics();
+        stats.Processed         = pipeline.Completed;
+        stats.ProcessedBytes    = pipeline.CompletedBytes;
+        stats.QueueDepth        = 0;
+        stats.QueueCapacity     = 0;
     }
+    return stats;
 }
 
 /**
- * @brief Prints out details of a frame such as: ID, w, h, FPS
- * 
- * @param pFrame The frame to work on
+ * @brief Snapshot of the stage counters
+ *
+ * @return PipelineStatistics
  */
-void FrameObserver::ShowFrameInfos( const FramePtr &pFrame ) 
+PipelineStatistics FrameObserver::GetPipelineStatistics() const
 {
-    bool                bShowFrameInfos     = false;
-    VmbUint64_t         nFrameID            = 0;
-    bool                bFrameIDValid       = false;
-    VmbFrameStatusType  eFrameStatus        = VmbFrameStatusComplete;
-    bool                bFrameStatusValid   = false;
-    VmbErrorType        res                 = VmbErrorSuccess;
-    double              dFPS                = 0.0;
-    bool                bFPSValid           = false;
-    VmbUint64_t         nFramesMissing      = 0;
-    if( FrameInfos_Show == m_eFrameInfos )
-    {
-        bShowFrameInfos = true;
-    }
-
-    res = pFrame->GetFrameID( nFrameID );
-    if( VmbErrorSuccess == res )
-    {
-        bFrameIDValid = true;
+    return m_pPipeline ? m_pPipeline->GetStatistics() : PipelineStatistics();
+}
 
-        if( m_FrameID.IsValid() )
-        {
-            if( nFrameID != ( m_FrameID() + 1 ) )
-            {
-                nFramesMissing = nFrameID - m_FrameID() - 1;
-                if( 1 == nFramesMissing )
-                {
-                    std::cout<<"1 missing frame detected\n";
-                }
-                else
-                {
-                    std::cout<<nFramesMissing<<"missing frames detected\n";
-                }
-            }
-        }
+/**
+ * @brief Processes a complete frame and hands its buffer back to the source.
+ * With the latency report enabled the time spent queued, processing and requeueing is recorded
+ * 
+ * @param Frame The frame to work on
+ * @param proc The processing state owned by the calling thread
+ */
+void FrameObserver::ProcessFrame( const SourceFrame &Frame, FrameProcessing &proc )
+{
+    LatencyMonitor * const pMonitor = m_pLatencyMonitor.get();
+    const VmbUint64_t nStart = NULL != pMonitor ? GetHostTime() : 0;
 
-        m_FrameID( nFrameID );
-        double dFrameTime = GetTime();
-        if(     ( m_FrameTime.IsValid() )
-            &&  ( 0 == nFramesMissing ) )
+    if( Frame.IsComplete() )
+    {            
+        /**
+         * @brief Funzione per la conversione del buffer raw in oggetto CV
+         * 
+         */
+        if(     ( proc.ProcessImage( Frame ))
+            &&  ( NULL != m_pDisplay ))
         {
-            double dTimeDiff = dFrameTime - m_FrameTime();
-            if( dTimeDiff > 0.0 )
-            {
-                dFPS = 1.0 / dTimeDiff;
-                bFPSValid = true;
-            }
-            else
-            {
-                bShowFrameInfos = true;
-            }
+            m_pDisplay->Offer( m_nSynchronizerInput, proc.GetCVImage(), Frame.FrameID );
         }
-
-        m_FrameTime( dFrameTime );
+        m_nProcessed.fetch_add( 1, std::memory_order_relaxed );
+        m_nProcessedBytes.fetch_add( Frame.ImageSize, std::memory_order_relaxed );
     }
     else
     {
-        bShowFrameInfos = true;
-        m_FrameID.Invalidate();
-        m_FrameTime.Invalidate();
+        m_nIncomplete.fetch_add( 1, std::memory_order_relaxed );
     }
+    const VmbUint64_t nProcessed = NULL != pMonitor ? GetHostTime() : 0;
 
-    res = pFrame->GetReceiveStatus( eFrameStatus );
-    if( VmbErrorSuccess == res )
-    {
-        bFrameStatusValid = true;
+    // The image may point into the frame buffer, drop it before the buffer is refilled
+    proc.Release();
+    m_Source.QueueFrame( Frame );
 
-        if( VmbFrameStatusComplete != eFrameStatus )
+    if( NULL != pMonitor )
+    {
+        pMonitor->Record( LatencyStage_QueueWait, nStart - Frame.ReceiveTime );
+        pMonitor->Record( LatencyStage_Requeue, GetHostTime() - nProcessed );
+        if( Frame.IsComplete() )
         {
-            bShowFrameInfos = true;
+            pMonitor->Record( LatencyStage_Processing, nProcessed - nStart );
+            pMonitor->Record( LatencyStage_Total, pMonitor->GetTransportLatency( Frame ) + ( nProcessed - Frame.ReceiveTime ));
         }
     }
-    else
-    {
-        bShowFrameInfos = true;
-    }
-    if( bShowFrameInfos )
+}
+
+/**
+ * @brief Drains the frame queue until Stop() is called.
+ * Idle workers sleep on the condition variable, the callback only notifies when someone sleeps
+ * 
+ * @param pProc The processing state owned by this worker
+ */
+void FrameObserver::WorkerLoop( FrameProcessing *pProc )
+{
+    SourceFrame frame;
+    for( ;; )
     {
-        std::cout<<"Frame ID:";
-        if( bFrameIDValid )
-        {
-            std::cout<<nFrameID;
-        }
-        else
+        if( m_FrameQueue.TryPop( frame ))
         {
-            std::cout<<"?";
+            ProcessFrame( frame, *pProc );
+            // Do not keep a reference to the frame while sleeping
+            frame = SourceFrame();
+            continue;
         }
 
-        std::cout<<" Status:";
-        if( bFrameStatusValid )
+        std::unique_lock<std::mutex> lock( m_WakeMutex );
+        if( m_bStopping.load() )
         {
-            PrintFrameStatus( eFrameStatus);
+            break;
         }
-        else
-        {
-            std::cout<<"?";
-        }
-        PrintFrameInfo( pFrame );
-        
-        std::cout<<" FPS:";
-        if( bFPSValid )
-        {
-            std::streamsize s = std::cout.precision();
-            std::cout<<std::fixed<<std::setprecision(2)<<dFPS<<std::setprecision(s);
-        }
-        else
+        m_nSleepingWorkers.fetch_add( 1 );
+        // Pairs with the fence in FrameReceived: either we see the new frame or the callback sees us sleeping
+        std::atomic_thread_fence( std::memory_order_seq_cst );
+        if( 0 == m_FrameQueue.Size() )
         {
-            std::cout<<"?";
+            // The timeout only guards against a missed notification, wakeups are signalled by the callback
+            m_WakeCondition.wait_for( lock, std::chrono::milliseconds( 100 ));
         }
-
-        std::cout<<"\n";
+        m_nSleepingWorkers.fetch_sub( 1 );
     }
-    else
+
+    // Finish whatever was queued before Stop()
+    while( m_FrameQueue.TryPop( frame ))
     {
-        std::cout<<".";
+        ProcessFrame( frame, *pProc );
     }
 }
 
 /**
  * @brief This is our callback routine that will be executed on every received frame.
+ * With workers configured it only hands the frame over and returns
  * 
- * @param pFrame The frame returned from the API
+ * @param Frame The frame delivered by the source
  */
-void FrameObserver::FrameReceived( const FramePtr pFrame )
+void FrameObserver::FrameReceived( const SourceFrame &Frame )
 {
-    if(!SP_ISNULL( pFrame ) )
+    // The source owns the callback thread, it can only be pinned from inside
+    if( !m_bCallbackPinned )
     {
-        if( FrameInfos_Off != m_eFrameInfos )
+        m_bCallbackPinned = true;
+        if( !SetCurrentThreadAffinity( m_Cpus ))
         {
-            ShowFrameInfos( pFrame);
+            std::cout<<"Could not pin callback thread of camera "<<m_Source.GetID()<<"\n";
         }
+    }
+
+    m_nReceived.fetch_add( 1, std::memory_order_relaxed );
 
-        VmbFrameStatusType status;
-        VmbErrorType Result;
+    // Missing frame detection relies on arrival order, so frame infos are queued from the callback thread
+    if( m_pFrameInfoLogger )
+    {
+        m_pFrameInfoLogger->Log( Frame );
+    }
+    if( m_pLatencyMonitor )
+    {
+        m_pLatencyMonitor->FrameArrived( Frame );
+    }
+    // The recorder copies the frame, so it costs the callback a memcpy but never holds the buffer
+    if(     ( NULL != m_pRecorder )
+        &&  ( !m_bPipelineRecords ))
+    {
+        m_pRecorder->Record( Frame );
+    }
 
-        Result = SP_ACCESS( pFrame)->GetReceiveStatus( status);
+    if( NULL != m_pSynchronizer )
+    {
+        m_pSynchronizer->Push( m_nSynchronizerInput, Frame );
+        return;
+    }
 
-        if( VmbErrorSuccess == Result && VmbFrameStatusComplete == status)
-        {            
-            /**
-             * @brief Funzione per la conversione del buffer raw in oggetto CV
-             * 
-             */
-            proc->ProcessImage(pFrame);
+    if( m_pPipeline )
+    {
+        if( Frame.IsComplete() )
+        {
+            m_pPipeline->Push( Frame );
         }
         else
         {
-            std::cout<<"frame incomplete\n";
+            // Counted instead of printed, a burst of them would stall the callback on the console
+            m_nIncomplete.fetch_add( 1, std::memory_order_relaxed );
+            m_Source.QueueFrame( Frame );
         }
+        return;
     }
-    else
+
+    if( m_Workers.empty() )
+    {
+        ProcessFrame( Frame, *m_Processors[0] );
+        return;
+    }
+
+    if( m_bStopping.load( std::memory_order_relaxed ))
+    {
+        m_Source.QueueFrame( Frame );
+        return;
+    }
+
+    if( !m_FrameQueue.TryPush( Frame ))
+    {
+        // Never hold back the buffer: a frame nobody can take right now goes straight back to the source
+        m_nOverflows.fetch_add( 1, std::memory_order_relaxed );
+        m_Source.QueueFrame( Frame );
+        return;
+    }
+
+    const size_t nDepth = m_FrameQueue.Size();
+    if( nDepth > m_nMaxQueueDepth.load( std::memory_order_relaxed ))
     {
-        std::cout <<" frame pointer NULL\n";
+        m_nMaxQueueDepth.store( nDepth, std::memory_order_relaxed );
     }
 
-    m_pCamera->QueueFrame( pFrame );
+    std::atomic_thread_fence( std::memory_order_seq_cst );
+    if( m_nSleepingWorkers.load() > 0 )
+    {
+        {
+            std::lock_guard<std::mutex> lock( m_WakeMutex );
+        }
+        m_WakeCondition.notify_one();
+    }
 }
 }} // namespace AVT::VmbAPI
@@ -1,34 +1,141 @@
+#include <cstring>
+#include <utility>
+
 #include "FrameProcessing.h"
+#include "CVPixelFormat.h"
+#include "PixelFormat.h"
 
 namespace AVT {
 namespace VmbAPI {
 
-FrameProcessing::FrameProcessing() {}
+// Colour correction applied with /c, the matrix of the Vimba AsynchronousGrab example
+static const VmbFloat_t g_ColorCorrectionMatrix[9] =
+{
+    0.6f, 0.3f, 0.1f,
+    0.6f, 0.3f, 0.1f,
+    0.6f, 0.3f, 0.1f,
+};
+
+FrameProcessing::FrameProcessing( bool bColor, ColorProcessing eColorProcessing, DemosaicProcessing eDemosaic, size_t nImageBuffers )
+    : m_bColor( bColor || ColorProcessing_Matrix == eColorProcessing )
+    , m_eColorProcessing( eColorProcessing )
+    , m_eDemosaic( eDemosaic )
+    , m_eImageInfoFormat( 0 )
+    , m_nImageBuffers( nImageBuffers )
+{
+    std::memset( &sourceImage, 0, sizeof( sourceImage ));
+    sourceImage.Size = sizeof( sourceImage );
+}
+
+bool FrameProcessing::ProcessImage(const SourceFrame &Frame)
+{
+    const VmbUint32_t Height = Frame.Height;
+    const VmbUint32_t Width  = Frame.Width;
+    const VmbPixelFormatType pixelF = Frame.PixelFormat;
+
+    if(     ( NULL == Frame.pBuffer )
+        ||  ( !Frame.bPixelFormatValid )
+        ||  ( 0 == Width || 0 == Height ))
+    {
+        cvImage.release();
+        return false;
+    }
+
+    // The image info only changes with format or geometry
+    if(     ( pixelF != m_eImageInfoFormat )
+        ||  ( Width != this->sourceImage.ImageInfo.Width )
+        ||  ( Height != this->sourceImage.ImageInfo.Height ))
+    {
+        this->sourceImage.Size = sizeof( this->sourceImage );
+        VmbSetImageInfoFromPixelFormat( pixelF, Width, Height, & this->sourceImage );
+        m_eImageInfoFormat = pixelF;
+    }
+    this->sourceImage.Data = Frame.pBuffer;
+
+    // Raw Bayer is only shown as is if no colour image was asked for,
+    // colour formats are copied if they get colour corrected
+    const bool bBayer = PixelFormatIsBayer( pixelF );
+    const bool bMono  = PixelFormatIsMono( pixelF );
+    int nType = 0;
+    if(     ( bBayer ? !m_bColor : ( bMono || ColorProcessing_Matrix != m_eColorProcessing ))
+        &&  ( PixelFormatToCVType( pixelF, nType )))
+    {
+        // Zero copy, the header points into the frame buffer
+        cvImage = cv::Mat( Height, Width, nType, (void*) this->sourceImage.Data );
+        return true;
+    }
+
+    // Packed mono formats are unpacked by the in-tree SIMD kernels of the conversion context
+    if( bMono || ( bBayer && !m_bColor ))
+    {
+        return Convert( Frame, "Mono8", CV_8UC1 );
+    }
+    return Convert( Frame, "BGR8", CV_8UC3 );
+}
 
-void FrameProcessing::ProcessImage(const FramePtr pFrame)
+/**
+ * @brief Converts the frame into a buffer leased from the conversion context.
+ * The context is only set up again when format or geometry change
+ * 
+ * @param Frame The frame to work on
+ * @param pDestinationFormat Vimba name of the destination format
+ * @param nType The matching OpenCV type
+ */
+bool FrameProcessing::Convert( const SourceFrame &Frame, const char *pDestinationFormat, int nType )
 {
-    VmbUint32_t Height = 0;
-    VmbUint32_t Width  = 0;
-    VmbPixelFormatType pixelF;
+    // A new Setup may replace the pooled buffers
+    cvImage.release();
+    m_Lease.Release();
+    if( !m_Context.Matches( Frame.PixelFormat, Frame.Width, Frame.Height ))
+    {
+        const bool bMatrix = ColorProcessing_Matrix == m_eColorProcessing && 0 == std::strcmp( pDestinationFormat, "BGR8" );
+        if( VmbErrorSuccess != m_Context.Setup( Frame.PixelFormat, Frame.Width, Frame.Height, pDestinationFormat, bMatrix ? g_ColorCorrectionMatrix : NULL, m_eDemosaic, m_nImageBuffers ))
+        {
+            cvImage.release();
+            return false;
+        }
+    }
 
-    pFrame->GetWidth(Width);
-    pFrame->GetHeight(Height);
-    pFrame->GetPixelFormat(pixelF);
+    if( VmbErrorSuccess != m_Context.Transform( Frame.pBuffer, m_Lease ))
+    {
+        cvImage.release();
+        return false;
+    }
 
-    VmbUchar_t *pBuffer;
-    VmbErrorType err = SP_ACCESS( pFrame )->GetImage( pBuffer );
+    cvImage = cv::Mat( Frame.Height, Frame.Width, nType, m_Lease.Data() );
+    return true;
+}
 
-    VmbSetImageInfoFromPixelFormat( pixelF, Width, Height, & this->sourceImage );
-    this->sourceImage.Data = pBuffer;
-    this->sourceImage.Size = sizeof( this->sourceImage );
+void FrameProcessing::Release()
+{
+    cvImage.release();
+    m_Lease.Release();
+    this->sourceImage.Data = NULL;
+}
 
-    cv::Mat imageLocal(cv::Size(Width, Height), CV_8UC3, (void*) this->sourceImage.Data);
+ImageBufferLease FrameProcessing::TakeLease()
+{
+    return std::move( m_Lease );
 }
 
 void FrameProcessing::Show()
 {
+    if( this->cvImage.empty() )
+    {
+        return;
+    }
     cv::imshow("Streaming Vimba", this->cvImage);
     cv::waitKey(1);
 }
 
-}}
\ No newline at end of file
+VmbImage FrameProcessing::GetImage()
+{
+    return this->sourceImage;
+}
+
+cv::Mat FrameProcessing::GetCVImage()
+{
+    return this->cvImage;
+}
+
+}}
@@ -0,0 +1,527 @@
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <chrono>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "FrameRecorder.h"
+#include "HostClock.h"
+#include "StripeCodec.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+static size_t AlignUp( size_t nSize, size_t nAlignment )
+{
+    return ( nSize + nAlignment - 1 ) / nAlignment * nAlignment;
+}
+
+FrameRecorder::FrameRecorder( bool bCompress, unsigned int nCodecThreads )
+    :   m_bCompress( bCompress )
+    ,   m_nCodecThreads( nCodecThreads )
+    ,   m_hFile( -1 )
+    ,   m_bDirectIO( false )
+    ,   m_pFill( NULL )
+    ,   m_nFill( 0 )
+    ,   m_nOffset( 0 )
+    ,   m_bStopping( false )
+    ,   m_bCodecStopping( false )
+    ,   m_bFailed( false )
+    ,   m_nFrames( 0 )
+    ,   m_nPayloadBytes( 0 )
+    ,   m_nStoredBytes( 0 )
+    ,   m_nCodedBytes( 0 )
+    ,   m_nCodecNanoseconds( 0 )
+    ,   m_nFileBytes( 0 )
+    ,   m_nDropped( 0 )
+{
+}
+
+FrameRecorder::~FrameRecorder()
+{
+    if( m_hFile >= 0 )
+    {
+        Close();
+    }
+}
+
+VmbErrorType FrameRecorder::Open( const std::string &strFileName, const std::string &strCameraID, VmbUint64_t nTimestampFrequency )
+{
+    if( m_hFile >= 0 )
+    {
+        return VmbErrorInvalidCall;
+    }
+
+    const int nFlags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+    m_hFile     = open( strFileName.c_str(), nFlags | O_DIRECT, 0644 );
+    m_bDirectIO = m_hFile >= 0;
+    if(     ( m_hFile < 0 )
+        &&  ( EINVAL == errno ))
+    {
+        m_hFile = open( strFileName.c_str(), nFlags, 0644 );
+    }
+    if( m_hFile < 0 )
+    {
+        return EACCES == errno ? VmbErrorInvalidAccess : VmbErrorOther;
+    }
+
+    m_Buffers.resize( BUFFER_COUNT );
+    for( size_t i = 0; i < m_Buffers.size(); ++i )
+    {
+        void *pData = NULL;
+        if( 0 != posix_memalign( &pData, BLOCK_SIZE, BUFFER_SIZE ))
+        {
+            m_Buffers.resize( i );
+            Close();
+            return VmbErrorResources;
+        }
+        m_Buffers[i].pData          = static_cast<VmbUchar_t*>( pData );
+        m_Buffers[i].nFileOffset    = 0;
+        m_Buffers[i].nSize          = 0;
+        m_FreeBuffers.push_back( &m_Buffers[i] );
+    }
+
+    m_pFill     = NULL;
+    m_nFill     = 0;
+    m_nOffset   = 0;
+    m_Index.clear();
+    m_bStopping = false;
+    m_bFailed.store( false );
+    m_nFrames.store( 0 );
+    m_nPayloadBytes.store( 0 );
+    m_nStoredBytes.store( 0 );
+    m_nCodedBytes.store( 0 );
+    m_nCodecNanoseconds.store( 0 );
+    m_nFileBytes.store( 0 );
+    m_nDropped.store( 0 );
+
+    RecordingFileHeader header;
+    std::memset( &header, 0, sizeof( header ));
+    header.Magic                = RECORDING_FILE_MAGIC;
+    header.Version              = RECORDING_VERSION;
+    header.HeaderSize           = sizeof( header );
+    header.TimestampFrequency   = nTimestampFrequency;
+    header.StartTime            = GetHostTime();
+    std::strncpy( header.CameraID, strCameraID.c_str(), sizeof( header.CameraID ) - 1 );
+    Append( &header, sizeof( header ));
+
+    m_Writer = std::thread( &FrameRecorder::WriterLoop, this );
+    if( m_bCompress )
+    {
+        if( !m_pCodecPool )
+        {
+            m_pCodecPool.reset( new ThreadPool( m_nCodecThreads ));
+        }
+        m_CodecFrames.resize( CODEC_FRAMES );
+        for( size_t i = 0; i < m_CodecFrames.size(); ++i )
+        {
+            m_FreeCodecFrames.push_back( &m_CodecFrames[i] );
+        }
+        m_bCodecStopping    = false;
+        m_Encoder           = std::thread( &FrameRecorder::EncoderLoop, this );
+    }
+    return VmbErrorSuccess;
+}
+
+/**
+ * @brief Bytes that can be appended without waiting for the disk
+ */
+size_t FrameRecorder::GetFreeSpace()
+{
+    size_t nFree = NULL != m_pFill ? BUFFER_SIZE - m_nFill : 0;
+    std::lock_guard<std::mutex> lock( m_Mutex );
+    return nFree + m_FreeBuffers.size() * BUFFER_SIZE;
+}
+
+void FrameRecorder::Record( const SourceFrame &Frame )
+{
+    if( m_hFile < 0 )
+    {
+        return;
+    }
+
+    RecordingFrameHeader header;
+    header.Magic            = RECORDING_FRAME_MAGIC;
+    header.HeaderSize       = sizeof( header );
+    header.FrameID          = Frame.FrameID;
+    header.Timestamp        = Frame.Timestamp;
+    header.ReceiveTime      = Frame.ReceiveTime;
+    header.ImageSize        = Frame.ImageSize;
+    header.Width            = Frame.Width;
+    header.Height           = Frame.Height;
+    header.OffsetX          = Frame.OffsetX;
+    header.OffsetY          = Frame.OffsetY;
+    header.PixelFormat      = Frame.PixelFormat;
+    header.ReceiveStatus    = Frame.ReceiveStatus;
+    header.Flags            = ( Frame.bFrameIDValid ? RecordingFrame_FrameIDValid : 0 )
+                            | ( Frame.bPixelFormatValid ? RecordingFrame_PixelFormatValid : 0 )
+                            | ( Frame.bReceiveStatusValid ? RecordingFrame_ReceiveStatusValid : 0 );
+    header.StoredSize       = Frame.ImageSize;
+    header.Reserved         = 0;
+
+    if( !m_bCompress )
+    {
+        if( BeginRecord( header, Frame.ImageSize ))
+        {
+            Append( Frame.pBuffer, Frame.ImageSize );
+            EndRecord( header );
+        }
+        return;
+    }
+
+    // The encoder gets a copy, the camera buffer is requeued as soon as this returns
+    CodecFrame *pFrame = NULL;
+    if( !m_bFailed.load( std::memory_order_relaxed ))
+    {
+        std::lock_guard<std::mutex> lock( m_CodecMutex );
+        if( !m_FreeCodecFrames.empty() )
+        {
+            pFrame = m_FreeCodecFrames.front();
+            m_FreeCodecFrames.pop_front();
+        }
+    }
+    if( NULL == pFrame )
+    {
+        m_nDropped.fetch_add( 1, std::memory_order_relaxed );
+        return;
+    }
+    pFrame->Header = header;
+    pFrame->Data.assign( Frame.pBuffer, Frame.pBuffer + Frame.ImageSize );
+    {
+        std::lock_guard<std::mutex> lock( m_CodecMutex );
+        m_PendingCodecFrames.push_back( pFrame );
+    }
+    m_CodecCondition.notify_one();
+}
+
+/**
+ * @brief Appends the frame header and adds the frame to the index if the whole record fits into the
+ * staging buffers. A frame goes in whole or not at all, a torn record would end the recoverable part
+ * of the file
+ *
+ * @param Header Gets nStoredSize as StoredSize
+ *
+ * @return false if the frame was dropped, the payload must then not be appended
+ */
+bool FrameRecorder::BeginRecord( RecordingFrameHeader &Header, size_t nStoredSize )
+{
+    const size_t nRecord = AlignUp( sizeof( RecordingFrameHeader ) + nStoredSize, RECORDING_ALIGNMENT );
+    if(     ( m_bFailed.load( std::memory_order_relaxed ))
+        ||  ( nRecord > GetFreeSpace() ))
+    {
+        m_nDropped.fetch_add( 1, std::memory_order_relaxed );
+        return false;
+    }
+    Header.StoredSize = static_cast<VmbUint32_t>( nStoredSize );
+
+    RecordingIndexEntry entry;
+    entry.Offset    = m_nOffset;
+    entry.FrameID   = Header.FrameID;
+    entry.Timestamp = Header.Timestamp;
+    m_Index.push_back( entry );
+
+    Append( &Header, sizeof( Header ));
+    return true;
+}
+
+/**
+ * @brief Pads the record after its payload was appended
+ */
+void FrameRecorder::EndRecord( const RecordingFrameHeader &Header )
+{
+    static const VmbUchar_t PADDING[ RECORDING_ALIGNMENT ] = { 0 };
+    Append( PADDING, AlignUp( Header.StoredSize, RECORDING_ALIGNMENT ) - Header.StoredSize );
+
+    m_nFrames.fetch_add( 1, std::memory_order_relaxed );
+    m_nPayloadBytes.fetch_add( Header.ImageSize, std::memory_order_relaxed );
+    m_nStoredBytes.fetch_add( Header.StoredSize, std::memory_order_relaxed );
+}
+
+/**
+ * @brief Codes and appends the copied frames in order until Close() is called
+ */
+void FrameRecorder::EncoderLoop()
+{
+    std::unique_lock<std::mutex> lock( m_CodecMutex );
+    for( ;; )
+    {
+        while( m_PendingCodecFrames.empty() && !m_bCodecStopping )
+        {
+            m_CodecCondition.wait( lock );
+        }
+        if( m_PendingCodecFrames.empty() )
+        {
+            break;
+        }
+        CodecFrame *pFrame = m_PendingCodecFrames.front();
+        m_PendingCodecFrames.pop_front();
+        lock.unlock();
+
+        Encode( *pFrame );
+
+        lock.lock();
+        m_FreeCodecFrames.push_back( pFrame );
+    }
+}
+
+/**
+ * @brief Codes the stripes of a frame in parallel and appends the record.
+ * A frame the codec cannot lay out or does not shrink is stored as delivered
+ */
+void FrameRecorder::Encode( CodecFrame &Frame )
+{
+    RecordingFrameHeader    &header = Frame.Header;
+    const VmbUchar_t        *pImage = Frame.Data.empty() ? NULL : &Frame.Data[0];
+    StripeLayout            layout;
+    if(     ( NULL == pImage )
+        ||  ( !GetStripeLayout( header.PixelFormat, header.Width, header.Height, header.ImageSize, layout )))
+    {
+        if( BeginRecord( header, header.ImageSize ))
+        {
+            Append( pImage, header.ImageSize );
+            EndRecord( header );
+        }
+        return;
+    }
+
+    const VmbUint32_t   nStripes    = ( layout.Rows + STRIPE_ROWS - 1 ) / STRIPE_ROWS;
+    const size_t        nMaxStripe  = MaxEncodedStripeSize( layout, STRIPE_ROWS );
+    if( m_Coded.size() < nStripes * nMaxStripe )
+    {
+        m_Coded.resize( nStripes * nMaxStripe );
+    }
+    m_StripeSizes.resize( nStripes );
+    m_pCodecPool->Run( nStripes, [&]( size_t i )
+    {
+        const std::chrono::steady_clock::time_point tStart = std::chrono::steady_clock::now();
+        const VmbUint32_t nFirstRow = static_cast<VmbUint32_t>( i ) * STRIPE_ROWS;
+        const VmbUint32_t nRows     = layout.Rows - nFirstRow < STRIPE_ROWS ? layout.Rows - nFirstRow : STRIPE_ROWS;
+        m_StripeSizes[i] = static_cast<VmbUint32_t>( EncodeStripe( layout, pImage + static_cast<size_t>( nFirstRow ) * layout.RowBytes, nRows, &m_Coded[ i * nMaxStripe ] ));
+        m_nCodecNanoseconds.fetch_add( std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - tStart ).count(), std::memory_order_relaxed );
+    });
+    m_nCodedBytes.fetch_add( header.ImageSize, std::memory_order_relaxed );
+
+    const size_t nTable = AlignUp( sizeof( RecordingStripesHeader ) + nStripes * sizeof( VmbUint32_t ), RECORDING_ALIGNMENT );
+    size_t nStored = nTable;
+    for( VmbUint32_t i = 0; i < nStripes; ++i )
+    {
+        nStored += m_StripeSizes[i];
+    }
+    if( nStored >= header.ImageSize )
+    {
+        if( BeginRecord( header, header.ImageSize ))
+        {
+            Append( pImage, header.ImageSize );
+            EndRecord( header );
+        }
+        return;
+    }
+
+    header.Flags |= RecordingFrame_Compressed;
+    if( BeginRecord( header, nStored ))
+    {
+        static const VmbUchar_t PADDING[ RECORDING_ALIGNMENT ] = { 0 };
+        RecordingStripesHeader stripes;
+        stripes.StripeCount     = nStripes;
+        stripes.RowsPerStripe   = STRIPE_ROWS;
+        Append( &stripes, sizeof( stripes ));
+        Append( &m_StripeSizes[0], nStripes * sizeof( VmbUint32_t ));
+        Append( PADDING, nTable - sizeof( stripes ) - nStripes * sizeof( VmbUint32_t ));
+        for( VmbUint32_t i = 0; i < nStripes; ++i )
+        {
+            Append( &m_Coded[ i * nMaxStripe ], m_StripeSizes[i] );
+        }
+        EndRecord( header );
+    }
+}
+
+/**
+ * @brief Copies bytes into the staging buffers, handing every full one to the writer.
+ * Waits for a free buffer only if there is none, which Record rules out beforehand
+ */
+void FrameRecorder::Append( const void *pData, size_t nSize )
+{
+    const VmbUchar_t *pSource = static_cast<const VmbUchar_t*>( pData );
+    while( nSize > 0 )
+    {
+        if( NULL == m_pFill )
+        {
+            std::unique_lock<std::mutex> lock( m_Mutex );
+            while( m_FreeBuffers.empty() )
+            {
+                m_FreeCondition.wait( lock );
+            }
+            m_pFill = m_FreeBuffers.front();
+            m_FreeBuffers.pop_front();
+            m_pFill->nFileOffset    = m_nOffset;
+            m_nFill                 = 0;
+        }
+        const size_t nCopy = nSize < BUFFER_SIZE - m_nFill ? nSize : BUFFER_SIZE - m_nFill;
+        std::memcpy( m_pFill->pData + m_nFill, pSource, nCopy );
+        m_nFill     += nCopy;
+        m_nOffset   += nCopy;
+        pSource     += nCopy;
+        nSize       -= nCopy;
+        if( BUFFER_SIZE == m_nFill )
+        {
+            Submit( BUFFER_SIZE );
+        }
+    }
+}
+
+/**
+ * @brief Queues the buffer being filled for the writer thread
+ *
+ * @param nSize Bytes to write, a multiple of BLOCK_SIZE
+ */
+void FrameRecorder::Submit( size_t nSize )
+{
+    m_pFill->nSize = nSize;
+    {
+        std::lock_guard<std::mutex> lock( m_Mutex );
+        m_FullBuffers.push_back( m_pFill );
+    }
+    m_WriteCondition.notify_one();
+    m_pFill = NULL;
+    m_nFill = 0;
+}
+
+/**
+ * @brief Writes the full buffers in order until Close() is called.
+ * After a failed write the buffers are still cycled so the recording thread never waits forever
+ */
+void FrameRecorder::WriterLoop()
+{
+    std::unique_lock<std::mutex> lock( m_Mutex );
+    for( ;; )
+    {
+        while( m_FullBuffers.empty() && !m_bStopping )
+        {
+            m_WriteCondition.wait( lock );
+        }
+        if( m_FullBuffers.empty() )
+        {
+            break;
+        }
+        StagingBuffer *pBuffer = m_FullBuffers.front();
+        m_FullBuffers.pop_front();
+        lock.unlock();
+
+        size_t nWritten = 0;
+        while(      ( nWritten < pBuffer->nSize )
+                &&  ( !m_bFailed.load( std::memory_order_relaxed )))
+        {
+            const ssize_t nResult = pwrite( m_hFile, pBuffer->pData + nWritten, pBuffer->nSize - nWritten, static_cast<off_t>( pBuffer->nFileOffset + nWritten ));
+            if( nResult > 0 )
+            {
+                nWritten += static_cast<size_t>( nResult );
+            }
+            else if(    ( nResult < 0 )
+                    &&  ( EINTR == errno ))
+            {
+                continue;
+            }
+            else
+            {
+                m_bFailed.store( true );
+            }
+        }
+        m_nFileBytes.fetch_add( nWritten, std::memory_order_relaxed );
+
+        lock.lock();
+        m_FreeBuffers.push_back( pBuffer );
+        m_FreeCondition.notify_one();
+    }
+}
+
+VmbErrorType FrameRecorder::Close()
+{
+    if( m_hFile < 0 )
+    {
+        return VmbErrorInvalidCall;
+    }
+
+    if( m_Encoder.joinable() )
+    {
+        // The frames already copied aside still make it into the file
+        {
+            std::lock_guard<std::mutex> lock( m_CodecMutex );
+            m_bCodecStopping = true;
+        }
+        m_CodecCondition.notify_all();
+        m_Encoder.join();
+    }
+    if( m_Writer.joinable() )
+    {
+        // The index follows the last frame, the trailer tells where it starts
+        RecordingTrailer trailer;
+        trailer.Magic           = RECORDING_TRAILER_MAGIC;
+        trailer.IndexOffset     = m_nOffset;
+        trailer.FrameCount      = m_Index.size();
+        trailer.PayloadBytes    = m_nPayloadBytes.load();
+        for( std::deque<RecordingIndexEntry>::const_iterator it = m_Index.begin(); it != m_Index.end(); ++it )
+        {
+            Append( &*it, sizeof( *it ));
+        }
+        Append( &trailer, sizeof( trailer ));
+
+        // O_DIRECT only writes whole blocks, the zeros past the trailer are cut off again below
+        if( NULL != m_pFill )
+        {
+            const size_t nSize = AlignUp( m_nFill, BLOCK_SIZE );
+            std::memset( m_pFill->pData + m_nFill, 0, nSize - m_nFill );
+            Submit( nSize );
+        }
+        {
+            std::lock_guard<std::mutex> lock( m_Mutex );
+            m_bStopping = true;
+        }
+        m_WriteCondition.notify_all();
+        m_Writer.join();
+    }
+
+    bool bSuccess = !m_bFailed.load();
+    if(     ( bSuccess )
+        &&  ( 0 != ftruncate( m_hFile, static_cast<off_t>( m_nOffset ))))
+    {
+        bSuccess = false;
+    }
+    if( 0 != close( m_hFile ))
+    {
+        bSuccess = false;
+    }
+    m_hFile = -1;
+
+    for( size_t i = 0; i < m_Buffers.size(); ++i )
+    {
+        std::free( m_Buffers[i].pData );
+    }
+    m_Buffers.clear();
+    m_FreeBuffers.clear();
+    m_FullBuffers.clear();
+    m_Index.clear();
+    m_CodecFrames.clear();
+    m_FreeCodecFrames.clear();
+    m_PendingCodecFrames.clear();
+    m_pFill = NULL;
+    m_nFill = 0;
+    return bSuccess ? VmbErrorSuccess : VmbErrorOther;
+}
+
+RecordStatistics FrameRecorder::GetStatistics() const
+{
+    RecordStatistics stats;
+    stats.Frames        = m_nFrames.load( std::memory_order_relaxed );
+    stats.PayloadBytes  = m_nPayloadBytes.load( std::memory_order_relaxed );
+    stats.FileBytes     = m_nFileBytes.load( std::memory_order_relaxed );
+    stats.Dropped       = m_nDropped.load( std::memory_order_relaxed );
+    stats.StoredBytes   = m_nStoredBytes.load( std::memory_order_relaxed );
+    stats.bDirectIO     = m_bDirectIO;
+    stats.bCompressed   = m_bCompress;
+    stats.CodedBytes    = m_nCodedBytes.load( std::memory_order_relaxed );
+    stats.CodecSeconds  = m_nCodecNanoseconds.load( std::memory_order_relaxed ) / 1e9;
+    return stats;
+}
+
+}} // namespace AVT::VmbAPI
@@ -0,0 +1,346 @@
+#include <cmath>
+
+#include "FrameSynchronizer.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+FrameSynchronizer::FrameSynchronizer( size_t nInputs, const ProgramConfig &Config, PreviewDisplay *pDisplay )
+    :   m_eMatching( Config.getBundleMatching() )
+    ,   m_pDisplay( pDisplay )
+    ,   m_nTolerance( static_cast<VmbInt64_t>( BundleMatching_Timestamp == Config.getBundleMatching() ? Config.getBundleTolerance() * 1000.0 : Config.getBundleTolerance() ))
+    ,   m_Inputs( nInputs )
+    ,   m_bStarted( false )
+    ,   m_bStopping( false )
+    ,   m_bLastKeyValid( false )
+    ,   m_nLastKey( 0 )
+{
+    for( size_t i = 0; i < m_Inputs.size(); ++i )
+    {
+        m_Inputs[i].pSource             = NULL;
+        m_Inputs[i].nTimestampFrequency = 1000000000ULL;
+        m_Inputs[i].bKeyValid           = false;
+        m_Inputs[i].nLastRawKey         = 0;
+        m_Inputs[i].nLastKey            = 0;
+        m_Inputs[i].nLastReceive        = 0;
+        m_Inputs[i].dKeyPeriod          = BundleMatching_FrameID == m_eMatching ? 0.0 : 1.0;
+        m_Inputs[i].nKeyOffset          = 0;
+        m_Inputs[i].pProcessing.reset( new FrameProcessing( Config.getRGBValue(), Config.getColorProcessing(), Config.getDemosaicProcessing() ));
+    }
+    m_BundleThread = std::thread( &FrameSynchronizer::BundleLoop, this );
+}
+
+FrameSynchronizer::~FrameSynchronizer()
+{
+    Stop();
+}
+
+void FrameSynchronizer::SetInput( size_t nInput, IFrameSource *pSource )
+{
+    std::lock_guard<std::mutex> lock( m_Mutex );
+    if( nInput < m_Inputs.size() )
+    {
+        m_Inputs[ nInput ].pSource = pSource;
+        if( NULL != pSource && 0 != pSource->GetTimestampFrequency() )
+        {
+            m_Inputs[ nInput ].nTimestampFrequency = pSource->GetTimestampFrequency();
+        }
+    }
+}
+
+void FrameSynchronizer::Start()
+{
+    std::lock_guard<std::mutex> lock( m_Mutex );
+    m_bStarted = !m_bStopping;
+}
+
+/**
+ * @brief The value frames are matched by, false if the frame lacks it
+ */
+bool FrameSynchronizer::GetKey( const Input &In, const SourceFrame &Frame, VmbInt64_t &nKey ) const
+{
+    if( BundleMatching_FrameID == m_eMatching )
+    {
+        nKey = static_cast<VmbInt64_t>( Frame.FrameID );
+        return Frame.bFrameIDValid;
+    }
+    nKey = static_cast<VmbInt64_t>( TimestampToNanoseconds( Frame.Timestamp, In.nTimestampFrequency ));
+    return 0 != Frame.Timestamp;
+}
+
+/**
+ * @brief Continues the keys of a restarted camera where the camera that delivered last, or else the
+ * restarted one itself, has got to by now. Its frames of the previous run can no longer get a partner.
+ * Called with the mutex held
+ *
+ * @param In The restarted input
+ * @param Frame The first frame after the restart
+ * @param nRawKey Its key as the camera sent it
+ */
+void FrameSynchronizer::Rebase( Input &In, const SourceFrame &Frame, VmbInt64_t nRawKey )
+{
+    const Input *pReference = &In;
+    for( size_t i = 0; i < m_Inputs.size(); ++i )
+    {
+        const Input &Other = m_Inputs[i];
+        if(     ( NULL != Other.pSource )
+            &&  ( Other.bKeyValid )
+            &&  ( Other.nLastReceive > pReference->nLastReceive ))
+        {
+            pReference = &Other;
+        }
+    }
+    VmbInt64_t nKey = pReference->nLastKey + 1;
+    if(     ( pReference->dKeyPeriod > 0.0 )
+        &&  ( Frame.ReceiveTime > pReference->nLastReceive ))
+    {
+        nKey = pReference->nLastKey + static_cast<VmbInt64_t>( std::floor( static_cast<double>( Frame.ReceiveTime - pReference->nLastReceive ) / pReference->dKeyPeriod + 0.5 ));
+    }
+    In.nKeyOffset = nKey - nRawKey;
+    while( !In.Pending.empty() )
+    {
+        ++m_Statistics.Unmatched;
+        In.pSource->QueueFrame( In.Pending.front().Frame );
+        In.Pending.pop_front();
+    }
+    ++m_Statistics.Restarts;
+}
+
+/**
+ * @brief Remembers the newest key of a camera and, when matching frame IDs, its frame period
+ */
+void FrameSynchronizer::TrackKey( Input &In, const SourceFrame &Frame, VmbInt64_t nRawKey, VmbInt64_t nKey ) const
+{
+    if(     ( BundleMatching_FrameID == m_eMatching )
+        &&  ( In.bKeyValid )
+        &&  ( nKey > In.nLastKey )
+        &&  ( Frame.ReceiveTime > In.nLastReceive ))
+    {
+        In.dKeyPeriod = static_cast<double>( Frame.ReceiveTime - In.nLastReceive ) / static_cast<double>( nKey - In.nLastKey );
+    }
+    In.bKeyValid    = true;
+    In.nLastRawKey  = nRawKey;
+    In.nLastKey     = nKey;
+    In.nLastReceive = Frame.ReceiveTime;
+}
+
+void FrameSynchronizer::Push( size_t nInput, const SourceFrame &Frame )
+{
+    std::lock_guard<std::mutex> lock( m_Mutex );
+    if( nInput >= m_Inputs.size() )
+    {
+        return;
+    }
+    Input &In = m_Inputs[ nInput ];
+    if( NULL == In.pSource )
+    {
+        return;
+    }
+    if( !m_bStarted || m_bStopping )
+    {
+        In.pSource->QueueFrame( Frame );
+        return;
+    }
+
+    // An incomplete frame would spoil the bundle, it counts as having no partner
+    PendingFrame pending;
+    pending.Frame = Frame;
+    VmbInt64_t nRawKey = 0;
+    if(     ( !Frame.IsComplete() )
+        ||  ( !GetKey( In, Frame, nRawKey )))
+    {
+        ++m_Statistics.Unmatched;
+        In.pSource->QueueFrame( Frame );
+        return;
+    }
+    // The keys of one camera only grow, unless it was restarted
+    if(     ( In.bKeyValid )
+        &&  ( nRawKey < In.nLastRawKey ))
+    {
+        Rebase( In, Frame, nRawKey );
+    }
+    pending.Key = nRawKey + In.nKeyOffset;
+    TrackKey( In, Frame, nRawKey, pending.Key );
+    if(     ( m_bLastKeyValid )
+        &&  ( pending.Key < m_nLastKey - m_nTolerance ))
+    {
+        // Its peers went into a bundle or back to their cameras already
+        ++m_Statistics.Late;
+        In.pSource->QueueFrame( Frame );
+        return;
+    }
+    if( In.Pending.size() >= MAX_PENDING )
+    {
+        // Another camera stopped delivering, the buffers must not pile up here meanwhile
+        ++m_Statistics.Overflows;
+        In.pSource->QueueFrame( In.Pending.front().Frame );
+        In.Pending.pop_front();
+    }
+    In.Pending.push_back( pending );
+    Match();
+}
+
+/**
+ * @brief Forms bundles while every input has a frame waiting, called with the mutex held.
+ * Frames arrive in key order per camera, so a head older than the newest head by more than the
+ * tolerance can never get a partner and goes back to its camera
+ */
+void FrameSynchronizer::Match()
+{
+    for( ;; )
+    {
+        VmbInt64_t  nNewest = 0;
+        bool        bFirst  = true;
+        for( size_t i = 0; i < m_Inputs.size(); ++i )
+        {
+            const Input &In = m_Inputs[i];
+            if( NULL == In.pSource )
+            {
+                continue;
+            }
+            if( In.Pending.empty() )
+            {
+                return;
+            }
+            if( bFirst || In.Pending.front().Key > nNewest )
+            {
+                nNewest = In.Pending.front().Key;
+                bFirst  = false;
+            }
+        }
+        if( bFirst )
+        {
+            return;
+        }
+
+        bool bAligned = true;
+        for( size_t i = 0; i < m_Inputs.size(); ++i )
+        {
+            Input &In = m_Inputs[i];
+            if(     ( NULL != In.pSource )
+                &&  ( In.Pending.front().Key < nNewest - m_nTolerance ))
+            {
+                ++m_Statistics.Unmatched;
+                In.pSource->QueueFrame( In.Pending.front().Frame );
+                In.Pending.pop_front();
+                bAligned = false;
+            }
+        }
+        if( !bAligned )
+        {
+            continue;
+        }
+
+        FrameBundle bundle( m_Inputs.size() );
+        for( size_t i = 0; i < m_Inputs.size(); ++i )
+        {
+            Input &In = m_Inputs[i];
+            if( NULL != In.pSource )
+            {
+                bundle[i] = In.Pending.front().Frame;
+                In.Pending.pop_front();
+            }
+        }
+        m_bLastKeyValid = true;
+        m_nLastKey      = nNewest;
+
+        if( m_Bundles.size() >= MAX_BUNDLES )
+        {
+            ++m_Statistics.Dropped;
+            ReleaseBundle( bundle );
+            continue;
+        }
+        m_Bundles.push_back( bundle );
+        m_BundleCondition.notify_one();
+    }
+}
+
+/**
+ * @brief Hands every frame of a bundle back to its camera
+ */
+void FrameSynchronizer::ReleaseBundle( const FrameBundle &Bundle )
+{
+    for( size_t i = 0; i < Bundle.size(); ++i )
+    {
+        if( NULL != m_Inputs[i].pSource )
+        {
+            m_Inputs[i].pSource->QueueFrame( Bundle[i] );
+        }
+    }
+}
+
+/**
+ * @brief Processes the bundles one after the other until Stop() is called
+ */
+void FrameSynchronizer::BundleLoop()
+{
+    std::unique_lock<std::mutex> lock( m_Mutex );
+    for( ;; )
+    {
+        while( m_Bundles.empty() && !m_bStopping )
+        {
+            m_BundleCondition.wait( lock );
+        }
+        if( m_Bundles.empty() )
+        {
+            break;
+        }
+        FrameBundle bundle;
+        bundle.swap( m_Bundles.front() );
+        m_Bundles.pop_front();
+
+        lock.unlock();
+        VmbUint64_t nBytes = 0;
+        for( size_t i = 0; i < bundle.size(); ++i )
+        {
+            if( NULL == m_Inputs[i].pSource )
+            {
+                continue;
+            }
+            FrameProcessing &proc = *m_Inputs[i].pProcessing;
+            if(     ( proc.ProcessImage( bundle[i] ))
+                &&  ( NULL != m_pDisplay ))
+            {
+                m_pDisplay->Offer( i, proc.GetCVImage(), bundle[i].FrameID );
+            }
+            // The image may point into the frame buffer, drop it before the buffer is refilled
+            proc.Release();
+            nBytes += bundle[i].ImageSize;
+        }
+        lock.lock();
+
+        ReleaseBundle( bundle );
+        ++m_Statistics.Bundles;
+        m_Statistics.BundleBytes += nBytes;
+    }
+}
+
+void FrameSynchronizer::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock( m_Mutex );
+        m_bStopping = true;
+        for( size_t i = 0; i < m_Inputs.size(); ++i )
+        {
+            Input &In = m_Inputs[i];
+            while( !In.Pending.empty() )
+            {
+                In.pSource->QueueFrame( In.Pending.front().Frame );
+                In.Pending.pop_front();
+            }
+        }
+    }
+    m_BundleCondition.notify_all();
+    if( m_BundleThread.joinable() )
+    {
+        m_BundleThread.join();
+    }
+}
+
+BundleStatistics FrameSynchronizer::GetStatistics() const
+{
+    std::lock_guard<std::mutex> lock( m_Mutex );
+    return m_Statistics;
+}
+
+}} // namespace AVT::VmbAPI
@@ -0,0 +1,219 @@
+#include <cmath>
+#include <cstring>
+
+#include "FrameTimingAnalyzer.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+// Device time after which a frame has 1/e of the weight of the newest one in the clock fit
+const double FIT_TIME_CONSTANT  = 30.0e9;
+// Device time the fit must cover before its slope is used, below that arrival jitter dominates it
+const double MIN_FIT_SPAN       = 1.0e9;
+// Nanoseconds per nanosecond the arrival floor rises on its own, so it follows a fit that moved up
+const double FLOOR_RISE         = 1.0e-6;
+// Frames delayed more than this above the floor are stalls and stay out of the fit
+const double FIT_GATE           = 1.0e6;
+// Consecutive gated frames after which the delay is taken as the new normal and the fit restarts
+const unsigned int FIT_GATE_FRAMES = 64;
+
+FrameTimingAnalyzer::FrameTimingAnalyzer( VmbUint64_t nTimestampFrequency )
+    :   m_nTimestampFrequency( 0 != nTimestampFrequency ? nTimestampFrequency : 1000000000ULL )
+    ,   m_nSequence( 0 )
+    ,   m_nFrames( 0 )
+    ,   m_nOriginDevice( 0 )
+    ,   m_nOriginHost( 0 )
+    ,   m_dWeight( 0.0 )
+    ,   m_dCovDeviceDevice( 0.0 )
+    ,   m_dCovDeviceHost( 0.0 )
+    ,   m_nGatedFrames( 0 )
+    ,   m_bHasLast( false )
+    ,   m_nLastFrameNumber( 0 )
+    ,   m_nLastDevice( 0 )
+    ,   m_nLastHost( 0 )
+{
+    std::memset( &m_Model, 0, sizeof( m_Model ));
+    for( size_t i = 0; i < MODEL_FIELDS; ++i )
+    {
+        m_Published[i].store( 0.0, std::memory_order_relaxed );
+    }
+}
+
+void FrameTimingAnalyzer::Update( const SourceFrame &Frame )
+{
+    if(     ( 0 == Frame.Timestamp )
+        ||  ( 0 == Frame.ReceiveTime ))
+    {
+        return;
+    }
+
+    const VmbUint64_t nDevice       = TimestampToNanoseconds( Frame.Timestamp, m_nTimestampFrequency );
+    const VmbUint64_t nHost         = Frame.ReceiveTime;
+    const VmbUint64_t nFrameNumber  = Frame.bFrameIDValid ? Frame.FrameID : m_nLastFrameNumber + 1;
+
+    if( !m_bHasLast )
+    {
+        m_nOriginDevice = nDevice;
+        m_nOriginHost   = nHost;
+    }
+    const double dDevice    = static_cast<double>( static_cast<VmbInt64_t>( nDevice - m_nOriginDevice ));
+    const double dHost      = static_cast<double>( static_cast<VmbInt64_t>( nHost - m_nOriginHost ));
+
+    if(     ( !m_bHasLast )
+        ||  ( nDevice < m_nLastDevice )
+        ||  ( m_nGatedFrames >= FIT_GATE_FRAMES ))
+    {
+        // First frame, the camera clock was reset or the arrivals moved for good: start a new fit through this frame
+        m_Model.MeanDevice          = dDevice;
+        m_Model.MeanHost            = dHost;
+        m_Model.Slope               = 1.0;
+        m_Model.Floor               = 0.0;
+        m_Model.DeviceSpan          = 0.0;
+        m_Model.FirstFrameNumber    = static_cast<double>( nFrameNumber );
+        m_Model.LastFrameNumber     = static_cast<double>( nFrameNumber );
+        m_dWeight                   = 1.0;
+        m_dCovDeviceDevice          = 0.0;
+        m_dCovDeviceHost            = 0.0;
+        m_nGatedFrames              = 0;
+    }
+    else
+    {
+        // Lost frames do not make the sensor look slow, their device time is split among them
+        const VmbUint64_t nDeviceDelta  = nDevice - m_nLastDevice;
+        const VmbUint64_t nFrameDelta   = nFrameNumber > m_nLastFrameNumber ? nFrameNumber - m_nLastFrameNumber : 1;
+        m_DeviceIntervals.Record( nDeviceDelta / nFrameDelta );
+        if( nHost > m_nLastHost )
+        {
+            m_ArrivalIntervals.Record( nHost - m_nLastHost );
+        }
+
+        // Residual against the fit before this frame joins it, the floor drops to early arrivals at once
+        const double dResidual  = dHost - ( m_Model.MeanHost + m_Model.Slope * ( dDevice - m_Model.MeanDevice ));
+        const double dRisen     = m_Model.Floor + FLOOR_RISE * static_cast<double>( nDeviceDelta );
+        m_Model.Floor           = dResidual < dRisen ? dResidual : dRisen;
+
+        // Exponentially weighted least squares, means and covariances updated in place.
+        // The decay applies even to gated frames so the weights stay tied to device time
+        const double dDecay     = std::exp( -static_cast<double>( nDeviceDelta ) / FIT_TIME_CONSTANT );
+        m_dWeight              *= dDecay;
+        m_dCovDeviceDevice     *= dDecay;
+        m_dCovDeviceHost       *= dDecay;
+        if( dResidual - m_Model.Floor <= FIT_GATE )
+        {
+            m_dWeight              += 1.0;
+            const double dDelta     = dDevice - m_Model.MeanDevice;
+            m_Model.MeanDevice     += dDelta / m_dWeight;
+            m_Model.MeanHost       += ( dHost - m_Model.MeanHost ) / m_dWeight;
+            m_dCovDeviceDevice     += dDelta * ( dDevice - m_Model.MeanDevice );
+            m_dCovDeviceHost       += dDelta * ( dHost - m_Model.MeanHost );
+            m_nGatedFrames          = 0;
+        }
+        else
+        {
+            ++m_nGatedFrames;
+        }
+
+        m_Model.DeviceSpan     += static_cast<double>( nDeviceDelta );
+        m_Model.LastFrameNumber = static_cast<double>( nFrameNumber );
+        if(     ( m_Model.DeviceSpan >= MIN_FIT_SPAN )
+            &&  ( m_dCovDeviceDevice > 0.0 ))
+        {
+            m_Model.Slope = m_dCovDeviceHost / m_dCovDeviceDevice;
+        }
+    }
+
+    m_bHasLast          = true;
+    m_nLastFrameNumber  = nFrameNumber;
+    m_nLastDevice       = nDevice;
+    m_nLastHost         = nHost;
+    Publish( m_Model );
+    m_nFrames.fetch_add( 1, std::memory_order_relaxed );
+}
+
+void FrameTimingAnalyzer::Publish( const ClockModel &Model )
+{
+    double fields[ MODEL_FIELDS ];
+    std::memcpy( fields, &Model, sizeof( fields ));
+
+    const unsigned int nSequence = m_nSequence.load( std::memory_order_relaxed );
+    m_nSequence.store( nSequence + 1, std::memory_order_relaxed );
+    std::atomic_thread_fence( std::memory_order_release );
+    for( size_t i = 0; i < MODEL_FIELDS; ++i )
+    {
+        m_Published[i].store( fields[i], std::memory_order_relaxed );
+    }
+    m_nSequence.store( nSequence + 2, std::memory_order_release );
+}
+
+/**
+ * @brief Reads a consistent copy of the model, retrying while the callback thread writes it
+ *
+ * @return false before the first frame
+ */
+bool FrameTimingAnalyzer::ReadModel( ClockModel &Model ) const
+{
+    double fields[ MODEL_FIELDS ];
+    for( ;; )
+    {
+        const unsigned int nBefore = m_nSequence.load( std::memory_order_acquire );
+        if( 0 == nBefore )
+        {
+            return false;
+        }
+        if( 0 != ( nBefore & 1 ))
+        {
+            continue;
+        }
+        for( size_t i = 0; i < MODEL_FIELDS; ++i )
+        {
+            fields[i] = m_Published[i].load( std::memory_order_relaxed );
+        }
+        std::atomic_thread_fence( std::memory_order_acquire );
+        if( nBefore == m_nSequence.load( std::memory_order_relaxed ))
+        {
+            break;
+        }
+    }
+    std::memcpy( &Model, fields, sizeof( fields ));
+    return true;
+}
+
+VmbUint64_t FrameTimingAnalyzer::GetTransportDelay( const SourceFrame &Frame ) const
+{
+    ClockModel model;
+    if(     ( 0 == Frame.Timestamp )
+        ||  ( !ReadModel( model )))
+    {
+        return 0;
+    }
+    const double dDevice    = static_cast<double>( static_cast<VmbInt64_t>( TimestampToNanoseconds( Frame.Timestamp, m_nTimestampFrequency ) - m_nOriginDevice ));
+    const double dHost      = static_cast<double>( static_cast<VmbInt64_t>( Frame.ReceiveTime - m_nOriginHost ));
+    const double dDelay     = dHost - ( model.MeanHost + model.Slope * ( dDevice - model.MeanDevice )) - model.Floor;
+    return dDelay > 0.0 ? static_cast<VmbUint64_t>( dDelay ) : 0;
+}
+
+FrameTimingStatistics FrameTimingAnalyzer::GetStatistics() const
+{
+    FrameTimingStatistics stats;
+    ClockModel model;
+    stats.Frames = m_nFrames.load( std::memory_order_relaxed );
+    if( !ReadModel( model ))
+    {
+        return stats;
+    }
+    if(     ( model.DeviceSpan > 0.0 )
+        &&  ( model.LastFrameNumber > model.FirstFrameNumber ))
+    {
+        stats.SensorFPS = ( model.LastFrameNumber - model.FirstFrameNumber ) * 1.0e9 / model.DeviceSpan;
+        stats.bFPSValid = true;
+    }
+    if(     ( model.DeviceSpan >= MIN_FIT_SPAN )
+        &&  ( model.Slope > 0.0 ))
+    {
+        stats.DriftPPM      = ( 1.0 / model.Slope - 1.0 ) * 1.0e6;
+        stats.bDriftValid   = true;
+    }
+    return stats;
+}
+
+}} // namespace AVT::VmbAPI
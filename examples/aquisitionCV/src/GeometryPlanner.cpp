@@ -0,0 +1,287 @@
+#include <algorithm>
+
+#include "GeometryPlanner.h"
+#include "PixelFormat.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+/**
+ * @brief The largest value of the range not above nValue, the minimum if nValue is below it
+ */
+static VmbInt64_t FitDown( VmbInt64_t nValue, VmbInt64_t nMin, VmbInt64_t nMax, VmbInt64_t nIncrement )
+{
+    nValue = std::max( nMin, std::min( nValue, nMax ));
+    return nMin + ( nValue - nMin ) / nIncrement * nIncrement;
+}
+
+/**
+ * @brief Like FitDown, one increment lower if the result is odd; Bayer phase and image transform need even values
+ */
+static VmbInt64_t FitDownEven( VmbInt64_t nValue, VmbInt64_t nMin, VmbInt64_t nMax, VmbInt64_t nIncrement )
+{
+    const VmbInt64_t nFit = FitDown( nValue, nMin, nMax, nIncrement );
+    return ( 0 != nFit % 2 && nFit - nIncrement >= nMin ) ? nFit - nIncrement : nFit;
+}
+
+/**
+ * @brief Sets a feature a camera may lack, a missing one counts as set to nValue if that is its neutral value
+ */
+static VmbErrorType SetOptionalInt( ICameraFeatures &Features, const char *pName, VmbInt64_t nValue, VmbInt64_t nNeutral )
+{
+    const VmbErrorType res = Features.SetInt( pName, nValue );
+    return ( VmbErrorNotFound == res && nValue == nNeutral ) ? VmbErrorSuccess : res;
+}
+
+static VmbErrorType SetReduction( ICameraFeatures &Features, GeometryReduction eReduction, VmbInt64_t nFactor )
+{
+    const bool bBinning = GeometryReduction_Binning == eReduction;
+    VmbErrorType res = SetOptionalInt( Features, bBinning ? "BinningHorizontal" : "DecimationHorizontal", nFactor, 1 );
+    if( VmbErrorSuccess == res )
+    {
+        res = SetOptionalInt( Features, bBinning ? "BinningVertical" : "DecimationVertical", nFactor, 1 );
+    }
+    return res;
+}
+
+/**
+ * @brief Width or height at the largest even value, the behaviour without a request
+ */
+static VmbErrorType SetMaxEven( ICameraFeatures &Features, const char *pName )
+{
+    VmbInt64_t nMin         = 0;
+    VmbInt64_t nMax         = 0;
+    VmbInt64_t nIncrement   = 1;
+    const VmbErrorType res  = Features.GetIntRange( pName, nMin, nMax, nIncrement );
+    if( VmbErrorSuccess != res )
+    {
+        return res;
+    }
+    return Features.SetInt( pName, FitDownEven( nMax, nMin, nMax, nIncrement ));
+}
+
+/**
+ * @brief Sets the size to the region, trimmed to the increments, and places it on the region's centre
+ *
+ * @param nRegionOffset Start of the region in binned or decimated pixels
+ * @param nRegionSize Size of the region in binned or decimated pixels
+ */
+static VmbErrorType SetImageAxis( ICameraFeatures &Features, const char *pSize, const char *pOffset, VmbInt64_t nRegionOffset, VmbInt64_t nRegionSize )
+{
+    VmbInt64_t nMin         = 0;
+    VmbInt64_t nMax         = 0;
+    VmbInt64_t nIncrement   = 1;
+    VmbErrorType res = Features.GetIntRange( pSize, nMin, nMax, nIncrement );
+    if( VmbErrorSuccess != res )
+    {
+        return res;
+    }
+    const VmbInt64_t nSize = FitDownEven( nRegionSize, nMin, nMax, nIncrement );
+    res = Features.SetInt( pSize, nSize );
+    if( VmbErrorSuccess != res )
+    {
+        return res;
+    }
+
+    res = Features.GetIntRange( pOffset, nMin, nMax, nIncrement );
+    if( VmbErrorNotFound == res )
+    {
+        return VmbErrorSuccess;
+    }
+    if( VmbErrorSuccess == res )
+    {
+        res = Features.SetInt( pOffset, FitDownEven( nRegionOffset + ( nRegionSize - nSize ) / 2, nMin, nMax, nIncrement ));
+    }
+    return res;
+}
+
+std::string ChoosePixelFormat( const std::vector<std::string> &Available, bool bColor, const std::string &strCurrent )
+{
+    static const char * const ColorFormats[]    = { "BayerRG8", "BayerGR8", "BayerGB8", "BayerBG8", "BGR8", "RGB8", "Mono8" };
+    static const char * const MonoFormats[]     = { "Mono8", "BayerRG8", "BayerGR8", "BayerGB8", "BayerBG8" };
+    const char * const * const pFirst   = bColor ? ColorFormats : MonoFormats;
+    const size_t nCount                 = bColor ? sizeof( ColorFormats ) / sizeof( ColorFormats[0] ) : sizeof( MonoFormats ) / sizeof( MonoFormats[0] );
+    for( size_t i = 0; i < nCount; ++i )
+    {
+        if( Available.end() != std::find( Available.begin(), Available.end(), std::string( pFirst[i] )))
+        {
+            return pFirst[i];
+        }
+    }
+    return strCurrent;
+}
+
+VmbErrorType ApplyGeometry( ICameraFeatures &Features, const GeometryRequest &Request, bool bColor, GeometryPlan &Plan )
+{
+    Plan = GeometryPlan();
+    VmbErrorType res = VmbErrorSuccess;
+
+    if( 0 == Request.Width )
+    {
+        // Offsets left by a previous run would keep the size below the maximum
+        SetOptionalInt( Features, "OffsetX", 0, 0 );
+        SetOptionalInt( Features, "OffsetY", 0, 0 );
+        res = SetMaxEven( Features, "Width" );
+        if( VmbErrorSuccess == res )
+        {
+            res = SetMaxEven( Features, "Height" );
+        }
+    }
+    else
+    {
+        // Cleared first: binning limits the formats on colour sensors, and the sensor size is read unbinned
+        res = SetReduction( Features, GeometryReduction_Binning, 1 );
+        if( VmbErrorSuccess == res )
+        {
+            res = SetReduction( Features, GeometryReduction_Decimation, 1 );
+        }
+        if( VmbErrorSuccess != res )
+        {
+            return res;
+        }
+
+        std::string strFormat;
+        Features.GetEnum( "PixelFormat", strFormat );
+        if( Request.bPixelFormat )
+        {
+            const char *pName = PixelFormatToName( Request.PixelFormat );
+            res = NULL == pName ? VmbErrorNotSupported : Features.SetEnum( "PixelFormat", pName );
+            if( VmbErrorSuccess != res )
+            {
+                return res;
+            }
+            strFormat = pName;
+        }
+        else
+        {
+            std::vector<std::string> Available;
+            Features.GetEnumEntries( "PixelFormat", Available );
+            const std::string strChosen = ChoosePixelFormat( Available, bColor, strFormat );
+            if(     ( strChosen != strFormat )
+                &&  ( VmbErrorSuccess == Features.SetEnum( "PixelFormat", strChosen )))
+            {
+                strFormat = strChosen;
+            }
+        }
+        VmbPixelFormatType eFormat = VmbPixelFormatMono8;
+        const bool bBayer = PixelFormatFromName( strFormat.c_str(), eFormat ) && PixelFormatIsBayer( eFormat );
+
+        VmbInt64_t nSensorWidth     = 0;
+        VmbInt64_t nSensorHeight    = 0;
+        res = Features.GetInt( "WidthMax", nSensorWidth );
+        if( VmbErrorSuccess == res )
+        {
+            res = Features.GetInt( "HeightMax", nSensorHeight );
+        }
+        if( VmbErrorSuccess != res )
+        {
+            return res;
+        }
+
+        // The field of view, clipped to the sensor
+        VmbInt64_t nRegionX         = std::min<VmbInt64_t>( Request.RegionX, nSensorWidth - 1 );
+        VmbInt64_t nRegionY         = std::min<VmbInt64_t>( Request.RegionY, nSensorHeight - 1 );
+        VmbInt64_t nRegionWidth     = 0 == Request.RegionWidth ? nSensorWidth : std::min<VmbInt64_t>( Request.RegionWidth, nSensorWidth - nRegionX );
+        VmbInt64_t nRegionHeight    = 0 == Request.RegionHeight ? nSensorHeight : std::min<VmbInt64_t>( Request.RegionHeight, nSensorHeight - nRegionY );
+        if( 0 == Request.RegionWidth )
+        {
+            nRegionX = 0;
+            nRegionY = 0;
+        }
+
+        // Binning keeps the full light and is preferred, on a Bayer sensor it would mix the colours
+        std::vector<GeometryReduction> Candidates;
+        switch( Request.Reduction )
+        {
+        case GeometryReduction_Auto:
+            if( !( bColor && bBayer ))
+            {
+                Candidates.push_back( GeometryReduction_Binning );
+            }
+            Candidates.push_back( GeometryReduction_Decimation );
+            break;
+        case GeometryReduction_Binning:
+        case GeometryReduction_Decimation:
+            Candidates.push_back( Request.Reduction );
+            break;
+        case GeometryReduction_Roi:
+            break;
+        }
+        const VmbInt64_t nWanted = std::min( nRegionWidth / Request.Width, nRegionHeight / Request.Height );
+        for( size_t i = 0; i < Candidates.size() && nWanted > 1 && 1 == Plan.Factor; ++i )
+        {
+            const bool bBinning = GeometryReduction_Binning == Candidates[i];
+            VmbInt64_t nMin         = 0;
+            VmbInt64_t nMaxH        = 0;
+            VmbInt64_t nMaxV        = 0;
+            VmbInt64_t nIncrement   = 1;
+            if(     ( VmbErrorSuccess != Features.GetIntRange( bBinning ? "BinningHorizontal" : "DecimationHorizontal", nMin, nMaxH, nIncrement ))
+                ||  ( VmbErrorSuccess != Features.GetIntRange( bBinning ? "BinningVertical" : "DecimationVertical", nMin, nMaxV, nIncrement )))
+            {
+                continue;
+            }
+            // Not every factor in the range is supported by every camera, the camera has the last word
+            for( VmbInt64_t nFactor = std::min( nWanted, std::min( nMaxH, nMaxV )); nFactor > 1; --nFactor )
+            {
+                if( VmbErrorSuccess == SetReduction( Features, Candidates[i], nFactor ))
+                {
+                    Plan.Reduction  = Candidates[i];
+                    Plan.Factor     = nFactor;
+                    break;
+                }
+            }
+            if( 1 == Plan.Factor )
+            {
+                SetReduction( Features, Candidates[i], 1 );
+            }
+        }
+
+        // Offsets cleared so the size can take any value up to the maximum
+        res = SetOptionalInt( Features, "OffsetX", 0, 0 );
+        if( VmbErrorSuccess == res )
+        {
+            res = SetOptionalInt( Features, "OffsetY", 0, 0 );
+        }
+        if( VmbErrorSuccess == res )
+        {
+            res = SetImageAxis( Features, "Width", "OffsetX", nRegionX / Plan.Factor, nRegionWidth / Plan.Factor );
+        }
+        if( VmbErrorSuccess == res )
+        {
+            res = SetImageAxis( Features, "Height", "OffsetY", nRegionY / Plan.Factor, nRegionHeight / Plan.Factor );
+        }
+        Plan.SensorWidth    = nSensorWidth;
+        Plan.SensorHeight   = nSensorHeight;
+    }
+    if( VmbErrorSuccess != res )
+    {
+        return res;
+    }
+
+    // Read back what the camera made of it
+    Features.GetEnum( "PixelFormat", Plan.PixelFormat );
+    Features.GetInt( "Width", Plan.Width );
+    Features.GetInt( "Height", Plan.Height );
+    Features.GetInt( "OffsetX", Plan.OffsetX );
+    Features.GetInt( "OffsetY", Plan.OffsetY );
+    if( 0 == Plan.SensorWidth )
+    {
+        Plan.SensorWidth    = Plan.Width;
+        Plan.SensorHeight   = Plan.Height;
+    }
+    return VmbErrorSuccess;
+}
+
+void PrintGeometryPlan( std::ostream &s, const GeometryPlan &Plan )
+{
+    s<<Plan.Width<<"x"<<Plan.Height<<"+"<<Plan.OffsetX<<"+"<<Plan.OffsetY<<" "<<Plan.PixelFormat;
+    switch( Plan.Reduction )
+    {
+    case GeometryReduction_Binning:     s<<", binning "<<Plan.Factor;       break;
+    case GeometryReduction_Decimation:  s<<", decimation "<<Plan.Factor;    break;
+    default:                            s<<", full resolution";             break;
+    }
+    s<<" of "<<Plan.SensorWidth<<"x"<<Plan.SensorHeight;
+}
+
+}} // namespace AVT::VmbAPI
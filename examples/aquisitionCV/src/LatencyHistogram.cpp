@@ -0,0 +1,119 @@
+#include "LatencyHistogram.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+LatencyHistogram::LatencyHistogram()
+    :   m_nCount( 0 )
+    ,   m_nMax( 0 )
+{
+    for( unsigned int i = 0; i < BUCKET_COUNT; ++i )
+    {
+        m_Buckets[i].store( 0, std::memory_order_relaxed );
+    }
+}
+
+/**
+ * @brief Values up to 2^( SUB_BUCKET_BITS + 1 ) map to themselves, larger ones keep their
+ * SUB_BUCKET_BITS + 1 most significant bits and add 2^SUB_BUCKET_BITS buckets per bit shifted out
+ */
+unsigned int LatencyHistogram::BucketIndex( VmbUint64_t nValue )
+{
+    const VmbUint64_t nLimit = ( 1ULL << MAX_VALUE_BITS ) - 1;
+    if( nValue > nLimit )
+    {
+        nValue = nLimit;
+    }
+    if( nValue < ( 2ULL << SUB_BUCKET_BITS ))
+    {
+        return static_cast<unsigned int>( nValue );
+    }
+    const unsigned int nMsb     = 63 - static_cast<unsigned int>( __builtin_clzll( nValue ));
+    const unsigned int nShift   = nMsb - SUB_BUCKET_BITS;
+    return ( nShift << SUB_BUCKET_BITS ) + static_cast<unsigned int>( nValue >> nShift );
+}
+
+VmbUint64_t LatencyHistogram::BucketUpperValue( unsigned int nIndex )
+{
+    if( nIndex < ( 2u << SUB_BUCKET_BITS ))
+    {
+        return nIndex;
+    }
+    const unsigned int nShift       = ( nIndex >> SUB_BUCKET_BITS ) - 1;
+    const VmbUint64_t  nSubBucket   = nIndex - ( nShift << SUB_BUCKET_BITS );
+    return (( nSubBucket + 1 ) << nShift ) - 1;
+}
+
+void LatencyHistogram::Record( VmbUint64_t nNanoseconds )
+{
+    m_Buckets[ BucketIndex( nNanoseconds ) ].fetch_add( 1, std::memory_order_relaxed );
+    m_nCount.fetch_add( 1, std::memory_order_relaxed );
+
+    VmbUint64_t nMax = m_nMax.load( std::memory_order_relaxed );
+    while(      ( nNanoseconds > nMax )
+            &&  ( !m_nMax.compare_exchange_weak( nMax, nNanoseconds, std::memory_order_relaxed )))
+    {}
+}
+
+VmbUint64_t LatencyHistogram::GetCount() const
+{
+    return m_nCount.load( std::memory_order_relaxed );
+}
+
+VmbUint64_t LatencyHistogram::GetMax() const
+{
+    return m_nMax.load( std::memory_order_relaxed );
+}
+
+VmbUint64_t LatencyHistogram::GetPercentile( double dPercentile ) const
+{
+    // Sum the buckets instead of using m_nCount, recorders may be halfway through
+    VmbUint64_t nTotal = 0;
+    for( unsigned int i = 0; i < BUCKET_COUNT; ++i )
+    {
+        nTotal += m_Buckets[i].load( std::memory_order_relaxed );
+    }
+    if( 0 == nTotal )
+    {
+        return 0;
+    }
+
+    VmbUint64_t nRank = static_cast<VmbUint64_t>( dPercentile / 100.0 * static_cast<double>( nTotal ) + 0.5 );
+    nRank = nRank < 1 ? 1 : nRank > nTotal ? nTotal : nRank;
+
+    const VmbUint64_t nMax = GetMax();
+    VmbUint64_t nSeen = 0;
+    for( unsigned int i = 0; i < BUCKET_COUNT; ++i )
+    {
+        nSeen += m_Buckets[i].load( std::memory_order_relaxed );
+        if( nSeen >= nRank )
+        {
+            // The last bucket also holds everything beyond its range, only the maximum bounds it
+            const VmbUint64_t nValue = BUCKET_COUNT - 1 == i ? nMax : BucketUpperValue( i );
+            return nValue < nMax ? nValue : nMax;
+        }
+    }
+    return nMax;
+}
+
+VmbUint64_t LatencyHistogram::GetCountAbove( VmbUint64_t nThreshold ) const
+{
+    VmbUint64_t nCount = 0;
+    for( unsigned int i = BucketIndex( nThreshold ) + 1; i < BUCKET_COUNT; ++i )
+    {
+        nCount += m_Buckets[i].load( std::memory_order_relaxed );
+    }
+    return nCount;
+}
+
+void LatencyHistogram::Reset()
+{
+    for( unsigned int i = 0; i < BUCKET_COUNT; ++i )
+    {
+        m_Buckets[i].store( 0, std::memory_order_relaxed );
+    }
+    m_nCount.store( 0, std::memory_order_relaxed );
+    m_nMax.store( 0, std::memory_order_relaxed );
+}
+
+}} // namespace AVT::VmbAPI
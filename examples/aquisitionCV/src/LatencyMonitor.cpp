@@ -0,0 +1,201 @@
+#include <cstdio>
+#include <csignal>
+#include <iostream>
+#include <string>
+#include <chrono>
+
+#include "LatencyMonitor.h"
+#include "HostClock.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+// The report thread checks for SIGUSR1 and the report interval this often
+const std::chrono::milliseconds POLL_INTERVAL( 100 );
+
+static const char* const STAGE_NAMES[ LatencyStage_Count ] =
+{
+    "transport",
+    "queue wait",
+    "processing",
+    "requeue",
+    "total"
+};
+
+// Incremented by the signal handler, every monitor prints when it sees a new value
+static std::atomic<unsigned int>    g_nReportRequests( 0 );
+// Monitors alive, the first installs the handler and the last restores the previous one
+static std::mutex                   g_SignalMutex;
+static unsigned int                 g_nSignalUsers = 0;
+static struct sigaction             g_PreviousAction;
+
+extern "C" void OnReportSignal( int )
+{
+    g_nReportRequests.fetch_add( 1, std::memory_order_relaxed );
+}
+
+static void InstallReportSignal()
+{
+    std::lock_guard<std::mutex> lock( g_SignalMutex );
+    if( 0 == g_nSignalUsers++ )
+    {
+        struct sigaction action;
+        sigemptyset( &action.sa_mask );
+        action.sa_flags     = SA_RESTART;
+        action.sa_handler   = OnReportSignal;
+        sigaction( SIGUSR1, &action, &g_PreviousAction );
+    }
+}
+
+static void RemoveReportSignal()
+{
+    std::lock_guard<std::mutex> lock( g_SignalMutex );
+    if( 0 == --g_nSignalUsers )
+    {
+        sigaction( SIGUSR1, &g_PreviousAction, NULL );
+    }
+}
+
+LatencyMonitor::LatencyMonitor( const std::string &strCameraID, VmbUint64_t nTimestampFrequency, double dReportInterval )
+    :   m_strCameraID( strCameraID )
+    ,   m_dReportInterval( dReportInterval )
+    ,   m_Timing( nTimestampFrequency )
+    ,   m_bStopping( false )
+{
+    InstallReportSignal();
+    m_Reporter = std::thread( &LatencyMonitor::ReporterLoop, this );
+}
+
+LatencyMonitor::~LatencyMonitor()
+{
+    if( m_Reporter.joinable() )
+    {
+        Stop();
+    }
+    RemoveReportSignal();
+}
+
+void LatencyMonitor::FrameArrived( const SourceFrame &Frame )
+{
+    m_Timing.Update( Frame );
+    Record( LatencyStage_Transport, m_Timing.GetTransportDelay( Frame ));
+}
+
+VmbUint64_t LatencyMonitor::GetTransportLatency( const SourceFrame &Frame ) const
+{
+    return m_Timing.GetTransportDelay( Frame );
+}
+
+void LatencyMonitor::Record( LatencyStage eStage, VmbUint64_t nNanoseconds )
+{
+    m_Histograms[ eStage ].Record( nNanoseconds );
+}
+
+void LatencyMonitor::Stop()
+{
+    m_bStopping.store( true );
+    {
+        std::lock_guard<std::mutex> lock( m_WakeMutex );
+    }
+    m_WakeCondition.notify_all();
+    if( m_Reporter.joinable() )
+    {
+        m_Reporter.join();
+        Print();
+    }
+}
+
+void LatencyMonitor::Print() const
+{
+    std::string report( "Camera " + m_strCameraID + "\n" );
+    report += "Latency [us]         count        p50        p99      p99.9        max\n";
+    char        line[128];
+    for( int i = 0; i < LatencyStage_Count; ++i )
+    {
+        const LatencyHistogram &histogram = m_Histograms[i];
+        std::snprintf(  line, sizeof( line ), "%-12s %12llu %10.1f %10.1f %10.1f %10.1f\n",
+                        STAGE_NAMES[i],
+                        static_cast<unsigned long long>( histogram.GetCount() ),
+                        histogram.GetPercentile( 50.0 ) / 1000.0,
+                        histogram.GetPercentile( 99.0 ) / 1000.0,
+                        histogram.GetPercentile( 99.9 ) / 1000.0,
+                        histogram.GetMax() / 1000.0 );
+        report += line;
+    }
+
+    // A frame interval half again as long as usual is a camera side stall, a frame arriving
+    // more than a frame interval late one on the host side
+    const FrameTimingStatistics timing      = m_Timing.GetStatistics();
+    const LatencyHistogram      &device     = m_Timing.GetDeviceIntervals();
+    const LatencyHistogram      &arrival    = m_Timing.GetArrivalIntervals();
+    const VmbUint64_t           nInterval   = device.GetPercentile( 50.0 );
+    if( timing.bFPSValid )
+    {
+        std::snprintf(  line, sizeof( line ), "Sensor %.2f fps, frame interval p50 %.1f us jitter %.1f us, %llu camera stalls\n",
+                        timing.SensorFPS,
+                        nInterval / 1000.0,
+                        ( device.GetPercentile( 99.0 ) - nInterval ) / 1000.0,
+                        static_cast<unsigned long long>( device.GetCountAbove( nInterval + nInterval / 2 )));
+        report += line;
+        const VmbUint64_t nArrival = arrival.GetPercentile( 50.0 );
+        std::snprintf(  line, sizeof( line ), "Arrival interval p50 %.1f us jitter %.1f us, %llu host stalls\n",
+                        nArrival / 1000.0,
+                        ( arrival.GetPercentile( 99.0 ) - nArrival ) / 1000.0,
+                        static_cast<unsigned long long>( m_Histograms[ LatencyStage_Transport ].GetCountAbove( nInterval )));
+        report += line;
+    }
+    else
+    {
+        report += "Sensor rate unknown, no device timestamps yet\n";
+    }
+    if( timing.bDriftValid )
+    {
+        std::snprintf( line, sizeof( line ), "Camera clock drift %+.2f ppm against the host clock\n", timing.DriftPPM );
+        report += line;
+    }
+    std::cout.write( report.data(), static_cast<std::streamsize>( report.size() ));
+    std::cout.flush();
+}
+
+void LatencyMonitor::ReporterLoop()
+{
+    typedef std::chrono::steady_clock clock;
+    const clock::duration   interval        = std::chrono::duration_cast<clock::duration>( std::chrono::duration<double>( m_dReportInterval ));
+    clock::time_point       nextReport      = clock::now() + interval;
+    unsigned int            nSeenRequests   = g_nReportRequests.load( std::memory_order_relaxed );
+
+    for( ;; )
+    {
+        {
+            std::unique_lock<std::mutex> lock( m_WakeMutex );
+            if( !m_bStopping.load() )
+            {
+                m_WakeCondition.wait_for( lock, POLL_INTERVAL );
+            }
+        }
+        if( m_bStopping.load() )
+        {
+            break;
+        }
+
+        bool bPrint = false;
+        const unsigned int nRequests = g_nReportRequests.load( std::memory_order_relaxed );
+        if( nRequests != nSeenRequests )
+        {
+            nSeenRequests   = nRequests;
+            bPrint          = true;
+        }
+        if(     ( m_dReportInterval > 0.0 )
+            &&  ( clock::now() >= nextReport ))
+        {
+            nextReport += interval;
+            bPrint      = true;
+        }
+        if( bPrint )
+        {
+            Print();
+        }
+    }
+}
+
+}} // namespace AVT::VmbAPI
@@ -0,0 +1,304 @@
+#include <iostream>
+#include <chrono>
+#include <functional>
+
+#include "Pipeline.h"
+#include "ThreadAffinity.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+Pipeline::Node::Node( std::unique_ptr<PipelineStage> pStage, unsigned int nThreads, size_t nQueueCapacity, OverflowPolicy eOverflow )
+    :   pStage( std::move( pStage ))
+    ,   nThreads( nThreads > 0 ? nThreads : 1 )
+    ,   eOverflow( eOverflow )
+    ,   Queue( nQueueCapacity )
+    ,   nSleepingWorkers( 0 )
+    ,   nBlockedProducers( 0 )
+    ,   bStopping( false )
+    ,   nProcessed( 0 )
+    ,   nDropped( 0 )
+    ,   nMaxQueueDepth( 0 )
+    ,   nBusyNanoseconds( 0 )
+{
+}
+
+Pipeline::Pipeline( IFrameSource &Source )
+    :   m_Source( Source )
+    ,   m_bStopping( false )
+    ,   m_nPushing( 0 )
+    ,   m_nPushed( 0 )
+    ,   m_nCompleted( 0 )
+    ,   m_nCompletedBytes( 0 )
+{
+}
+
+Pipeline::~Pipeline()
+{
+    Stop();
+}
+
+size_t Pipeline::AddStage( std::unique_ptr<PipelineStage> pStage, unsigned int nThreads, size_t nQueueCapacity, OverflowPolicy eOverflow )
+{
+    m_Nodes.push_back( std::unique_ptr<Node>( new Node( std::move( pStage ), nThreads, nQueueCapacity, eOverflow )));
+    return m_Nodes.size();
+}
+
+void Pipeline::Connect( size_t nFrom, size_t nTo )
+{
+    if(     ( nFrom >= nTo )
+        ||  ( nTo > m_Nodes.size() ))
+    {
+        return;
+    }
+    std::vector<size_t> &Outputs = SOURCE == nFrom ? m_SourceOutputs : m_Nodes[ nFrom - 1 ]->Outputs;
+    Outputs.push_back( nTo );
+}
+
+void Pipeline::Start( const std::vector<unsigned int> &Cpus )
+{
+    for( size_t i = 0; i < m_Nodes.size(); ++i )
+    {
+        Node &Target = *m_Nodes[i];
+        Target.pStage->Prepare( Target.nThreads );
+        for( unsigned int j = 0; j < Target.nThreads; ++j )
+        {
+            Target.Workers.push_back( std::thread( &Pipeline::WorkerLoop, this, &Target, j ));
+            if( !SetThreadAffinity( Target.Workers.back(), Cpus ))
+            {
+                std::cout<<"Could not pin "<<Target.pStage->GetName()<<" thread of camera "<<m_Source.GetID()<<"\n";
+            }
+        }
+    }
+}
+
+/**
+ * @brief Deleter of the shared frame, runs on the thread dropping the last packet
+ */
+void Pipeline::Complete( const SourceFrame *pFrame )
+{
+    m_Source.QueueFrame( *pFrame );
+    m_nCompleted.fetch_add( 1, std::memory_order_relaxed );
+    m_nCompletedBytes.fetch_add( pFrame->ImageSize, std::memory_order_relaxed );
+    delete pFrame;
+}
+
+void Pipeline::Push( const SourceFrame &Frame )
+{
+    m_nPushing.fetch_add( 1 );
+    if( m_bStopping.load() )
+    {
+        m_nPushing.fetch_sub( 1 );
+        m_Source.QueueFrame( Frame );
+        return;
+    }
+    m_nPushed.fetch_add( 1, std::memory_order_relaxed );
+
+    PipelinePacket Packet;
+    Packet.pFrame.reset( new SourceFrame( Frame ), std::bind( &Pipeline::Complete, this, std::placeholders::_1 ));
+    Forward( m_SourceOutputs, Packet );
+    // Without a taker the frame goes back to the source right here
+    Packet = PipelinePacket();
+    m_nPushing.fetch_sub( 1 );
+}
+
+void Pipeline::Forward( const std::vector<size_t> &Outputs, const PipelinePacket &Packet )
+{
+    for( size_t i = 0; i < Outputs.size(); ++i )
+    {
+        Node &Target = *m_Nodes[ Outputs[i] - 1 ];
+        if( !Enqueue( Target, Packet ))
+        {
+            continue;
+        }
+
+        const size_t nDepth = Target.Queue.Size();
+        if( nDepth > Target.nMaxQueueDepth.load( std::memory_order_relaxed ))
+        {
+            Target.nMaxQueueDepth.store( nDepth, std::memory_order_relaxed );
+        }
+
+        // Pairs with the fence in WorkerLoop: either the worker sees the packet or we see it sleeping
+        std::atomic_thread_fence( std::memory_order_seq_cst );
+        if( Target.nSleepingWorkers.load() > 0 )
+        {
+            {
+                std::lock_guard<std::mutex> lock( Target.WakeMutex );
+            }
+            Target.WakeCondition.notify_one();
+        }
+    }
+}
+
+/**
+ * @brief Puts a packet into the queue of a stage, applying its overflow policy when it is full
+ *
+ * @return false if the packet was dropped
+ */
+bool Pipeline::Enqueue( Node &Target, const PipelinePacket &Packet )
+{
+    if( Target.Queue.TryPush( Packet ))
+    {
+        return true;
+    }
+
+    switch( Target.eOverflow )
+    {
+    case Overflow_Block:
+        {
+            std::unique_lock<std::mutex> lock( Target.WakeMutex );
+            Target.nBlockedProducers.fetch_add( 1 );
+            // Pairs with the fence in WorkerLoop: either we see the room or the worker sees us waiting
+            std::atomic_thread_fence( std::memory_order_seq_cst );
+            bool bPushed = Target.Queue.TryPush( Packet );
+            while(      ( !bPushed )
+                    &&  ( !Target.bStopping.load() ))
+            {
+                // The timeout only guards against a missed notification
+                Target.SpaceCondition.wait_for( lock, std::chrono::milliseconds( 100 ));
+                bPushed = Target.Queue.TryPush( Packet );
+            }
+            Target.nBlockedProducers.fetch_sub( 1 );
+            if( bPushed )
+            {
+                return true;
+            }
+        }
+        break;
+    case Overflow_DropOldest:
+        {
+            // A worker may take the oldest packet first, there is room either way unless another producer fills it
+            PipelinePacket Oldest;
+            if( Target.Queue.TryPop( Oldest ))
+            {
+                Target.nDropped.fetch_add( 1, std::memory_order_relaxed );
+            }
+            Oldest = PipelinePacket();
+            if( Target.Queue.TryPush( Packet ))
+            {
+                return true;
+            }
+        }
+        break;
+    case Overflow_DropNewest:
+        break;
+    }
+    Target.nDropped.fetch_add( 1, std::memory_order_relaxed );
+    return false;
+}
+
+void Pipeline::Execute( Node &Target, PipelinePacket &Packet, unsigned int nThread )
+{
+    const std::chrono::steady_clock::time_point tStart = std::chrono::steady_clock::now();
+    const bool bPass = Target.pStage->Process( Packet, nThread );
+    Target.nBusyNanoseconds.fetch_add( std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - tStart ).count(), std::memory_order_relaxed );
+    Target.nProcessed.fetch_add( 1, std::memory_order_relaxed );
+    if( bPass )
+    {
+        Forward( Target.Outputs, Packet );
+    }
+}
+
+/**
+ * @brief Drains the queue of a stage until it is stopped.
+ * Idle workers sleep on the condition variable, producers only notify when someone sleeps
+ */
+void Pipeline::WorkerLoop( Node *pNode, unsigned int nThread )
+{
+    Node &Target = *pNode;
+    PipelinePacket Packet;
+    for( ;; )
+    {
+        if( Target.Queue.TryPop( Packet ))
+        {
+            std::atomic_thread_fence( std::memory_order_seq_cst );
+            if( Target.nBlockedProducers.load() > 0 )
+            {
+                {
+                    std::lock_guard<std::mutex> lock( Target.WakeMutex );
+                }
+                Target.SpaceCondition.notify_all();
+            }
+            Execute( Target, Packet, nThread );
+            // Do not keep the frame while sleeping
+            Packet = PipelinePacket();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock( Target.WakeMutex );
+        if( Target.bStopping.load() )
+        {
+            break;
+        }
+        Target.nSleepingWorkers.fetch_add( 1 );
+        std::atomic_thread_fence( std::memory_order_seq_cst );
+        if( 0 == Target.Queue.Size() )
+        {
+            Target.WakeCondition.wait_for( lock, std::chrono::milliseconds( 100 ));
+        }
+        Target.nSleepingWorkers.fetch_sub( 1 );
+    }
+
+    // Finish whatever was queued before Stop()
+    while( Target.Queue.TryPop( Packet ))
+    {
+        Execute( Target, Packet, nThread );
+        Packet = PipelinePacket();
+    }
+}
+
+void Pipeline::Stop()
+{
+    m_bStopping.store( true );
+    // A Push past the stopping check may still block on a full queue, the stages are running to take it
+    while( m_nPushing.load() > 0 )
+    {
+        std::this_thread::yield();
+    }
+
+    // A stage only gets input from the stages before it, once those are joined its queue only shrinks
+    for( size_t i = 0; i < m_Nodes.size(); ++i )
+    {
+        Node &Target = *m_Nodes[i];
+        {
+            std::lock_guard<std::mutex> lock( Target.WakeMutex );
+            Target.bStopping.store( true );
+        }
+        Target.WakeCondition.notify_all();
+        Target.SpaceCondition.notify_all();
+        for( size_t j = 0; j < Target.Workers.size(); ++j )
+        {
+            if( Target.Workers[j].joinable() )
+            {
+                Target.Workers[j].join();
+            }
+        }
+        Target.Workers.clear();
+    }
+}
+
+PipelineStatistics Pipeline::GetStatistics() const
+{
+    PipelineStatistics stats;
+    stats.Pushed            = m_nPushed.load( std::memory_order_relaxed );
+    stats.Completed         = m_nCompleted.load( std::memory_order_relaxed );
+    stats.CompletedBytes    = m_nCompletedBytes.load( std::memory_order_relaxed );
+    for( size_t i = 0; i < m_Nodes.size(); ++i )
+    {
+        const Node &Target = *m_Nodes[i];
+        PipelineStageStatistics stage;
+        stage.Name          = Target.pStage->GetName();
+        stage.Threads       = Target.nThreads;
+        stage.Processed     = Target.nProcessed.load( std::memory_order_relaxed );
+        stage.Dropped       = Target.nDropped.load( std::memory_order_relaxed );
+        stage.QueueDepth    = Target.Queue.Size();
+        stage.MaxQueueDepth = Target.nMaxQueueDepth.load( std::memory_order_relaxed );
+        stage.QueueCapacity = Target.Queue.Capacity();
+        stage.BusySeconds   = Target.nBusyNanoseconds.load( std::memory_order_relaxed ) / 1.0e9;
+        stage.Summary       = Target.pStage->GetSummary();
+        stats.Stages.push_back( stage );
+    }
+    return stats;
+}
+
+}} // namespace AVT::VmbAPI
@@ -0,0 +1,250 @@
+#include <sstream>
+
+#include "PipelineStages.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+namespace {
+
+/**
+ * @brief Holds the place of a record or display stage whose recorder or preview is missing
+ */
+class PassStage : public PipelineStage
+{
+    public:
+        explicit PassStage( const std::string &strName )
+            :   m_strName( strName )
+        {
+        }
+
+        virtual std::string GetName() const { return m_strName; }
+        virtual bool        Process( PipelinePacket &, unsigned int ) { return true; }
+
+    private:
+        const std::string   m_strName;
+};
+
+}
+
+ConvertStage::ConvertStage( const ProgramConfig &Config, size_t nImageBuffers )
+    :   m_bRGB( Config.getRGBValue() )
+    ,   m_eColorProcessing( Config.getColorProcessing() )
+    ,   m_eDemosaic( Config.getDemosaicProcessing() )
+    ,   m_nImageBuffers( nImageBuffers )
+{
+}
+
+std::string ConvertStage::GetName() const
+{
+    return "convert";
+}
+
+void ConvertStage::Prepare( unsigned int nThreads )
+{
+    m_Processors.clear();
+    for( unsigned int i = 0; i < nThreads; ++i )
+    {
+        m_Processors.push_back( std::unique_ptr<FrameProcessing>( new FrameProcessing( m_bRGB, m_eColorProcessing, m_eDemosaic, m_nImageBuffers )));
+    }
+}
+
+bool ConvertStage::Process( PipelinePacket &Packet, unsigned int nThread )
+{
+    FrameProcessing &proc = *m_Processors[ nThread ];
+    const SourceFrame &Frame = *Packet.pFrame;
+    bool bConverted = proc.ProcessImage( Frame );
+    if( bConverted )
+    {
+        // The packet keeps the frame buffer alive, and the pooled buffer of a converted image
+        Packet.Image = proc.GetCVImage();
+        ImageBufferLease Lease = proc.TakeLease();
+        if( Lease.IsValid() )
+        {
+            Packet.pImageBuffer = std::make_shared<ImageBufferLease>( std::move( Lease ));
+        }
+        bConverted = !Packet.Image.empty();
+    }
+    proc.Release();
+    return bConverted;
+}
+
+CropStage::CropStage( unsigned int nX, unsigned int nY, unsigned int nWidth, unsigned int nHeight )
+    :   m_Region( static_cast<int>( nX ), static_cast<int>( nY ), static_cast<int>( nWidth ), static_cast<int>( nHeight ))
+{
+}
+
+std::string CropStage::GetName() const
+{
+    return "crop";
+}
+
+bool CropStage::Process( PipelinePacket &Packet, unsigned int )
+{
+    const cv::Rect Region = m_Region & cv::Rect( 0, 0, Packet.Image.cols, Packet.Image.rows );
+    if( Region.area() <= 0 )
+    {
+        return false;
+    }
+    Packet.Image = Packet.Image( Region );
+    return true;
+}
+
+ResizeStage::ResizeStage( unsigned int nWidth, unsigned int nHeight )
+    :   m_Size( static_cast<int>( nWidth ), static_cast<int>( nHeight ))
+{
+}
+
+std::string ResizeStage::GetName() const
+{
+    return "resize";
+}
+
+bool ResizeStage::Process( PipelinePacket &Packet, unsigned int )
+{
+    if( Packet.Image.empty() )
+    {
+        return false;
+    }
+    // A new matrix, the input may be shared with other stages
+    cv::Mat Resized;
+    cv::resize( Packet.Image, Resized, m_Size, 0, 0, cv::INTER_AREA );
+    Packet.Image = Resized;
+    Packet.pImageBuffer.reset();
+    return true;
+}
+
+AnalyzeStage::AnalyzeStage()
+    :   m_nImages( 0 )
+    ,   m_dLastMean( 0.0 )
+    ,   m_dMinMean( 0.0 )
+    ,   m_dMaxMean( 0.0 )
+{
+}
+
+std::string AnalyzeStage::GetName() const
+{
+    return "analyze";
+}
+
+bool AnalyzeStage::Process( PipelinePacket &Packet, unsigned int )
+{
+    if( Packet.Image.empty() )
+    {
+        return false;
+    }
+    const cv::Scalar Means = cv::mean( Packet.Image );
+    double dMean = 0.0;
+    for( int i = 0; i < Packet.Image.channels() && i < 4; ++i )
+    {
+        dMean += Means[i];
+    }
+    dMean /= Packet.Image.channels() < 4 ? Packet.Image.channels() : 4;
+
+    std::lock_guard<std::mutex> lock( m_Mutex );
+    m_dMinMean  = 0 == m_nImages || dMean < m_dMinMean ? dMean : m_dMinMean;
+    m_dMaxMean  = 0 == m_nImages || dMean > m_dMaxMean ? dMean : m_dMaxMean;
+    m_dLastMean = dMean;
+    ++m_nImages;
+    return true;
+}
+
+std::string AnalyzeStage::GetSummary() const
+{
+    std::lock_guard<std::mutex> lock( m_Mutex );
+    std::ostringstream s;
+    s<<"mean "<<m_dLastMean<<" (range "<<m_dMinMean<<" - "<<m_dMaxMean<<")";
+    return s.str();
+}
+
+RecordStage::RecordStage( FrameRecorder &Recorder )
+    :   m_Recorder( Recorder )
+{
+}
+
+std::string RecordStage::GetName() const
+{
+    return "record";
+}
+
+bool RecordStage::Process( PipelinePacket &Packet, unsigned int )
+{
+    m_Recorder.Record( *Packet.pFrame );
+    return true;
+}
+
+DisplayStage::DisplayStage( PreviewDisplay &Display, size_t nInput )
+    :   m_Display( Display )
+    ,   m_nInput( nInput )
+{
+}
+
+std::string DisplayStage::GetName() const
+{
+    return "display";
+}
+
+bool DisplayStage::Process( PipelinePacket &Packet, unsigned int )
+{
+    if( Packet.Image.empty() )
+    {
+        return false;
+    }
+    m_Display.Offer( m_nInput, Packet.Image, Packet.pFrame->FrameID );
+    return true;
+}
+
+/**
+ * @brief Packets the stages fed by a stage, directly or through others, hold at most: every such stage
+ * can queue its capacity and work on one packet per thread. Plus the one the stage itself passes on
+ */
+static size_t PacketsBehind( const ProgramConfig &Config, size_t nStage )
+{
+    const std::vector<PipelineStageConfig> &Stages = Config.getPipeline();
+    std::vector<bool> Behind( Stages.size() + 1, false );
+    Behind[ nStage ] = true;
+    size_t nPackets = 1;
+    for( size_t i = nStage; i < Stages.size(); ++i )
+    {
+        for( size_t j = 0; j < Stages[i].Inputs.size() && !Behind[ i + 1 ]; ++j )
+        {
+            Behind[ i + 1 ] = Behind[ Stages[i].Inputs[j] ];
+        }
+        if( Behind[ i + 1 ] )
+        {
+            nPackets += ( Stages[i].QueueCapacity > 0 ? Stages[i].QueueCapacity : Config.getQueueCapacity() ) + Stages[i].Threads;
+        }
+    }
+    return nPackets;
+}
+
+void BuildPipeline( Pipeline &Target, const ProgramConfig &Config, FrameRecorder *pRecorder, PreviewDisplay *pDisplay, size_t nInput )
+{
+    const std::vector<PipelineStageConfig> &Stages = Config.getPipeline();
+    for( size_t i = 0; i < Stages.size(); ++i )
+    {
+        const PipelineStageConfig &Stage = Stages[i];
+        std::unique_ptr<PipelineStage> pStage;
+        switch( Stage.Type )
+        {
+        case PipelineStage_Convert:     pStage.reset( new ConvertStage( Config, PacketsBehind( Config, i + 1 )));       break;
+        case PipelineStage_Crop:        pStage.reset( new CropStage( Stage.X, Stage.Y, Stage.Width, Stage.Height ));    break;
+        case PipelineStage_Resize:      pStage.reset( new ResizeStage( Stage.Width, Stage.Height ));                    break;
+        case PipelineStage_Analyze:     pStage.reset( new AnalyzeStage() );                                             break;
+        case PipelineStage_Record:
+            pStage.reset( NULL != pRecorder ? static_cast<PipelineStage*>( new RecordStage( *pRecorder )) : new PassStage( "record" ));
+            break;
+        case PipelineStage_Display:
+            pStage.reset( NULL != pDisplay ? static_cast<PipelineStage*>( new DisplayStage( *pDisplay, nInput )) : new PassStage( "display" ));
+            break;
+        }
+        const size_t nCapacity = Stage.QueueCapacity > 0 ? Stage.QueueCapacity : Config.getQueueCapacity();
+        const size_t nStage = Target.AddStage( std::move( pStage ), Stage.Threads, nCapacity, Stage.Overflow );
+        for( size_t j = 0; j < Stage.Inputs.size(); ++j )
+        {
+            Target.Connect( Stage.Inputs[j], nStage );
+        }
+    }
+}
+
+}} // namespace AVT::VmbAPI
@@ -0,0 +1,586 @@
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "PlaybackFrameSource.h"
+#include "FrameObserver.h"
+#include "HostClock.h"
+#include "StripeCodec.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+static const VmbUint64_t NO_SEEK = ~0ULL;
+// The playback thread notices StopAcquisition at least this often, even during a long recorded pause
+static const std::chrono::milliseconds MAX_SLEEP( 100 );
+
+static VmbUint64_t AlignUp( VmbUint64_t nSize, VmbUint64_t nAlignment )
+{
+    return ( nSize + nAlignment - 1 ) / nAlignment * nAlignment;
+}
+
+/**
+ * @brief Construct a new Playback Frame Source:: Playback Frame Source object
+ *
+ * @param strFileName The recording
+ * @param Playback Timing, first frame and looping
+ * @param nBufferCount Frames in flight at most, like the buffers of a camera
+ * @param nDecodeThreads Threads decoding the stripes of a compressed frame, 0 for one per core
+ */
+PlaybackFrameSource::PlaybackFrameSource( const std::string &strFileName, const PlaybackConfig &Playback, VmbUint32_t nBufferCount, unsigned int nDecodeThreads )
+    :   m_strFileName( strFileName )
+    ,   m_Playback( Playback )
+    ,   m_nBufferCount( nBufferCount > 0 ? nBufferCount : 1 )
+    ,   m_nDecodeThreads( nDecodeThreads )
+    ,   m_hFile( -1 )
+    ,   m_pMapping( NULL )
+    ,   m_nMappingSize( 0 )
+    ,   m_pHeader( NULL )
+    ,   m_pIndex( NULL )
+    ,   m_nFrames( 0 )
+    ,   m_nFrameIDSpan( 0 )
+    ,   m_nTimestampSpan( 0 )
+    ,   m_pObserver( NULL )
+    ,   m_bRunning( false )
+    ,   m_nSeek( NO_SEEK )
+    ,   m_nDecodedBytes( 0 )
+    ,   m_nDecodeNanoseconds( 0 )
+{
+}
+
+PlaybackFrameSource::~PlaybackFrameSource()
+{
+    Close();
+}
+
+/**
+ * @brief Maps the recording and checks its header and index
+ */
+VmbErrorType PlaybackFrameSource::Open()
+{
+    if( NULL != m_pMapping )
+    {
+        return VmbErrorInvalidCall;
+    }
+
+    m_hFile = open( m_strFileName.c_str(), O_RDONLY | O_CLOEXEC );
+    if( m_hFile < 0 )
+    {
+        return ENOENT == errno ? VmbErrorNotFound : VmbErrorInvalidAccess;
+    }
+    struct stat status;
+    if(     ( 0 != fstat( m_hFile, &status ))
+        ||  ( static_cast<VmbUint64_t>( status.st_size ) < sizeof( RecordingFileHeader )))
+    {
+        Close();
+        return VmbErrorInvalidValue;
+    }
+
+    // Private and writable, so a processing step working in place gets its own copy of the page
+    // instead of a fault; the file itself is never changed
+    m_nMappingSize  = static_cast<size_t>( status.st_size );
+    void *pMapping  = mmap( NULL, m_nMappingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, m_hFile, 0 );
+    if( MAP_FAILED == pMapping )
+    {
+        m_nMappingSize = 0;
+        Close();
+        return VmbErrorResources;
+    }
+    m_pMapping = static_cast<VmbUchar_t*>( pMapping );
+    madvise( m_pMapping, m_nMappingSize, MADV_SEQUENTIAL );
+
+    m_pHeader = reinterpret_cast<const RecordingFileHeader*>( m_pMapping );
+    if(     ( RECORDING_FILE_MAGIC != m_pHeader->Magic )
+        ||  ( 0 == m_pHeader->Version || m_pHeader->Version > RECORDING_VERSION )
+        ||  ( m_pHeader->HeaderSize < sizeof( RecordingFileHeader ))
+        ||  ( m_pHeader->HeaderSize > m_nMappingSize )
+        ||  ( 0 == m_pHeader->TimestampFrequency )
+        ||  ( !LoadIndex() ))
+    {
+        Close();
+        return VmbErrorInvalidValue;
+    }
+    if(     ( 0 != m_Playback.FirstFrame )
+        &&  ( m_Playback.FirstFrame >= m_nFrames ))
+    {
+        Close();
+        return VmbErrorBadParameter;
+    }
+
+    // Looping keeps frame IDs and timestamps rising, as if the camera had recorded the sequence again
+    if( m_nFrames > 0 )
+    {
+        const RecordingIndexEntry &first    = m_pIndex[0];
+        const RecordingIndexEntry &last     = m_pIndex[ m_nFrames - 1 ];
+        m_nFrameIDSpan      = last.FrameID >= first.FrameID ? last.FrameID - first.FrameID + 1 : m_nFrames;
+        m_nTimestampSpan    = last.Timestamp >= first.Timestamp ? last.Timestamp - first.Timestamp : 0;
+        if( m_nFrames > 1 )
+        {
+            m_nTimestampSpan += m_nTimestampSpan / ( m_nFrames - 1 );
+        }
+    }
+    m_Decoded.resize( m_nBufferCount );
+    m_pQueued.reset( new std::atomic<bool>[ m_nBufferCount ] );
+    for( VmbUint32_t i = 0; i < m_nBufferCount; ++i )
+    {
+        m_pQueued[i].store( false );
+    }
+    return VmbErrorSuccess;
+}
+
+/**
+ * @brief The frame record at the given offset if it is complete before nEnd.
+ * An uncompressed image is handed out in place, so its record must hold all of it
+ */
+const RecordingFrameHeader* PlaybackFrameSource::GetFrame( VmbUint64_t nOffset, VmbUint64_t nEnd ) const
+{
+    if( nOffset + RECORDING_FRAME_HEADER_SIZE_V1 > nEnd )
+    {
+        return NULL;
+    }
+    const RecordingFrameHeader *pFrame = reinterpret_cast<const RecordingFrameHeader*>( m_pMapping + nOffset );
+    if(     ( RECORDING_FRAME_MAGIC != pFrame->Magic )
+        ||  ( pFrame->HeaderSize < RECORDING_FRAME_HEADER_SIZE_V1 )
+        ||  ( nOffset + pFrame->HeaderSize > nEnd )
+        ||  ( nOffset + pFrame->HeaderSize + RecordingStoredSize( *pFrame ) > nEnd )
+        ||  (   ( 0 == ( pFrame->Flags & RecordingFrame_Compressed ))
+            &&  ( pFrame->ImageSize != RecordingStoredSize( *pFrame ))))
+    {
+        return NULL;
+    }
+    return pFrame;
+}
+
+/**
+ * @brief Uses the trailing index, or rebuilds it from the frame records if the recording was not closed
+ *
+ * @return false if the file is not a consistent recording
+ */
+bool PlaybackFrameSource::LoadIndex()
+{
+    const VmbUint64_t nSize = m_nMappingSize;
+    // A closed recording ends on a whole index entry, anything else has no trailer to read
+    if(     ( nSize >= m_pHeader->HeaderSize + sizeof( RecordingTrailer ))
+        &&  ( 0 == nSize % RECORDING_ALIGNMENT ))
+    {
+        const RecordingTrailer *pTrailer = reinterpret_cast<const RecordingTrailer*>( m_pMapping + nSize - sizeof( RecordingTrailer ));
+        if(     ( RECORDING_TRAILER_MAGIC == pTrailer->Magic )
+            &&  ( pTrailer->IndexOffset % RECORDING_ALIGNMENT == 0 )
+            &&  ( pTrailer->IndexOffset <= nSize - sizeof( RecordingTrailer ))
+            &&  ( pTrailer->FrameCount <= nSize / sizeof( RecordingIndexEntry ))
+            &&  ( pTrailer->FrameCount * sizeof( RecordingIndexEntry ) == nSize - sizeof( RecordingTrailer ) - pTrailer->IndexOffset ))
+        {
+            m_pIndex    = reinterpret_cast<const RecordingIndexEntry*>( m_pMapping + pTrailer->IndexOffset );
+            m_nFrames   = pTrailer->FrameCount;
+            for( VmbUint64_t i = 0; i < m_nFrames; ++i )
+            {
+                if(     ( m_pIndex[i].Offset + RECORDING_FRAME_HEADER_SIZE_V1 > pTrailer->IndexOffset )
+                    ||  ( m_pIndex[i].Offset % RECORDING_ALIGNMENT != 0 ))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+    }
+
+    // No trailer, every complete record up to where the file ends counts
+    m_RebuiltIndex.clear();
+    VmbUint64_t nOffset = m_pHeader->HeaderSize;
+    for( ;; )
+    {
+        const RecordingFrameHeader *pFrame = GetFrame( nOffset, nSize );
+        if( NULL == pFrame )
+        {
+            break;
+        }
+        RecordingIndexEntry entry;
+        entry.Offset    = nOffset;
+        entry.FrameID   = pFrame->FrameID;
+        entry.Timestamp = pFrame->Timestamp;
+        m_RebuiltIndex.push_back( entry );
+        nOffset += AlignUp( pFrame->HeaderSize + static_cast<VmbUint64_t>( RecordingStoredSize( *pFrame )), RECORDING_ALIGNMENT );
+    }
+    m_pIndex    = m_RebuiltIndex.empty() ? NULL : &m_RebuiltIndex[0];
+    m_nFrames   = m_RebuiltIndex.size();
+    return true;
+}
+
+/**
+ * @brief Starts the playback thread with every buffer queued
+ *
+ * @param pObserver Receives every frame
+ */
+VmbErrorType PlaybackFrameSource::StartAcquisition( FrameObserver *pObserver )
+{
+    if( NULL == pObserver )
+    {
+        return VmbErrorBadParameter;
+    }
+    if( NULL == m_pMapping )
+    {
+        return VmbErrorDeviceNotOpen;
+    }
+    if( m_bRunning.load() )
+    {
+        return VmbErrorInvalidCall;
+    }
+
+    for( VmbUint32_t i = 0; i < m_nBufferCount; ++i )
+    {
+        m_pQueued[i].store( true );
+    }
+    m_pObserver         = pObserver;
+    m_nDecodedBytes     = 0;
+    m_nDecodeNanoseconds.store( 0 );
+    m_bRunning.store( true );
+    m_Player = std::thread( &PlaybackFrameSource::PlaybackLoop, this );
+    return VmbErrorSuccess;
+}
+
+/**
+ * @brief Stops the playback thread, no frame is delivered afterwards
+ */
+VmbErrorType PlaybackFrameSource::StopAcquisition()
+{
+    m_bRunning.store( false );
+    if( m_Player.joinable() )
+    {
+        m_Player.join();
+    }
+    return VmbErrorSuccess;
+}
+
+VmbErrorType PlaybackFrameSource::Close()
+{
+    StopAcquisition();
+    if( NULL != m_pMapping )
+    {
+        munmap( m_pMapping, m_nMappingSize );
+        m_pMapping      = NULL;
+        m_nMappingSize  = 0;
+    }
+    if( m_hFile >= 0 )
+    {
+        close( m_hFile );
+        m_hFile = -1;
+    }
+    m_pHeader   = NULL;
+    m_pIndex    = NULL;
+    m_nFrames   = 0;
+    m_RebuiltIndex.clear();
+    m_pQueued.reset();
+    m_Decoded.clear();
+    return VmbErrorSuccess;
+}
+
+/**
+ * @brief Marks the buffer of the frame as available again, the mapping itself stays untouched
+ */
+VmbErrorType PlaybackFrameSource::QueueFrame( const SourceFrame &Frame )
+{
+    if( !m_pQueued || Frame.nSlot >= m_nBufferCount )
+    {
+        return VmbErrorBadParameter;
+    }
+    m_pQueued[ Frame.nSlot ].store( true, std::memory_order_release );
+    return VmbErrorSuccess;
+}
+
+std::string PlaybackFrameSource::GetID() const
+{
+    if( NULL == m_pHeader )
+    {
+        return m_strFileName;
+    }
+    return std::string( m_pHeader->CameraID, strnlen( m_pHeader->CameraID, sizeof( m_pHeader->CameraID )));
+}
+
+/**
+ * @brief The timestamp frequency of the recorded camera
+ */
+VmbUint64_t PlaybackFrameSource::GetTimestampFrequency() const
+{
+    return NULL != m_pHeader ? m_pHeader->TimestampFrequency : 1000000000ULL;
+}
+
+VmbUint64_t PlaybackFrameSource::GetFrameCount() const
+{
+    return m_nFrames;
+}
+
+VmbErrorType PlaybackFrameSource::Seek( VmbUint64_t nFrame )
+{
+    if( nFrame >= m_nFrames )
+    {
+        return VmbErrorBadParameter;
+    }
+    m_nSeek.store( nFrame );
+    return VmbErrorSuccess;
+}
+
+/**
+ * @brief Sleeps in short steps until the given time
+ *
+ * @return false if the playback was stopped meanwhile
+ */
+bool PlaybackFrameSource::WaitUntil( const Clock::time_point &tWakeUp ) const
+{
+    for( ;; )
+    {
+        if( !m_bRunning.load( std::memory_order_relaxed ))
+        {
+            return false;
+        }
+        const Clock::time_point tNow = Clock::now();
+        if( tNow >= tWakeUp )
+        {
+            return true;
+        }
+        std::this_thread::sleep_until( tWakeUp - tNow > MAX_SLEEP ? tNow + MAX_SLEEP : tWakeUp );
+    }
+}
+
+/**
+ * @brief Decodes the stripes of a compressed frame in parallel
+ *
+ * @param Image Resized to the image
+ *
+ * @return false if the payload is damaged
+ */
+bool PlaybackFrameSource::Decode( const RecordingFrameHeader &Frame, std::vector<VmbUchar_t> &Image )
+{
+    const VmbUchar_t *  pPayload    = reinterpret_cast<const VmbUchar_t*>( &Frame ) + Frame.HeaderSize;
+    const VmbUint64_t   nStored     = RecordingStoredSize( Frame );
+    StripeLayout        layout;
+    if(     ( nStored < sizeof( RecordingStripesHeader ))
+        ||  ( !GetStripeLayout( Frame.PixelFormat, Frame.Width, Frame.Height, Frame.ImageSize, layout )))
+    {
+        return false;
+    }
+    const RecordingStripesHeader    *pStripes   = reinterpret_cast<const RecordingStripesHeader*>( pPayload );
+    const VmbUint32_t               *pSizes     = reinterpret_cast<const VmbUint32_t*>( pStripes + 1 );
+    const VmbUint32_t               nStripes    = pStripes->StripeCount;
+    const VmbUint32_t               nRows       = pStripes->RowsPerStripe;
+    if(     ( 0 == nRows )
+        ||  ( nStripes != ( layout.Rows + nRows - 1 ) / nRows )
+        ||  ( AlignUp( sizeof( RecordingStripesHeader ) + static_cast<VmbUint64_t>( nStripes ) * sizeof( VmbUint32_t ), RECORDING_ALIGNMENT ) > nStored ))
+    {
+        return false;
+    }
+    VmbUint64_t nOffset = AlignUp( sizeof( RecordingStripesHeader ) + static_cast<VmbUint64_t>( nStripes ) * sizeof( VmbUint32_t ), RECORDING_ALIGNMENT );
+    m_StripeOffsets.resize( nStripes );
+    for( VmbUint32_t i = 0; i < nStripes; ++i )
+    {
+        m_StripeOffsets[i]  = static_cast<size_t>( nOffset );
+        nOffset            += pSizes[i];
+    }
+    if( nOffset > nStored )
+    {
+        return false;
+    }
+
+    if( !m_pDecodePool )
+    {
+        m_pDecodePool.reset( new ThreadPool( m_nDecodeThreads ));
+    }
+    Image.resize( Frame.ImageSize );
+    std::atomic<bool> bDamaged( false );
+    m_pDecodePool->Run( nStripes, [&]( size_t i )
+    {
+        const Clock::time_point tStart      = Clock::now();
+        const VmbUint32_t       nFirstRow   = static_cast<VmbUint32_t>( i ) * nRows;
+        if( !DecodeStripe(  layout, pPayload + m_StripeOffsets[i], pSizes[i],
+                            layout.Rows - nFirstRow < nRows ? layout.Rows - nFirstRow : nRows,
+                            &Image[0] + static_cast<size_t>( nFirstRow ) * layout.RowBytes ))
+        {
+            bDamaged.store( true, std::memory_order_relaxed );
+        }
+        m_nDecodeNanoseconds.fetch_add( std::chrono::duration_cast<std::chrono::nanoseconds>( Clock::now() - tStart ).count(), std::memory_order_relaxed );
+    });
+    m_nDecodedBytes += Frame.ImageSize;
+    return !bDamaged.load();
+}
+
+/**
+ * @brief Delivers the recorded frames until the end of the recording or StopAcquisition.
+ * With a fixed pace a frame finding no queued buffer is skipped like a camera drops it,
+ * as fast as possible the thread waits for the next buffer instead
+ */
+void PlaybackFrameSource::PlaybackLoop()
+{
+    const bool              bOriginal   = PlaybackTiming_Original == m_Playback.Timing;
+    const bool              bFixedRate  = PlaybackTiming_FixedRate == m_Playback.Timing;
+    const Clock::duration   tPeriod     = bFixedRate
+                                        ? std::chrono::duration_cast<Clock::duration>( std::chrono::duration<double>( 1.0 / m_Playback.FrameRate ))
+                                        : Clock::duration::zero();
+    const VmbUint64_t       nFrequency  = m_pHeader->TimestampFrequency;
+    const Clock::time_point tStart      = Clock::now();
+    Clock::time_point       tNext       = tStart;
+    Clock::time_point       tBase       = tStart;       // When the frame with nBaseDevice is due
+    VmbUint64_t             nBaseDevice = 0;
+    bool                    bBaseValid  = false;
+    VmbUint64_t             nPosition   = m_Playback.FirstFrame;
+    VmbUint64_t             nPass       = 0;
+    VmbUint64_t             nDelivered  = 0;
+    VmbUint64_t             nSkipped    = 0;
+    VmbUint32_t             nCursor     = 0;
+    bool                    bFinished   = false;
+
+    while( m_bRunning.load( std::memory_order_relaxed ))
+    {
+        const VmbUint64_t nSeek = m_nSeek.exchange( NO_SEEK );
+        if( NO_SEEK != nSeek )
+        {
+            nPosition   = nSeek;
+            bBaseValid  = false;
+        }
+        if( nPosition >= m_nFrames )
+        {
+            if(     ( !m_Playback.bLoop )
+                ||  ( 0 == m_nFrames ))
+            {
+                bFinished = true;
+                break;
+            }
+            nPosition   = 0;
+            bBaseValid  = false;
+            ++nPass;
+        }
+
+        const RecordingIndexEntry   &entry  = m_pIndex[ nPosition++ ];
+        const RecordingFrameHeader  *pFrame = GetFrame( entry.Offset, m_nMappingSize );
+        if( NULL == pFrame )
+        {
+            ++nSkipped;
+            continue;
+        }
+
+        if( bOriginal )
+        {
+            // The recorded intervals are replayed, a timestamp going back restarts the pacing
+            const VmbUint64_t nDevice = TimestampToNanoseconds( pFrame->Timestamp, nFrequency );
+            if(     ( !bBaseValid )
+                ||  ( nDevice < nBaseDevice ))
+            {
+                tBase       = Clock::now();
+                nBaseDevice = nDevice;
+                bBaseValid  = true;
+            }
+            if( !WaitUntil( tBase + std::chrono::duration_cast<Clock::duration>( std::chrono::nanoseconds( nDevice - nBaseDevice ))))
+            {
+                break;
+            }
+        }
+        else if( bFixedRate )
+        {
+            tNext += tPeriod;
+            if( !WaitUntil( tNext ))
+            {
+                break;
+            }
+        }
+
+        // Take the next queued buffer in round robin order like the transport layer does
+        VmbUint32_t nSlot = m_nBufferCount;
+        for( ;; )
+        {
+            for( VmbUint32_t i = 0; i < m_nBufferCount; ++i )
+            {
+                const VmbUint32_t nCandidate = ( nCursor + i ) % m_nBufferCount;
+                if( m_pQueued[ nCandidate ].load( std::memory_order_acquire ))
+                {
+                    nSlot = nCandidate;
+                    break;
+                }
+            }
+            if(     ( nSlot < m_nBufferCount )
+                ||  ( bOriginal || bFixedRate )
+                ||  ( !m_bRunning.load( std::memory_order_relaxed )))
+            {
+                break;
+            }
+            std::this_thread::yield();
+        }
+        if( nSlot == m_nBufferCount )
+        {
+            ++nSkipped;
+            continue;
+        }
+        nCursor = ( nSlot + 1 ) % m_nBufferCount;
+        m_pQueued[ nSlot ].store( false, std::memory_order_relaxed );
+
+        VmbUchar_t *pImage = m_pMapping + entry.Offset + pFrame->HeaderSize;
+        if( 0 != ( pFrame->Flags & RecordingFrame_Compressed ))
+        {
+            if( !Decode( *pFrame, m_Decoded[ nSlot ] ))
+            {
+                m_pQueued[ nSlot ].store( true, std::memory_order_relaxed );
+                ++nSkipped;
+                continue;
+            }
+            pImage = &m_Decoded[ nSlot ][0];
+        }
+
+        SourceFrame frame;
+        frame.nSlot                 = nSlot;
+        frame.pBuffer               = pImage;
+        frame.ImageSize             = pFrame->ImageSize;
+        frame.Width                 = pFrame->Width;
+        frame.Height                = pFrame->Height;
+        frame.OffsetX               = pFrame->OffsetX;
+        frame.OffsetY               = pFrame->OffsetY;
+        frame.PixelFormat           = pFrame->PixelFormat;
+        frame.bPixelFormatValid     = 0 != ( pFrame->Flags & RecordingFrame_PixelFormatValid );
+        frame.FrameID               = pFrame->FrameID + nPass * m_nFrameIDSpan;
+        frame.bFrameIDValid         = 0 != ( pFrame->Flags & RecordingFrame_FrameIDValid );
+        frame.Timestamp             = 0 != pFrame->Timestamp ? pFrame->Timestamp + nPass * m_nTimestampSpan : 0;
+        frame.ReceiveStatus         = static_cast<VmbFrameStatusType>( pFrame->ReceiveStatus );
+        frame.bReceiveStatusValid   = 0 != ( pFrame->Flags & RecordingFrame_ReceiveStatusValid );
+        frame.ReceiveTime           = GetHostTime();
+
+        m_pObserver->FrameReceived( frame );
+        ++nDelivered;
+    }
+
+    const double dSeconds = std::chrono::duration<double>( Clock::now() - tStart ).count();
+    PrintSummary( nDelivered, dSeconds, bFinished );
+    if( nSkipped > 0 )
+    {
+        std::cout<<"Playback of "<<m_strFileName<<" skipped "<<nSkipped<<" frames finding no free buffer or a damaged record\n";
+    }
+}
+
+/**
+ * @brief Prints the frames delivered and the rate, as fast as possible that is the rate the pipeline sustains
+ */
+void PlaybackFrameSource::PrintSummary( VmbUint64_t nDelivered, double dSeconds, bool bFinished ) const
+{
+    char line[256];
+    std::snprintf(  line, sizeof( line ), "Playback of %s %s: %llu frames in %.3f s, %.1f fps%s\n",
+                    m_strFileName.c_str(),
+                    bFinished ? "finished" : "stopped",
+                    static_cast<unsigned long long>( nDelivered ),
+                    dSeconds,
+                    dSeconds > 0.0 ? nDelivered / dSeconds : 0.0,
+                    PlaybackTiming_Fast == m_Playback.Timing ? " sustained by the pipeline" : "" );
+    std::cout<<line;
+    if( m_nDecodedBytes > 0 )
+    {
+        const double dDecodeSeconds = m_nDecodeNanoseconds.load() / 1e9;
+        std::snprintf(  line, sizeof( line ), "Playback of %s decoded %.1f MB, %.1f MB/s per core on %u threads\n",
+                        m_strFileName.c_str(),
+                        m_nDecodedBytes / 1e6,
+                        dDecodeSeconds > 0.0 ? m_nDecodedBytes / 1e6 / dDecodeSeconds : 0.0,
+                        m_pDecodePool->GetThreadCount() );
+        std::cout<<line;
+    }
+    std::cout.flush();
+}
+
+}} // namespace AVT::VmbAPI
@@ -0,0 +1,192 @@
+#include <cstdio>
+#include <chrono>
+
+#include "PreviewDisplay.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+// A filled mailbox is seen at the latest after this, the producers do not take the mutex to notify
+static const std::chrono::milliseconds POLL_INTERVAL( 5 );
+
+PreviewDisplay::PreviewDisplay( const std::vector<std::string> &Names, VmbUint32_t nMaxWidth, VmbUint32_t nMaxHeight )
+    :   m_nMaxWidth( nMaxWidth > 0 ? nMaxWidth : 1 )
+    ,   m_nMaxHeight( nMaxHeight > 0 ? nMaxHeight : 1 )
+    ,   m_bStopping( false )
+{
+    for( size_t i = 0; i < Names.size(); ++i )
+    {
+        m_Mailboxes.push_back( std::unique_ptr<Mailbox>( new Mailbox() ));
+        m_Mailboxes.back()->Window  = Names[i];
+        m_Mailboxes.back()->State.store( Mailbox_Idle );
+        m_Mailboxes.back()->FrameID = 0;
+        m_Mailboxes.back()->nOffered.store( 0 );
+        m_Mailboxes.back()->nShown.store( 0 );
+    }
+}
+
+PreviewDisplay::~PreviewDisplay()
+{
+    Stop();
+}
+
+void PreviewDisplay::Start()
+{
+    if( m_Display.joinable() )
+    {
+        return;
+    }
+    m_bStopping.store( false );
+    m_Display = std::thread( &PreviewDisplay::DisplayLoop, this );
+}
+
+void PreviewDisplay::Stop()
+{
+    m_bStopping.store( true );
+    m_Condition.notify_all();
+    if( m_Display.joinable() )
+    {
+        m_Display.join();
+    }
+}
+
+/**
+ * @brief The image size scaled down to fit into the maximum size, never up
+ */
+cv::Size PreviewDisplay::GetPreviewSize( const cv::Size &ImageSize ) const
+{
+    const double dScaleX    = static_cast<double>( m_nMaxWidth ) / ImageSize.width;
+    const double dScaleY    = static_cast<double>( m_nMaxHeight ) / ImageSize.height;
+    const double dScale     = dScaleX < dScaleY ? dScaleX : dScaleY;
+    if( dScale >= 1.0 )
+    {
+        return ImageSize;
+    }
+    const int nWidth    = static_cast<int>( ImageSize.width * dScale );
+    const int nHeight   = static_cast<int>( ImageSize.height * dScale );
+    return cv::Size( nWidth > 0 ? nWidth : 1, nHeight > 0 ? nHeight : 1 );
+}
+
+void PreviewDisplay::Offer( size_t nInput, const cv::Mat &Image, VmbUint64_t nFrameID )
+{
+    if( nInput >= m_Mailboxes.size() )
+    {
+        return;
+    }
+    Mailbox &box = *m_Mailboxes[ nInput ];
+    box.nOffered.fetch_add( 1, std::memory_order_relaxed );
+
+    // Only the first producer after the display asked gets to fill the mailbox
+    int eState = Mailbox_Wanted;
+    if(     ( Image.empty() )
+        ||  ( !box.State.compare_exchange_strong( eState, Mailbox_Filling, std::memory_order_acquire )))
+    {
+        return;
+    }
+    const cv::Size size = GetPreviewSize( Image.size() );
+    if( size.area() == Image.size().area() )
+    {
+        Image.copyTo( box.Preview );
+    }
+    else
+    {
+        cv::resize( Image, box.Preview, size, 0, 0, cv::INTER_AREA );
+    }
+    box.FrameID = nFrameID;
+    box.State.store( Mailbox_Full, std::memory_order_release );
+    m_Condition.notify_one();
+}
+
+PreviewStatistics PreviewDisplay::GetStatistics( size_t nInput ) const
+{
+    PreviewStatistics stats;
+    if( nInput < m_Mailboxes.size() )
+    {
+        stats.Offered   = m_Mailboxes[ nInput ]->nOffered.load( std::memory_order_relaxed );
+        stats.Shown     = m_Mailboxes[ nInput ]->nShown.load( std::memory_order_relaxed );
+    }
+    return stats;
+}
+
+bool PreviewDisplay::AnyFull() const
+{
+    for( size_t i = 0; i < m_Mailboxes.size(); ++i )
+    {
+        if( Mailbox_Full == m_Mailboxes[i]->State.load( std::memory_order_relaxed ))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Draws a filled mailbox with the frame ID and the frames skipped so far
+ */
+void PreviewDisplay::Draw( Mailbox &Box )
+{
+    cv::Mat &image = Box.Preview;
+    if( CV_16U == image.depth() )
+    {
+        // The significant bits of 10 to 16 bit data are unknown here, the preview is stretched to its maximum
+        double dMax = 0.0;
+        cv::minMaxLoc( image, NULL, &dMax );
+        image.convertTo( Box.Display, CV_8U, dMax > 0.0 ? 255.0 / dMax : 1.0 );
+    }
+    else
+    {
+        Box.Display = image;
+    }
+
+    const VmbUint64_t nShown    = Box.nShown.load( std::memory_order_relaxed ) + 1;
+    const VmbUint64_t nOffered  = Box.nOffered.load( std::memory_order_relaxed );
+    char text[128];
+    std::snprintf(  text, sizeof( text ), "frame %llu  skipped %llu",
+                    static_cast<unsigned long long>( Box.FrameID ),
+                    static_cast<unsigned long long>( nOffered > nShown ? nOffered - nShown : 0 ));
+    cv::putText( Box.Display, text, cv::Point( 8, 24 ), cv::FONT_HERSHEY_SIMPLEX, 0.6, cv::Scalar::all( 255 ), 1 );
+
+    cv::imshow( Box.Window, Box.Display );
+    Box.nShown.store( nShown, std::memory_order_relaxed );
+}
+
+/**
+ * @brief Asks every camera for a picture, draws what arrives and keeps the windows responsive.
+ * All GUI calls are made on this thread
+ */
+void PreviewDisplay::DisplayLoop()
+{
+    for( size_t i = 0; i < m_Mailboxes.size(); ++i )
+    {
+        cv::namedWindow( m_Mailboxes[i]->Window, cv::WINDOW_AUTOSIZE );
+    }
+    while( !m_bStopping.load() )
+    {
+        for( size_t i = 0; i < m_Mailboxes.size(); ++i )
+        {
+            int eState = Mailbox_Idle;
+            m_Mailboxes[i]->State.compare_exchange_strong( eState, Mailbox_Wanted );
+        }
+        {
+            std::unique_lock<std::mutex> lock( m_Mutex );
+            m_Condition.wait_for( lock, POLL_INTERVAL, [this]() { return m_bStopping.load() || AnyFull(); } );
+        }
+        for( size_t i = 0; i < m_Mailboxes.size(); ++i )
+        {
+            Mailbox &box = *m_Mailboxes[i];
+            if( Mailbox_Full == box.State.load( std::memory_order_acquire ))
+            {
+                Draw( box );
+                box.State.store( Mailbox_Idle, std::memory_order_relaxed );
+            }
+        }
+        cv::waitKey( 1 );
+    }
+    for( size_t i = 0; i < m_Mailboxes.size(); ++i )
+    {
+        cv::destroyWindow( m_Mailboxes[i]->Window );
+        m_Mailboxes[i]->State.store( Mailbox_Idle );
+    }
+}
+
+}} // namespace AVT::VmbAPI
@@ -0,0 +1,71 @@
+#include "ReconnectMonitor.h"
+#include "HostClock.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+ReconnectMonitor::ReconnectMonitor()
+    :   m_bAwaitingFrame( false )
+    ,   m_bLost( false )
+    ,   m_nLostTime( 0 )
+    ,   m_nReappearTime( 0 )
+{}
+
+void ReconnectMonitor::Lost()
+{
+    std::lock_guard<std::mutex> lock( m_Mutex );
+    if( m_bLost )
+    {
+        return;
+    }
+    m_bLost     = true;
+    m_nLostTime = GetHostTime();
+    m_bAwaitingFrame.store( false, std::memory_order_relaxed );
+    ++m_Statistics.Losses;
+}
+
+void ReconnectMonitor::Reappeared()
+{
+    std::lock_guard<std::mutex> lock( m_Mutex );
+    m_nReappearTime = GetHostTime();
+}
+
+void ReconnectMonitor::Restarted( bool bReallocated )
+{
+    std::lock_guard<std::mutex> lock( m_Mutex );
+    if( m_bLost && bReallocated )
+    {
+        ++m_Statistics.Reallocations;
+    }
+    m_bAwaitingFrame.store( m_bLost, std::memory_order_relaxed );
+}
+
+/**
+ * @brief Closes the outage, frames racing in on several threads only count once
+ */
+void ReconnectMonitor::FirstFrame()
+{
+    const VmbUint64_t nNow = GetHostTime();
+    std::lock_guard<std::mutex> lock( m_Mutex );
+    if( !m_bAwaitingFrame.load( std::memory_order_relaxed ))
+    {
+        return;
+    }
+    m_bAwaitingFrame.store( false, std::memory_order_relaxed );
+    m_bLost = false;
+    ++m_Statistics.Reconnects;
+    m_Statistics.LastTimeToFirstFrame = ( nNow - m_nReappearTime ) / 1.0e9;
+    if( m_Statistics.LastTimeToFirstFrame > m_Statistics.MaxTimeToFirstFrame )
+    {
+        m_Statistics.MaxTimeToFirstFrame = m_Statistics.LastTimeToFirstFrame;
+    }
+    m_Statistics.Downtime += ( nNow - m_nLostTime ) / 1.0e9;
+}
+
+ReconnectStatistics ReconnectMonitor::GetStatistics() const
+{
+    std::lock_guard<std::mutex> lock( m_Mutex );
+    return m_Statistics;
+}
+
+}} // namespace AVT::VmbAPI
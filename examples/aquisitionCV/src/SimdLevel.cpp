@@ -0,0 +1,40 @@
+#include "SimdLevel.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+SimdLevel DetectSimdLevel()
+{
+#if defined( __x86_64__ ) || defined( __i386__ )
+    static const SimdLevel eLevel = __builtin_cpu_supports( "avx2" )    ? SimdLevel_AVX2
+                                  : __builtin_cpu_supports( "sse4.1" )  ? SimdLevel_SSE41
+                                  : SimdLevel_Scalar;
+    return eLevel;
+#else
+    return SimdLevel_Scalar;
+#endif
+}
+
+SimdLevel ResolveSimdLevel( SimdLevel eRequested )
+{
+    const SimdLevel eDetected = DetectSimdLevel();
+    if( SimdLevel_Auto == eRequested || eRequested > eDetected )
+    {
+        return eDetected;
+    }
+    return eRequested;
+}
+
+const char* SimdLevelToName( SimdLevel eLevel )
+{
+    switch( eLevel )
+    {
+    case SimdLevel_Auto:    return "auto";
+    case SimdLevel_Scalar:  return "scalar";
+    case SimdLevel_SSE41:   return "SSE4.1";
+    case SimdLevel_AVX2:    return "AVX2";
+    default:                return "unknown";
+    }
+}
+
+}} // namespace AVT::VmbAPI
@@ -0,0 +1,326 @@
+#include <cstring>
+#include <algorithm>
+
+#include "SimulatedCameraFeatures.h"
+#include "PixelFormat.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+const double SimulatedCameraFeatures::FRAME_RATE        = 30.0;
+const double SimulatedCameraFeatures::FRAME_RATE_MAX    = 1000.0;
+const double SimulatedCameraFeatures::GAIN_MAX          = 24.0;
+
+static const char * const   GainSelectors[]     = { "All", "AnalogAll", "DigitalAll" };
+static const size_t         GAIN_SELECTORS      = sizeof( GainSelectors ) / sizeof( GainSelectors[0] );
+
+static bool IsName( const char *pName, const char *pFeature )
+{
+    return 0 == std::strcmp( pName, pFeature );
+}
+
+SimulatedCameraFeatures::SimulatedCameraFeatures( VmbInt64_t nSensorWidth, VmbInt64_t nSensorHeight, const std::vector<std::string> &PixelFormats )
+    :   m_nSensorWidth( nSensorWidth )
+    ,   m_nSensorHeight( nSensorHeight )
+    ,   m_PixelFormats( PixelFormats )
+    ,   m_strPixelFormat( PixelFormats.empty() ? std::string( "Mono8" ) : PixelFormats[0] )
+    ,   m_nBinningHorizontal( 1 )
+    ,   m_nBinningVertical( 1 )
+    ,   m_nDecimationHorizontal( 1 )
+    ,   m_nDecimationVertical( 1 )
+    ,   m_nWidth( 0 )
+    ,   m_nHeight( 0 )
+    ,   m_nOffsetX( 0 )
+    ,   m_nOffsetY( 0 )
+    ,   m_nPacketSize( PACKET_SIZE )
+    ,   m_nStreamBytesPerSecond( STREAM_BYTES_MAX )
+    ,   m_dFrameRate( FRAME_RATE )
+    ,   m_strGainSelector( GainSelectors[0] )
+{
+    m_nWidth    = WidthMax();
+    m_nHeight   = HeightMax();
+    for( size_t i = 0; i < GAIN_SELECTORS; ++i )
+    {
+        m_Gains[i] = 0.0;
+    }
+}
+
+VmbInt64_t SimulatedCameraFeatures::WidthMax() const
+{
+    const VmbInt64_t nMax = m_nSensorWidth / ( m_nBinningHorizontal * m_nDecimationHorizontal );
+    return nMax - nMax % WIDTH_INCREMENT;
+}
+
+VmbInt64_t SimulatedCameraFeatures::HeightMax() const
+{
+    const VmbInt64_t nMax = m_nSensorHeight / ( m_nBinningVertical * m_nDecimationVertical );
+    return nMax - nMax % HEIGHT_INCREMENT;
+}
+
+bool SimulatedCameraFeatures::IsBayer( const std::string &strFormat ) const
+{
+    return 0 == strFormat.compare( 0, 5, "Bayer" );
+}
+
+size_t SimulatedCameraFeatures::GainIndex() const
+{
+    return static_cast<size_t>( std::find( GainSelectors, GainSelectors + GAIN_SELECTORS, m_strGainSelector ) - GainSelectors );
+}
+
+/**
+ * @brief Cuts the image down after binning or decimation shrank the sensor, as the camera does
+ */
+void SimulatedCameraFeatures::FitImage()
+{
+    m_nWidth    = std::min( m_nWidth, WidthMax() );
+    m_nHeight   = std::min( m_nHeight, HeightMax() );
+    m_nOffsetX  = std::min( m_nOffsetX, WidthMax() - m_nWidth );
+    m_nOffsetX -= m_nOffsetX % OFFSET_X_INCREMENT;
+    m_nOffsetY  = std::min( m_nOffsetY, HeightMax() - m_nHeight );
+    m_nOffsetY -= m_nOffsetY % OFFSET_Y_INCREMENT;
+}
+
+VmbErrorType SimulatedCameraFeatures::GetInt( const char *pName, VmbInt64_t &nValue )
+{
+    if( IsName( pName, "SensorWidth" ))               { nValue = m_nSensorWidth; }
+    else if( IsName( pName, "SensorHeight" ))         { nValue = m_nSensorHeight; }
+    else if( IsName( pName, "WidthMax" ))             { nValue = WidthMax(); }
+    else if( IsName( pName, "HeightMax" ))            { nValue = HeightMax(); }
+    else if( IsName( pName, "Width" ))                { nValue = m_nWidth; }
+    else if( IsName( pName, "Height" ))               { nValue = m_nHeight; }
+    else if( IsName( pName, "OffsetX" ))              { nValue = m_nOffsetX; }
+    else if( IsName( pName, "OffsetY" ))              { nValue = m_nOffsetY; }
+    else if( IsName( pName, "BinningHorizontal" ))    { nValue = m_nBinningHorizontal; }
+    else if( IsName( pName, "BinningVertical" ))      { nValue = m_nBinningVertical; }
+    else if( IsName( pName, "DecimationHorizontal" )) { nValue = m_nDecimationHorizontal; }
+    else if( IsName( pName, "DecimationVertical" ))   { nValue = m_nDecimationVertical; }
+    else if( IsName( pName, "GVSPPacketSize" ))       { nValue = m_nPacketSize; }
+    else if( IsName( pName, "StreamBytesPerSecond" )) { nValue = m_nStreamBytesPerSecond; }
+    else if( IsName( pName, "PayloadSize" ))
+    {
+        VmbPixelFormatType eFormat = VmbPixelFormatMono8;
+        if( !PixelFormatFromName( m_strPixelFormat.c_str(), eFormat ))
+        {
+            return VmbErrorNotSupported;
+        }
+        nValue = PixelFormatImageSize( eFormat, static_cast<VmbUint32_t>( m_nWidth ), static_cast<VmbUint32_t>( m_nHeight ));
+    }
+    else
+    {
+        return VmbErrorNotFound;
+    }
+    return VmbErrorSuccess;
+}
+
+VmbErrorType SimulatedCameraFeatures::GetIntRange( const char *pName, VmbInt64_t &nMin, VmbInt64_t &nMax, VmbInt64_t &nIncrement )
+{
+    nIncrement = 1;
+    if( IsName( pName, "Width" ))
+    {
+        nMin        = MIN_SIZE;
+        nMax        = WidthMax() - m_nOffsetX;
+        nIncrement  = WIDTH_INCREMENT;
+    }
+    else if( IsName( pName, "Height" ))
+    {
+        nMin        = MIN_SIZE;
+        nMax        = HeightMax() - m_nOffsetY;
+        nIncrement  = HEIGHT_INCREMENT;
+    }
+    else if( IsName( pName, "OffsetX" ))
+    {
+        nMin        = 0;
+        nMax        = WidthMax() - m_nWidth;
+        nIncrement  = OFFSET_X_INCREMENT;
+    }
+    else if( IsName( pName, "OffsetY" ))
+    {
+        nMin        = 0;
+        nMax        = HeightMax() - m_nHeight;
+        nIncrement  = OFFSET_Y_INCREMENT;
+    }
+    else if(    ( IsName( pName, "BinningHorizontal" ))
+            ||  ( IsName( pName, "BinningVertical" ))
+            ||  ( IsName( pName, "DecimationHorizontal" ))
+            ||  ( IsName( pName, "DecimationVertical" )))
+    {
+        nMin        = 1;
+        nMax        = MAX_FACTOR;
+    }
+    else if( IsName( pName, "StreamBytesPerSecond" ))
+    {
+        nMin        = STREAM_BYTES_MIN;
+        nMax        = STREAM_BYTES_MAX;
+        nIncrement  = STREAM_BYTES_INCREMENT;
+    }
+    else if( VmbErrorSuccess == GetInt( pName, nMin ))
+    {
+        // Read only
+        nMax        = nMin;
+    }
+    else
+    {
+        return VmbErrorNotFound;
+    }
+    return VmbErrorSuccess;
+}
+
+VmbErrorType SimulatedCameraFeatures::SetInt( const char *pName, VmbInt64_t nValue )
+{
+    VmbInt64_t nMin         = 0;
+    VmbInt64_t nMax         = 0;
+    VmbInt64_t nIncrement   = 1;
+    const VmbErrorType res  = GetIntRange( pName, nMin, nMax, nIncrement );
+    if( VmbErrorSuccess != res )
+    {
+        return res;
+    }
+    if(     ( nValue < nMin || nValue > nMax )
+        ||  ( 0 != ( nValue - nMin ) % nIncrement ))
+    {
+        return VmbErrorInvalidValue;
+    }
+
+    const bool bBinning = IsName( pName, "BinningHorizontal" ) || IsName( pName, "BinningVertical" );
+    if(     ( bBinning )
+        &&  ( nValue > 1 && IsBayer( m_strPixelFormat )))
+    {
+        return VmbErrorInvalidValue;
+    }
+
+    if( IsName( pName, "Width" ))                       { m_nWidth = nValue; }
+    else if( IsName( pName, "Height" ))                 { m_nHeight = nValue; }
+    else if( IsName( pName, "OffsetX" ))                { m_nOffsetX = nValue; }
+    else if( IsName( pName, "OffsetY" ))                { m_nOffsetY = nValue; }
+    else if( IsName( pName, "BinningHorizontal" ))      { m_nBinningHorizontal = nValue; }
+    else if( IsName( pName, "BinningVertical" ))        { m_nBinningVertical = nValue; }
+    else if( IsName( pName, "DecimationHorizontal" ))   { m_nDecimationHorizontal = nValue; }
+    else if( IsName( pName, "DecimationVertical" ))     { m_nDecimationVertical = nValue; }
+    else if( IsName( pName, "StreamBytesPerSecond" ))   { m_nStreamBytesPerSecond = nValue; }
+    else
+    {
+        return VmbErrorInvalidAccess;
+    }
+    FitImage();
+    return VmbErrorSuccess;
+}
+
+VmbErrorType SimulatedCameraFeatures::GetEnum( const char *pName, std::string &strValue )
+{
+    if( IsName( pName, "PixelFormat" ))         { strValue = m_strPixelFormat; }
+    else if( IsName( pName, "GainSelector" ))   { strValue = m_strGainSelector; }
+    else
+    {
+        return VmbErrorNotFound;
+    }
+    return VmbErrorSuccess;
+}
+
+VmbErrorType SimulatedCameraFeatures::GetEnumEntries( const char *pName, std::vector<std::string> &Entries )
+{
+    if( IsName( pName, "GainSelector" ))
+    {
+        Entries.assign( GainSelectors, GainSelectors + GAIN_SELECTORS );
+        return VmbErrorSuccess;
+    }
+    if( !IsName( pName, "PixelFormat" ))
+    {
+        return VmbErrorNotFound;
+    }
+    // Colour formats are not available while binning
+    Entries.clear();
+    for( size_t i = 0; i < m_PixelFormats.size(); ++i )
+    {
+        if(     ( !IsBayer( m_PixelFormats[i] ))
+            ||  ( 1 == m_nBinningHorizontal && 1 == m_nBinningVertical ))
+        {
+            Entries.push_back( m_PixelFormats[i] );
+        }
+    }
+    return VmbErrorSuccess;
+}
+
+VmbErrorType SimulatedCameraFeatures::SetEnum( const char *pName, const std::string &strValue )
+{
+    std::vector<std::string> Entries;
+    const VmbErrorType res = GetEnumEntries( pName, Entries );
+    if( VmbErrorSuccess != res )
+    {
+        return res;
+    }
+    if( Entries.end() == std::find( Entries.begin(), Entries.end(), strValue ))
+    {
+        return VmbErrorInvalidValue;
+    }
+    ( IsName( pName, "PixelFormat" ) ? m_strPixelFormat : m_strGainSelector ) = strValue;
+    return VmbErrorSuccess;
+}
+
+VmbErrorType SimulatedCameraFeatures::GetFloat( const char *pName, double &dValue )
+{
+    if( IsName( pName, "AcquisitionFrameRateAbs" ))   { dValue = m_dFrameRate; }
+    else if( IsName( pName, "Gain" ))                 { dValue = m_Gains[ GainIndex() ]; }
+    else
+    {
+        return VmbErrorNotFound;
+    }
+    return VmbErrorSuccess;
+}
+
+VmbErrorType SimulatedCameraFeatures::GetFloatRange( const char *pName, double &dMin, double &dMax, double &dIncrement )
+{
+    dIncrement = 0.0;
+    if( IsName( pName, "AcquisitionFrameRateAbs" ))
+    {
+        dMin        = 1.0;
+        dMax        = FRAME_RATE_MAX;
+    }
+    else if( IsName( pName, "Gain" ))
+    {
+        dMin        = 0.0;
+        dMax        = GAIN_MAX;
+    }
+    else
+    {
+        return VmbErrorNotFound;
+    }
+    return VmbErrorSuccess;
+}
+
+VmbErrorType SimulatedCameraFeatures::SetFloat( const char *pName, double dValue )
+{
+    double dMin         = 0.0;
+    double dMax         = 0.0;
+    double dIncrement   = 0.0;
+    const VmbErrorType res = GetFloatRange( pName, dMin, dMax, dIncrement );
+    if( VmbErrorSuccess != res )
+    {
+        return res;
+    }
+    if( dValue < dMin || dValue > dMax )
+    {
+        return VmbErrorInvalidValue;
+    }
+    ( IsName( pName, "Gain" ) ? m_Gains[ GainIndex() ] : m_dFrameRate ) = dValue;
+    return VmbErrorSuccess;
+}
+
+VmbErrorType SimulatedCameraFeatures::GetBool( const char *, bool & )
+{
+    return VmbErrorNotFound;
+}
+
+VmbErrorType SimulatedCameraFeatures::SetBool( const char *, bool )
+{
+    return VmbErrorNotFound;
+}
+
+/**
+ * @brief The packet size the path carries is the one already set
+ */
+VmbErrorType SimulatedCameraFeatures::RunCommand( const char *pName )
+{
+    return IsName( pName, "GVSPAdjustPacketSize" ) ? VmbErrorSuccess : VmbErrorNotFound;
+}
+
+}} // namespace AVT::VmbAPI
@@ -0,0 +1,411 @@
+#include <cstring>
+#include <vector>
+
+#include "StripeCodec.h"
+#include "PixelFormat.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+// Residuals sharing one Rice parameter
+static const VmbUint32_t BLOCK_SIZE     = 32;
+// Bits of the Rice parameter in front of every block
+static const VmbUint32_t PARAMETER_BITS = 5;
+// A quotient this large is replaced by the residual itself, so no code is longer than ESCAPE + 1 + 16 bits
+static const VmbUint32_t ESCAPE         = 24;
+
+/**
+ * @brief Appends bits to a byte stream, least significant bit first.
+ * Whole 32 bit words are stored little endian, the byte order of every supported host
+ */
+class BitWriter
+{
+    public:
+        explicit BitWriter( VmbUchar_t *pOutput )
+            :   m_pStart( pOutput )
+            ,   m_pOutput( pOutput )
+            ,   m_nBits( 0 )
+            ,   m_nCount( 0 )
+        {}
+
+        // nCount must not exceed 32
+        void Put( VmbUint64_t nBits, VmbUint32_t nCount )
+        {
+            m_nBits  |= nBits << m_nCount;
+            m_nCount += nCount;
+            if( m_nCount >= 32 )
+            {
+                const VmbUint32_t nWord = static_cast<VmbUint32_t>( m_nBits );
+                std::memcpy( m_pOutput, &nWord, sizeof( nWord ));
+                m_pOutput   += sizeof( nWord );
+                m_nBits    >>= 32;
+                m_nCount    -= 32;
+            }
+        }
+
+        size_t Finish()
+        {
+            while( m_nCount > 0 )
+            {
+                *m_pOutput++    = static_cast<VmbUchar_t>( m_nBits );
+                m_nBits       >>= 8;
+                m_nCount        = m_nCount > 8 ? m_nCount - 8 : 0;
+            }
+            return static_cast<size_t>( m_pOutput - m_pStart );
+        }
+
+    private:
+        VmbUchar_t * const  m_pStart;
+        VmbUchar_t *        m_pOutput;
+        VmbUint64_t         m_nBits;
+        VmbUint32_t         m_nCount;
+};
+
+/**
+ * @brief Reads what BitWriter wrote, never past the end of the input
+ */
+class BitReader
+{
+    public:
+        BitReader( const VmbUchar_t *pInput, size_t nSize )
+            :   m_pInput( pInput )
+            ,   m_pEnd( pInput + nSize )
+            ,   m_nBits( 0 )
+            ,   m_nCount( 0 )
+        {}
+
+        bool Get( VmbUint32_t nCount, VmbUint32_t &nValue )
+        {
+            if( m_nCount < nCount )
+            {
+                Refill();
+                if( m_nCount < nCount )
+                {
+                    return false;
+                }
+            }
+            nValue      = static_cast<VmbUint32_t>( m_nBits & (( 1ULL << nCount ) - 1 ));
+            m_nBits   >>= nCount;
+            m_nCount   -= nCount;
+            return true;
+        }
+
+        // Counts and consumes the zeros up to and including the next one
+        bool GetUnary( VmbUint32_t &nZeros )
+        {
+            if( m_nCount <= ESCAPE )
+            {
+                Refill();
+            }
+            if( 0 == m_nBits )
+            {
+                return false;
+            }
+            nZeros = static_cast<VmbUint32_t>( __builtin_ctzll( m_nBits ));
+            if(     ( nZeros > ESCAPE )
+                ||  ( nZeros >= m_nCount ))
+            {
+                return false;
+            }
+            m_nBits   >>= nZeros + 1;
+            m_nCount   -= nZeros + 1;
+            return true;
+        }
+
+    private:
+        void Refill()
+        {
+            if(     ( m_nCount <= 32 )
+                &&  ( m_pEnd - m_pInput >= 4 ))
+            {
+                VmbUint32_t nWord;
+                std::memcpy( &nWord, m_pInput, sizeof( nWord ));
+                m_nBits    |= static_cast<VmbUint64_t>( nWord ) << m_nCount;
+                m_nCount   += 32;
+                m_pInput   += sizeof( nWord );
+                return;
+            }
+            while(      ( m_nCount <= 56 )
+                    &&  ( m_pInput < m_pEnd ))
+            {
+                m_nBits    |= static_cast<VmbUint64_t>( *m_pInput++ ) << m_nCount;
+                m_nCount   += 8;
+            }
+        }
+
+        const VmbUchar_t *  m_pInput;
+        const VmbUchar_t *  m_pEnd;
+        VmbUint64_t         m_nBits;
+        VmbUint32_t         m_nCount;
+};
+
+/**
+ * @brief Median edge detector: the median of the left and upper neighbour and the planar estimate
+ * a + b - c, which is that estimate clamped to the range of the two neighbours. Free of branches so
+ * the compiler vectorizes the row loops
+ */
+static inline VmbInt32_t Predict( VmbInt32_t a, VmbInt32_t b, VmbInt32_t c )
+{
+    const VmbInt32_t nMin       = a < b ? a : b;
+    const VmbInt32_t nMax       = a < b ? b : a;
+    const VmbInt32_t nPlanar    = a + b - c;
+    return nPlanar < nMin ? nMin : ( nPlanar > nMax ? nMax : nPlanar );
+}
+
+/**
+ * @brief Zigzagged prediction residuals of a row. The first row of a stripe is predicted from the
+ * left only, the first samples of the other rows from above
+ */
+template <typename T>
+static void RowResiduals( const T *pRow, const T *pUp, VmbUint32_t nSamples, VmbUint32_t nDX, VmbUint32_t *pResiduals )
+{
+    const VmbUint32_t nMask = ( 1u << ( 8 * sizeof( T ))) - 1;
+    const VmbUint32_t nHalf = ( nMask >> 1 ) + 1;
+    const VmbUint32_t nEdge = nDX < nSamples ? nDX : nSamples;
+    for( VmbUint32_t x = 0; x < nEdge; ++x )
+    {
+        pResiduals[x] = pRow[x] - ( NULL != pUp ? pUp[x] : 0 );
+    }
+    if( NULL == pUp )
+    {
+        for( VmbUint32_t x = nEdge; x < nSamples; ++x )
+        {
+            pResiduals[x] = pRow[x] - pRow[ x - nDX ];
+        }
+    }
+    else
+    {
+        for( VmbUint32_t x = nEdge; x < nSamples; ++x )
+        {
+            pResiduals[x] = pRow[x] - Predict( pRow[ x - nDX ], pUp[x], pUp[ x - nDX ] );
+        }
+    }
+    // Residual modulo 2^bits, folded to the signed range and zigzagged so small errors get small codes
+    for( VmbUint32_t x = 0; x < nSamples; ++x )
+    {
+        const VmbUint32_t nResidual = pResiduals[x] & nMask;
+        pResiduals[x] = nResidual < nHalf ? nResidual << 1 : (( nMask - nResidual ) << 1 ) | 1;
+    }
+}
+
+/**
+ * @brief Inverse of RowResiduals
+ */
+template <typename T>
+static void RowFromResiduals( T *pRow, const T *pUp, VmbUint32_t nSamples, VmbUint32_t nDX, VmbUint32_t *pResiduals )
+{
+    const VmbUint32_t nMask = ( 1u << ( 8 * sizeof( T ))) - 1;
+    const VmbUint32_t nEdge = nDX < nSamples ? nDX : nSamples;
+    for( VmbUint32_t x = 0; x < nSamples; ++x )
+    {
+        const VmbUint32_t nZigzag = pResiduals[x];
+        pResiduals[x] = 0 == ( nZigzag & 1 ) ? nZigzag >> 1 : nMask - ( nZigzag >> 1 );
+    }
+    for( VmbUint32_t x = 0; x < nEdge; ++x )
+    {
+        pRow[x] = static_cast<T>( pResiduals[x] + ( NULL != pUp ? pUp[x] : 0 ));
+    }
+    if( NULL == pUp )
+    {
+        for( VmbUint32_t x = nEdge; x < nSamples; ++x )
+        {
+            pRow[x] = static_cast<T>( pResiduals[x] + pRow[ x - nDX ] );
+        }
+    }
+    else
+    {
+        for( VmbUint32_t x = nEdge; x < nSamples; ++x )
+        {
+            pRow[x] = static_cast<T>( pResiduals[x] + Predict( pRow[ x - nDX ], pUp[x], pUp[ x - nDX ] ));
+        }
+    }
+}
+
+/**
+ * @brief Rice codes a block of zigzagged residuals with the parameter that suits their mean
+ */
+static void EncodeBlock( BitWriter &Writer, const VmbUint32_t *pResiduals, VmbUint32_t nCount, VmbUint32_t nSampleBits )
+{
+    VmbUint64_t nSum = 0;
+    for( VmbUint32_t i = 0; i < nCount; ++i )
+    {
+        nSum += pResiduals[i];
+    }
+    VmbUint32_t k = 0;
+    while(      ( k < nSampleBits )
+            &&  ( static_cast<VmbUint64_t>( nCount ) << ( k + 1 )) <= nSum )
+    {
+        ++k;
+    }
+    Writer.Put( k, PARAMETER_BITS );
+    for( VmbUint32_t i = 0; i < nCount; ++i )
+    {
+        const VmbUint32_t nValue    = pResiduals[i];
+        const VmbUint32_t nQuotient = nValue >> k;
+        if( nQuotient < ESCAPE )
+        {
+            // Quotient in unary as zeros ended by a one, then the k low bits
+            const VmbUint64_t nCode = ( 1 | ( static_cast<VmbUint64_t>( nValue & (( 1u << k ) - 1 )) << 1 )) << nQuotient;
+            const VmbUint32_t nBits = nQuotient + 1 + k;
+            if( nBits <= 32 )
+            {
+                Writer.Put( nCode, nBits );
+            }
+            else
+            {
+                Writer.Put( nCode & 0xFFFFFFFFu, 32 );
+                Writer.Put( nCode >> 32, nBits - 32 );
+            }
+        }
+        else
+        {
+            Writer.Put( 0, ESCAPE );
+            Writer.Put( 1 | ( static_cast<VmbUint64_t>( nValue ) << 1 ), 1 + nSampleBits );
+        }
+    }
+}
+
+static bool DecodeBlock( BitReader &Reader, VmbUint32_t *pResiduals, VmbUint32_t nCount, VmbUint32_t nSampleBits )
+{
+    VmbUint32_t k = 0;
+    if(     ( !Reader.Get( PARAMETER_BITS, k ))
+        ||  ( k > nSampleBits ))
+    {
+        return false;
+    }
+    for( VmbUint32_t i = 0; i < nCount; ++i )
+    {
+        VmbUint32_t nQuotient   = 0;
+        VmbUint32_t nLow        = 0;
+        if( !Reader.GetUnary( nQuotient ))
+        {
+            return false;
+        }
+        if( nQuotient < ESCAPE )
+        {
+            if( !Reader.Get( k, nLow ))
+            {
+                return false;
+            }
+            pResiduals[i] = ( nQuotient << k ) | nLow;
+        }
+        else if( !Reader.Get( nSampleBits, pResiduals[i] ))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename T>
+static size_t EncodeRows( const StripeLayout &Layout, const VmbUchar_t *pRows, VmbUint32_t nRows, VmbUchar_t *pOutput )
+{
+    const VmbUint32_t           nSampleBits = 8 * sizeof( T );
+    const VmbUint32_t           nSamples    = Layout.RowBytes / sizeof( T );
+    std::vector<VmbUint32_t>    residuals( nSamples );
+    BitWriter                   writer( pOutput );
+
+    for( VmbUint32_t y = 0; y < nRows; ++y )
+    {
+        const T *pRow   = reinterpret_cast<const T*>( pRows + static_cast<size_t>( y ) * Layout.RowBytes );
+        const T *pUp    = y >= Layout.DY ? reinterpret_cast<const T*>( pRows + static_cast<size_t>( y - Layout.DY ) * Layout.RowBytes ) : NULL;
+        RowResiduals( pRow, pUp, nSamples, Layout.DX, &residuals[0] );
+        // Blocks end with the row, the last one of a row may be shorter
+        for( VmbUint32_t x = 0; x < nSamples; x += BLOCK_SIZE )
+        {
+            EncodeBlock( writer, &residuals[x], nSamples - x < BLOCK_SIZE ? nSamples - x : BLOCK_SIZE, nSampleBits );
+        }
+    }
+    return writer.Finish();
+}
+
+template <typename T>
+static bool DecodeRows( const StripeLayout &Layout, const VmbUchar_t *pInput, size_t nInputSize, VmbUint32_t nRows, VmbUchar_t *pRows )
+{
+    const VmbUint32_t           nSampleBits = 8 * sizeof( T );
+    const VmbUint32_t           nSamples    = Layout.RowBytes / sizeof( T );
+    std::vector<VmbUint32_t>    residuals( nSamples );
+    BitReader                   reader( pInput, nInputSize );
+
+    for( VmbUint32_t y = 0; y < nRows; ++y )
+    {
+        T *         pRow    = reinterpret_cast<T*>( pRows + static_cast<size_t>( y ) * Layout.RowBytes );
+        const T *   pUp     = y >= Layout.DY ? reinterpret_cast<const T*>( pRows + static_cast<size_t>( y - Layout.DY ) * Layout.RowBytes ) : NULL;
+        for( VmbUint32_t x = 0; x < nSamples; x += BLOCK_SIZE )
+        {
+            if( !DecodeBlock( reader, &residuals[x], nSamples - x < BLOCK_SIZE ? nSamples - x : BLOCK_SIZE, nSampleBits ))
+            {
+                return false;
+            }
+        }
+        RowFromResiduals( pRow, pUp, nSamples, Layout.DX, &residuals[0] );
+    }
+    return true;
+}
+
+bool GetStripeLayout( VmbPixelFormatType eFormat, VmbUint32_t nWidth, VmbUint32_t nHeight, VmbUint32_t nImageSize, StripeLayout &Layout )
+{
+    if(     ( 0 == nWidth || 0 == nHeight || 0 == nImageSize )
+        ||  ( 0 != nImageSize % nHeight ))
+    {
+        return false;
+    }
+    const VmbUint32_t   nBits   = PixelFormatBitsPerPixel( eFormat );
+    const bool          bBayer  = PixelFormatIsBayer( eFormat );
+    Layout.RowBytes = nImageSize / nHeight;
+    Layout.Rows     = nHeight;
+    Layout.DY       = bBayer ? 2 : 1;
+    if(     ( 16 == nBits )
+        &&  ( bBayer || PixelFormatIsMono( eFormat )))
+    {
+        // One little endian word per pixel
+        Layout.SampleBytes  = 2;
+        Layout.DX           = bBayer ? 2 : 1;
+    }
+    else if( 0 == nBits % 8 && 0 != nBits )
+    {
+        // One byte per channel, the same channel is a pixel to the left
+        Layout.SampleBytes  = 1;
+        Layout.DX           = 8 == nBits && bBayer ? 2 : nBits / 8;
+    }
+    else
+    {
+        // Packed, a group of bytes holds whole pixels, e.g. 3 bytes two 12 bit ones, and the
+        // byte of the previous group has the same role
+        VmbUint32_t nGroupBits = nBits;
+        while( 0 != nGroupBits % 8 )
+        {
+            nGroupBits += nBits;
+        }
+        Layout.SampleBytes  = 1;
+        Layout.DX           = nGroupBits / 8;
+    }
+    return 0 == Layout.RowBytes % Layout.SampleBytes;
+}
+
+size_t MaxEncodedStripeSize( const StripeLayout &Layout, VmbUint32_t nRows )
+{
+    const VmbUint64_t nSamples  = static_cast<VmbUint64_t>( Layout.RowBytes / Layout.SampleBytes ) * nRows;
+    const VmbUint64_t nBits     = nSamples * ( ESCAPE + 1 + 8 * Layout.SampleBytes ) + ( nSamples / BLOCK_SIZE + 1 ) * PARAMETER_BITS;
+    return static_cast<size_t>(( nBits + 7 ) / 8 + 8 );
+}
+
+size_t EncodeStripe( const StripeLayout &Layout, const VmbUchar_t *pRows, VmbUint32_t nRows, VmbUchar_t *pOutput )
+{
+    if( 2 == Layout.SampleBytes )
+    {
+        return EncodeRows<VmbUint16_t>( Layout, pRows, nRows, pOutput );
+    }
+    return EncodeRows<VmbUchar_t>( Layout, pRows, nRows, pOutput );
+}
+
+bool DecodeStripe( const StripeLayout &Layout, const VmbUchar_t *pInput, size_t nInputSize, VmbUint32_t nRows, VmbUchar_t *pRows )
+{
+    if( 2 == Layout.SampleBytes )
+    {
+        return DecodeRows<VmbUint16_t>( Layout, pInput, nInputSize, nRows, pRows );
+    }
+    return DecodeRows<VmbUchar_t>( Layout, pInput, nInputSize, nRows, pRows );
+}
+
+}} // namespace AVT::VmbAPI
@@ -0,0 +1,601 @@
+#include <iostream>
+#include <chrono>
+#include <functional>
+#include <algorithm>
+
+#include "SyntheticFrameSource.h"
+#include "FrameObserver.h"
+#include "PixelFormat.h"
+#include "HostClock.h"
+#include "SimulatedCameraFeatures.h"
+#include "GeometryPlanner.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+/**
+ * @brief Colour channel (0 = R, 1 = G, 2 = B) of a Bayer pixel format at the given position
+ */
+static int BayerChannelAt( VmbPixelFormatType eFormat, VmbUint32_t x, VmbUint32_t y )
+{
+    // Channels of the 2x2 cell, row major: RG, GR, GB, BG
+    static const int RG[4] = { 0, 1, 1, 2 };
+    static const int GR[4] = { 1, 0, 2, 1 };
+    static const int GB[4] = { 1, 2, 0, 1 };
+    static const int BG[4] = { 2, 1, 1, 0 };
+    const int nIndex = ( y & 1 ) * 2 + ( x & 1 );
+    switch( eFormat )
+    {
+    case VmbPixelFormatBayerGR8:
+    case VmbPixelFormatBayerGR10:
+    case VmbPixelFormatBayerGR12:
+    case VmbPixelFormatBayerGR16:
+        return GR[nIndex];
+    case VmbPixelFormatBayerGB8:
+    case VmbPixelFormatBayerGB10:
+    case VmbPixelFormatBayerGB12:
+    case VmbPixelFormatBayerGB16:
+        return GB[nIndex];
+    case VmbPixelFormatBayerBG8:
+    case VmbPixelFormatBayerBG10:
+    case VmbPixelFormatBayerBG12:
+    case VmbPixelFormatBayerBG16:
+        return BG[nIndex];
+    default:
+        return RG[nIndex];
+    }
+}
+
+/**
+ * @brief Significant bits per pixel of the formats the generator can produce, 0 if not supported
+ */
+static VmbUint32_t SyntheticBitDepth( VmbPixelFormatType eFormat )
+{
+    switch( eFormat )
+    {
+    case VmbPixelFormatMono8:
+    case VmbPixelFormatBayerGR8:
+    case VmbPixelFormatBayerRG8:
+    case VmbPixelFormatBayerGB8:
+    case VmbPixelFormatBayerBG8:
+    case VmbPixelFormatRgb8:
+    case VmbPixelFormatBgr8:
+        return 8;
+    case VmbPixelFormatMono10:
+    case VmbPixelFormatMono10p:
+    case VmbPixelFormatBayerGR10:
+    case VmbPixelFormatBayerRG10:
+    case VmbPixelFormatBayerGB10:
+    case VmbPixelFormatBayerBG10:
+        return 10;
+    case VmbPixelFormatMono12:
+    case VmbPixelFormatMono12p:
+    case VmbPixelFormatMono12Packed:
+    case VmbPixelFormatBayerGR12:
+    case VmbPixelFormatBayerRG12:
+    case VmbPixelFormatBayerGB12:
+    case VmbPixelFormatBayerBG12:
+        return 12;
+    case VmbPixelFormatMono14:
+        return 14;
+    case VmbPixelFormatMono16:
+    case VmbPixelFormatBayerGR16:
+    case VmbPixelFormatBayerRG16:
+    case VmbPixelFormatBayerGB16:
+    case VmbPixelFormatBayerBG16:
+        return 16;
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief Writes pixel nIndex of a packed mono image, the buffer has to be zeroed before
+ */
+static void StorePackedPixel( VmbUchar_t *pBuffer, size_t nIndex, VmbUint32_t nValue, VmbPixelFormatType eFormat )
+{
+    if( VmbPixelFormatMono12Packed == eFormat )
+    {
+        // Two pixels in three bytes, the low nibbles share the middle byte
+        VmbUchar_t *p = pBuffer + 3 * ( nIndex / 2 );
+        if( 0 == ( nIndex & 1 ))
+        {
+            p[0] = static_cast<VmbUchar_t>( nValue >> 4 );
+            p[1] = static_cast<VmbUchar_t>(( p[1] & 0xF0 ) | ( nValue & 0x0F ));
+        }
+        else
+        {
+            p[2] = static_cast<VmbUchar_t>( nValue >> 4 );
+            p[1] = static_cast<VmbUchar_t>(( p[1] & 0x0F ) | (( nValue & 0x0F ) << 4 ));
+        }
+        return;
+    }
+    // Mono10p and Mono12p are a continuous bit stream, least significant bit first
+    const VmbUint32_t   nBits   = SyntheticBitDepth( eFormat );
+    const size_t        nBit    = nIndex * nBits;
+    VmbUchar_t *        p       = pBuffer + nBit / 8;
+    const VmbUint32_t   nWord   = nValue << ( nBit & 7 );
+    p[0] |= static_cast<VmbUchar_t>( nWord );
+    p[1] |= static_cast<VmbUchar_t>( nWord >> 8 );
+    if(( nBit & 7 ) + nBits > 16 )
+    {
+        p[2] |= static_cast<VmbUchar_t>( nWord >> 16 );
+    }
+}
+
+/**
+ * @brief Construct a new Synthetic Frame Source:: Synthetic Frame Source object
+ *
+ * @param strID ID reported for the camera
+ * @param Camera Pixel format, geometry, frame rate and simulated faults
+ * @param nBufferCount Number of frame buffers cycling between source and observer, the least if Buffers is adaptive
+ * @param Geometry The image the processing needs, applied to a simulated feature tree of the sensor
+ * @param bColor Whether the processing demosaics, decides pixel format and binning
+ * @param Buffers Number, page size, locking and NUMA node of the frame buffers
+ */
+SyntheticFrameSource::SyntheticFrameSource( const std::string &strID, const SyntheticCameraConfig &Camera, VmbUint32_t nBufferCount,
+                                            const GeometryRequest &Geometry, bool bColor, const FrameBufferConfig &Buffers )
+    :   m_strID( strID )
+    ,   m_Camera( Camera )
+    ,   m_Geometry( Geometry )
+    ,   m_bColor( bColor )
+    ,   m_Buffers( Buffers )
+    ,   m_nImageSize( PixelFormatImageSize( Camera.PixelFormat, Camera.Width, Camera.Height ))
+    ,   m_nSlots( 0 )
+    ,   m_Sizer( Buffers, nBufferCount )
+    ,   m_pObserver( NULL )
+    ,   m_bRunning( false )
+    ,   m_nStarved( 0 )
+    ,   m_nRandomState( 0x9E3779B97F4A7C15ULL ^ std::hash<std::string>()( strID ))
+{
+    // Cameras of one process must not fail in lockstep, xorshift only needs a non-zero state
+    if( 0 == m_nRandomState )
+    {
+        m_nRandomState = 0x9E3779B97F4A7C15ULL;
+    }
+}
+
+SyntheticFrameSource::~SyntheticFrameSource()
+{
+    StopAcquisition();
+}
+
+/**
+ * @brief Applies the requested geometry to a simulated feature tree of the configured sensor,
+ * which offers the configured format and its 8 bit sibling, and takes over what it settled on
+ */
+VmbErrorType SyntheticFrameSource::PrepareCamera()
+{
+    std::vector<std::string> Formats( 1, PixelFormatToName( m_Camera.PixelFormat ));
+    const std::string strFamily = Formats[0].substr( 0, Formats[0].find_first_of( "0123456789" ));
+    if( strFamily + "8" != Formats[0] )
+    {
+        Formats.push_back( strFamily + "8" );
+    }
+    SimulatedCameraFeatures features( m_Camera.Width, m_Camera.Height, Formats );
+    GeometryPlan plan;
+    VmbErrorType res = ApplyGeometry( features, m_Geometry, m_bColor, plan );
+    if( VmbErrorSuccess == res )
+    {
+        res = PixelFormatFromName( plan.PixelFormat.c_str(), m_Camera.PixelFormat ) ? VmbErrorSuccess : VmbErrorNotSupported;
+    }
+    if( VmbErrorSuccess != res )
+    {
+        return res;
+    }
+    m_Camera.Width  = static_cast<VmbUint32_t>( plan.Width );
+    m_Camera.Height = static_cast<VmbUint32_t>( plan.Height );
+    m_nImageSize    = PixelFormatImageSize( m_Camera.PixelFormat, m_Camera.Width, m_Camera.Height );
+    std::cout<<"Camera "<<m_strID<<" delivers ";
+    PrintGeometryPlan( std::cout, plan );
+    std::cout<<"\n";
+    return VmbErrorSuccess;
+}
+
+/**
+ * @brief Allocates the frame buffers and renders the test pattern into each of them once,
+ * so generating a frame costs no memory bandwidth
+ */
+VmbErrorType SyntheticFrameSource::Open()
+{
+    if(     ( 0 == SyntheticBitDepth( m_Camera.PixelFormat ))
+        ||  ( NULL == PixelFormatToName( m_Camera.PixelFormat )))
+    {
+        return VmbErrorNotSupported;
+    }
+    if( 0 == m_Camera.Width || 0 == m_Camera.Height )
+    {
+        return VmbErrorBadParameter;
+    }
+    // Without a request the configured geometry is delivered as is
+    if( 0 != m_Geometry.Width )
+    {
+        const VmbErrorType res = PrepareCamera();
+        if( VmbErrorSuccess != res )
+        {
+            return res;
+        }
+    }
+
+    const VmbUint32_t nFrames = m_Sizer.Plan( m_nImageSize, m_Camera.FrameRate );
+    m_Pools.clear();
+    m_pSlots.reset( new Slot[ m_Sizer.GetStatistics().Limit ] );
+    m_nSlots.store( 0 );
+    const VmbErrorType res = AddBuffers( nFrames );
+    if( VmbErrorSuccess != res )
+    {
+        m_pSlots.reset();
+        return res;
+    }
+    std::cout<<"Camera "<<m_strID<<" buffers: ";
+    PrintBufferDepthStatistics( std::cout, m_Sizer.GetStatistics() );
+    std::cout<<"\n";
+    if( m_Buffers.bOwnBuffers )
+    {
+        std::cout<<"Camera "<<m_strID<<" frame buffers: ";
+        PrintFrameBufferInfo( std::cout, m_Pools[0]->GetInfo() );
+        std::cout<<"\n";
+    }
+    return VmbErrorSuccess;
+}
+
+/**
+ * @brief Maps nCount more buffers, renders the pattern into them and publishes them as not queued
+ */
+VmbErrorType SyntheticFrameSource::AddBuffers( VmbUint32_t nCount )
+{
+    std::unique_ptr<FrameBufferPool> pPool( new FrameBufferPool );
+    const VmbErrorType res = pPool->Allocate( nCount, m_nImageSize, m_Buffers );
+    if( VmbErrorSuccess != res )
+    {
+        return res;
+    }
+    const VmbUint32_t nFirst = m_nSlots.load();
+    for( VmbUint32_t i = 0; i < nCount; ++i )
+    {
+        m_pSlots[ nFirst + i ].pBuffer = pPool->GetBuffer( i );
+        m_pSlots[ nFirst + i ].bQueued.store( false );
+        FillPattern( m_pSlots[ nFirst + i ].pBuffer );
+    }
+    m_Pools.push_back( std::move( pPool ));
+    m_nSlots.store( nFirst + nCount, std::memory_order_release );
+    return VmbErrorSuccess;
+}
+
+/**
+ * @brief Queues all buffers and starts the generator thread
+ *
+ * @param pObserver Receives every frame
+ */
+VmbErrorType SyntheticFrameSource::StartAcquisition( FrameObserver *pObserver )
+{
+    if( NULL == pObserver )
+    {
+        return VmbErrorBadParameter;
+    }
+    if( !m_pSlots )
+    {
+        return VmbErrorDeviceNotOpen;
+    }
+    if( m_bRunning.load() )
+    {
+        return VmbErrorInvalidCall;
+    }
+
+    for( VmbUint32_t i = 0; i < m_nSlots.load(); ++i )
+    {
+        m_pSlots[i].bQueued.store( true );
+    }
+    m_pObserver = pObserver;
+    m_bRunning.store( true );
+    m_Generator = std::thread( &SyntheticFrameSource::GeneratorLoop, this );
+    return VmbErrorSuccess;
+}
+
+/**
+ * @brief Stops the generator thread, no frame is delivered afterwards
+ */
+VmbErrorType SyntheticFrameSource::StopAcquisition()
+{
+    m_bRunning.store( false );
+    if( m_Generator.joinable() )
+    {
+        m_Generator.join();
+    }
+    return VmbErrorSuccess;
+}
+
+VmbErrorType SyntheticFrameSource::Close()
+{
+    StopAcquisition();
+    m_pSlots.reset();
+    m_nSlots.store( 0 );
+    m_Pools.clear();
+    return VmbErrorSuccess;
+}
+
+/**
+ * @brief Marks the buffer of the frame as available for the generator
+ */
+VmbErrorType SyntheticFrameSource::QueueFrame( const SourceFrame &Frame )
+{
+    if( !m_pSlots || Frame.nSlot >= m_nSlots.load( std::memory_order_acquire ))
+    {
+        return VmbErrorBadParameter;
+    }
+    m_Sizer.Requeued( Frame );
+    m_pSlots[ Frame.nSlot ].bQueued.store( true, std::memory_order_release );
+    return VmbErrorSuccess;
+}
+
+std::string SyntheticFrameSource::GetID() const
+{
+    return m_strID;
+}
+
+/**
+ * @brief Timestamps count nanoseconds
+ */
+VmbUint64_t SyntheticFrameSource::GetTimestampFrequency() const
+{
+    return 1000000000ULL;
+}
+
+ReconnectStatistics SyntheticFrameSource::GetReconnectStatistics() const
+{
+    return m_Reconnects.GetStatistics();
+}
+
+BufferDepthStatistics SyntheticFrameSource::GetBufferStatistics() const
+{
+    return m_Sizer.GetStatistics();
+}
+
+VmbUint64_t SyntheticFrameSource::GetStarvedFrames() const
+{
+    return m_nStarved.load( std::memory_order_relaxed );
+}
+
+/**
+ * @brief Random decision with the given probability in percent
+ */
+bool SyntheticFrameSource::Chance( double dPercent )
+{
+    if( dPercent <= 0.0 )
+    {
+        return false;
+    }
+    m_nRandomState ^= m_nRandomState << 13;
+    m_nRandomState ^= m_nRandomState >> 7;
+    m_nRandomState ^= m_nRandomState << 17;
+    return static_cast<double>( m_nRandomState % 1000000 ) < dPercent * 10000.0;
+}
+
+/**
+ * @brief Stays away for the configured time like an unplugged camera. Buffers handed back meanwhile
+ * stay queued, so the camera comes back with the buffers it had
+ *
+ * @return false if stopped while away
+ */
+bool SyntheticFrameSource::DropOut()
+{
+    typedef std::chrono::steady_clock Clock;
+
+    m_Reconnects.Lost();
+    std::cout<<"Camera "<<m_strID<<" lost, waiting for it to come back\n";
+    const Clock::time_point tBack = Clock::now() + std::chrono::duration_cast<Clock::duration>( std::chrono::duration<double>( m_Camera.DropoutDuration ));
+    while( Clock::now() < tBack )
+    {
+        if( !m_bRunning.load( std::memory_order_relaxed ))
+        {
+            return false;
+        }
+        std::this_thread::sleep_for( std::min<Clock::duration>( tBack - Clock::now(), std::chrono::milliseconds( 10 )));
+    }
+    m_Reconnects.Reappeared();
+    m_Sizer.Restarted();
+    std::cout<<"Camera "<<m_strID<<" reconnected, frames reused\n";
+    m_Reconnects.Restarted( false );
+    return true;
+}
+
+/**
+ * @brief Renders a gradient pattern in the configured pixel format.
+ * Red rises left to right, green top to bottom, blue right to left
+ *
+ * @param pBuffer Buffer of m_nImageSize bytes
+ */
+void SyntheticFrameSource::FillPattern( VmbUchar_t *pBuffer ) const
+{
+    const VmbUint32_t   nWidth      = m_Camera.Width;
+    const VmbUint32_t   nHeight     = m_Camera.Height;
+    const VmbUint32_t   nBits       = SyntheticBitDepth( m_Camera.PixelFormat );
+    const VmbUint32_t   nMax        = ( 1u << nBits ) - 1;
+    const VmbUint32_t   nBytesPerPixel = PixelFormatBitsPerPixel( m_Camera.PixelFormat ) / 8;
+
+    for( VmbUint32_t y = 0; y < nHeight; ++y )
+    {
+        for( VmbUint32_t x = 0; x < nWidth; ++x )
+        {
+            const VmbUint32_t nRGB[3] =
+            {
+                static_cast<VmbUint32_t>( static_cast<VmbUint64_t>( x ) * nMax / ( nWidth > 1 ? nWidth - 1 : 1 )),
+                static_cast<VmbUint32_t>( static_cast<VmbUint64_t>( y ) * nMax / ( nHeight > 1 ? nHeight - 1 : 1 )),
+                0
+            };
+            const VmbUint32_t nBlue = nMax - nRGB[0];
+            const size_t nIndex = static_cast<size_t>( y ) * nWidth + x;
+            VmbUchar_t *pPixel = pBuffer + nIndex * nBytesPerPixel;
+
+            switch( m_Camera.PixelFormat )
+            {
+            case VmbPixelFormatRgb8:
+                pPixel[0] = static_cast<VmbUchar_t>( nRGB[0] );
+                pPixel[1] = static_cast<VmbUchar_t>( nRGB[1] );
+                pPixel[2] = static_cast<VmbUchar_t>( nBlue );
+                break;
+            case VmbPixelFormatBgr8:
+                pPixel[0] = static_cast<VmbUchar_t>( nBlue );
+                pPixel[1] = static_cast<VmbUchar_t>( nRGB[1] );
+                pPixel[2] = static_cast<VmbUchar_t>( nRGB[0] );
+                break;
+            case VmbPixelFormatMono10p:
+            case VmbPixelFormatMono12p:
+            case VmbPixelFormatMono12Packed:
+                StorePackedPixel( pBuffer, nIndex, ( nRGB[0] + nRGB[1] ) / 2, m_Camera.PixelFormat );
+                break;
+            default:
+            {
+                VmbUint32_t nValue;
+                if( VmbPixelFormatMono8 == m_Camera.PixelFormat
+                    || VmbPixelFormatMono10 == m_Camera.PixelFormat
+                    || VmbPixelFormatMono12 == m_Camera.PixelFormat
+                    || VmbPixelFormatMono14 == m_Camera.PixelFormat
+                    || VmbPixelFormatMono16 == m_Camera.PixelFormat )
+                {
+                    nValue = ( nRGB[0] + nRGB[1] ) / 2;
+                }
+                else
+                {
+                    const int nChannel = BayerChannelAt( m_Camera.PixelFormat, x, y );
+                    nValue = 2 == nChannel ? nBlue : nRGB[ nChannel ];
+                }
+                // Wider formats are little endian, one pixel per 16 bit word
+                pPixel[0] = static_cast<VmbUchar_t>( nValue & 0xFF );
+                if( nBytesPerPixel > 1 )
+                {
+                    pPixel[1] = static_cast<VmbUchar_t>( nValue >> 8 );
+                }
+                break;
+            }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Delivers frames at the configured rate until StopAcquisition.
+ * Frame IDs and timestamps behave like those of a camera: the ID advances for every exposure,
+ * whether it was delivered or not, the timestamp counts nanoseconds since acquisition start
+ */
+void SyntheticFrameSource::GeneratorLoop()
+{
+    typedef std::chrono::steady_clock Clock;
+
+    const bool              bFixedRate  = m_Camera.FrameRate > 0.0;
+    const Clock::duration   tPeriod     = bFixedRate
+                                        ? std::chrono::duration_cast<Clock::duration>( std::chrono::duration<double>( 1.0 / m_Camera.FrameRate ))
+                                        : Clock::duration::zero();
+    const bool              bDropouts   = m_Camera.DropoutInterval > 0.0;
+    const Clock::duration   tUptime     = std::chrono::duration_cast<Clock::duration>( std::chrono::duration<double>( m_Camera.DropoutInterval ));
+    Clock::time_point       tStart      = Clock::now();
+    Clock::time_point       tNext       = tStart;
+    VmbUint64_t             nFrameID    = 0;
+    VmbUint32_t             nCursor     = 0;
+
+    while( m_bRunning.load( std::memory_order_relaxed ))
+    {
+        if(     ( bDropouts )
+            &&  ( Clock::now() - tStart >= tUptime ))
+        {
+            if( !DropOut() )
+            {
+                break;
+            }
+            tStart      = Clock::now();
+            tNext       = tStart;
+            nFrameID    = 0;
+        }
+        if( bFixedRate )
+        {
+            tNext += tPeriod;
+            std::this_thread::sleep_until( tNext );
+        }
+
+        // Lost on the wire, the camera exposed the frames but they never arrive
+        if( Chance( m_Camera.GapPercent ))
+        {
+            const VmbUint32_t nLost = 1 + ( m_nRandomState % 3 );
+            nFrameID += nLost;
+            if( bFixedRate )
+            {
+                // Their exposure time still passes, the device timestamps keep the sensor cadence
+                tNext += tPeriod * nLost;
+                std::this_thread::sleep_until( tNext );
+            }
+        }
+
+        // Take the next queued buffer in round robin order like the transport layer does
+        const VmbUint32_t nSlots = m_nSlots.load( std::memory_order_relaxed );
+        VmbUint32_t nSlot   = nSlots;
+        for( ;; )
+        {
+            for( VmbUint32_t i = 0; i < nSlots; ++i )
+            {
+                const VmbUint32_t nCandidate = ( nCursor + i ) % nSlots;
+                if( m_pSlots[ nCandidate ].bQueued.load( std::memory_order_acquire ))
+                {
+                    nSlot = nCandidate;
+                    break;
+                }
+            }
+            if(     ( nSlot < nSlots )
+                ||  ( bFixedRate )
+                ||  ( !m_bRunning.load( std::memory_order_relaxed )))
+            {
+                break;
+            }
+            std::this_thread::yield();
+        }
+        if( nSlot == nSlots )
+        {
+            // Buffer starvation, the camera drops the frame
+            if( bFixedRate )
+            {
+                m_nStarved.fetch_add( 1, std::memory_order_relaxed );
+                ++nFrameID;
+            }
+            continue;
+        }
+        nCursor = ( nSlot + 1 ) % nSlots;
+        m_pSlots[ nSlot ].bQueued.store( false, std::memory_order_relaxed );
+
+        SourceFrame frame;
+        frame.nSlot                 = nSlot;
+        frame.pBuffer               = m_pSlots[ nSlot ].pBuffer;
+        frame.ImageSize             = m_nImageSize;
+        frame.Width                 = m_Camera.Width;
+        frame.Height                = m_Camera.Height;
+        frame.PixelFormat           = m_Camera.PixelFormat;
+        frame.bPixelFormatValid     = true;
+        frame.FrameID               = nFrameID++;
+        frame.bFrameIDValid         = true;
+        frame.Timestamp             = static_cast<VmbUint64_t>( std::chrono::duration_cast<std::chrono::nanoseconds>( Clock::now() - tStart ).count() );
+        frame.ReceiveStatus         = Chance( m_Camera.IncompletePercent ) ? VmbFrameStatusIncomplete : VmbFrameStatusComplete;
+        frame.bReceiveStatusValid   = true;
+        frame.ReceiveTime           = GetHostTime();
+
+        m_Reconnects.Frame();
+        const bool bGrow = m_Sizer.Delivered( frame );
+        m_pObserver->FrameReceived( frame );
+
+        // Like a camera announcing more buffers, the frames due meanwhile are late
+        if( bGrow )
+        {
+            const VmbUint32_t nTarget = m_Sizer.GetTarget();
+            const VmbUint32_t nCount = m_nSlots.load();
+            if(     ( nTarget > nCount )
+                &&  ( VmbErrorSuccess == AddBuffers( nTarget - nCount )))
+            {
+                for( VmbUint32_t i = nCount; i < nTarget; ++i )
+                {
+                    m_pSlots[i].bQueued.store( true, std::memory_order_release );
+                }
+                std::cout<<"Camera "<<m_strID<<" buffers grown to "<<nTarget<<" frames\n";
+            }
+            m_Sizer.Grown( m_nSlots.load() );
+        }
+    }
+}
+
+}} // namespace AVT::VmbAPI
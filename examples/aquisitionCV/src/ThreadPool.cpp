@@ -0,0 +1,117 @@
+#include "ThreadPool.h"
+
+namespace AVT {
+namespace VmbAPI {
+
+ThreadPool::ThreadPool( unsigned int nThreads )
+    :   m_pTask( NULL )
+    ,   m_nTasks( 0 )
+    ,   m_nNextTask( 0 )
+    ,   m_nGeneration( 0 )
+    ,   m_nBusyWorkers( 0 )
+    ,   m_bStopping( false )
+{
+    if( 0 == nThreads )
+    {
+        nThreads = std::thread::hardware_concurrency();
+    }
+    for( unsigned int i = 1; i < nThreads; ++i )
+    {
+        m_Workers.push_back( std::thread( &ThreadPool::WorkerLoop, this ));
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock( m_Mutex );
+        m_bStopping = true;
+    }
+    m_StartCondition.notify_all();
+    for( size_t i = 0; i < m_Workers.size(); ++i )
+    {
+        m_Workers[i].join();
+    }
+}
+
+unsigned int ThreadPool::GetThreadCount() const
+{
+    return static_cast<unsigned int>( m_Workers.size() ) + 1;
+}
+
+/**
+ * @brief Takes iterations until none is left
+ */
+void ThreadPool::RunTasks()
+{
+    for( ;; )
+    {
+        const size_t i = m_nNextTask.fetch_add( 1 );
+        if( i >= m_nTasks )
+        {
+            break;
+        }
+        ( *m_pTask )( i );
+    }
+}
+
+void ThreadPool::Run( size_t nTasks, const std::function<void( size_t )> &Task )
+{
+    if( m_Workers.empty() || nTasks < 2 )
+    {
+        for( size_t i = 0; i < nTasks; ++i )
+        {
+            Task( i );
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock( m_Mutex );
+        m_pTask         = &Task;
+        m_nTasks        = nTasks;
+        m_nNextTask.store( 0 );
+        m_nBusyWorkers  = static_cast<unsigned int>( m_Workers.size() );
+        ++m_nGeneration;
+    }
+    m_StartCondition.notify_all();
+
+    RunTasks();
+
+    // The task object lives on the caller's stack, no worker may touch it after Run returned
+    std::unique_lock<std::mutex> lock( m_Mutex );
+    while( m_nBusyWorkers > 0 )
+    {
+        m_DoneCondition.wait( lock );
+    }
+    m_pTask = NULL;
+}
+
+void ThreadPool::WorkerLoop()
+{
+    VmbUint64_t nGeneration = 0;
+    std::unique_lock<std::mutex> lock( m_Mutex );
+    for( ;; )
+    {
+        while( nGeneration == m_nGeneration && !m_bStopping )
+        {
+            m_StartCondition.wait( lock );
+        }
+        if( m_bStopping )
+        {
+            break;
+        }
+        nGeneration = m_nGeneration;
+        lock.unlock();
+
+        RunTasks();
+
+        lock.lock();
+        if( 0 == --m_nBusyWorkers )
+        {
+            m_DoneCondition.notify_one();
+        }
+    }
+}
+
+}} // namespace AVT::VmbAPI
@@ -0,0 +1,358 @@
+#include "Unpack.h"
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+#define UNPACK_X86
+#include <immintrin.h>
+#endif
+
+namespace AVT {
+namespace VmbAPI {
+
+namespace {
+
+enum PackingKind
+{
+    Packing_Word,               // One little endian 16 bit word per pixel
+    Packing_Mono12Packed,       // Two pixels in three bytes, high bits in the outer bytes, low nibbles shared in the middle
+    Packing_Mono12p,            // Continuous bit stream, least significant bit first, 12 bits per pixel
+    Packing_Mono10p,            // Continuous bit stream, least significant bit first, 10 bits per pixel
+};
+
+struct Packing
+{
+    PackingKind eKind;
+    VmbUint32_t nBits;
+};
+
+bool GetPacking( VmbPixelFormatType eFormat, Packing &packing )
+{
+    switch( eFormat )
+    {
+    case VmbPixelFormatMono10:          packing.eKind = Packing_Word;           packing.nBits = 10; return true;
+    case VmbPixelFormatMono12:          packing.eKind = Packing_Word;           packing.nBits = 12; return true;
+    case VmbPixelFormatMono14:          packing.eKind = Packing_Word;           packing.nBits = 14; return true;
+    case VmbPixelFormatMono16:          packing.eKind = Packing_Word;           packing.nBits = 16; return true;
+    case VmbPixelFormatMono12Packed:    packing.eKind = Packing_Mono12Packed;   packing.nBits = 12; return true;
+    case VmbPixelFormatMono12p:         packing.eKind = Packing_Mono12p;        packing.nBits = 12; return true;
+    case VmbPixelFormatMono10p:         packing.eKind = Packing_Mono10p;        packing.nBits = 10; return true;
+    default:
+        return false;
+    }
+}
+
+/**
+ * @brief Bytes holding the given number of pixels, the count is a multiple of 8 or the end of the image
+ */
+size_t PackedSize( PackingKind eKind, size_t nPixels )
+{
+    switch( eKind )
+    {
+    case Packing_Word:      return 2 * nPixels;
+    case Packing_Mono10p:   return ( 10 * nPixels + 7 ) / 8;
+    default:                return ( 12 * nPixels + 7 ) / 8;
+    }
+}
+
+/**
+ * @brief Reads a single pixel, the reference every vectorised kernel has to match
+ */
+inline VmbUint32_t UnpackPixel( const VmbUchar_t *pSource, size_t i, PackingKind eKind )
+{
+    switch( eKind )
+    {
+    case Packing_Word:
+        {
+            const VmbUchar_t *p = pSource + 2 * i;
+            return p[0] | ( p[1] << 8 );
+        }
+    case Packing_Mono12Packed:
+        {
+            const VmbUchar_t *p = pSource + 3 * ( i / 2 );
+            return 0 == ( i & 1 ) ? ( p[0] << 4 ) | ( p[1] & 0x0F )
+                                  : ( p[2] << 4 ) | ( p[1] >> 4 );
+        }
+    case Packing_Mono12p:
+        {
+            const VmbUchar_t *p = pSource + 3 * ( i / 2 );
+            return 0 == ( i & 1 ) ? p[0] | (( p[1] & 0x0F ) << 8 )
+                                  : ( p[1] >> 4 ) | ( p[2] << 4 );
+        }
+    case Packing_Mono10p:
+    default:
+        {
+            const size_t        nBit    = 10 * i;
+            const VmbUchar_t *  p       = pSource + nBit / 8;
+            return (( p[0] | ( p[1] << 8 )) >> ( nBit & 7 )) & 0x3FF;
+        }
+    }
+}
+
+/**
+ * @brief Unpacks the pixels [nBegin, nEnd) with the reference implementation.
+ * Exactly one of the destinations is used, 8 bit values saturate like the vector kernels do
+ */
+void UnpackSpan( const VmbUchar_t *pSource, const Packing &packing, size_t nBegin, size_t nEnd, VmbUint16_t *pDestination16, VmbUchar_t *pDestination8 )
+{
+    const VmbUint32_t nShift = packing.nBits - 8;
+    for( size_t i = nBegin; i < nEnd; ++i )
+    {
+        const VmbUint32_t nValue = UnpackPixel( pSource, i, packing.eKind );
+        if( NULL != pDestination16 )
+        {
+            pDestination16[i] = static_cast<VmbUint16_t>( nValue );
+        }
+        else
+        {
+            const VmbUint32_t nShifted = nValue >> nShift;
+            pDestination8[i] = static_cast<VmbUchar_t>( nShifted > 255 ? 255 : nShifted );
+        }
+    }
+}
+
+/**
+ * @brief Unpacks a leading part of the image, the caller finishes the rest with UnpackSpan
+ *
+ * @return Number of pixels done, a multiple of 8
+ */
+typedef size_t (*UnpackKernel)( const VmbUchar_t *pSource, size_t nSourceBytes, size_t nPixelCount, VmbUint32_t nShift,
+                                VmbUint16_t *pDestination16, VmbUchar_t *pDestination8 );
+
+#ifdef UNPACK_X86
+
+/**
+ * @brief Source bytes of 8 pixels
+ */
+template<PackingKind KIND>
+inline size_t BytesPer8()
+{
+    return Packing_Word == KIND ? 16 : Packing_Mono10p == KIND ? 10 : 12;
+}
+
+/**
+ * @brief Unpacks 8 pixels into 16 bit lanes, same result as UnpackPixel.
+ * A shuffle moves the two bytes holding each pixel into its lane, then the
+ * pixel is shifted into place. Reads 16 bytes
+ */
+template<PackingKind KIND>
+__attribute__(( target( "sse4.1" )))
+inline __m128i Unpack8SSE41( const VmbUchar_t *p )
+{
+    const __m128i v = _mm_loadu_si128( reinterpret_cast<const __m128i*>( p ));
+    if( Packing_Mono12p == KIND )
+    {
+        // Even pixels are the low 12 bits of their lane, odd pixels the high 12 bits.
+        // Multiplying even lanes by 16 drops the 4 foreign bits, the shift aligns both
+        const __m128i lanes = _mm_shuffle_epi8( v, _mm_setr_epi8( 0, 1, 1, 2, 3, 4, 4, 5, 6, 7, 7, 8, 9, 10, 10, 11 ));
+        return _mm_srli_epi16( _mm_mullo_epi16( lanes, _mm_setr_epi16( 16, 1, 16, 1, 16, 1, 16, 1 )), 4 );
+    }
+    if( Packing_Mono10p == KIND )
+    {
+        // Pixel k starts at bit 2 * ( k % 4 ) of its lane, same trick as above
+        const __m128i lanes = _mm_shuffle_epi8( v, _mm_setr_epi8( 0, 1, 1, 2, 2, 3, 3, 4, 5, 6, 6, 7, 7, 8, 8, 9 ));
+        return _mm_srli_epi16( _mm_mullo_epi16( lanes, _mm_setr_epi16( 64, 16, 4, 1, 64, 16, 4, 1 )), 6 );
+    }
+    if( Packing_Mono12Packed == KIND )
+    {
+        // Even lanes hold high byte and middle byte, odd lanes outer high byte and middle byte
+        const __m128i lanes     = _mm_shuffle_epi8( v, _mm_setr_epi8( 1, 0, 1, 2, 4, 3, 4, 5, 7, 6, 7, 8, 10, 9, 10, 11 ));
+        const __m128i shifted   = _mm_srli_epi16( lanes, 4 );
+        const __m128i even      = _mm_or_si128( _mm_and_si128( shifted, _mm_set1_epi16( 0x0FF0 )), _mm_and_si128( lanes, _mm_set1_epi16( 0x000F )));
+        return _mm_blend_epi16( even, shifted, 0xAA );
+    }
+    return v;
+}
+
+template<PackingKind KIND>
+__attribute__(( target( "sse4.1" )))
+size_t UnpackSSE41( const VmbUchar_t *pSource, size_t nSourceBytes, size_t nPixelCount, VmbUint32_t nShift,
+                    VmbUint16_t *pDestination16, VmbUchar_t *pDestination8 )
+{
+    const size_t    nStepBytes  = BytesPer8<KIND>();
+    const __m128i   shift       = _mm_cvtsi32_si128( static_cast<int>( nShift ));
+    size_t i        = 0;
+    size_t nOffset  = 0;
+    for( ; i + 16 <= nPixelCount && nOffset + nStepBytes + 16 <= nSourceBytes; i += 16, nOffset += 2 * nStepBytes )
+    {
+        const __m128i low   = Unpack8SSE41<KIND>( pSource + nOffset );
+        const __m128i high  = Unpack8SSE41<KIND>( pSource + nOffset + nStepBytes );
+        if( NULL != pDestination16 )
+        {
+            _mm_storeu_si128( reinterpret_cast<__m128i*>( pDestination16 + i ),     low );
+            _mm_storeu_si128( reinterpret_cast<__m128i*>( pDestination16 + i + 8 ), high );
+        }
+        else
+        {
+            _mm_storeu_si128( reinterpret_cast<__m128i*>( pDestination8 + i ), _mm_packus_epi16( _mm_srl_epi16( low, shift ), _mm_srl_epi16( high, shift )));
+        }
+    }
+    return i;
+}
+
+/**
+ * @brief Unpacks 16 pixels, each 128 bit half works like Unpack8SSE41.
+ * Reads 16 bytes at p and 16 bytes at the start of the second group of 8 pixels
+ */
+template<PackingKind KIND>
+__attribute__(( target( "avx2" )))
+inline __m256i Unpack16AVX2( const VmbUchar_t *p )
+{
+    if( Packing_Word == KIND )
+    {
+        return _mm256_loadu_si256( reinterpret_cast<const __m256i*>( p ));
+    }
+    const __m256i v = _mm256_inserti128_si256( _mm256_castsi128_si256( _mm_loadu_si128( reinterpret_cast<const __m128i*>( p ))),
+                                               _mm_loadu_si128( reinterpret_cast<const __m128i*>( p + BytesPer8<KIND>() )), 1 );
+    if( Packing_Mono12p == KIND )
+    {
+        const __m256i lanes = _mm256_shuffle_epi8( v, _mm256_setr_epi8( 0, 1, 1, 2, 3, 4, 4, 5, 6, 7, 7, 8, 9, 10, 10, 11,
+                                                                        0, 1, 1, 2, 3, 4, 4, 5, 6, 7, 7, 8, 9, 10, 10, 11 ));
+        return _mm256_srli_epi16( _mm256_mullo_epi16( lanes, _mm256_setr_epi16( 16, 1, 16, 1, 16, 1, 16, 1, 16, 1, 16, 1, 16, 1, 16, 1 )), 4 );
+    }
+    if( Packing_Mono10p == KIND )
+    {
+        const __m256i lanes = _mm256_shuffle_epi8( v, _mm256_setr_epi8( 0, 1, 1, 2, 2, 3, 3, 4, 5, 6, 6, 7, 7, 8, 8, 9,
+                                                                        0, 1, 1, 2, 2, 3, 3, 4, 5, 6, 6, 7, 7, 8, 8, 9 ));
+        return _mm256_srli_epi16( _mm256_mullo_epi16( lanes, _mm256_setr_epi16( 64, 16, 4, 1, 64, 16, 4, 1, 64, 16, 4, 1, 64, 16, 4, 1 )), 6 );
+    }
+    const __m256i lanes     = _mm256_shuffle_epi8( v, _mm256_setr_epi8( 1, 0, 1, 2, 4, 3, 4, 5, 7, 6, 7, 8, 10, 9, 10, 11,
+                                                                        1, 0, 1, 2, 4, 3, 4, 5, 7, 6, 7, 8, 10, 9, 10, 11 ));
+    const __m256i shifted   = _mm256_srli_epi16( lanes, 4 );
+    const __m256i even      = _mm256_or_si256( _mm256_and_si256( shifted, _mm256_set1_epi16( 0x0FF0 )), _mm256_and_si256( lanes, _mm256_set1_epi16( 0x000F )));
+    return _mm256_blend_epi16( even, shifted, 0xAA );
+}
+
+template<PackingKind KIND>
+__attribute__(( target( "avx2" )))
+size_t UnpackAVX2( const VmbUchar_t *pSource, size_t nSourceBytes, size_t nPixelCount, VmbUint32_t nShift,
+                   VmbUint16_t *pDestination16, VmbUchar_t *pDestination8 )
+{
+    const size_t    nStepBytes  = BytesPer8<KIND>();
+    const __m128i   shift       = _mm_cvtsi32_si128( static_cast<int>( nShift ));
+    size_t i        = 0;
+    size_t nOffset  = 0;
+    for( ; i + 32 <= nPixelCount && nOffset + 3 * nStepBytes + 16 <= nSourceBytes; i += 32, nOffset += 4 * nStepBytes )
+    {
+        const __m256i low   = Unpack16AVX2<KIND>( pSource + nOffset );
+        const __m256i high  = Unpack16AVX2<KIND>( pSource + nOffset + 2 * nStepBytes );
+        if( NULL != pDestination16 )
+        {
+            _mm256_storeu_si256( reinterpret_cast<__m256i*>( pDestination16 + i ),      low );
+            _mm256_storeu_si256( reinterpret_cast<__m256i*>( pDestination16 + i + 16 ), high );
+        }
+        else
+        {
+            // Packing works within 128 bit halves, the permute restores the pixel order
+            const __m256i packed = _mm256_packus_epi16( _mm256_srl_epi16( low, shift ), _mm256_srl_epi16( high, shift ));
+            _mm256_storeu_si256( reinterpret_cast<__m256i*>( pDestination8 + i ), _mm256_permute4x64_epi64( packed, 0xD8 ));
+        }
+    }
+    return i;
+}
+
+#endif // UNPACK_X86
+
+size_t UnpackNone( const VmbUchar_t*, size_t, size_t, VmbUint32_t, VmbUint16_t*, VmbUchar_t* )
+{
+    return 0;
+}
+
+UnpackKernel SelectKernel( PackingKind eKind, SimdLevel eLevel )
+{
+    switch( ResolveSimdLevel( eLevel ))
+    {
+#ifdef UNPACK_X86
+    case SimdLevel_AVX2:
+        switch( eKind )
+        {
+        case Packing_Word:          return UnpackAVX2<Packing_Word>;
+        case Packing_Mono12Packed:  return UnpackAVX2<Packing_Mono12Packed>;
+        case Packing_Mono12p:       return UnpackAVX2<Packing_Mono12p>;
+        case Packing_Mono10p:       return UnpackAVX2<Packing_Mono10p>;
+        }
+        break;
+    case SimdLevel_SSE41:
+        switch( eKind )
+        {
+        case Packing_Word:          return UnpackSSE41<Packing_Word>;
+        case Packing_Mono12Packed:  return UnpackSSE41<Packing_Mono12Packed>;
+        case Packing_Mono12p:       return UnpackSSE41<Packing_Mono12p>;
+        case Packing_Mono10p:       return UnpackSSE41<Packing_Mono10p>;
+        }
+        break;
+#endif
+    default:
+        break;
+    }
+    return UnpackNone;
+}
+
+// Pixels unpacked to 16 bit at a time before they go through a table, a multiple of 8
+const size_t LUT_CHUNK = 1024;
+
+} // namespace
+
+VmbUint32_t UnpackBitDepth( VmbPixelFormatType eFormat )
+{
+    Packing packing;
+    return GetPacking( eFormat, packing ) ? packing.nBits : 0;
+}
+
+VmbErrorType UnpackMono16( const VmbUchar_t *pSource, VmbUint32_t nPixelCount, VmbPixelFormatType eFormat,
+                           VmbUint16_t *pDestination, SimdLevel eSimd )
+{
+    Packing packing;
+    if( !GetPacking( eFormat, packing ))
+    {
+        return VmbErrorNotSupported;
+    }
+    if( NULL == pSource || NULL == pDestination )
+    {
+        return VmbErrorBadParameter;
+    }
+
+    const size_t nDone = SelectKernel( packing.eKind, eSimd )( pSource, PackedSize( packing.eKind, nPixelCount ), nPixelCount, 0, pDestination, NULL );
+    UnpackSpan( pSource, packing, nDone, nPixelCount, pDestination, NULL );
+    return VmbErrorSuccess;
+}
+
+VmbErrorType UnpackMono8( const VmbUchar_t *pSource, VmbUint32_t nPixelCount, VmbPixelFormatType eFormat,
+                          VmbUchar_t *pDestination, const VmbUchar_t *pLut, SimdLevel eSimd )
+{
+    Packing packing;
+    if( !GetPacking( eFormat, packing ))
+    {
+        return VmbErrorNotSupported;
+    }
+    if( NULL == pSource || NULL == pDestination )
+    {
+        return VmbErrorBadParameter;
+    }
+
+    const UnpackKernel  kernel          = SelectKernel( packing.eKind, eSimd );
+    const size_t        nSourceBytes    = PackedSize( packing.eKind, nPixelCount );
+    if( NULL == pLut )
+    {
+        const size_t nDone = kernel( pSource, nSourceBytes, nPixelCount, packing.nBits - 8, NULL, pDestination );
+        UnpackSpan( pSource, packing, nDone, nPixelCount, NULL, pDestination );
+        return VmbErrorSuccess;
+    }
+
+    // Table lookups do not vectorise, so unpack a chunk to 16 bit and map it while it is in the cache
+    const VmbUint32_t nMask = ( 1u << packing.nBits ) - 1;
+    VmbUint16_t chunk[ LUT_CHUNK ];
+    for( size_t nFirst = 0; nFirst < nPixelCount; nFirst += LUT_CHUNK )
+    {
+        const size_t        nCount  = nPixelCount - nFirst < LUT_CHUNK ? nPixelCount - nFirst : LUT_CHUNK;
+        const size_t        nOffset = PackedSize( packing.eKind, nFirst );
+        const VmbUchar_t *  pChunk  = pSource + nOffset;
+        const size_t        nDone   = kernel( pChunk, nSourceBytes - nOffset, nCount, 0, chunk, NULL );
+        UnpackSpan( pChunk, packing, nDone, nCount, chunk, NULL );
+        for( size_t i = 0; i < nCount; ++i )
+        {
+            pDestination[ nFirst + i ] = pLut[ chunk[i] & nMask ];
+        }
+    }
+    return VmbErrorSuccess;
+}
+
+}} // namespace AVT::VmbAPI
@@ -1,6 +1,9 @@
 #include <string>
 #include <cstring>
 #include <iostream>
+#include <sstream>
+#include <vector>
+#include <chrono>
 
 #include "VimbaCPP/Include/VimbaCPP.h"
 #include "ApiController.h"
@@ -41,35 +44,168 @@ int main( int argc, char* argv[] )
         err = apiController.StartUp();        
         if ( VmbErrorSuccess == err )
         {
-            if( Config.getCameraID().empty() )
+            const unsigned int nCameraCount = Config.getCameraCount() > 0 ? Config.getCameraCount() : 1;
+            if( Config.getUseSyntheticCamera() )
             {
-                AVT::VmbAPI::CameraPtrVector cameras = apiController.GetCameraList();
-                if( cameras.empty() )
+                if( Config.getCameraIDs().empty() )
                 {
-                    err = VmbErrorNotFound;
-                }
-                else
-                {
-                    std::string strCameraID;
-                    err = cameras[0]->GetID( strCameraID );
-                    if( VmbErrorSuccess == err )
+                    std::vector<std::string> IDs;
+                    for( unsigned int i = 0; i < nCameraCount; ++i )
                     {
-                        Config.setCameraID( strCameraID );
+                        std::ostringstream id;
+                        id<<"Synthetic";
+                        if( nCameraCount > 1 )
+                        {
+                            id<<i;
+                        }
+                        IDs.push_back( id.str() );
                     }
+                    Config.setCameraIDs( IDs );
+                }
+            }
+            else if( !Config.getUsePlayback() )
+            {
+                std::vector<std::string> IDs = Config.getCameraIDs();
+                err = apiController.FindCameras( nCameraCount, IDs );
+                if( VmbErrorSuccess == err )
+                {
+                    Config.setCameraIDs( IDs );
                 }
             }
             if ( VmbErrorSuccess == err )
             {
-                std::cout<<"Opening camera with ID: "<< Config.getCameraID() <<"\n";
+                for( size_t i = 0; i < Config.getCameraIDs().size(); ++i )
+                {
+                    std::cout<<( Config.getUsePlayback() ? "Opening recording: " : "Opening camera with ID: " )<< Config.getCameraIDs()[i] <<"\n";
+                }
 
                 err = apiController.StartContinuousImageAcquisition( Config );
 
+                // One failing camera does not stop the others
+                for( size_t i = 0; i < apiController.GetStreamCount(); ++i )
+                {
+                    if( VmbErrorSuccess != apiController.GetStreamResult( i ))
+                    {
+                        std::cout<<"Camera "<<apiController.GetStreamCameraID( i )<<" failed: "<<apiController.ErrorCodeToMessage( apiController.GetStreamResult( i ))<<"\n";
+                    }
+                }
+
                 if ( VmbErrorSuccess == err )
                 {
-                    std::cout<< "Press <enter> to stop acquisition...\n" ;
-                    getchar();
+                    const std::chrono::steady_clock::time_point tStart = std::chrono::steady_clock::now();
+                    if( Config.getPresetFile().empty() )
+                    {
+                        std::cout<< "Press <enter> to stop acquisition...\n" ;
+                        getchar();
+                    }
+                    else
+                    {
+                        // Every line names a preset to switch to, an empty one stops
+                        std::cout<< "Enter a preset to switch to or press <enter> to stop acquisition...\n" ;
+                        std::string strPreset;
+                        while(      ( std::getline( std::cin, strPreset ))
+                                &&  ( !strPreset.empty() ))
+                        {
+                            std::vector<AVT::VmbAPI::PresetReport> reports;
+                            if( VmbErrorNotFound == apiController.ApplyPreset( strPreset, reports ))
+                            {
+                                std::cout<<"No preset "<<strPreset<<"\n";
+                                continue;
+                            }
+                            AVT::VmbAPI::CameraPreset preset;
+                            preset.Name = strPreset;
+                            for( size_t i = 0; i < reports.size(); ++i )
+                            {
+                                if( VmbErrorInvalidCall != reports[i].Result )
+                                {
+                                    std::cout<<"Camera "<<apiController.GetStreamCameraID( i )<<" ";
+                                    AVT::VmbAPI::PrintPresetReport( std::cout, preset, reports[i] );
+                                    std::cout<<"\n";
+                                }
+                            }
+                        }
+                    }
 
                     apiController.StopContinuousImageAcquisition();
+                    const double dSeconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - tStart ).count();
+
+                    for( size_t i = 0; i < apiController.GetStreamCount(); ++i )
+                    {
+                        if( VmbErrorSuccess != apiController.GetStreamResult( i ))
+                        {
+                            continue;
+                        }
+                        AVT::VmbAPI::FrameQueueStatistics stats = apiController.GetQueueStatistics( i );
+                        std::cout<<"Camera "<<apiController.GetStreamCameraID( i )<<" frames received: "<<stats.Received<<" processed: "<<stats.Processed<<" overflows: "<<stats.Overflows
+                                 <<" incomplete: "<<stats.Incomplete<<" max queue depth: "<<stats.MaxQueueDepth<<"/"<<stats.QueueCapacity<<"\n";
+                        const AVT::VmbAPI::BufferDepthStatistics buffers = apiController.GetBufferStatistics( i );
+                        if( buffers.Depth > 0 )
+                        {
+                            std::cout<<"Camera "<<apiController.GetStreamCameraID( i )<<" buffers: ";
+                            AVT::VmbAPI::PrintBufferDepthStatistics( std::cout, buffers );
+                            std::cout<<"\n";
+                        }
+                        const AVT::VmbAPI::ReconnectStatistics reconnects = apiController.GetReconnectStatistics( i );
+                        if( reconnects.Losses > 0 )
+                        {
+                            std::cout<<"Camera "<<apiController.GetStreamCameraID( i )<<" lost: "<<reconnects.Losses<<" reconnected: "<<reconnects.Reconnects
+                                     <<" time to first frame: "<<reconnects.LastTimeToFirstFrame * 1000.0<<" ms (max "<<reconnects.MaxTimeToFirstFrame * 1000.0<<" ms)"
+                                     <<" down: "<<reconnects.Downtime<<" s buffers reallocated: "<<reconnects.Reallocations<<"\n";
+                        }
+                        if( Config.getBandwidthPlanning() )
+                        {
+                            const AVT::VmbAPI::BandwidthAllocation bandwidth = apiController.GetBandwidthPlan( i );
+                            if( bandwidth.CapBytesPerSecond > 0.0 )
+                            {
+                                std::cout<<"Camera "<<apiController.GetStreamCameraID( i )<<" bandwidth planned: "<<bandwidth.CapBytesPerSecond / 1.0e6<<" MB/s ("<<bandwidth.PlannedFrameRate<<" fps)"
+                                         <<" achieved: "<<stats.Received * bandwidth.WireBytesPerFrame / dSeconds / 1.0e6<<" MB/s ("<<stats.Received / dSeconds<<" fps)\n";
+                            }
+                            else
+                            {
+                                std::cout<<"Camera "<<apiController.GetStreamCameraID( i )<<" bandwidth not planned\n";
+                            }
+                        }
+                        const AVT::VmbAPI::PipelineStatistics pipeline = apiController.GetPipelineStatistics( i );
+                        for( size_t j = 0; j < pipeline.Stages.size(); ++j )
+                        {
+                            const AVT::VmbAPI::PipelineStageStatistics &stage = pipeline.Stages[j];
+                            std::cout<<"Camera "<<apiController.GetStreamCameraID( i )<<" stage "<<j + 1<<" "<<stage.Name<<": "<<stage.Processed / dSeconds<<" fps dropped: "<<stage.Dropped
+                                     <<" max queue depth: "<<stage.MaxQueueDepth<<"/"<<stage.QueueCapacity<<" busy: "<<100.0 * stage.BusySeconds / ( dSeconds * stage.Threads )<<"% of "<<stage.Threads
+                                     <<( 1 == stage.Threads ? " thread" : " threads" )<<( stage.Summary.empty() ? "" : " " )<<stage.Summary<<"\n";
+                        }
+                        if( Config.getPreview() )
+                        {
+                            AVT::VmbAPI::PreviewStatistics preview = apiController.GetPreviewStatistics( i );
+                            std::cout<<"Camera "<<apiController.GetStreamCameraID( i )<<" preview shown: "<<preview.Shown<<" skipped: "<<preview.Offered - preview.Shown<<"\n";
+                        }
+                        if( !Config.getRecordFile().empty() )
+                        {
+                            AVT::VmbAPI::RecordStatistics record = apiController.GetRecordStatistics( i );
+                            std::cout<<"Camera "<<apiController.GetStreamCameraID( i )<<" frames recorded: "<<record.Frames<<" dropped: "<<record.Dropped
+                                     <<" written: "<<record.FileBytes / 1.0e6<<" MB ("<<record.FileBytes / dSeconds / 1.0e6<<" MB/s"<<( record.bDirectIO ? ", direct I/O)\n" : ", buffered)\n" );
+                            if( record.bCompressed )
+                            {
+                                std::cout<<"Camera "<<apiController.GetStreamCameraID( i )<<" compression ratio: "<<( record.StoredBytes > 0 ? static_cast<double>( record.PayloadBytes ) / record.StoredBytes : 0.0 )
+                                         <<" codec: "<<( record.CodecSeconds > 0.0 ? record.CodedBytes / record.CodecSeconds / 1.0e6 : 0.0 )<<" MB/s per core\n";
+                            }
+                        }
+                    }
+
+                    // With bundling the frames are processed per bundle and not counted per camera
+                    if(     ( AVT::VmbAPI::BundleMatching_Off != Config.getBundleMatching() )
+                        &&  ( apiController.GetStreamCount() > 1 ))
+                    {
+                        AVT::VmbAPI::BundleStatistics bundles = apiController.GetBundleStatistics();
+                        std::cout<<"Bundles processed: "<<bundles.Bundles<<" ("<<bundles.Bundles / dSeconds<<" per s, "<<bundles.BundleBytes / dSeconds / 1.0e6<<" MB/s)"
+                                 <<" dropped: "<<bundles.Dropped<<" unmatched frames: "<<bundles.Unmatched<<" late: "<<bundles.Late<<" overflows: "<<bundles.Overflows
+                                 <<" restarts: "<<bundles.Restarts<<"\n";
+                    }
+                    else
+                    {
+                        AVT::VmbAPI::FrameQueueStatistics total = apiController.GetQueueStatistics();
+                        std::cout<<"All cameras: "<<total.Processed<<" frames processed, "
+                                 <<total.Processed / dSeconds<<" fps, "<<total.ProcessedBytes / dSeconds / 1.0e6<<" MB/s\n";
+                    }
                 }
             }
 
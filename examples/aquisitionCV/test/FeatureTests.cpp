@@ -0,0 +1,505 @@
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "BandwidthPlanner.h"
+#include "CameraPreset.h"
+#include "GeometryPlanner.h"
+#include "ProgramConfig.h"
+#include "SimulatedCameraFeatures.h"
+
+using namespace AVT::VmbAPI;
+
+namespace {
+
+const VmbInt64_t    SENSOR_WIDTH    = 2448;
+const VmbInt64_t    SENSOR_HEIGHT   = 2048;
+
+std::vector<std::string> Formats( const char *pFirst, const char *pSecond )
+{
+    std::vector<std::string> formats;
+    formats.push_back( pFirst );
+    formats.push_back( pSecond );
+    return formats;
+}
+
+/**
+ * @brief Compares the plan against the expected geometry and prints both if they differ
+ */
+bool CheckPlan( const char *pName, const GeometryPlan &Plan, GeometryReduction eReduction, VmbInt64_t nFactor,
+                VmbInt64_t nWidth, VmbInt64_t nHeight, VmbInt64_t nOffsetX, VmbInt64_t nOffsetY )
+{
+    if(     ( Plan.Reduction == eReduction && Plan.Factor == nFactor )
+        &&  ( Plan.Width == nWidth && Plan.Height == nHeight )
+        &&  ( Plan.OffsetX == nOffsetX && Plan.OffsetY == nOffsetY ))
+    {
+        return true;
+    }
+    GeometryPlan expected;
+    expected.PixelFormat    = Plan.PixelFormat;
+    expected.Reduction      = eReduction;
+    expected.Factor         = nFactor;
+    expected.Width          = nWidth;
+    expected.Height         = nHeight;
+    expected.OffsetX        = nOffsetX;
+    expected.OffsetY        = nOffsetY;
+    expected.SensorWidth    = Plan.SensorWidth;
+    expected.SensorHeight   = Plan.SensorHeight;
+    std::cout<<"Geometry, "<<pName<<": ";
+    PrintGeometryPlan( std::cout, Plan );
+    std::cout<<" instead of ";
+    PrintGeometryPlan( std::cout, expected );
+    std::cout<<"\n";
+    return false;
+}
+
+/**
+ * @brief A field of view reaching past the sensor is cut at WidthMax and HeightMax
+ */
+bool TestGeometryClipsRegion()
+{
+    SimulatedCameraFeatures features( SENSOR_WIDTH, SENSOR_HEIGHT, Formats( "Mono8", "Mono12" ));
+    GeometryRequest request;
+    if( !ProgramConfig::ParseGeometryRequest( "400x300:4000x4000+2000+100:roi", request ))
+    {
+        std::cout<<"Geometry: a region past the sensor is not parsed\n";
+        return false;
+    }
+    GeometryPlan plan;
+    const VmbErrorType res = ApplyGeometry( features, request, false, plan );
+    if( VmbErrorSuccess != res )
+    {
+        std::cout<<"Geometry: applying a region past the sensor fails with "<<res<<"\n";
+        return false;
+    }
+    return CheckPlan( "clipped region", plan, GeometryReduction_Roi, 1, SENSOR_WIDTH - 2000, SENSOR_HEIGHT - 100, 2000, 100 );
+}
+
+/**
+ * @brief A Bayer format the camera does not bin in falls back from binning to decimation
+ */
+bool TestGeometryFallsBackToDecimation()
+{
+    SimulatedCameraFeatures features( SENSOR_WIDTH, SENSOR_HEIGHT, Formats( "Mono8", "BayerRG8" ));
+    GeometryRequest request;
+    if( !ProgramConfig::ParseGeometryRequest( "612x512:BayerRG8", request ))
+    {
+        std::cout<<"Geometry: a size with a pixel format is not parsed\n";
+        return false;
+    }
+    GeometryPlan plan;
+    const VmbErrorType res = ApplyGeometry( features, request, false, plan );
+    if( VmbErrorSuccess != res || "BayerRG8" != plan.PixelFormat )
+    {
+        std::cout<<"Geometry: applying BayerRG8 fails with "<<res<<", format "<<plan.PixelFormat<<"\n";
+        return false;
+    }
+    // 2448 / 4 = 612 is off the width increment of 8
+    return CheckPlan( "Bayer reduction", plan, GeometryReduction_Decimation, 4, 608, 512, 0, 0 );
+}
+
+/**
+ * @brief Offsets a previous run left are cleared so the size can grow, then the image is centred
+ * on the region, trimmed to the offset increment
+ */
+bool TestGeometryClearsAndCentresOffsets()
+{
+    SimulatedCameraFeatures features( SENSOR_WIDTH, SENSOR_HEIGHT, Formats( "Mono8", "Mono12" ));
+    if(     ( VmbErrorSuccess != features.SetInt( "Width", 800 ))
+        ||  ( VmbErrorSuccess != features.SetInt( "OffsetX", 1600 ))
+        ||  ( VmbErrorSuccess != features.SetInt( "Height", 600 ))
+        ||  ( VmbErrorSuccess != features.SetInt( "OffsetY", 1400 )))
+    {
+        std::cout<<"Geometry: the simulated camera does not take a region\n";
+        return false;
+    }
+    GeometryRequest request;
+    GeometryPlan plan;
+    // Without a request the full sensor is read out
+    VmbErrorType res = ApplyGeometry( features, request, false, plan );
+    if(     ( VmbErrorSuccess != res )
+        ||  ( !CheckPlan( "full sensor", plan, GeometryReduction_Roi, 1, SENSOR_WIDTH, SENSOR_HEIGHT, 0, 0 )))
+    {
+        return false;
+    }
+
+    features.SetInt( "Width", 800 );
+    features.SetInt( "OffsetX", 1600 );
+    features.SetInt( "Height", 600 );
+    features.SetInt( "OffsetY", 1400 );
+    // 2004 is trimmed to 2000 and centred at 26, the offset increment makes it 24; 1003 to 1002 at 11, made 10
+    if( !ProgramConfig::ParseGeometryRequest( "2004x1003:2004x1003+24+10:roi", request ))
+    {
+        std::cout<<"Geometry: a region is not parsed\n";
+        return false;
+    }
+    res = ApplyGeometry( features, request, false, plan );
+    if( VmbErrorSuccess != res )
+    {
+        std::cout<<"Geometry: applying a region over old offsets fails with "<<res<<"\n";
+        return false;
+    }
+    return CheckPlan( "centred region", plan, GeometryReduction_Roi, 1, 2000, 1002, 24, 10 );
+}
+
+/**
+ * @brief Sizes and regions of zero are rejected, the other fields parse in any order
+ */
+bool TestGeometryParsing()
+{
+    static const char * const Invalid[] = { "0x480", "640x0", "640x480:0x100+0+0", "640x480:100x0+0+0", "640x480x", "640x480:bogus", "" };
+    for( size_t i = 0; i < sizeof( Invalid ) / sizeof( Invalid[0] ); ++i )
+    {
+        GeometryRequest request;
+        if( ProgramConfig::ParseGeometryRequest( Invalid[i], request ))
+        {
+            std::cout<<"Geometry: \""<<Invalid[i]<<"\" is accepted\n";
+            return false;
+        }
+    }
+    GeometryRequest request;
+    if(     ( !ProgramConfig::ParseGeometryRequest( "640x480:Mono8:dec:1000x800+10+20", request ))
+        ||  ( 640 != request.Width || 480 != request.Height )
+        ||  ( 1000 != request.RegionWidth || 800 != request.RegionHeight || 10 != request.RegionX || 20 != request.RegionY )
+        ||  ( GeometryReduction_Decimation != request.Reduction )
+        ||  ( !request.bPixelFormat || VmbPixelFormatMono8 != request.PixelFormat ))
+    {
+        std::cout<<"Geometry: fields in any order are not parsed\n";
+        return false;
+    }
+    std::cout<<"Geometry: clipping, reduction fallback, offsets and parsing as expected\n";
+    return true;
+}
+
+/**
+ * @brief Whether two byte rates agree to a millionth
+ */
+bool SameRate( double dValue, double dExpected )
+{
+    return std::fabs( dValue - dExpected ) <= 1.0e-6 * std::fabs( dExpected );
+}
+
+/**
+ * @brief Two large cameras and a small one share an interface that cannot carry all of them, a fourth
+ * camera has an interface of its own. The small one gets its demand with resend headroom, the large
+ * ones split the rest equally, and the caps end up on the increment of StreamBytesPerSecond
+ */
+bool TestBandwidthSharing()
+{
+    static const double LINK_BYTES_PER_SECOND   = 100.0e6;
+    static const double RESEND_HEADROOM         = 1.05;
+    static const double SMALL_FRAME_RATE        = 10.0;
+
+    std::vector<std::string> formats( 1, "Mono8" );
+    SimulatedCameraFeatures large1( SENSOR_WIDTH, SENSOR_HEIGHT, formats );
+    SimulatedCameraFeatures large2( SENSOR_WIDTH, SENSOR_HEIGHT, formats );
+    SimulatedCameraFeatures small( 640, 480, formats );
+    SimulatedCameraFeatures alone( SENSOR_WIDTH, SENSOR_HEIGHT, formats );
+    small.SetFloat( "AcquisitionFrameRateAbs", SMALL_FRAME_RATE );
+    ICameraFeatures * const cameras[]       = { &large1, &small, &large2, &alone };
+    const char * const      interfaces[]    = { "eth0", "eth0", "eth0", "eth1" };
+    const size_t            nCameras        = sizeof( cameras ) / sizeof( cameras[0] );
+
+    std::vector<BandwidthDemand> demands( nCameras );
+    for( size_t i = 0; i < nCameras; ++i )
+    {
+        const VmbErrorType res = ReadBandwidthDemand( *cameras[i], demands[i] );
+        if( VmbErrorSuccess != res || 0.0 == demands[i].FrameRate )
+        {
+            std::cout<<"Bandwidth: reading the demand of camera "<<i<<" fails with "<<res<<"\n";
+            return false;
+        }
+        demands[i].InterfaceID = interfaces[i];
+    }
+    std::vector<BandwidthAllocation> allocations = PlanBandwidth( demands, LINK_BYTES_PER_SECOND );
+
+    const double dLargeWire = GetWireBytesPerFrame( SENSOR_WIDTH * SENSOR_HEIGHT, SimulatedCameraFeatures::PACKET_SIZE );
+    const double dSmallCap  = GetWireBytesPerFrame( 640 * 480, SimulatedCameraFeatures::PACKET_SIZE ) * SMALL_FRAME_RATE * RESEND_HEADROOM;
+    const double dLargeCap  = ( LINK_BYTES_PER_SECOND - dSmallCap ) / 2.0;
+    const double expected[] = { dLargeCap, dSmallCap, dLargeCap, LINK_BYTES_PER_SECOND };
+    for( size_t i = 0; i < nCameras; ++i )
+    {
+        if(     ( !SameRate( allocations[i].CapBytesPerSecond, expected[i] ))
+            ||  ( 1 != i && !SameRate( allocations[i].PlannedFrameRate, expected[i] / dLargeWire )))
+        {
+            std::cout<<"Bandwidth: camera "<<i<<" on "<<interfaces[i]<<" gets "<<allocations[i].CapBytesPerSecond<<" B/s for "
+                     <<allocations[i].PlannedFrameRate<<" fps instead of "<<expected[i]<<" B/s\n";
+            return false;
+        }
+    }
+    if( SimulatedCameraFeatures::FRAME_RATE * dLargeWire * RESEND_HEADROOM <= dLargeCap )
+    {
+        std::cout<<"Bandwidth: the large cameras fit into the link, nothing is shared\n";
+        return false;
+    }
+
+    double dShared = 0.0;
+    for( size_t i = 0; i < nCameras; ++i )
+    {
+        const double dCap = allocations[i].CapBytesPerSecond;
+        VmbInt64_t nSet = 0;
+        if(     ( VmbErrorSuccess != ApplyBandwidth( *cameras[i], allocations[i] ))
+            ||  ( VmbErrorSuccess != cameras[i]->GetInt( "StreamBytesPerSecond", nSet ))
+            ||  ( static_cast<double>( nSet ) > dCap || static_cast<double>( nSet ) <= dCap - SimulatedCameraFeatures::STREAM_BYTES_INCREMENT )
+            ||  ( 0 != ( nSet - SimulatedCameraFeatures::STREAM_BYTES_MIN ) % SimulatedCameraFeatures::STREAM_BYTES_INCREMENT )
+            ||  ( static_cast<double>( nSet ) != allocations[i].CapBytesPerSecond ))
+        {
+            std::cout<<"Bandwidth: camera "<<i<<" is set to "<<nSet<<" B/s for a cap of "<<dCap<<" B/s\n";
+            return false;
+        }
+        dShared += 3 == i ? 0.0 : allocations[i].CapBytesPerSecond;
+    }
+    if( dShared > LINK_BYTES_PER_SECOND )
+    {
+        std::cout<<"Bandwidth: the caps on eth0 add up to "<<dShared<<" B/s\n";
+        return false;
+    }
+
+    // Caps out of range are clamped to it
+    const double    caps[]      = { 500.0e6, 10.0 };
+    const VmbInt64_t clamped[]  = { SimulatedCameraFeatures::STREAM_BYTES_MAX, SimulatedCameraFeatures::STREAM_BYTES_MIN };
+    for( size_t i = 0; i < 2; ++i )
+    {
+        BandwidthAllocation allocation = allocations[0];
+        allocation.CapBytesPerSecond = caps[i];
+        VmbInt64_t nSet = 0;
+        if(     ( VmbErrorSuccess != ApplyBandwidth( large1, allocation ))
+            ||  ( VmbErrorSuccess != large1.GetInt( "StreamBytesPerSecond", nSet ))
+            ||  ( clamped[i] != nSet ))
+        {
+            std::cout<<"Bandwidth: a cap of "<<caps[i]<<" B/s is set to "<<nSet<<" B/s instead of "<<clamped[i]<<"\n";
+            return false;
+        }
+    }
+    std::cout<<"Bandwidth: "<<dLargeCap<<" B/s for each large camera next to "<<dSmallCap<<" B/s for the small one\n";
+    return true;
+}
+
+PresetSetting NumberSetting( const char *pFeature, double dNumber )
+{
+    PresetSetting setting;
+    setting.Feature = pFeature;
+    setting.Number  = dNumber;
+    return setting;
+}
+
+PresetSetting TextSetting( const char *pFeature, const char *pText )
+{
+    PresetSetting setting;
+    setting.Feature = pFeature;
+    setting.bText   = true;
+    setting.Text    = pText;
+    return setting;
+}
+
+/**
+ * @brief Applies the preset and compares the report, printing it if it differs
+ */
+bool CheckPreset( ICameraFeatures &Features, const CameraPreset &Preset, bool bStreaming, VmbErrorType eResult, const char *pFeature, size_t nWritten, size_t nUnchanged )
+{
+    PresetReport report;
+    const VmbErrorType res = ApplyCameraPreset( Features, Preset, report, bStreaming );
+    if(     ( eResult == res && eResult == report.Result )
+        &&  ( pFeature == report.Feature )
+        &&  ( VmbErrorSuccess != eResult || ( nWritten == report.Written && nUnchanged == report.Unchanged )))
+    {
+        return true;
+    }
+    std::cout<<"Preset: ";
+    PrintPresetReport( std::cout, Preset, report );
+    std::cout<<" instead of "<<nWritten<<" written, "<<nUnchanged<<" unchanged"<<( pFeature[0] ? " failing at " : "" )<<pFeature<<"\n";
+    return false;
+}
+
+/**
+ * @brief A preset listed against its dependencies is written in rank order: the format before binning,
+ * which the simulated camera refuses in a Bayer format, binning before the size it limits and the size
+ * before the offset it limits. Applied again nothing is written, and values out of range or off the
+ * increment fail before being written
+ */
+bool TestPresetOrder()
+{
+    SimulatedCameraFeatures features( SENSOR_WIDTH, SENSOR_HEIGHT, Formats( "BayerRG8", "Mono8" ));
+    CameraPreset preset;
+    preset.Name = "binned";
+    preset.Settings.push_back( NumberSetting( "AcquisitionFrameRateAbs", 50.0 ));
+    preset.Settings.push_back( NumberSetting( "OffsetX", 16 ));
+    preset.Settings.push_back( NumberSetting( "Width", 1200 ));
+    preset.Settings.push_back( NumberSetting( "BinningHorizontal", 2 ));
+    preset.Settings.push_back( TextSetting( "PixelFormat", "Mono8" ));
+    if(     ( !CheckPreset( features, preset, false, VmbErrorSuccess, "", 5, 0 ))
+        ||  ( !CheckPreset( features, preset, false, VmbErrorSuccess, "", 0, 5 )))
+    {
+        return false;
+    }
+    VmbInt64_t  nWidth      = 0;
+    VmbInt64_t  nOffsetX    = 0;
+    VmbInt64_t  nBinning    = 0;
+    std::string strFormat;
+    features.GetInt( "Width", nWidth );
+    features.GetInt( "OffsetX", nOffsetX );
+    features.GetInt( "BinningHorizontal", nBinning );
+    features.GetEnum( "PixelFormat", strFormat );
+    if( 1200 != nWidth || 16 != nOffsetX || 2 != nBinning || "Mono8" != strFormat )
+    {
+        std::cout<<"Preset: the camera reads "<<nWidth<<"+"<<nOffsetX<<" binned "<<nBinning<<" in "<<strFormat<<"\n";
+        return false;
+    }
+
+    // The binned sensor is 1224 wide, 16 pixels are taken by the offset
+    CameraPreset invalid;
+    invalid.Name = "invalid";
+    invalid.Settings.push_back( NumberSetting( "Width", 1216 ));
+    if( !CheckPreset( features, invalid, false, VmbErrorInvalidValue, "Width", 0, 0 ))
+    {
+        return false;
+    }
+    invalid.Settings[0] = NumberSetting( "Width", 1204 );
+    if( !CheckPreset( features, invalid, false, VmbErrorInvalidValue, "Width", 0, 0 ))
+    {
+        return false;
+    }
+    invalid.Settings[0] = NumberSetting( "AcquisitionFrameRateAbs", SimulatedCameraFeatures::FRAME_RATE_MAX * 2.0 );
+    if( !CheckPreset( features, invalid, false, VmbErrorInvalidValue, "AcquisitionFrameRateAbs", 0, 0 ))
+    {
+        return false;
+    }
+    invalid.Settings[0] = TextSetting( "PixelFormat", "BayerRG8" );
+    if( !CheckPreset( features, invalid, false, VmbErrorInvalidValue, "PixelFormat", 0, 0 ))
+    {
+        return false;
+    }
+    invalid.Settings[0] = NumberSetting( "Widht", 1200 );
+    if( !CheckPreset( features, invalid, false, VmbErrorNotFound, "Widht", 0, 0 ))
+    {
+        return false;
+    }
+    features.GetInt( "Width", nWidth );
+    if( 1200 != nWidth )
+    {
+        std::cout<<"Preset: a rejected width left the camera "<<nWidth<<" wide\n";
+        return false;
+    }
+    std::cout<<"Preset: written in dependency order, skipped when unchanged, invalid values rejected\n";
+    return true;
+}
+
+/**
+ * @brief While streaming a preset changing the image format is rejected with the features named and
+ * nothing written, one keeping it is applied
+ */
+bool TestPresetWhileStreaming()
+{
+    SimulatedCameraFeatures features( SENSOR_WIDTH, SENSOR_HEIGHT, Formats( "Mono8", "Mono12" ));
+    CameraPreset preset;
+    preset.Name = "smaller";
+    preset.Settings.push_back( NumberSetting( "AcquisitionFrameRateAbs", 50.0 ));
+    preset.Settings.push_back( TextSetting( "PixelFormat", "Mono12" ));
+    preset.Settings.push_back( NumberSetting( "Width", 1200 ));
+    preset.Settings.push_back( NumberSetting( "Height", SENSOR_HEIGHT ));
+    PresetReport report;
+    const VmbErrorType res = ApplyCameraPreset( features, preset, report, true );
+    double dFrameRate = 0.0;
+    features.GetFloat( "AcquisitionFrameRateAbs", dFrameRate );
+    if(     ( VmbErrorInvalidAccess != res )
+        ||  ( 2 != report.Locked.size() || "PixelFormat" != report.Locked[0] || "Width" != report.Locked[1] )
+        ||  ( 0 != report.Written || SimulatedCameraFeatures::FRAME_RATE != dFrameRate ))
+    {
+        std::cout<<"Preset: while streaming ";
+        PrintPresetReport( std::cout, preset, report );
+        std::cout<<", frame rate "<<dFrameRate<<"\n";
+        return false;
+    }
+
+    // Keeping the format and the size the rest is written while streaming
+    preset.Settings[1] = TextSetting( "PixelFormat", "Mono8" );
+    preset.Settings[2] = NumberSetting( "Width", SENSOR_WIDTH );
+    if( !CheckPreset( features, preset, true, VmbErrorSuccess, "", 1, 3 ))
+    {
+        return false;
+    }
+    std::cout<<"Preset: a change of the image format is refused while streaming\n";
+    return true;
+}
+
+/**
+ * @brief Gain written under three values of GainSelector is replayed under each of them onto a camera
+ * with its defaults back, the selector ends at its last value and a rewrite under the same
+ * selector replaces the earlier one
+ */
+bool TestJournalSelectors()
+{
+    SimulatedCameraFeatures camera( SENSOR_WIDTH, SENSOR_HEIGHT, Formats( "Mono8", "Mono12" ));
+    FeatureJournal journal;
+    journal.SetTarget( &camera );
+    if(     ( VmbErrorSuccess != journal.SetFloat( "Gain", 1.0 ))
+        ||  ( VmbErrorSuccess != journal.SetEnum( "GainSelector", "AnalogAll" ))
+        ||  ( VmbErrorSuccess != journal.SetFloat( "Gain", 2.0 ))
+        ||  ( VmbErrorSuccess != journal.SetEnum( "GainSelector", "DigitalAll" ))
+        ||  ( VmbErrorSuccess != journal.SetFloat( "Gain", 3.0 ))
+        ||  ( VmbErrorSuccess != journal.SetInt( "Width", 1200 ))
+        ||  ( VmbErrorSuccess != journal.SetFloat( "Gain", 4.0 )))
+    {
+        std::cout<<"Journal: writing through it fails\n";
+        return false;
+    }
+
+    SimulatedCameraFeatures reconnected( SENSOR_WIDTH, SENSOR_HEIGHT, Formats( "Mono8", "Mono12" ));
+    journal.SetTarget( &reconnected );
+    PresetReport report;
+    const VmbErrorType res = journal.Replay( reconnected, report );
+    // All, AnalogAll and DigitalAll with their gain, Width, and the selector back at DigitalAll
+    static const char * const   Selectors[] = { "All", "AnalogAll", "DigitalAll" };
+    static const double         Gains[]     = { 1.0, 2.0, 4.0 };
+    bool bReplayed = VmbErrorSuccess == res;
+    std::string strSelector;
+    reconnected.GetEnum( "GainSelector", strSelector );
+    for( size_t i = 0; i < 3; ++i )
+    {
+        double dGain = 0.0;
+        reconnected.SetEnum( "GainSelector", Selectors[i] );
+        reconnected.GetFloat( "Gain", dGain );
+        bReplayed = bReplayed && Gains[i] == dGain;
+    }
+    VmbInt64_t nWidth = 0;
+    reconnected.GetInt( "Width", nWidth );
+    if( !bReplayed || "DigitalAll" != strSelector || 1200 != nWidth )
+    {
+        std::cout<<"Journal: replaying ";
+        PrintPresetReport( std::cout, CameraPreset(), report );
+        std::cout<<" leaves GainSelector at "<<strSelector<<", Width "<<nWidth<<"\n";
+        for( size_t i = 0; i < 3; ++i )
+        {
+            double dGain = 0.0;
+            reconnected.SetEnum( "GainSelector", Selectors[i] );
+            reconnected.GetFloat( "Gain", dGain );
+            std::cout<<"Journal: Gain "<<dGain<<" under "<<Selectors[i]<<" instead of "<<Gains[i]<<"\n";
+        }
+        return false;
+    }
+    std::cout<<"Journal: a gain for each selector value comes back after reconnecting\n";
+    return true;
+}
+
+} // namespace
+
+/**
+ * @brief Checks the camera setup against the simulated feature tree, without a camera.
+ * Returns 0 if all tests pass, so it runs under ctest
+ */
+int main()
+{
+    bool bPassed = true;
+    bPassed = TestGeometryClipsRegion() && bPassed;
+    bPassed = TestGeometryFallsBackToDecimation() && bPassed;
+    bPassed = TestGeometryClearsAndCentresOffsets() && bPassed;
+    bPassed = TestGeometryParsing() && bPassed;
+    bPassed = TestBandwidthSharing() && bPassed;
+    bPassed = TestPresetOrder() && bPassed;
+    bPassed = TestPresetWhileStreaming() && bPassed;
+    bPassed = TestJournalSelectors() && bPassed;
+
+    std::cout<<( bPassed ? "All tests passed\n" : "Tests FAILED\n" );
+    return bPassed ? 0 : 1;
+}
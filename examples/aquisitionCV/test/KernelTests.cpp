@@ -0,0 +1,487 @@
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+#include "Demosaic.h"
+#include "Unpack.h"
+
+using namespace AVT::VmbAPI;
+
+namespace {
+
+const VmbPixelFormatType    BAYER_FORMATS[]     = { VmbPixelFormatBayerRG8, VmbPixelFormatBayerGR8, VmbPixelFormatBayerGB8, VmbPixelFormatBayerBG8 };
+const DemosaicMethod        DEMOSAIC_METHODS[]  = { DemosaicMethod_Bilinear, DemosaicMethod_EdgeAware };
+const DemosaicOutput        DEMOSAIC_OUTPUTS[]  = { DemosaicOutput_BGR8, DemosaicOutput_Mono8 };
+const SimdLevel             SIMD_LEVELS[]       = { SimdLevel_SSE41, SimdLevel_AVX2 };
+const VmbPixelFormatType    UNPACK_FORMATS[]    = { VmbPixelFormatMono10p, VmbPixelFormatMono12p, VmbPixelFormatMono12Packed,
+                                                    VmbPixelFormatMono10, VmbPixelFormatMono12, VmbPixelFormatMono14, VmbPixelFormatMono16 };
+
+/**
+ * @brief xorshift, so every run tests the same images
+ */
+class Random
+{
+    public:
+        explicit Random( VmbUint64_t nSeed )
+            :   m_nState( nSeed )
+        {}
+
+        VmbUint32_t Next()
+        {
+            m_nState ^= m_nState << 13;
+            m_nState ^= m_nState >> 7;
+            m_nState ^= m_nState << 17;
+            return static_cast<VmbUint32_t>( m_nState >> 32 );
+        }
+
+        void Fill( std::vector<VmbUchar_t> &Data )
+        {
+            for( size_t i = 0; i < Data.size(); ++i )
+            {
+                Data[i] = static_cast<VmbUchar_t>( Next() );
+            }
+        }
+
+    private:
+        VmbUint64_t m_nState;
+};
+
+/**
+ * @brief Levels this CPU runs, the others would silently test a lower level twice
+ */
+std::vector<SimdLevel> SupportedLevels()
+{
+    std::vector<SimdLevel> levels;
+    for( size_t i = 0; i < sizeof( SIMD_LEVELS ) / sizeof( SIMD_LEVELS[0] ); ++i )
+    {
+        if( ResolveSimdLevel( SIMD_LEVELS[i] ) == SIMD_LEVELS[i] )
+        {
+            levels.push_back( SIMD_LEVELS[i] );
+        }
+        else
+        {
+            std::cout<<SimdLevelToName( SIMD_LEVELS[i] )<<" not supported by this CPU, skipped\n";
+        }
+    }
+    return levels;
+}
+
+/**
+ * @return Index of the first differing byte, or Size
+ */
+size_t FirstDifference( const VmbUchar_t *pA, const VmbUchar_t *pB, size_t nSize )
+{
+    size_t i = 0;
+    while( i < nSize && pA[i] == pB[i] )
+    {
+        ++i;
+    }
+    return i;
+}
+
+/**
+ * @brief Every SIMD level matches the scalar reference bit by bit, for every width including the
+ * tails the vector loops leave to the scalar code, every Bayer layout, method and output
+ */
+bool TestDemosaicLevels( const std::vector<SimdLevel> &Levels )
+{
+    static const VmbUint32_t HEIGHTS[] = { 2, 3, 4, 5, 7, 16, 33 };
+    std::vector<VmbUint32_t> widths;
+    for( VmbUint32_t w = 2; w <= 80; ++w )
+    {
+        widths.push_back( w );
+    }
+    static const VmbUint32_t WIDE[] = { 127, 128, 129, 255, 256, 257, 640 };
+    widths.insert( widths.end(), WIDE, WIDE + sizeof( WIDE ) / sizeof( WIDE[0] ));
+
+    Random random( 0x2545F4914F6CDD1DULL );
+    VmbUint64_t nImages = 0;
+    for( size_t h = 0; h < sizeof( HEIGHTS ) / sizeof( HEIGHTS[0] ); ++h )
+    {
+        for( size_t w = 0; w < widths.size(); ++w )
+        {
+            const VmbUint32_t nWidth = widths[w];
+            const VmbUint32_t nHeight = HEIGHTS[h];
+            std::vector<VmbUchar_t> source( nWidth * nHeight );
+            random.Fill( source );
+            std::vector<VmbUchar_t> reference( nWidth * nHeight * 3 );
+            std::vector<VmbUchar_t> result( nWidth * nHeight * 3 );
+            for( size_t f = 0; f < sizeof( BAYER_FORMATS ) / sizeof( BAYER_FORMATS[0] ); ++f )
+            {
+                for( size_t m = 0; m < sizeof( DEMOSAIC_METHODS ) / sizeof( DEMOSAIC_METHODS[0] ); ++m )
+                {
+                    for( size_t o = 0; o < sizeof( DEMOSAIC_OUTPUTS ) / sizeof( DEMOSAIC_OUTPUTS[0] ); ++o )
+                    {
+                        const size_t nSize = nWidth * nHeight * ( DemosaicOutput_BGR8 == DEMOSAIC_OUTPUTS[o] ? 3 : 1 );
+                        if( VmbErrorSuccess != DemosaicBayer8( &source[0], nWidth, nHeight, BAYER_FORMATS[f], &reference[0],
+                                                               DEMOSAIC_OUTPUTS[o], DEMOSAIC_METHODS[m], SimdLevel_Scalar ))
+                        {
+                            std::cout<<"Demosaic "<<nWidth<<"x"<<nHeight<<" failed\n";
+                            return false;
+                        }
+                        for( size_t l = 0; l < Levels.size(); ++l )
+                        {
+                            DemosaicBayer8( &source[0], nWidth, nHeight, BAYER_FORMATS[f], &result[0],
+                                            DEMOSAIC_OUTPUTS[o], DEMOSAIC_METHODS[m], Levels[l] );
+                            const size_t nAt = FirstDifference( &reference[0], &result[0], nSize );
+                            if( nAt != nSize )
+                            {
+                                std::cout<<"Demosaic "<<SimdLevelToName( Levels[l] )<<" "<<nWidth<<"x"<<nHeight<<" format "<<f<<" method "<<m
+                                         <<" output "<<o<<" differs at byte "<<nAt<<": "<<int( result[nAt] )<<" instead of "<<int( reference[nAt] )<<"\n";
+                                return false;
+                            }
+                            ++nImages;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    std::cout<<"Demosaic: "<<nImages<<" images match the scalar reference\n";
+    return true;
+}
+
+/**
+ * @brief A frame split into row bands comes out as the whole frame does
+ */
+bool TestDemosaicBands()
+{
+    const VmbUint32_t nWidth = 100;
+    const VmbUint32_t nHeight = 37;
+    Random random( 0x9E3779B97F4A7C15ULL );
+    std::vector<VmbUchar_t> source( nWidth * nHeight );
+    random.Fill( source );
+    std::vector<VmbUchar_t> whole( nWidth * nHeight * 3 );
+    std::vector<VmbUchar_t> bands( nWidth * nHeight * 3 );
+    DemosaicBayer8( &source[0], nWidth, nHeight, VmbPixelFormatBayerGR8, &whole[0], DemosaicOutput_BGR8, DemosaicMethod_EdgeAware );
+    for( VmbUint32_t nFirst = 0; nFirst < nHeight; nFirst += 5 )
+    {
+        const VmbUint32_t nRows = nHeight - nFirst < 5 ? nHeight - nFirst : 5;
+        DemosaicBayer8Rows( &source[0], nWidth, nHeight, VmbPixelFormatBayerGR8, &bands[0], DemosaicOutput_BGR8, DemosaicMethod_EdgeAware,
+                            SimdLevel_Auto, nFirst, nRows );
+    }
+    if( whole != bands )
+    {
+        std::cout<<"Demosaic in bands differs from the whole frame\n";
+        return false;
+    }
+    std::cout<<"Demosaic: bands match the whole frame\n";
+    return true;
+}
+
+/**
+ * @brief A mosaic of one colour comes back as exactly that colour, borders included
+ */
+bool TestDemosaicFlat()
+{
+    const VmbUint32_t nWidth = 34;
+    const VmbUint32_t nHeight = 6;
+    const VmbUchar_t nRed = 200, nGreen = 90, nBlue = 17;
+    std::vector<VmbUchar_t> source( nWidth * nHeight );
+    for( VmbUint32_t y = 0; y < nHeight; ++y )
+    {
+        for( VmbUint32_t x = 0; x < nWidth; ++x )
+        {
+            // BayerRG8: R G on even rows, G B on odd rows
+            source[ y * nWidth + x ] = ( 0 == ( y & 1 )) ? ( 0 == ( x & 1 ) ? nRed : nGreen ) : ( 0 == ( x & 1 ) ? nGreen : nBlue );
+        }
+    }
+    std::vector<VmbUchar_t> result( nWidth * nHeight * 3 );
+    for( size_t m = 0; m < sizeof( DEMOSAIC_METHODS ) / sizeof( DEMOSAIC_METHODS[0] ); ++m )
+    {
+        DemosaicBayer8( &source[0], nWidth, nHeight, VmbPixelFormatBayerRG8, &result[0], DemosaicOutput_BGR8, DEMOSAIC_METHODS[m] );
+        for( size_t i = 0; i < nWidth * nHeight; ++i )
+        {
+            if( result[ 3 * i ] != nBlue || result[ 3 * i + 1 ] != nGreen || result[ 3 * i + 2 ] != nRed )
+            {
+                std::cout<<"Demosaic method "<<m<<" of a flat mosaic differs at pixel "<<i<<"\n";
+                return false;
+            }
+        }
+    }
+    std::cout<<"Demosaic: a flat mosaic keeps its colour\n";
+    return true;
+}
+
+/**
+ * @brief The second stage of the two stage path: the colour correction in floating point on a demosaiced
+ * BGR8 image, rounded to nearest and saturated
+ */
+void CorrectFloat( const VmbFloat_t *pMatrix, std::vector<VmbUchar_t> &Image )
+{
+    for( size_t i = 0; i + 2 < Image.size(); i += 3 )
+    {
+        const VmbFloat_t rgb[3] = { static_cast<VmbFloat_t>( Image[ i + 2 ] ), static_cast<VmbFloat_t>( Image[ i + 1 ] ), static_cast<VmbFloat_t>( Image[i] ) };
+        VmbUchar_t corrected[3];
+        for( int c = 0; c < 3; ++c )
+        {
+            const VmbFloat_t fValue = pMatrix[ 3 * c ] * rgb[0] + pMatrix[ 3 * c + 1 ] * rgb[1] + pMatrix[ 3 * c + 2 ] * rgb[2];
+            corrected[c] = static_cast<VmbUchar_t>( fValue <= 0.0f ? 0 : fValue >= 255.0f ? 255 : static_cast<int>( fValue + 0.5f ));
+        }
+        Image[i]        = corrected[2];
+        Image[ i + 1 ]  = corrected[1];
+        Image[ i + 2 ]  = corrected[0];
+    }
+}
+
+/**
+ * @brief The fused demosaic and colour correction stays within 1 LSB of demosaicing first and correcting
+ * the result in floating point, and every SIMD level matches the fused scalar reference bit by bit
+ */
+bool TestColorCorrection( const std::vector<SimdLevel> &Levels )
+{
+    std::vector< std::vector<VmbFloat_t> > matrices;
+    const VmbFloat_t IDENTITY[9]    = { 1.0f, 0.0f, 0.0f,   0.0f, 1.0f, 0.0f,   0.0f, 0.0f, 1.0f };
+    const VmbFloat_t TYPICAL[9]     = { 1.62f, -0.41f, -0.21f,   -0.28f, 1.51f, -0.23f,   -0.06f, -0.55f, 1.61f };
+    matrices.push_back( std::vector<VmbFloat_t>( IDENTITY, IDENTITY + 9 ));
+    matrices.push_back( std::vector<VmbFloat_t>( TYPICAL, TYPICAL + 9 ));
+    Random random( 0xD1B54A32D192ED03ULL );
+    for( int n = 0; n < 8; ++n )
+    {
+        std::vector<VmbFloat_t> matrix( 9 );
+        for( int i = 0; i < 9; ++i )
+        {
+            // [-8, 8) in steps of 1/1024
+            matrix[i] = static_cast<VmbFloat_t>( static_cast<int>( random.Next() % 16384 ) - 8192 ) / 1024.0f;
+        }
+        matrices.push_back( matrix );
+    }
+
+    const VmbUint32_t nWidth = 203;
+    const VmbUint32_t nHeight = 19;
+    std::vector<VmbUchar_t> source( nWidth * nHeight );
+    random.Fill( source );
+    std::vector<VmbUchar_t> twoStage( nWidth * nHeight * 3 );
+    std::vector<VmbUchar_t> fused( nWidth * nHeight * 3 );
+    std::vector<VmbUchar_t> result( nWidth * nHeight * 3 );
+    int nMaxDifference = 0;
+    for( size_t n = 0; n < matrices.size(); ++n )
+    {
+        for( size_t f = 0; f < sizeof( BAYER_FORMATS ) / sizeof( BAYER_FORMATS[0] ); ++f )
+        {
+            for( size_t m = 0; m < sizeof( DEMOSAIC_METHODS ) / sizeof( DEMOSAIC_METHODS[0] ); ++m )
+            {
+                DemosaicBayer8( &source[0], nWidth, nHeight, BAYER_FORMATS[f], &twoStage[0], DemosaicOutput_BGR8, DEMOSAIC_METHODS[m], SimdLevel_Scalar );
+                CorrectFloat( &matrices[n][0], twoStage );
+                if( VmbErrorSuccess != DemosaicBayer8( &source[0], nWidth, nHeight, BAYER_FORMATS[f], &fused[0], DemosaicOutput_BGR8,
+                                                       DEMOSAIC_METHODS[m], SimdLevel_Scalar, &matrices[n][0] ))
+                {
+                    std::cout<<"Colour correction with matrix "<<n<<" failed\n";
+                    return false;
+                }
+                for( size_t i = 0; i < fused.size(); ++i )
+                {
+                    const int nDifference = std::abs( int( fused[i] ) - int( twoStage[i] ));
+                    if( nDifference > 1 )
+                    {
+                        std::cout<<"Colour correction with matrix "<<n<<" format "<<f<<" method "<<m<<" differs by "<<nDifference
+                                 <<" from the two stage path at byte "<<i<<"\n";
+                        return false;
+                    }
+                    nMaxDifference = nDifference > nMaxDifference ? nDifference : nMaxDifference;
+                }
+                for( size_t l = 0; l < Levels.size(); ++l )
+                {
+                    DemosaicBayer8( &source[0], nWidth, nHeight, BAYER_FORMATS[f], &result[0], DemosaicOutput_BGR8,
+                                    DEMOSAIC_METHODS[m], Levels[l], &matrices[n][0] );
+                    const size_t nAt = FirstDifference( &fused[0], &result[0], fused.size() );
+                    if( nAt != fused.size() )
+                    {
+                        std::cout<<"Colour correction "<<SimdLevelToName( Levels[l] )<<" with matrix "<<n<<" format "<<f<<" method "<<m
+                                 <<" differs at byte "<<nAt<<": "<<int( result[nAt] )<<" instead of "<<int( fused[nAt] )<<"\n";
+                        return false;
+                    }
+                }
+            }
+        }
+    }
+    std::cout<<"Colour correction: "<<matrices.size()<<" matrices within "<<nMaxDifference<<" LSB of the two stage path\n";
+    return true;
+}
+
+/**
+ * @brief Bytes of nPixels pixels, packed formats end on the byte holding their last bit
+ */
+size_t UnpackSourceSize( VmbPixelFormatType eFormat, size_t nPixels )
+{
+    switch( eFormat )
+    {
+    case VmbPixelFormatMono10p:         return ( 10 * nPixels + 7 ) / 8;
+    case VmbPixelFormatMono12p:
+    case VmbPixelFormatMono12Packed:    return ( 12 * nPixels + 7 ) / 8;
+    default:                            return 2 * nPixels;
+    }
+}
+
+/**
+ * @brief Reads pixel i bit by bit, written from the format definitions and independent of the scalar
+ * path of Unpack.cpp
+ */
+VmbUint32_t ReadPixel( const VmbUchar_t *pSource, size_t i, VmbPixelFormatType eFormat )
+{
+    size_t      nFirstBit;
+    VmbUint32_t nBits;
+    switch( eFormat )
+    {
+    case VmbPixelFormatMono10p:
+        nFirstBit   = 10 * i;
+        nBits       = 10;
+        break;
+    case VmbPixelFormatMono12p:
+        nFirstBit   = 12 * i;
+        nBits       = 12;
+        break;
+    case VmbPixelFormatMono12Packed:
+        {
+            // Even pixels: 8 high bits in byte 0, low nibble in the low half of byte 1; odd pixels: byte 2 and the high half of byte 1
+            const VmbUchar_t *p = pSource + 3 * ( i / 2 );
+            return 0 == ( i % 2 ) ? p[0] * 16u + p[1] % 16u : p[2] * 16u + p[1] / 16u;
+        }
+    default:
+        nFirstBit   = 16 * i;
+        nBits       = 16;
+        break;
+    }
+    VmbUint32_t nValue = 0;
+    for( VmbUint32_t b = 0; b < nBits; ++b )
+    {
+        const size_t nBit = nFirstBit + b;
+        nValue |= static_cast<VmbUint32_t>(( pSource[ nBit / 8 ] >> ( nBit % 8 )) & 1 ) << b;
+    }
+    return nValue;
+}
+
+/**
+ * @brief Every level unpacks to 16 bit, to the 8 most significant bits and through a table exactly like
+ * a bit by bit reader, for every pixel count up to 700, so every tail the vector loops leave is covered.
+ * The source buffers end on the last byte of the image so a sanitizer catches reads past it
+ */
+bool TestUnpack( const std::vector<SimdLevel> &Levels )
+{
+    std::vector<SimdLevel> levels( 1, SimdLevel_Scalar );
+    levels.insert( levels.end(), Levels.begin(), Levels.end() );
+    Random random( 0xBF58476D1CE4E5B9ULL );
+    VmbUint64_t nImages = 0;
+    for( size_t f = 0; f < sizeof( UNPACK_FORMATS ) / sizeof( UNPACK_FORMATS[0] ); ++f )
+    {
+        const VmbPixelFormatType eFormat = UNPACK_FORMATS[f];
+        const VmbUint32_t nDepth = UnpackBitDepth( eFormat );
+        std::vector<VmbUchar_t> lut( static_cast<size_t>( 1 ) << nDepth );
+        random.Fill( lut );
+        for( VmbUint32_t nPixels = 1; nPixels <= 700; ++nPixels )
+        {
+            std::vector<VmbUchar_t> source( UnpackSourceSize( eFormat, nPixels ));
+            random.Fill( source );
+            std::vector<VmbUint16_t> expected16( nPixels );
+            std::vector<VmbUchar_t> expected8( nPixels );
+            std::vector<VmbUchar_t> expectedLut( nPixels );
+            for( VmbUint32_t i = 0; i < nPixels; ++i )
+            {
+                // Words of unpacked formats may carry bits above the depth, 8 bit output saturates then
+                const VmbUint32_t nValue = ReadPixel( &source[0], i, eFormat );
+                expected16[i]   = static_cast<VmbUint16_t>( nValue );
+                expected8[i]    = static_cast<VmbUchar_t>(( nValue >> ( nDepth - 8 )) > 255 ? 255 : nValue >> ( nDepth - 8 ));
+                expectedLut[i]  = lut[ nValue & (( 1u << nDepth ) - 1 ) ];
+            }
+            std::vector<VmbUint16_t> result16( nPixels );
+            std::vector<VmbUchar_t> result8( nPixels );
+            std::vector<VmbUchar_t> resultLut( nPixels );
+            for( size_t l = 0; l < levels.size(); ++l )
+            {
+                if(     ( VmbErrorSuccess != UnpackMono16( &source[0], nPixels, eFormat, &result16[0], levels[l] ))
+                    ||  ( VmbErrorSuccess != UnpackMono8( &source[0], nPixels, eFormat, &result8[0], NULL, levels[l] ))
+                    ||  ( VmbErrorSuccess != UnpackMono8( &source[0], nPixels, eFormat, &resultLut[0], &lut[0], levels[l] )))
+                {
+                    std::cout<<"Unpack format "<<f<<" failed\n";
+                    return false;
+                }
+                const char *pOutput = result16 != expected16 ? "16 bit" : result8 != expected8 ? "8 bit" : resultLut != expectedLut ? "table" : NULL;
+                if( NULL != pOutput )
+                {
+                    std::cout<<"Unpack "<<SimdLevelToName( levels[l] )<<" format "<<f<<" to "<<pOutput<<" differs for "<<nPixels<<" pixels\n";
+                    return false;
+                }
+                ++nImages;
+            }
+        }
+    }
+    std::cout<<"Unpack: "<<nImages<<" images match the bit by bit reader\n";
+    return true;
+}
+
+/**
+ * @brief Single core throughput of the unpack kernels on a 5 MP frame, in GB/s of source data
+ */
+void BenchmarkUnpack( const std::vector<SimdLevel> &Levels )
+{
+    static const char * const NAMES[] = { "Mono10p", "Mono12p", "Mono12Packed", "Mono10", "Mono12", "Mono14", "Mono16" };
+    const VmbUint32_t nPixels = 2448 * 2048;
+    std::vector<SimdLevel> levels( 1, SimdLevel_Scalar );
+    levels.insert( levels.end(), Levels.begin(), Levels.end() );
+    Random random( 0x94D049BB133111EBULL );
+    std::vector<VmbUint16_t> result16( nPixels );
+    std::vector<VmbUchar_t> result8( nPixels );
+    std::vector<VmbUchar_t> lut( 65536 );
+    random.Fill( lut );
+
+    std::cout<<"Unpack 2448x2048 on one core, GB/s of source data: to 16 bit / to 8 bit / through a table\n";
+    for( size_t f = 0; f < sizeof( UNPACK_FORMATS ) / sizeof( UNPACK_FORMATS[0] ); ++f )
+    {
+        const VmbPixelFormatType eFormat = UNPACK_FORMATS[f];
+        std::vector<VmbUchar_t> source( UnpackSourceSize( eFormat, nPixels ));
+        random.Fill( source );
+        for( size_t l = 0; l < levels.size(); ++l )
+        {
+            double dRates[3];
+            for( int o = 0; o < 3; ++o )
+            {
+                const std::chrono::steady_clock::time_point tStart = std::chrono::steady_clock::now();
+                int nRuns = 0;
+                double dSeconds = 0.0;
+                do
+                {
+                    switch( o )
+                    {
+                    case 0:     UnpackMono16( &source[0], nPixels, eFormat, &result16[0], levels[l] );          break;
+                    case 1:     UnpackMono8( &source[0], nPixels, eFormat, &result8[0], NULL, levels[l] );      break;
+                    default:    UnpackMono8( &source[0], nPixels, eFormat, &result8[0], &lut[0], levels[l] );   break;
+                    }
+                    ++nRuns;
+                    dSeconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - tStart ).count();
+                }
+                while( dSeconds < 0.2 );
+                dRates[o] = source.size() * static_cast<double>( nRuns ) / dSeconds / 1.0e9;
+            }
+            std::cout<<"    "<<NAMES[f]<<" "<<SimdLevelToName( levels[l] )<<": "<<dRates[0]<<" / "<<dRates[1]<<" / "<<dRates[2]<<"\n";
+        }
+    }
+}
+
+} // namespace
+
+/**
+ * @brief Checks the SIMD kernels against their scalar reference.
+ * Returns 0 if all tests pass, so it runs under ctest. With --bench it measures the throughput instead
+ */
+int main( int argc, char* argv[] )
+{
+    std::cout<<"Detected "<<SimdLevelToName( DetectSimdLevel() )<<"\n";
+    const std::vector<SimdLevel> levels = SupportedLevels();
+    if( argc > 1 && 0 == std::strcmp( argv[1], "--bench" ))
+    {
+        BenchmarkUnpack( levels );
+        return 0;
+    }
+
+    bool bPassed = true;
+    bPassed = TestDemosaicLevels( levels ) && bPassed;
+    bPassed = TestDemosaicBands() && bPassed;
+    bPassed = TestDemosaicFlat() && bPassed;
+    bPassed = TestColorCorrection( levels ) && bPassed;
+    bPassed = TestUnpack( levels ) && bPassed;
+
+    std::cout<<( bPassed ? "All tests passed\n" : "Tests FAILED\n" );
+    return bPassed ? 0 : 1;
+}
@@ -0,0 +1,533 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "FrameRecorder.h"
+#include "PlaybackFrameSource.h"
+#include "PixelFormat.h"
+#include "StripeCodec.h"
+
+using namespace AVT::VmbAPI;
+
+namespace {
+
+const char * const  RECORDING_FILE      = "recordingTests.vrec";
+const char * const  TRUNCATED_FILE      = "recordingTests-truncated.vrec";
+const char * const  CAMERA_ID           = "DEV_RECORDING_TEST";
+const VmbUint64_t   TIMESTAMP_FREQUENCY = 1000000000ULL;
+
+/**
+ * @brief xorshift, so every run tests the same images
+ */
+class Random
+{
+    public:
+        explicit Random( VmbUint64_t nSeed )
+            :   m_nState( nSeed )
+        {}
+
+        VmbUint32_t Next()
+        {
+            m_nState ^= m_nState << 13;
+            m_nState ^= m_nState >> 7;
+            m_nState ^= m_nState << 17;
+            return static_cast<VmbUint32_t>( m_nState >> 32 );
+        }
+
+    private:
+        VmbUint64_t m_nState;
+};
+
+/**
+ * @brief A frame as a camera would hand it to the recorder, with the image it points to
+ */
+struct TestFrame
+{
+    SourceFrame                 Frame;
+    std::vector<VmbUchar_t>     Image;
+};
+
+/**
+ * @brief Frames of changing formats and sizes with a gap in the frame IDs. The images are smooth
+ * with some noise like a sensor's, so they compress but not to nothing
+ */
+std::vector<TestFrame> MakeFrames( size_t nCount )
+{
+    static const VmbPixelFormatType FORMATS[]   = { VmbPixelFormatMono8, VmbPixelFormatMono12, VmbPixelFormatBayerRG12, VmbPixelFormatMono12p };
+    static const VmbUint32_t        WIDTHS[]    = { 64, 100, 36, 50 };
+    static const VmbUint32_t        HEIGHTS[]   = { 48, 30, 22, 17 };
+    Random random( 0x2545F4914F6CDD1DULL );
+    std::vector<TestFrame> frames( nCount );
+    for( size_t i = 0; i < nCount; ++i )
+    {
+        const size_t nKind = i % 4;
+        SourceFrame &frame      = frames[i].Frame;
+        frame.Width             = WIDTHS[ nKind ];
+        frame.Height            = HEIGHTS[ nKind ];
+        frame.PixelFormat       = FORMATS[ nKind ];
+        frame.bPixelFormatValid = true;
+        frame.FrameID           = 1000 + i + ( i >= nCount / 2 ? 5 : 0 );
+        frame.bFrameIDValid     = true;
+        frame.Timestamp         = 5000000ULL + i * 16666667ULL;
+        frame.ReceiveTime       = 7000000ULL + i * 16666667ULL;
+        frame.ReceiveStatus     = 0 == i % 7 ? VmbFrameStatusIncomplete : VmbFrameStatusComplete;
+        frame.bReceiveStatusValid = true;
+        frame.OffsetX           = static_cast<VmbUint32_t>( 2 * i );
+        frame.OffsetY           = static_cast<VmbUint32_t>( i );
+        frame.ImageSize         = PixelFormatImageSize( frame.PixelFormat, frame.Width, frame.Height );
+
+        std::vector<VmbUchar_t> &image = frames[i].Image;
+        image.resize( frame.ImageSize );
+        for( size_t b = 0; b < image.size(); ++b )
+        {
+            image[b] = static_cast<VmbUchar_t>(( b / 7 + i * 3 ) + ( random.Next() % 5 ));
+        }
+        // Unpacked 12 bit words keep their top nibble clear like a camera's
+        if( VmbPixelFormatMono12 == frame.PixelFormat || VmbPixelFormatBayerRG12 == frame.PixelFormat )
+        {
+            for( size_t b = 1; b < image.size(); b += 2 )
+            {
+                image[b] &= 0x0F;
+            }
+        }
+        frame.pBuffer = &image[0];
+    }
+    return frames;
+}
+
+bool ReadFile( const char *pFileName, std::vector<VmbUchar_t> &Data )
+{
+    std::ifstream file( pFileName, std::ios::binary );
+    Data.assign( std::istreambuf_iterator<char>( file ), std::istreambuf_iterator<char>() );
+    return file.good() || file.eof();
+}
+
+bool WriteFile( const char *pFileName, const VmbUchar_t *pData, size_t nSize )
+{
+    std::ofstream file( pFileName, std::ios::binary | std::ios::trunc );
+    file.write( reinterpret_cast<const char*>( pData ), static_cast<std::streamsize>( nSize ));
+    return file.good();
+}
+
+VmbUint64_t AlignRecord( VmbUint64_t nSize )
+{
+    return ( nSize + RECORDING_ALIGNMENT - 1 ) / RECORDING_ALIGNMENT * RECORDING_ALIGNMENT;
+}
+
+/**
+ * @brief Records the frames, compressed with bCompress. The codec drops a frame if all of its buffers
+ * are taken, so every frame is waited for until it is written
+ */
+bool RecordFrames( const std::vector<TestFrame> &Frames, bool bCompress = false )
+{
+    FrameRecorder recorder( bCompress, 2 );
+    if( VmbErrorSuccess != recorder.Open( RECORDING_FILE, CAMERA_ID, TIMESTAMP_FREQUENCY ))
+    {
+        std::cout<<"Recording to "<<RECORDING_FILE<<" failed to open\n";
+        return false;
+    }
+    for( size_t i = 0; i < Frames.size(); ++i )
+    {
+        recorder.Record( Frames[i].Frame );
+        const std::chrono::steady_clock::time_point tGiveUp = std::chrono::steady_clock::now() + std::chrono::seconds( 10 );
+        while(      ( bCompress )
+                &&  ( recorder.GetStatistics().Frames + recorder.GetStatistics().Dropped <= i )
+                &&  ( std::chrono::steady_clock::now() < tGiveUp ))
+        {
+            std::this_thread::sleep_for( std::chrono::milliseconds( 1 ));
+        }
+    }
+    const VmbErrorType res = recorder.Close();
+    const RecordStatistics stats = recorder.GetStatistics();
+    if( VmbErrorSuccess != res || stats.Frames != Frames.size() || 0 != stats.Dropped )
+    {
+        std::cout<<"Recording wrote "<<stats.Frames<<" of "<<Frames.size()<<" frames, dropped "<<stats.Dropped<<"\n";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief The header of a record carries the metadata of its frame
+ */
+bool SameFrame( const RecordingFrameHeader &Header, const SourceFrame &Frame )
+{
+    return  ( Header.FrameID == Frame.FrameID )
+        &&  ( Header.Timestamp == Frame.Timestamp )
+        &&  ( Header.ReceiveTime == Frame.ReceiveTime )
+        &&  ( Header.ImageSize == Frame.ImageSize )
+        &&  ( Header.Width == Frame.Width )
+        &&  ( Header.Height == Frame.Height )
+        &&  ( Header.OffsetX == Frame.OffsetX )
+        &&  ( Header.OffsetY == Frame.OffsetY )
+        &&  ( Header.PixelFormat == Frame.PixelFormat )
+        &&  ( Header.ReceiveStatus == Frame.ReceiveStatus )
+        &&  (( Header.Flags & ~static_cast<VmbUint32_t>( RecordingFrame_Compressed )) == ( RecordingFrame_FrameIDValid | RecordingFrame_PixelFormatValid | RecordingFrame_ReceiveStatusValid ));
+}
+
+/**
+ * @brief Walks the records of a closed recording from the file header on, reading the file on its own
+ * instead of through PlaybackFrameSource, and checks them against the frames, the index and the trailer
+ *
+ * @param Offsets Receives the offset of every record
+ */
+bool CheckRecording( const std::vector<VmbUchar_t> &File, const std::vector<TestFrame> &Frames, std::vector<VmbUint64_t> &Offsets )
+{
+    if( File.size() < sizeof( RecordingFileHeader ) + sizeof( RecordingTrailer ))
+    {
+        std::cout<<"Recording of "<<File.size()<<" bytes is too short\n";
+        return false;
+    }
+    RecordingFileHeader header;
+    std::memcpy( &header, &File[0], sizeof( header ));
+    if(     ( RECORDING_FILE_MAGIC != header.Magic || RECORDING_VERSION != header.Version )
+        ||  ( sizeof( RecordingFileHeader ) != header.HeaderSize )
+        ||  ( TIMESTAMP_FREQUENCY != header.TimestampFrequency )
+        ||  ( 0 != std::strcmp( header.CameraID, CAMERA_ID )))
+    {
+        std::cout<<"Recording has a wrong file header\n";
+        return false;
+    }
+
+    VmbUint64_t nOffset = header.HeaderSize;
+    VmbUint64_t nPayloadBytes = 0;
+    Offsets.clear();
+    for( size_t i = 0; i < Frames.size(); ++i )
+    {
+        RecordingFrameHeader record;
+        if( nOffset + sizeof( record ) > File.size() )
+        {
+            std::cout<<"Record "<<i<<" lies past the end of the file\n";
+            return false;
+        }
+        std::memcpy( &record, &File[ nOffset ], sizeof( record ));
+        if(     ( RECORDING_FRAME_MAGIC != record.Magic || sizeof( record ) != record.HeaderSize )
+            ||  ( 0 != nOffset % RECORDING_ALIGNMENT )
+            ||  ( nOffset + record.HeaderSize + record.StoredSize > File.size() )
+            ||  ( !SameFrame( record, Frames[i].Frame )))
+        {
+            std::cout<<"Record "<<i<<" at offset "<<nOffset<<" does not match its frame\n";
+            return false;
+        }
+        if(     ( 0 == ( record.Flags & RecordingFrame_Compressed ))
+            &&  (   ( record.StoredSize != record.ImageSize )
+                ||  ( 0 != std::memcmp( &File[ nOffset + record.HeaderSize ], &Frames[i].Image[0], record.ImageSize ))))
+        {
+            std::cout<<"Record "<<i<<" does not hold the image of its frame\n";
+            return false;
+        }
+        Offsets.push_back( nOffset );
+        nPayloadBytes += record.ImageSize;
+        nOffset += AlignRecord( record.HeaderSize + static_cast<VmbUint64_t>( record.StoredSize ));
+    }
+
+    RecordingTrailer trailer;
+    std::memcpy( &trailer, &File[ File.size() - sizeof( trailer ) ], sizeof( trailer ));
+    if(     ( RECORDING_TRAILER_MAGIC != trailer.Magic )
+        ||  ( nOffset != trailer.IndexOffset )
+        ||  ( Frames.size() != trailer.FrameCount )
+        ||  ( nPayloadBytes != trailer.PayloadBytes )
+        ||  ( trailer.IndexOffset + trailer.FrameCount * sizeof( RecordingIndexEntry ) + sizeof( trailer ) != File.size() ))
+    {
+        std::cout<<"Trailer does not match the records\n";
+        return false;
+    }
+    for( size_t i = 0; i < Frames.size(); ++i )
+    {
+        RecordingIndexEntry entry;
+        std::memcpy( &entry, &File[ trailer.IndexOffset + i * sizeof( entry ) ], sizeof( entry ));
+        if(     ( Offsets[i] != entry.Offset )
+            ||  ( Frames[i].Frame.FrameID != entry.FrameID )
+            ||  ( Frames[i].Frame.Timestamp != entry.Timestamp ))
+        {
+            std::cout<<"Index entry "<<i<<" does not match record "<<i<<"\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Restores the image of a compressed record from its stripe table, reading the layout
+ * RecordingFormat.h documents rather than going through PlaybackFrameSource
+ */
+bool DecodeRecord( const VmbUchar_t *pRecord, std::vector<VmbUchar_t> &Image )
+{
+    RecordingFrameHeader record;
+    std::memcpy( &record, pRecord, sizeof( record ));
+    const VmbUchar_t    *pPayload = pRecord + record.HeaderSize;
+    StripeLayout        layout;
+    RecordingStripesHeader stripes;
+    std::memcpy( &stripes, pPayload, sizeof( stripes ));
+    if(     ( !GetStripeLayout( record.PixelFormat, record.Width, record.Height, record.ImageSize, layout ))
+        ||  ( 0 == stripes.RowsPerStripe )
+        ||  ( stripes.StripeCount != ( layout.Rows + stripes.RowsPerStripe - 1 ) / stripes.RowsPerStripe ))
+    {
+        return false;
+    }
+    std::vector<VmbUint32_t> sizes( stripes.StripeCount );
+    std::memcpy( &sizes[0], pPayload + sizeof( stripes ), sizes.size() * sizeof( VmbUint32_t ));
+    VmbUint64_t nOffset = AlignRecord( sizeof( stripes ) + sizes.size() * sizeof( VmbUint32_t ));
+    Image.assign( record.ImageSize, 0 );
+    for( VmbUint32_t i = 0; i < stripes.StripeCount; ++i )
+    {
+        const VmbUint32_t nFirstRow = i * stripes.RowsPerStripe;
+        const VmbUint32_t nRows     = layout.Rows - nFirstRow < stripes.RowsPerStripe ? layout.Rows - nFirstRow : stripes.RowsPerStripe;
+        if(     ( nOffset + sizes[i] > record.StoredSize )
+            ||  ( !DecodeStripe( layout, pPayload + nOffset, sizes[i], nRows, &Image[ static_cast<size_t>( nFirstRow ) * layout.RowBytes ] )))
+        {
+            return false;
+        }
+        nOffset += sizes[i];
+    }
+    return nOffset == record.StoredSize;
+}
+
+/**
+ * @brief Opens a recording for playback the way /y: does
+ *
+ * @return The frames its index holds, or -1 if it does not open
+ */
+long long PlaybackFrameCount( const char *pFileName )
+{
+    PlaybackFrameSource source( pFileName, PlaybackConfig(), 3 );
+    if( VmbErrorSuccess != source.Open() )
+    {
+        return -1;
+    }
+    const long long nFrames = static_cast<long long>( source.GetFrameCount() );
+    if( CAMERA_ID != source.GetID() || TIMESTAMP_FREQUENCY != source.GetTimestampFrequency() )
+    {
+        std::cout<<"Playback of "<<pFileName<<" reports a wrong camera\n";
+        return -1;
+    }
+    source.Close();
+    return nFrames;
+}
+
+/**
+ * @brief Records frames, checks the file against them record by record, and checks that playback finds
+ * the same frames through the trailing index and, after the trailer was cut off, by walking the records
+ */
+bool TestRecordingIndex()
+{
+    const std::vector<TestFrame> frames = MakeFrames( 40 );
+    std::vector<VmbUchar_t> file;
+    std::vector<VmbUint64_t> offsets;
+    if(     ( !RecordFrames( frames ))
+        ||  ( !ReadFile( RECORDING_FILE, file ))
+        ||  ( !CheckRecording( file, frames, offsets )))
+    {
+        return false;
+    }
+    const long long nIndexed = PlaybackFrameCount( RECORDING_FILE );
+    if( static_cast<long long>( frames.size() ) != nIndexed )
+    {
+        std::cout<<"Playback indexes "<<nIndexed<<" of "<<frames.size()<<" frames\n";
+        return false;
+    }
+
+    // A recording cut off in its last record, as by a crash, loses that record only
+    if(     ( !WriteFile( TRUNCATED_FILE, &file[0], offsets.back() + 10 ))
+        ||  ( static_cast<long long>( frames.size() ) - 1 != PlaybackFrameCount( TRUNCATED_FILE )))
+    {
+        std::cout<<"Playback of a truncated recording does not rebuild its index\n";
+        return false;
+    }
+    std::remove( TRUNCATED_FILE );
+    std::remove( RECORDING_FILE );
+    std::cout<<"Recording: "<<frames.size()<<" records match their frames, index and playback\n";
+    return true;
+}
+
+/**
+ * @brief An uncompressed record claiming a larger image than it stores is damaged: playback must not
+ * hand out the bytes past it. Walking the records without the index stops in front of it
+ */
+bool TestDamagedRecord()
+{
+    const std::vector<TestFrame> frames = MakeFrames( 12 );
+    std::vector<VmbUchar_t> file;
+    std::vector<VmbUint64_t> offsets;
+    if(     ( !RecordFrames( frames ))
+        ||  ( !ReadFile( RECORDING_FILE, file ))
+        ||  ( !CheckRecording( file, frames, offsets )))
+    {
+        return false;
+    }
+    RecordingTrailer trailer;
+    std::memcpy( &trailer, &file[ file.size() - sizeof( trailer ) ], sizeof( trailer ));
+
+    const size_t nDamaged = 5;
+    RecordingFrameHeader record;
+    std::memcpy( &record, &file[ offsets[ nDamaged ]], sizeof( record ));
+    record.StoredSize -= 2 * RECORDING_ALIGNMENT;
+    std::memcpy( &file[ offsets[ nDamaged ]], &record, sizeof( record ));
+    if(     ( !WriteFile( TRUNCATED_FILE, &file[0], trailer.IndexOffset ))
+        ||  ( static_cast<long long>( nDamaged ) != PlaybackFrameCount( TRUNCATED_FILE )))
+    {
+        std::cout<<"Playback indexes a record storing less than its image\n";
+        return false;
+    }
+
+    // The last record growing its image would reach past the end of the mapping
+    record.StoredSize += 2 * RECORDING_ALIGNMENT;
+    std::memcpy( &file[ offsets[ nDamaged ]], &record, sizeof( record ));
+    std::memcpy( &record, &file[ offsets.back() ], sizeof( record ));
+    record.ImageSize += 4096;
+    std::memcpy( &file[ offsets.back() ], &record, sizeof( record ));
+    if(     ( !WriteFile( TRUNCATED_FILE, &file[0], trailer.IndexOffset ))
+        ||  ( static_cast<long long>( frames.size() ) - 1 != PlaybackFrameCount( TRUNCATED_FILE )))
+    {
+        std::cout<<"Playback indexes a last record claiming more than it stores\n";
+        return false;
+    }
+    std::remove( TRUNCATED_FILE );
+    std::remove( RECORDING_FILE );
+    std::cout<<"Recording: damaged records are not played back\n";
+    return true;
+}
+
+/**
+ * @brief Codes the images of every recorded format, and random bytes that do not compress, in stripes
+ * of several heights and checks that decoding restores them bit for bit. Damaged input must be
+ * rejected or at least decode without reading or writing out of bounds
+ */
+bool TestStripeCodec()
+{
+    static const VmbUint32_t STRIPE_HEIGHTS[] = { 1, 3, 8, 1000 };
+    std::vector<TestFrame> frames = MakeFrames( 8 );
+    Random random( 0x9E3779B97F4A7C15ULL );
+    for( size_t i = 4; i < frames.size(); ++i )
+    {
+        for( size_t b = 0; b < frames[i].Image.size(); ++b )
+        {
+            frames[i].Image[b] = static_cast<VmbUchar_t>( random.Next() );
+        }
+    }
+
+    size_t nImageBytes = 0;
+    size_t nCodedBytes = 0;
+    for( size_t i = 0; i < frames.size(); ++i )
+    {
+        const SourceFrame   &frame = frames[i].Frame;
+        StripeLayout        layout;
+        if( !GetStripeLayout( frame.PixelFormat, frame.Width, frame.Height, frame.ImageSize, layout ))
+        {
+            std::cout<<"Codec has no layout for "<<PixelFormatToName( frame.PixelFormat )<<"\n";
+            return false;
+        }
+        for( size_t h = 0; h < sizeof( STRIPE_HEIGHTS ) / sizeof( STRIPE_HEIGHTS[0] ); ++h )
+        {
+            const VmbUint32_t nStripeRows = STRIPE_HEIGHTS[h] < layout.Rows ? STRIPE_HEIGHTS[h] : layout.Rows;
+            std::vector<VmbUchar_t> coded( MaxEncodedStripeSize( layout, nStripeRows ));
+            std::vector<VmbUchar_t> decoded( frames[i].Image.size() );
+            for( VmbUint32_t nFirstRow = 0; nFirstRow < layout.Rows; nFirstRow += nStripeRows )
+            {
+                const VmbUint32_t   nRows   = layout.Rows - nFirstRow < nStripeRows ? layout.Rows - nFirstRow : nStripeRows;
+                const size_t        nStart  = static_cast<size_t>( nFirstRow ) * layout.RowBytes;
+                const size_t        nCoded  = EncodeStripe( layout, &frames[i].Image[ nStart ], nRows, &coded[0] );
+                if(     ( nCoded > MaxEncodedStripeSize( layout, nRows ))
+                    ||  ( !DecodeStripe( layout, &coded[0], nCoded, nRows, &decoded[ nStart ] )))
+                {
+                    std::cout<<"Codec fails on "<<PixelFormatToName( frame.PixelFormat )<<" rows "<<nFirstRow<<" to "<<nFirstRow + nRows<<"\n";
+                    return false;
+                }
+                nImageBytes += nRows * layout.RowBytes;
+                nCodedBytes += nCoded;
+
+                // Cut short the stream misses codes, garbled it may decode to anything but within bounds
+                if( nCoded > 1 && DecodeStripe( layout, &coded[0], nCoded - 1, nRows, &decoded[ nStart ] ))
+                {
+                    std::cout<<"Codec decodes a truncated "<<PixelFormatToName( frame.PixelFormat )<<" stripe\n";
+                    return false;
+                }
+                std::vector<VmbUchar_t> garbled( coded.begin(), coded.begin() + nCoded );
+                for( size_t b = 0; b < garbled.size(); b += 5 )
+                {
+                    garbled[b] = static_cast<VmbUchar_t>( random.Next() );
+                }
+                DecodeStripe( layout, &garbled[0], garbled.size(), nRows, &decoded[ nStart ] );
+                DecodeStripe( layout, &coded[0], nCoded, nRows, &decoded[ nStart ] );
+            }
+            if( decoded != frames[i].Image )
+            {
+                std::cout<<"Codec does not restore "<<PixelFormatToName( frame.PixelFormat )<<" in stripes of "<<nStripeRows<<" rows\n";
+                return false;
+            }
+        }
+    }
+    std::cout<<"Codec: "<<frames.size()<<" images round trip, "<<nImageBytes<<" bytes coded to "<<nCodedBytes<<"\n";
+    return true;
+}
+
+/**
+ * @brief Records compressed, checks the container as for uncompressed recordings, decodes every
+ * compressed record back to its frame and checks that playback indexes all of them
+ */
+bool TestCompressedRecording()
+{
+    const std::vector<TestFrame> frames = MakeFrames( 16 );
+    std::vector<VmbUchar_t> file;
+    std::vector<VmbUint64_t> offsets;
+    if(     ( !RecordFrames( frames, true ))
+        ||  ( !ReadFile( RECORDING_FILE, file ))
+        ||  ( !CheckRecording( file, frames, offsets )))
+    {
+        return false;
+    }
+    size_t nCompressed = 0;
+    for( size_t i = 0; i < frames.size(); ++i )
+    {
+        RecordingFrameHeader record;
+        std::memcpy( &record, &file[ offsets[i] ], sizeof( record ));
+        if( 0 == ( record.Flags & RecordingFrame_Compressed ))
+        {
+            continue;
+        }
+        std::vector<VmbUchar_t> image;
+        if( !DecodeRecord( &file[ offsets[i] ], image ) || image != frames[i].Image )
+        {
+            std::cout<<"Compressed record "<<i<<" does not decode to its frame\n";
+            return false;
+        }
+        ++nCompressed;
+    }
+    if( 0 == nCompressed )
+    {
+        std::cout<<"Compressed recording stores every frame as is\n";
+        return false;
+    }
+    const long long nIndexed = PlaybackFrameCount( RECORDING_FILE );
+    if( static_cast<long long>( frames.size() ) != nIndexed )
+    {
+        std::cout<<"Playback indexes "<<nIndexed<<" of "<<frames.size()<<" compressed frames\n";
+        return false;
+    }
+    std::remove( RECORDING_FILE );
+    std::cout<<"Recording: "<<nCompressed<<" of "<<frames.size()<<" compressed records decode to their frames\n";
+    return true;
+}
+
+} // namespace
+
+/**
+ * @brief Checks the stripe codec, the recording container and the playback of it.
+ * Works in the current directory and returns 0 if all tests pass, so it runs under ctest
+ */
+int main()
+{
+    bool bPassed = true;
+    bPassed = TestStripeCodec() && bPassed;
+    bPassed = TestRecordingIndex() && bPassed;
+    bPassed = TestDamagedRecord() && bPassed;
+    bPassed = TestCompressedRecording() && bPassed;
+
+    std::cout<<( bPassed ? "All tests passed\n" : "Tests FAILED\n" );
+    return bPassed ? 0 : 1;
+}
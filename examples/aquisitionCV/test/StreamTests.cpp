@@ -0,0 +1,641 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "CameraDevice.h"
+#include "CameraFrameSource.h"
+#include "FrameBufferSizer.h"
+#include "FrameObserver.h"
+#include "FrameSource.h"
+#include "FrameSynchronizer.h"
+#include "HostClock.h"
+#include "SimulatedCameraFeatures.h"
+
+using namespace AVT::VmbAPI;
+
+namespace {
+
+/**
+ * @brief A frame that arrives now, held for dHold seconds once it is handed back right away
+ */
+SourceFrame HeldFrame( VmbUint64_t nFrameID, double dHold )
+{
+    SourceFrame frame;
+    frame.FrameID       = nFrameID;
+    frame.bFrameIDValid = true;
+    frame.ReceiveTime   = GetHostTime() - static_cast<VmbUint64_t>( dHold * 1.0e9 );
+    return frame;
+}
+
+/**
+ * @brief One frame held for long raises the depth at once, but a steady state after it lets the hold
+ * estimate fall back, so buffers planned again are sized for the steady state and not for the stall
+ */
+bool TestBufferSizerForgetsStall()
+{
+    static const double         WINDOW          = 0.1;
+    static const double         FRAME_RATE      = 100.0;
+    static const double         STALL           = 0.3;
+    static const double         STEADY          = 0.01;
+    static const VmbUint32_t    PAYLOAD_SIZE    = 1000;
+
+    FrameBufferConfig config;
+    config.bAdaptive    = true;
+    config.Budget       = 1000 * PAYLOAD_SIZE;
+    FrameBufferSizer sizer( config, 3, WINDOW );
+    const VmbUint32_t nPlanned = sizer.Plan( PAYLOAD_SIZE, FRAME_RATE );
+    // Frames received before planning do not count, the stall has to start after it
+    std::this_thread::sleep_for( std::chrono::milliseconds( static_cast<int>( STALL * 1000.0 ) + 50 ));
+
+    VmbUint64_t nFrameID = 1;
+    SourceFrame stalled = HeldFrame( nFrameID++, STALL );
+    sizer.Delivered( stalled );
+    sizer.Requeued( stalled );
+    SourceFrame next = HeldFrame( nFrameID++, 0.0 );
+    const bool bRaised = sizer.Delivered( next );
+    sizer.Requeued( next );
+    const VmbUint32_t nStallTarget = sizer.GetTarget();
+    BufferDepthStatistics stats = sizer.GetStatistics();
+    if( !bRaised || nStallTarget < static_cast<VmbUint32_t>( STALL * FRAME_RATE ) || stats.RecentHoldTime < STALL )
+    {
+        std::cout<<"Buffer sizer: a stall of "<<STALL * 1000.0<<" ms planned from "<<nPlanned<<" frames raises the target to "<<nStallTarget
+                 <<", recent hold "<<stats.RecentHoldTime * 1000.0<<" ms\n";
+        return false;
+    }
+    sizer.Grown( nStallTarget );
+
+    // Steady state for more than two windows
+    const VmbUint64_t nSteadyEnd = GetHostTime() + static_cast<VmbUint64_t>( 3.5 * WINDOW * 1.0e9 );
+    while( GetHostTime() < nSteadyEnd )
+    {
+        SourceFrame frame = HeldFrame( nFrameID++, STEADY );
+        if( sizer.Delivered( frame ))
+        {
+            std::cout<<"Buffer sizer: steady state frames of "<<STEADY * 1000.0<<" ms raise the target to "<<sizer.GetTarget()<<"\n";
+            return false;
+        }
+        sizer.Requeued( frame );
+        std::this_thread::sleep_for( std::chrono::milliseconds( 5 ));
+    }
+    stats = sizer.GetStatistics();
+    if( stats.RecentHoldTime > 2 * STEADY || stats.MaxHoldTime < STALL )
+    {
+        std::cout<<"Buffer sizer: after the steady state the recent hold is "<<stats.RecentHoldTime * 1000.0<<" ms, the longest "
+                 <<stats.MaxHoldTime * 1000.0<<" ms\n";
+        return false;
+    }
+    // Planning again, e.g. after reconnecting, no longer keeps the stalled depth
+    const VmbUint32_t nReplanned = sizer.Plan( PAYLOAD_SIZE, FRAME_RATE );
+    if( nReplanned != nPlanned )
+    {
+        std::cout<<"Buffer sizer: planned "<<nReplanned<<" frames after the steady state instead of "<<nPlanned<<"\n";
+        return false;
+    }
+    std::cout<<"Buffer sizer: "<<nPlanned<<" frames, "<<nStallTarget<<" for a stall of "<<STALL * 1000.0<<" ms, "
+             <<nReplanned<<" again once it was forgotten\n";
+    return true;
+}
+
+/**
+ * @brief A camera the test plugs out and in. Every Open brings up SimulatedCameraFeatures with their
+ * defaults, like a camera that lost power, and forgets the frames announced before.
+ * The test delivers the queued frames itself
+ */
+class SimulatedCameraDevice : public ICameraDevice
+{
+    public:
+        static const VmbInt64_t SENSOR_WIDTH    = 640;
+        static const VmbInt64_t SENSOR_HEIGHT   = 480;
+
+        SimulatedCameraDevice()
+            :   m_pListener( NULL )
+            ,   m_bPresent( true )
+            ,   m_bCapturing( false )
+            ,   m_nFrameID( 0 )
+        {}
+
+        virtual VmbErrorType Open()
+        {
+            std::lock_guard<std::mutex> lock( m_Mutex );
+            if( !m_bPresent )
+            {
+                return VmbErrorNotFound;
+            }
+            m_pFeatures.reset( new SimulatedCameraFeatures( SENSOR_WIDTH, SENSOR_HEIGHT, std::vector<std::string>( 1, "Mono8" )));
+            m_Announced.clear();
+            return VmbErrorSuccess;
+        }
+        virtual VmbErrorType Close()
+        {
+            std::lock_guard<std::mutex> lock( m_Mutex );
+            m_pFeatures.reset();
+            return VmbErrorSuccess;
+        }
+        virtual ICameraFeatures* GetFeatures()
+        {
+            return m_pFeatures.get();
+        }
+        virtual VmbErrorType GetPayloadSize( VmbUint32_t &nPayloadSize )
+        {
+            VmbInt64_t nValue = 0;
+            const VmbErrorType res = m_pFeatures->GetInt( "PayloadSize", nValue );
+            nPayloadSize = static_cast<VmbUint32_t>( nValue );
+            return res;
+        }
+        virtual VmbErrorType AnnounceFrame( const FramePtr &pFrame, VmbUint32_t nSlot )
+        {
+            std::lock_guard<std::mutex> lock( m_Mutex );
+            m_Announced.push_back( std::make_pair( pFrame, nSlot ));
+            return VmbErrorSuccess;
+        }
+        virtual VmbErrorType StartCapture()
+        {
+            std::lock_guard<std::mutex> lock( m_Mutex );
+            m_bCapturing = true;
+            return VmbErrorSuccess;
+        }
+        virtual VmbErrorType QueueFrame( const FramePtr &pFrame )
+        {
+            std::lock_guard<std::mutex> lock( m_Mutex );
+            for( size_t i = 0; i < m_Announced.size() && m_bCapturing && m_bPresent; ++i )
+            {
+                if( SP_ISEQUAL( m_Announced[i].first, pFrame ))
+                {
+                    m_Queued.push_back( m_Announced[i] );
+                    return VmbErrorSuccess;
+                }
+            }
+            return VmbErrorInvalidCall;
+        }
+        virtual VmbErrorType StartAcquisition()
+        {
+            return VmbErrorSuccess;
+        }
+        virtual void EndCapture()
+        {
+            std::lock_guard<std::mutex> lock( m_Mutex );
+            m_bCapturing = false;
+            m_Queued.clear();
+        }
+        virtual std::string GetInterfaceID() const
+        {
+            return "eth0";
+        }
+        virtual void SetListener( ICameraDeviceListener *pListener )
+        {
+            m_pListener = pListener;
+        }
+
+        /**
+         * @brief Fills the oldest queued frame and passes it to the source
+         *
+         * @return false if no frame is queued
+         */
+        bool Deliver()
+        {
+            SourceFrame frame;
+            {
+                std::lock_guard<std::mutex> lock( m_Mutex );
+                if( m_Queued.empty() )
+                {
+                    return false;
+                }
+                frame.pFrame    = m_Queued.front().first;
+                frame.nSlot     = m_Queued.front().second;
+                m_Queued.erase( m_Queued.begin() );
+                VmbInt64_t nWidth = 0;
+                VmbInt64_t nHeight = 0;
+                m_pFeatures->GetInt( "Width", nWidth );
+                m_pFeatures->GetInt( "Height", nHeight );
+                frame.Width     = static_cast<VmbUint32_t>( nWidth );
+                frame.Height    = static_cast<VmbUint32_t>( nHeight );
+                frame.ImageSize = frame.Width * frame.Height;
+            }
+            SP_ACCESS( frame.pFrame )->GetBuffer( frame.pBuffer );
+            frame.bPixelFormatValid     = true;
+            frame.FrameID               = ++m_nFrameID;
+            frame.bFrameIDValid         = true;
+            frame.ReceiveTime           = GetHostTime();
+            frame.ReceiveStatus         = VmbFrameStatusComplete;
+            frame.bReceiveStatusValid   = true;
+            m_pListener->FrameReceived( frame );
+            return true;
+        }
+        /**
+         * @brief Waits for the source to queue frames, i.e. to have started the camera
+         */
+        bool WaitForQueued( double dTimeout )
+        {
+            const VmbUint64_t nEnd = GetHostTime() + static_cast<VmbUint64_t>( dTimeout * 1.0e9 );
+            while( GetHostTime() < nEnd )
+            {
+                {
+                    std::lock_guard<std::mutex> lock( m_Mutex );
+                    if( !m_Queued.empty() )
+                    {
+                        return true;
+                    }
+                }
+                std::this_thread::sleep_for( std::chrono::milliseconds( 5 ));
+            }
+            return false;
+        }
+        void Unplug()
+        {
+            {
+                std::lock_guard<std::mutex> lock( m_Mutex );
+                m_bPresent = false;
+            }
+            m_pListener->CameraListChanged( UpdateTriggerPluggedOut );
+        }
+        void Plug()
+        {
+            {
+                std::lock_guard<std::mutex> lock( m_Mutex );
+                m_bPresent = true;
+            }
+            m_pListener->CameraListChanged( UpdateTriggerPluggedIn );
+        }
+        std::vector<FramePtr> GetAnnounced()
+        {
+            std::lock_guard<std::mutex> lock( m_Mutex );
+            std::vector<FramePtr> frames;
+            for( size_t i = 0; i < m_Announced.size(); ++i )
+            {
+                frames.push_back( m_Announced[i].first );
+            }
+            return frames;
+        }
+
+    private:
+        typedef std::pair<FramePtr, VmbUint32_t> AnnouncedFrame;
+
+        std::mutex              m_Mutex;
+        std::unique_ptr<SimulatedCameraFeatures> m_pFeatures;   // While open
+        ICameraDeviceListener * m_pListener;
+        bool                    m_bPresent;
+        bool                    m_bCapturing;
+        std::vector<AnnouncedFrame> m_Announced;
+        std::vector<AnnouncedFrame> m_Queued;
+        VmbUint64_t             m_nFrameID;
+};
+
+/**
+ * @brief A camera plugged out while streaming and back in comes up with its defaults. The source
+ * writes the geometry and the gain set while streaming again from its journal, announces the same
+ * frames and times the first frame after the camera reappeared
+ */
+bool TestCameraReconnect()
+{
+    static const VmbUint32_t    FRAMES  = 4;
+    static const double         GAIN    = 6.0;
+
+    SimulatedCameraDevice *pDevice = new SimulatedCameraDevice;
+    GeometryRequest geometry;
+    geometry.Width  = 320;
+    geometry.Height = 240;
+    CameraFrameSource source( std::unique_ptr<ICameraDevice>( pDevice ), "DEV_SIMULATED", FRAMES, FrameAllocation_AnnounceFrame, geometry );
+    if( VmbErrorSuccess != source.Open() )
+    {
+        std::cout<<"Reconnect: opening the simulated camera failed\n";
+        return false;
+    }
+    ProgramConfig config;
+    bool bPassed = true;
+    {
+        FrameObserver observer( source, config );
+        if( VmbErrorSuccess != source.StartAcquisition( &observer ))
+        {
+            std::cout<<"Reconnect: starting the simulated camera failed\n";
+            source.Close();
+            return false;
+        }
+        source.GetFeatures()->SetFloat( "Gain", GAIN );
+        const std::vector<FramePtr> announced = pDevice->GetAnnounced();
+        for( VmbUint32_t i = 0; i < 2 * FRAMES; ++i )
+        {
+            pDevice->Deliver();
+        }
+
+        pDevice->Unplug();
+        // Out for a moment, the reconnect thread releases the camera meanwhile
+        std::this_thread::sleep_for( std::chrono::milliseconds( 50 ));
+        pDevice->Plug();
+        const bool bRestarted = pDevice->WaitForQueued( 2.0 );
+        const bool bDelivered = bRestarted && pDevice->Deliver();
+
+        VmbInt64_t nWidth = 0;
+        VmbInt64_t nHeight = 0;
+        double dGain = 0.0;
+        ICameraFeatures * const pFeatures = pDevice->GetFeatures();
+        if(     ( NULL == pFeatures )
+            ||  ( VmbErrorSuccess != pFeatures->GetInt( "Width", nWidth ))
+            ||  ( VmbErrorSuccess != pFeatures->GetInt( "Height", nHeight ))
+            ||  ( VmbErrorSuccess != pFeatures->GetFloat( "Gain", dGain )))
+        {
+            std::cout<<"Reconnect: the features of the reconnected camera cannot be read\n";
+            bPassed = false;
+        }
+        else if( static_cast<VmbInt64_t>( geometry.Width ) != nWidth || static_cast<VmbInt64_t>( geometry.Height ) != nHeight || GAIN != dGain )
+        {
+            std::cout<<"Reconnect: the camera came back with "<<nWidth<<"x"<<nHeight<<" and a gain of "<<dGain<<" dB instead of "
+                     <<geometry.Width<<"x"<<geometry.Height<<" and "<<GAIN<<" dB\n";
+            bPassed = false;
+        }
+        const std::vector<FramePtr> reannounced = pDevice->GetAnnounced();
+        bool bSameFrames = announced.size() == reannounced.size() && FRAMES <= announced.size();
+        for( size_t i = 0; i < announced.size() && bSameFrames; ++i )
+        {
+            bSameFrames = i < reannounced.size() && SP_ISEQUAL( announced[i], reannounced[i] );
+        }
+        const ReconnectStatistics stats = source.GetReconnectStatistics();
+        if( !bRestarted || !bDelivered || !bSameFrames )
+        {
+            std::cout<<"Reconnect: "<<( bRestarted ? "" : "not restarted, " )<<( bDelivered ? "" : "no frame after the restart, " )
+                     <<reannounced.size()<<" frames announced again, "<<announced.size()<<( bSameFrames ? " the same\n" : " before, not the same\n" );
+            bPassed = false;
+        }
+        if( 1 != stats.Losses || 1 != stats.Reconnects || 0 != stats.Reallocations || stats.LastTimeToFirstFrame <= 0.0 )
+        {
+            std::cout<<"Reconnect: "<<stats.Losses<<" losses, "<<stats.Reconnects<<" reconnects, "<<stats.Reallocations<<" reallocations, "
+                     <<stats.LastTimeToFirstFrame * 1000.0<<" ms to the first frame\n";
+            bPassed = false;
+        }
+        else if( bPassed )
+        {
+            std::cout<<"Reconnect: "<<reannounced.size()<<" frames announced again, "<<nWidth<<"x"<<nHeight<<" at "<<dGain<<" dB, first frame after "
+                     <<stats.LastTimeToFirstFrame * 1000.0<<" ms\n";
+        }
+        source.StopAcquisition();
+    }
+    source.Close();
+    return bPassed;
+}
+
+/**
+ * @brief Takes frames back and counts them, for pushing frames without a camera
+ */
+class CountingFrameSource : public IFrameSource
+{
+    public:
+        CountingFrameSource()
+            :   m_nQueued( 0 )
+        {}
+
+        virtual VmbErrorType Open()                                 { return VmbErrorSuccess; }
+        virtual VmbErrorType StartAcquisition( FrameObserver * )    { return VmbErrorSuccess; }
+        virtual VmbErrorType StopAcquisition()                      { return VmbErrorSuccess; }
+        virtual VmbErrorType Close()                                { return VmbErrorSuccess; }
+        virtual VmbErrorType QueueFrame( const SourceFrame & )
+        {
+            m_nQueued.fetch_add( 1 );
+            return VmbErrorSuccess;
+        }
+        virtual std::string GetID() const                           { return "counting"; }
+        virtual VmbUint64_t GetTimestampFrequency() const           { return 1000000000ULL; }
+
+        unsigned int GetQueued() const
+        {
+            return m_nQueued.load();
+        }
+
+    private:
+        std::atomic<unsigned int> m_nQueued;
+};
+
+/**
+ * @brief A complete frame with an ID, received at nReceiveTime
+ */
+SourceFrame TriggeredFrame( VmbUint64_t nFrameID, VmbUint64_t nReceiveTime )
+{
+    SourceFrame frame;
+    frame.FrameID               = nFrameID;
+    frame.bFrameIDValid         = true;
+    frame.ReceiveTime           = nReceiveTime;
+    frame.ReceiveStatus         = VmbFrameStatusComplete;
+    frame.bReceiveStatusValid   = true;
+    return frame;
+}
+
+/**
+ * @brief Two triggered cameras matched by frame ID, one of them restarts its frame IDs after an outage
+ * while the other keeps counting. Its frames are bundled again from the first one on, even though it
+ * arrives just ahead of its partner, instead of being late until its IDs caught up
+ */
+bool TestSynchronizerRestart()
+{
+    static const VmbUint64_t    FRAMES  = 20;
+    static const VmbUint64_t    OUTAGE  = 50;
+    static const VmbUint64_t    PERIOD  = 10000000;     // ns
+    static const VmbUint64_t    SKEW    = 1000000;      // ns the second camera is behind or, after the restart, ahead
+
+    ProgramConfig config;
+    char strProgram[]   = "streamTests";
+    char strBundles[]   = "/b:id";
+    char *argv[]        = { strProgram, strBundles };
+    if( VmbErrorSuccess != config.ParseCommandline( 2, argv ))
+    {
+        std::cout<<"Synchronizer: /b:id is not accepted\n";
+        return false;
+    }
+    CountingFrameSource sources[2];
+    BundleStatistics stats;
+    {
+        FrameSynchronizer synchronizer( 2, config );
+        synchronizer.SetInput( 0, &sources[0] );
+        synchronizer.SetInput( 1, &sources[1] );
+        synchronizer.Start();
+
+        const VmbUint64_t nStart = GetHostTime();
+        VmbUint64_t nFrameID = 1;
+        for( ; nFrameID <= FRAMES; ++nFrameID )
+        {
+            synchronizer.Push( 0, TriggeredFrame( nFrameID, nStart + nFrameID * PERIOD ));
+            synchronizer.Push( 1, TriggeredFrame( nFrameID, nStart + nFrameID * PERIOD + SKEW ));
+        }
+        for( ; nFrameID <= FRAMES + OUTAGE; ++nFrameID )
+        {
+            synchronizer.Push( 0, TriggeredFrame( nFrameID, nStart + nFrameID * PERIOD ));
+        }
+        for( VmbUint64_t nRestartedID = 1; nRestartedID <= FRAMES; ++nRestartedID, ++nFrameID )
+        {
+            synchronizer.Push( 1, TriggeredFrame( nRestartedID, nStart + nFrameID * PERIOD - SKEW ));
+            synchronizer.Push( 0, TriggeredFrame( nFrameID, nStart + nFrameID * PERIOD ));
+        }
+        synchronizer.Stop();
+        stats = synchronizer.GetStatistics();
+    }
+    const VmbUint64_t nBundles = stats.Bundles + stats.Dropped;
+    const bool bReturned = sources[0].GetQueued() == FRAMES + OUTAGE + FRAMES && sources[1].GetQueued() == FRAMES + FRAMES;
+    if( 2 * FRAMES != nBundles || 1 != stats.Restarts || 0 != stats.Late || !bReturned )
+    {
+        std::cout<<"Synchronizer: "<<nBundles<<" bundles of "<<2 * FRAMES<<", "<<stats.Restarts<<" restarts, "<<stats.Late<<" late, "
+                 <<stats.Unmatched<<" unmatched, "<<sources[0].GetQueued()<<" and "<<sources[1].GetQueued()<<" frames handed back\n";
+        return false;
+    }
+    std::cout<<"Synchronizer: "<<nBundles<<" bundles, "<<FRAMES<<" of them after a camera restarted its frame IDs\n";
+    return true;
+}
+
+/**
+ * @brief Records the frames handed back. Frames handed back by any thread but the producer wait
+ * until Release, so the worker of a FrameObserver can be held inside its first frame
+ */
+class GatedFrameSource : public IFrameSource
+{
+    public:
+        GatedFrameSource()
+            :   m_Producer( std::this_thread::get_id() )
+            ,   m_bOpen( false )
+            ,   m_nWaiting( 0 )
+        {}
+
+        virtual VmbErrorType Open()                                 { return VmbErrorSuccess; }
+        virtual VmbErrorType StartAcquisition( FrameObserver * )    { return VmbErrorSuccess; }
+        virtual VmbErrorType StopAcquisition()                      { return VmbErrorSuccess; }
+        virtual VmbErrorType Close()                                { return VmbErrorSuccess; }
+        virtual VmbErrorType QueueFrame( const SourceFrame &Frame )
+        {
+            std::unique_lock<std::mutex> lock( m_Mutex );
+            if( std::this_thread::get_id() == m_Producer )
+            {
+                m_FromProducer.push_back( Frame.FrameID );
+            }
+            else
+            {
+                ++m_nWaiting;
+                m_Changed.notify_all();
+                m_Changed.wait( lock, [this]() { return m_bOpen; } );
+                --m_nWaiting;
+            }
+            m_Returned.push_back( Frame.FrameID );
+            return VmbErrorSuccess;
+        }
+        virtual std::string GetID() const                           { return "gated"; }
+        virtual VmbUint64_t GetTimestampFrequency() const           { return 1000000000ULL; }
+
+        /**
+         * @brief Waits for a frame handed back by another thread than the producer
+         */
+        bool WaitForWorker( double dTimeout )
+        {
+            std::unique_lock<std::mutex> lock( m_Mutex );
+            return m_Changed.wait_for( lock, std::chrono::milliseconds( static_cast<int>( dTimeout * 1000.0 )), [this]() { return 0 != m_nWaiting; } );
+        }
+        void Release()
+        {
+            {
+                std::lock_guard<std::mutex> lock( m_Mutex );
+                m_bOpen = true;
+            }
+            m_Changed.notify_all();
+        }
+        std::vector<VmbUint64_t> GetFromProducer()
+        {
+            std::lock_guard<std::mutex> lock( m_Mutex );
+            return m_FromProducer;
+        }
+        std::vector<VmbUint64_t> GetReturned()
+        {
+            std::lock_guard<std::mutex> lock( m_Mutex );
+            return m_Returned;
+        }
+
+    private:
+        const std::thread::id       m_Producer;
+        std::mutex                  m_Mutex;
+        std::condition_variable     m_Changed;
+        bool                        m_bOpen;
+        unsigned int                m_nWaiting;
+        std::vector<VmbUint64_t>    m_FromProducer;         // Handed back by the producer, i.e. the callback
+        std::vector<VmbUint64_t>    m_Returned;             // In the order they were handed back
+};
+
+/**
+ * @brief A worker held inside its first frame lets the queue fill up. Every frame beyond its capacity
+ * goes straight back to the source from the callback and is counted as overflow, and after Stop every
+ * frame was handed back exactly once
+ */
+bool TestObserverOverflow()
+{
+    static const VmbUint64_t EXTRA = 6;
+
+    ProgramConfig config;
+    char strProgram[]   = "streamTests";
+    char strWorkers[]   = "/w:1";
+    char strQueue[]     = "/q:4";
+    char *argv[]        = { strProgram, strWorkers, strQueue };
+    if( VmbErrorSuccess != config.ParseCommandline( 3, argv ))
+    {
+        std::cout<<"Observer: /w:1 /q:4 is not accepted\n";
+        return false;
+    }
+    GatedFrameSource source;
+    FrameQueueStatistics stats;
+    VmbUint64_t nFrames = 0;
+    bool bHeld = false;
+    {
+        FrameObserver observer( source, config );
+        const VmbUint64_t nCapacity = observer.GetStatistics().QueueCapacity;
+        nFrames = 1 + nCapacity + EXTRA;
+
+        observer.FrameReceived( TriggeredFrame( 1, GetHostTime() ));
+        bHeld = source.WaitForWorker( 2.0 );
+        for( VmbUint64_t nFrameID = 2; nFrameID <= nFrames; ++nFrameID )
+        {
+            observer.FrameReceived( TriggeredFrame( nFrameID, GetHostTime() ));
+        }
+        stats = observer.GetStatistics();
+        source.Release();
+        observer.Stop();
+    }
+
+    // The frames after the full queue, in order
+    std::vector<VmbUint64_t> overflowed;
+    for( VmbUint64_t nFrameID = nFrames - EXTRA + 1; nFrameID <= nFrames; ++nFrameID )
+    {
+        overflowed.push_back( nFrameID );
+    }
+    std::vector<VmbUint64_t> returned = source.GetReturned();
+    std::sort( returned.begin(), returned.end() );
+    bool bAllOnce = returned.size() == nFrames;
+    for( size_t i = 0; i < returned.size() && bAllOnce; ++i )
+    {
+        bAllOnce = returned[i] == i + 1;
+    }
+    if(     ( !bHeld )
+        ||  ( EXTRA != stats.Overflows )
+        ||  ( nFrames != stats.Received )
+        ||  ( source.GetFromProducer() != overflowed )
+        ||  ( !bAllOnce ))
+    {
+        std::cout<<"Observer: "<<( bHeld ? "" : "worker not held, " )<<stats.Received<<" of "<<nFrames<<" frames received, "<<stats.Overflows<<" overflows of "
+                 <<EXTRA<<", "<<source.GetFromProducer().size()<<" handed back by the callback, "<<returned.size()<<( bAllOnce ? " in all, each once\n" : " in all, not each once\n" );
+        return false;
+    }
+    std::cout<<"Observer: "<<stats.Overflows<<" of "<<nFrames<<" frames overflowed a queue of "<<stats.QueueCapacity<<" and went back at once, all handed back after Stop\n";
+    return true;
+}
+
+} // namespace
+
+/**
+ * @brief Checks how sources size, hand out and take back their frames, and reconnect, without a camera.
+ * Returns 0 if all tests pass, so it runs under ctest
+ */
+int main()
+{
+    bool bPassed = true;
+    bPassed = TestBufferSizerForgetsStall() && bPassed;
+    bPassed = TestCameraReconnect() && bPassed;
+    bPassed = TestSynchronizerRestart() && bPassed;
+    bPassed = TestObserverOverflow() && bPassed;
+
+    std::cout<<( bPassed ? "All tests passed\n" : "Tests FAILED\n" );
+    return bPassed ? 0 : 1;
+}
@@ -1,13 +1,24 @@
 #ifndef AVT_VMBAPI_EXAMPLES_LISTCAMERAS
 #define AVT_VMBAPI_EXAMPLES_LISTCAMERAS
 
+#include <string>
+
+#include "CameraInventory.h"
+
 namespace AVT {
 namespace VmbAPI {
 
 class ListCameras
 {
   public:
-    static void Print();
+    /**
+     * @brief Start Vimba and print the connected cameras
+     *
+     * @param eFormat Human readable, JSON or tab separated
+     * @param bWarmStart Validate the cameras of the cache instead of enumerating all cameras
+     * @param strCacheFile The inventory cache, none if empty
+     */
+    static void Print( InventoryFormat eFormat, bool bWarmStart, const std::string &strCacheFile );
 };
 
 }} // mamespace AVT::Vimba
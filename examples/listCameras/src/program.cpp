@@ -1,12 +1,46 @@
+#include <cstring>
 #include <iostream>
 
 #include "ListCameras.h"
 
 int main( int argc, char* argv[] ){
-    std::cout << "\n";
-    std::cout << "//////////////////////////////////////\n";
-    std::cout << "/// Vimba API List Cameras Example ///\n";
-    std::cout << "//////////////////////////////////////\n\n";
+    AVT::VmbAPI::InventoryFormat eFormat = AVT::VmbAPI::InventoryFormat_Text;
+    bool bWarmStart = false;
+    bool bHelp = false;
+    std::string strCacheFile = AVT::VmbAPI::CameraInventory::GetDefaultCacheFile();
+    for( int i = 1; i < argc; ++i ) {
+        if( 0 == std::strcmp( argv[i], "/j" )) {
+            eFormat = AVT::VmbAPI::InventoryFormat_Json;
+        } else if( 0 == std::strcmp( argv[i], "/t" )) {
+            eFormat = AVT::VmbAPI::InventoryFormat_Tsv;
+        } else if( 0 == std::strcmp( argv[i], "/w" )) {
+            bWarmStart = true;
+        } else if( 0 == std::strncmp( argv[i], "/c:", 3 ) && '\0' != argv[i][3] ) {
+            strCacheFile = argv[i] + 3;
+        } else if( 0 == std::strcmp( argv[i], "/n" )) {
+            strCacheFile.clear();
+        } else {
+            bHelp = true;
+        }
+    }
 
-    AVT::VmbAPI::ListCameras::Print();
+    if( AVT::VmbAPI::InventoryFormat_Text == eFormat || bHelp ) {
+        std::cout << "\n";
+        std::cout << "//////////////////////////////////////\n";
+        std::cout << "/// Vimba API List Cameras Example ///\n";
+        std::cout << "//////////////////////////////////////\n\n";
+    }
+
+    if( bHelp ) {
+        std::cout << "Usage: listCam [/j | /t] [/w] [/c:<file> | /n]\n\n"
+                  << "Parameters:   /j          Print the cameras as JSON\n"
+                  << "              /t          Print the cameras tab separated\n"
+                  << "              /w          Warm start, ask the cameras of the cache by\n"
+                  << "                          their ID instead of enumerating all cameras\n"
+                  << "              /c:<file>   Inventory cache (" << strCacheFile << " by default)\n"
+                  << "              /n          No inventory cache\n\n";
+        return 1;
+    }
+
+    AVT::VmbAPI::ListCameras::Print( eFormat, bWarmStart, strCacheFile );
 }